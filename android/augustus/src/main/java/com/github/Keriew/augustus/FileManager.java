@@ -37,7 +37,7 @@ public class FileManager {
         try {
             baseUri = newUri;
             FileInfo.base = new FileInfo(DocumentsContract.getTreeDocumentId(newUri), null,
-                DocumentsContract.Document.MIME_TYPE_DIR, 0, Uri.EMPTY);
+                DocumentsContract.Document.MIME_TYPE_DIR, 0, 0, Uri.EMPTY);
             return 1;
         } catch (Exception e) {
             Log.e("augustus", "Error in setBaseUri: " + e);
@@ -63,13 +63,14 @@ public class FileManager {
             DocumentsContract.Document.COLUMN_DOCUMENT_ID,
             DocumentsContract.Document.COLUMN_DISPLAY_NAME,
             DocumentsContract.Document.COLUMN_MIME_TYPE,
-            DocumentsContract.Document.COLUMN_LAST_MODIFIED
+            DocumentsContract.Document.COLUMN_LAST_MODIFIED,
+            DocumentsContract.Document.COLUMN_SIZE
         };
         Cursor cursor = activity.getContentResolver().query(children, columns, null, null, null);
         if (cursor != null) {
             while (cursor.moveToNext()) {
                 FileInfo fileInfo = new FileInfo(cursor.getString(0), cursor.getString(1), cursor.getString(2),
-                    cursor.getLong(3), dir);
+                    cursor.getLong(3), cursor.isNull(4) ? 0 : cursor.getLong(4), dir);
                 result.put(cursor.getString(1).toLowerCase(), fileInfo);
             }
             cursor.close();
@@ -213,7 +214,7 @@ public class FileManager {
                 HashMap<String, FileInfo> dirCache = directoryStructureCache.get(folderInfo.getUri());
                 if (dirCache != null) {
                     fileInfo = new FileInfo(DocumentsContract.getDocumentId(fileUri),
-                        fileName, "application/octet-stream", System.currentTimeMillis(), folderInfo.getUri());
+                        fileName, "application/octet-stream", System.currentTimeMillis(), 0, folderInfo.getUri());
                     dirCache.put(fileName.toLowerCase(), fileInfo);
                 }
             } else {
@@ -260,7 +261,7 @@ public class FileManager {
             if (dirCache != null) {
                 newFolderInfo = new FileInfo(DocumentsContract.getDocumentId(folderUri),
                     folderName, DocumentsContract.Document.MIME_TYPE_DIR,
-                    System.currentTimeMillis(), folderInfo.getUri());
+                    System.currentTimeMillis(), 0, folderInfo.getUri());
                 dirCache.put(folderName.toLowerCase(), newFolderInfo);
             }
         } catch (Exception e) {
@@ -278,14 +279,16 @@ public class FileManager {
         private final String mimeType;
         private final Uri parent;
         private long modifiedTime;
+        private final long size;
         private Uri uri;
 
-        private FileInfo(String documentId, String name, String mimeType, long modifiedTime, Uri parent) {
+        private FileInfo(String documentId, String name, String mimeType, long modifiedTime, long size, Uri parent) {
             this.documentId = documentId;
             this.name = name;
             this.mimeType = mimeType;
             this.parent = parent;
             this.modifiedTime = modifiedTime / 1000;
+            this.size = size;
             this.uri = Uri.EMPTY;
         }
 
@@ -297,6 +300,10 @@ public class FileManager {
             return this.modifiedTime;
         }
 
+        public long getSize() {
+            return this.size;
+        }
+
         public void updateModifiedTime() {
             this.modifiedTime = System.currentTimeMillis() / 1000;
         }
@@ -1,6 +1,7 @@
 #include "log.h"
 
 #include "assets/assets.h"
+#include "assets/bundle.h"
 #include "assets/group.h"
 #include "assets/image.h"
 #include "assets/layer.h"
@@ -25,6 +26,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -39,6 +41,8 @@
 #define CURSORS_DIR "Cursors"
 #define CURSORS_NAME "Color_Cursors"
 #define BYTES_PER_PIXEL 4
+#define BENCHMARK_ATLAS_SIZE 4096
+#define BENCHMARK_RUNS 5
 
 #ifdef FORMAT_XML
 #define FORMAT_NEWLINE "\n"
@@ -717,9 +721,320 @@ static void pack_cursors(void)
     image_packer_free(&packer);
 }
 
+static int compare_bundle_files(const void *a, const void *b)
+{
+    const asset_bundle_file *file_a = a;
+    const asset_bundle_file *file_b = b;
+    return platform_file_manager_compare_filename(file_a->path, file_b->path);
+}
+
+static int write_bundle(const image_packer *packer, asset_bundle_file *files)
+{
+    int total_pages = packer->result.images_needed;
+    color_t **pages = calloc(total_pages ? total_pages : 1, sizeof(color_t *));
+    int *page_widths = malloc(sizeof(int) * (total_pages ? total_pages : 1));
+    int *page_heights = malloc(sizeof(int) * (total_pages ? total_pages : 1));
+    int result = pages && page_widths && page_heights;
+    for (int i = 0; result && i < total_pages; i++) {
+        int is_last_page = i == total_pages - 1;
+        page_widths[i] = is_last_page ? packer->result.last_image_width : ASSETS_IMAGE_SIZE;
+        page_heights[i] = is_last_page ? packer->result.last_image_height : ASSETS_IMAGE_SIZE;
+        pages[i] = calloc((size_t) page_widths[i] * page_heights[i], sizeof(color_t));
+        result = pages[i] != 0;
+    }
+    if (!result) {
+        log_error("Out of memory when creating the bundle pages.", 0, 0);
+    }
+
+    int total_files = 0;
+    packed_asset *asset;
+    array_foreach(packed_assets, asset) {
+        if (!result || !asset->pixels) {
+            continue;
+        }
+        asset_bundle_file *file = &files[total_files++];
+        memset(file, 0, sizeof(asset_bundle_file));
+        file->path = asset->path;
+        file->width = asset->img.original.width;
+        file->height = asset->img.original.height;
+        if (!asset->img.width || !asset->img.height) {
+            continue;
+        }
+        file->x_offset = asset->img.x_offset;
+        file->y_offset = asset->img.y_offset;
+        file->cropped_width = asset->img.width;
+        file->cropped_height = asset->img.height;
+        file->page = asset->rect->output.image_index;
+        file->page_x = asset->rect->output.x;
+        file->page_y = asset->rect->output.y;
+
+        final_image_pixels = pages[file->page];
+        final_image_width = page_widths[file->page];
+        color_t *src = asset->pixels + asset->img.y_offset * asset->img.original.width + asset->img.x_offset;
+        copy_to_final_image(src, asset->rect, asset->img.original.width);
+    }
+    final_image_pixels = 0;
+
+    if (result) {
+        qsort(files, total_files, sizeof(asset_bundle_file), compare_bundle_files);
+        snprintf(current_file, FILE_NAME_MAX, "%s/%s", ASSETS_DIR_NAME, ASSET_BUNDLE_FILE_NAME);
+        log_info("Creating bundle file...", 0, 0);
+        result = asset_bundle_write(current_file, files, total_files, pages, page_widths, page_heights,
+            total_pages);
+        if (result) {
+            printf("Info: %d files bundled. Pages: %d.\n", total_files, total_pages);
+        }
+    }
+
+    for (int i = 0; pages && i < total_pages; i++) {
+        free(pages[i]);
+    }
+    free(pages);
+    free(page_widths);
+    free(page_heights);
+    return result;
+}
+
+static int create_bundle(void)
+{
+    array_init(packed_assets, PACKED_ASSETS_BLOCK_SIZE, new_packed_asset, packed_asset_active);
+    for (int group_id = 0; group_id < group_get_total(); group_id++) {
+        get_assets_for_group(group_id);
+    }
+
+    image_packer packer;
+    asset_bundle_file *files = malloc(sizeof(asset_bundle_file) * (packed_assets.size ? packed_assets.size : 1));
+    if (!files || image_packer_init(&packer, packed_assets.size, ASSETS_IMAGE_SIZE, ASSETS_IMAGE_SIZE) !=
+        IMAGE_PACKER_OK) {
+        log_error("Out of memory.", 0, 0);
+        free(files);
+        return 0;
+    }
+    // Rotated images would need to be rotated back when they are read, so rotation is not allowed
+    packer.options.fail_policy = IMAGE_PACKER_NEW_IMAGE;
+    packer.options.reduce_image_size = 1;
+    packer.options.sort_by = IMAGE_PACKER_SORT_BY_AREA;
+
+    log_info("Loading the images...", 0, 0);
+
+    populate_asset_rects(&packer);
+
+    int result = 0;
+    if (image_packer_pack(&packer) != packed_assets.size) {
+        log_error("Error during pack.", 0, 0);
+    } else {
+        result = write_bundle(&packer, files);
+    }
+
+    packed_asset *asset;
+    array_foreach(packed_assets, asset) {
+        free(asset->pixels);
+    }
+    image_packer_free(&packer);
+    free(files);
+    return result;
+}
+
+typedef struct {
+    unsigned int width;
+    unsigned int height;
+} benchmark_rect;
+
+typedef struct {
+    double milliseconds;
+    unsigned int images;
+    double used_area;
+    double total_area;
+} benchmark_result;
+
+static struct {
+    benchmark_rect *rects;
+    int total_rects;
+    int *group_starts;
+    int total_groups;
+} benchmark;
+
+static void free_benchmark_rects(void)
+{
+    free(benchmark.rects);
+    free(benchmark.group_starts);
+    benchmark.rects = 0;
+    benchmark.group_starts = 0;
+    benchmark.total_rects = 0;
+    benchmark.total_groups = 0;
+}
+
+static void free_packed_asset_pixels(void)
+{
+    packed_asset *asset;
+    array_foreach(packed_assets, asset) {
+        free(asset->pixels);
+        asset->pixels = 0;
+    }
+}
+
+static int collect_benchmark_rects(void)
+{
+    benchmark.total_groups = group_get_total();
+    benchmark.group_starts = malloc(sizeof(int) * (benchmark.total_groups + 1));
+    if (!benchmark.group_starts) {
+        log_error("Out of memory.", 0, 0);
+        free_benchmark_rects();
+        return 0;
+    }
+    for (int group_id = 0; group_id < benchmark.total_groups; group_id++) {
+        benchmark.group_starts[group_id] = benchmark.total_rects;
+        const image_groups *group = group_get_from_id(group_id);
+        if (!group || !*group->name) {
+            continue;
+        }
+        array_init(packed_assets, PACKED_ASSETS_BLOCK_SIZE, new_packed_asset, packed_asset_active);
+        get_assets_for_group(group_id);
+
+        image_packer packer;
+        benchmark_rect *rects = realloc(benchmark.rects,
+            sizeof(benchmark_rect) * (benchmark.total_rects + packed_assets.size));
+        if (!rects) {
+            log_error("Out of memory.", 0, 0);
+            free_packed_asset_pixels();
+            free_benchmark_rects();
+            return 0;
+        }
+        benchmark.rects = rects;
+        if (image_packer_init(&packer, packed_assets.size, ASSETS_IMAGE_SIZE, ASSETS_IMAGE_SIZE) !=
+            IMAGE_PACKER_OK) {
+            log_error("Out of memory.", 0, 0);
+            image_packer_free(&packer);
+            free_packed_asset_pixels();
+            free_benchmark_rects();
+            return 0;
+        }
+        populate_asset_rects(&packer);
+
+        packed_asset *asset;
+        array_foreach(packed_assets, asset) {
+            if (asset->rect && asset->rect->input.width && asset->rect->input.height) {
+                benchmark.rects[benchmark.total_rects].width = asset->rect->input.width;
+                benchmark.rects[benchmark.total_rects].height = asset->rect->input.height;
+                benchmark.total_rects++;
+            }
+        }
+        free_packed_asset_pixels();
+        image_packer_free(&packer);
+    }
+    benchmark.group_starts[benchmark.total_groups] = benchmark.total_rects;
+    return 1;
+}
+
+static void pack_benchmark_rects(int first, int last, unsigned int size, int allow_rotation,
+    image_packer_algorithm algorithm, benchmark_result *result)
+{
+    if (first == last) {
+        return;
+    }
+    image_packer packer;
+    if (image_packer_init(&packer, last - first, size, size) != IMAGE_PACKER_OK) {
+        log_error("Out of memory.", 0, 0);
+        image_packer_free(&packer);
+        return;
+    }
+    packer.options.allow_rotation = allow_rotation;
+    packer.options.reduce_image_size = 1;
+    packer.options.sort_by = IMAGE_PACKER_SORT_BY_AREA;
+    packer.options.fail_policy = IMAGE_PACKER_NEW_IMAGE;
+    packer.options.algorithm = algorithm;
+
+    for (int i = first; i < last; i++) {
+        packer.rects[i - first].input.width = benchmark.rects[i].width;
+        packer.rects[i - first].input.height = benchmark.rects[i].height;
+    }
+
+    clock_t start = clock();
+    image_packer_pack(&packer);
+    result->milliseconds += (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+
+    double total_area = (packer.result.images_needed - 1) * (double) size * size +
+        (double) packer.result.last_image_width * packer.result.last_image_height;
+    result->images += packer.result.images_needed;
+    result->total_area += total_area;
+    result->used_area += image_packer_get_occupancy(&packer) * total_area;
+
+    image_packer_free(&packer);
+}
+
+static void print_benchmark_result(const char *algorithm, const char *atlas, const benchmark_result *result)
+{
+    printf("%-12s %-24s %10.2f %7u %9.1f%%\n", algorithm, atlas, result->milliseconds / BENCHMARK_RUNS,
+        result->images / BENCHMARK_RUNS, result->total_area ? result->used_area * 100 / result->total_area : 0);
+}
+
+static void run_packer_benchmark(void)
+{
+    static const struct {
+        image_packer_algorithm algorithm;
+        const char *name;
+    } algorithms[] = {
+        { IMAGE_PACKER_EMPTY_AREAS, "empty areas" },
+        { IMAGE_PACKER_SKYLINE, "skyline" }
+    };
+
+    log_info("Collecting the image sizes...", 0, 0);
+
+    if (!collect_benchmark_rects()) {
+        return;
+    }
+
+    printf("Info: %d images in %d groups, %d runs each.\n", benchmark.total_rects, benchmark.total_groups,
+        BENCHMARK_RUNS);
+    printf("%-12s %-24s %10s %7s %10s\n", "Algorithm", "Atlas", "Time (ms)", "Images", "Occupancy");
+
+    for (int i = 0; i < sizeof(algorithms) / sizeof(algorithms[0]); i++) {
+        // One image per group, as this packer creates them
+        benchmark_result per_group = { 0 };
+        // All images in one atlas, as the game loads them
+        benchmark_result all_groups = { 0 };
+        for (int run = 0; run < BENCHMARK_RUNS; run++) {
+            for (int group_id = 0; group_id < benchmark.total_groups; group_id++) {
+                pack_benchmark_rects(benchmark.group_starts[group_id], benchmark.group_starts[group_id + 1],
+                    ASSETS_IMAGE_SIZE, 1, algorithms[i].algorithm, &per_group);
+            }
+            pack_benchmark_rects(0, benchmark.total_rects, BENCHMARK_ATLAS_SIZE, 0,
+                algorithms[i].algorithm, &all_groups);
+        }
+        print_benchmark_result(algorithms[i].name, "per group, 2048x2048", &per_group);
+        print_benchmark_result(algorithms[i].name, "all groups, 4096x4096", &all_groups);
+    }
+
+    free_benchmark_rects();
+}
+
+static int load_assetlists(const dir_listing *xml_files)
+{
+    if (!group_create_all(xml_files->num_files) || !asset_image_init_array()) {
+        log_error("Not enough memory to initialize extra assets.", 0, 0);
+        return 0;
+    }
+
+    xml_init();
+
+    for (int i = 0; i < xml_files->num_files; ++i) {
+        xml_process_assetlist_file(xml_files->files[i].name);
+    }
+
+    xml_finish();
+
+    return 1;
+}
+
 int main(int argc, char **argv)
 {
     int using_custom_path = 0;
+    int benchmark_only = argc > 1 && strcmp(argv[1], "--benchmark") == 0;
+    int bundle_only = argc > 1 && strcmp(argv[1], "--bundle") == 0;
+    if (benchmark_only || bundle_only) {
+        argc--;
+        argv++;
+    }
     if (argc == 2) {
         log_info("Attempting to use the path", argv[1], 0);
         if (!platform_file_manager_set_base_path(argv[1])) {
@@ -735,29 +1050,41 @@ int main(int argc, char **argv)
         }
         log_error("Please add a valid assets folder to this directory.\n"
             "Alternatively, you can run as:\n\n"
-            "asset_packer.exe [WORK_DIRECTORY]\n\n"
-            "where WORK_DIRECTORY is the directory where the assets folder is in.", 0, 0);
+            "asset_packer.exe [--benchmark | --bundle] [WORK_DIRECTORY]\n\n"
+            "where WORK_DIRECTORY is the directory where the assets folder is in.\n"
+            "With --benchmark, the packing algorithms are only compared and nothing is written.\n"
+            "With --bundle, the images of the assets folder are only written to " ASSET_BUNDLE_FILE_NAME
+            " in that folder.", 0, 0);
         return 1;
     }
 
+    if (benchmark_only) {
+        if (!load_assetlists(xml_files)) {
+            return 3;
+        }
+        run_packer_benchmark();
+        png_unload();
+        return 0;
+    }
+
+    if (bundle_only) {
+        if (!load_assetlists(xml_files)) {
+            return 3;
+        }
+        int result = create_bundle();
+        png_unload();
+        return result ? 0 : 4;
+    }
+
     if (!prepare_packed_assets_dir()) {
         return 2;
     }
 
 #ifdef PACK_XMLS
-    if (!group_create_all(xml_files->num_files) || !asset_image_init_array()) {
-        log_error("Not enough memory to initialize extra assets.", 0, 0);
+    if (!load_assetlists(xml_files)) {
         return 3;
     }
 
-    xml_init();
-
-    for (int i = 0; i < xml_files->num_files; ++i) {
-        xml_process_assetlist_file(xml_files->files[i].name);
-    }
-
-    xml_finish();
-
     log_info("Preparing to pack...", 0, 0);
 
     for (int i = 0; i < group_get_total(); i++) {
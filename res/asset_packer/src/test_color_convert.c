@@ -0,0 +1,125 @@
+#include "core/color_convert.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The plain C versions are compiled a second time under other names, so they can be compared
+// with the vectorized versions that the game uses
+#define COLOR_CONVERT_NO_SIMD
+#define color_convert_sg2_pixels reference_convert_sg2_pixels
+#define color_convert_to_white reference_convert_to_white
+#define color_convert_to_grayscale reference_convert_to_grayscale
+#define color_convert_rgba_to_argb reference_convert_rgba_to_argb
+#include "core/color_convert.c"
+#undef color_convert_sg2_pixels
+#undef color_convert_to_white
+#undef color_convert_to_grayscale
+#undef color_convert_rgba_to_argb
+
+// Every color, plus a few leftover pixels for the plain C tail of the vectorized versions
+#define TOTAL_PIXELS ((1 << 24) + 3)
+#define TOTAL_SG2_PIXELS ((1 << 16) + 3)
+
+typedef void (*color_function)(color_t *pixels, int total_pixels);
+
+static color_t *expected;
+static color_t *actual;
+
+static int compare(const char *name, int total_pixels)
+{
+    if (memcmp(expected, actual, total_pixels * sizeof(color_t)) == 0) {
+        return 1;
+    }
+    int total_different = 0;
+    int first_different = -1;
+    for (int i = 0; i < total_pixels; i++) {
+        if (expected[i] != actual[i]) {
+            if (first_different < 0) {
+                first_different = i;
+            }
+            total_different++;
+        }
+    }
+    printf("%s: %d different pixels, first at %d: expected %08x, got %08x\n", name, total_different,
+        first_different, expected[first_different], actual[first_different]);
+    return 0;
+}
+
+static void fill_pixels(color_t alpha)
+{
+    for (int i = 0; i < TOTAL_PIXELS; i++) {
+        expected[i] = alpha | (i & COLOR_CHANNEL_RGB);
+    }
+    memcpy(actual, expected, TOTAL_PIXELS * sizeof(color_t));
+}
+
+static int check_function(const char *name, color_function reference, color_function vectorized)
+{
+    static const color_t ALPHAS[] = { ALPHA_TRANSPARENT, 0x01000000, 0x80000000, ALPHA_OPAQUE };
+    int ok = 1;
+    for (int i = 0; i < (int) (sizeof(ALPHAS) / sizeof(color_t)); i++) {
+        fill_pixels(ALPHAS[i]);
+        reference(expected, TOTAL_PIXELS);
+        vectorized(actual, TOTAL_PIXELS);
+        ok &= compare(name, TOTAL_PIXELS);
+    }
+    // Unaligned starts and every short length
+    for (int start = 1; start < 4; start++) {
+        for (int length = 0; length < 16; length++) {
+            fill_pixels(ALPHA_OPAQUE);
+            reference(&expected[start], length);
+            vectorized(&actual[start], length);
+            ok &= compare(name, start + length + 1);
+        }
+    }
+    if (ok) {
+        printf("%s: ok\n", name);
+    }
+    return ok;
+}
+
+static int check_sg2_pixels(void)
+{
+    uint8_t *src = malloc(TOTAL_SG2_PIXELS * 2 + 1);
+    if (!src) {
+        return 0;
+    }
+    for (int i = 0; i < TOTAL_SG2_PIXELS; i++) {
+        src[i * 2] = i & 0xff;
+        src[i * 2 + 1] = (i >> 8) & 0xff;
+    }
+    int ok = 1;
+    for (int use_transparent_color = 0; use_transparent_color <= 1; use_transparent_color++) {
+        reference_convert_sg2_pixels(src, expected, TOTAL_SG2_PIXELS, use_transparent_color);
+        color_convert_sg2_pixels(src, actual, TOTAL_SG2_PIXELS, use_transparent_color);
+        ok &= compare("sg2 pixels", TOTAL_SG2_PIXELS);
+        // An odd start, so the loads are not aligned
+        reference_convert_sg2_pixels(&src[1], expected, TOTAL_SG2_PIXELS - 1, use_transparent_color);
+        color_convert_sg2_pixels(&src[1], actual, TOTAL_SG2_PIXELS - 1, use_transparent_color);
+        ok &= compare("sg2 pixels", TOTAL_SG2_PIXELS - 1);
+    }
+    free(src);
+    if (ok) {
+        printf("sg2 pixels: ok\n");
+    }
+    return ok;
+}
+
+int main(void)
+{
+    expected = malloc(TOTAL_PIXELS * sizeof(color_t));
+    actual = malloc(TOTAL_PIXELS * sizeof(color_t));
+    if (!expected || !actual) {
+        printf("Unable to allocate memory for the test\n");
+        return 1;
+    }
+    int ok = check_sg2_pixels();
+    ok &= check_function("white", reference_convert_to_white, color_convert_to_white);
+    ok &= check_function("grayscale", reference_convert_to_grayscale, color_convert_to_grayscale);
+    ok &= check_function("rgba to argb", reference_convert_rgba_to_argb, color_convert_rgba_to_argb);
+    free(expected);
+    free(actual);
+    printf(ok ? "All pixel conversions match\n" : "Some pixel conversions differ\n");
+    return ok ? 0 : 1;
+}
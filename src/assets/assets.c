@@ -1,10 +1,13 @@
 #include "assets.h"
 
+#include "assets/bundle.h"
+#include "assets/cache.h"
 #include "assets/group.h"
 #include "assets/image.h"
 #include "assets/xml.h"
 #include "core/dir.h"
 #include "core/log.h"
+#include "core/trace.h"
 #include "graphics/renderer.h"
 #include "core/png_read.h"
 
@@ -18,21 +21,15 @@ static struct {
     int font_lookup[ASSET_FONT_MAX_KEY];
 } data;
 
-void assets_init(int force_reload, color_t **main_images, int *main_image_widths)
+static void load_from_assetlists(color_t **main_images, int *main_image_widths, uint64_t cache_key)
 {
-    if (graphics_renderer()->has_image_atlas(ATLAS_EXTRA_ASSET) && !force_reload) {
-        asset_image_reload_climate();
-        return;
-    }
-
-    graphics_renderer()->free_image_atlas(ATLAS_EXTRA_ASSET);
-
     const dir_listing *xml_files = dir_find_files_with_extension(ASSETS_DIRECTORY "/" ASSETS_IMAGE_PATH, "xml");
 
     if (!group_create_all(xml_files->num_files) || !asset_image_init_array()) {
         log_error("Not enough memory to initialize extra assets. The game will probably crash.", 0, 0);
     }
 
+    trace_begin("xml");
     xml_init();
 
     for (int i = 0; i < xml_files->num_files; ++i) {
@@ -40,9 +37,33 @@ void assets_init(int force_reload, color_t **main_images, int *main_image_widths
     }
 
     xml_finish();
+    trace_end("xml");
 
-    asset_image_load_all(main_images, main_image_widths);
+    asset_image_load_all(main_images, main_image_widths, cache_key);
+}
 
+void assets_init(int force_reload, int climate_id, int is_editor, color_t **main_images, int *main_image_widths)
+{
+    if (graphics_renderer()->has_image_atlas(ATLAS_EXTRA_ASSET) && !force_reload) {
+        asset_image_reload_climate();
+        return;
+    }
+
+    graphics_renderer()->free_image_atlas(ATLAS_EXTRA_ASSET);
+
+    trace_begin("load_cache");
+    uint64_t cache_key = asset_cache_get_key(climate_id, is_editor);
+    int loaded_from_cache = asset_cache_load(cache_key);
+    trace_end("load_cache");
+    if (!loaded_from_cache) {
+        trace_begin("load_bundle");
+        asset_bundle_load();
+        trace_end("load_bundle");
+        load_from_assetlists(main_images, main_image_widths, cache_key);
+        asset_bundle_unload();
+    }
+
+    group_build_name_index();
     group_set_for_external_files();
 
     // By default, if the requested image is not found, the roadblock image will be shown.
@@ -153,7 +174,9 @@ int assets_load_single_group(const char *file_name, color_t **main_images, int *
     }
     xml_init();
     graphics_renderer()->free_image_atlas(ATLAS_EXTRA_ASSET);
-    return xml_process_assetlist_file(file_name) && asset_image_load_all(main_images, main_image_widths);
+    int result = xml_process_assetlist_file(file_name) && asset_image_load_all(main_images, main_image_widths, 0);
+    group_build_name_index();
+    return result;
 }
 
 int assets_get_group_id(const char *assetlist_name)
@@ -176,12 +199,9 @@ int assets_get_image_id(const char *assetlist_name, const char *image_name)
         log_info("Asset group not found: ", assetlist_name, 0);
         return data.roadblock_image_id;
     }
-    const asset_image *img = asset_image_get_from_id(group->first_image_index);
-    while (img && img->index <= (unsigned int) group->last_image_index) {
-        if (img->id && strcmp(img->id, image_name) == 0) {
-            return img->index + IMAGE_MAIN_ENTRIES;
-        }
-        img = asset_image_get_from_id(img->index + 1);
+    int image_index = group_get_image_index(group, image_name);
+    if (image_index >= 0) {
+        return image_index + IMAGE_MAIN_ENTRIES;
     }
     log_info("Asset image not found: ", image_name, 0);
     log_info("Asset group is: ", assetlist_name, 0);
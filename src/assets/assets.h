@@ -103,7 +103,7 @@ typedef enum {
 	ASSET_FONT_MAX_KEY
 } asset_font_id;
 
-void assets_init(int force_reload, color_t **main_images, int *main_image_widths);
+void assets_init(int force_reload, int climate_id, int is_editor, color_t **main_images, int *main_image_widths);
 
 int assets_load_single_group(const char *file_name, color_t **main_images, int *main_image_widths);
 
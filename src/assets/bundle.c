@@ -0,0 +1,468 @@
+#include "bundle.h"
+
+#include "core/buffer.h"
+#include "core/dir.h"
+#include "core/file.h"
+#include "core/log.h"
+#include "core/lz4.h"
+#include "platform/file_manager.h"
+
+#ifndef BUILDING_ASSET_PACKER
+#include "core/thread_pool.h"
+#endif
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUNDLE_MAGIC "AUGBUNDL"
+#define BUNDLE_MAGIC_LENGTH 8
+#define BUNDLE_FORMAT_VERSION 1
+
+#define FILE_RECORD_SIZE (sizeof(uint16_t) + 9 * sizeof(int32_t))
+#define PAGE_RECORD_SIZE (3 * sizeof(int32_t))
+
+static int compare_paths(const char *a, const char *b)
+{
+    // Paths from the assetlists do not always match the case of the files
+    return platform_file_manager_compare_filename(a, b);
+}
+
+#ifndef BUILDING_ASSET_PACKER
+
+typedef struct {
+    const uint8_t *stored;
+    int stored_size;
+    uint8_t *decompressed;
+    const uint8_t *pixels;
+    int width;
+    int height;
+    int result;
+} bundle_page;
+
+static struct {
+    file_mapping file;
+    asset_bundle_file *files;
+    uint8_t *is_outdated;
+    int total_files;
+    bundle_page *pages;
+    int total_pages;
+    unsigned int modified_time;
+} data;
+
+static int read_files(buffer *buf)
+{
+    int total_files = buffer_read_i32(buf);
+    if (buf->overflow || total_files <= 0 || (size_t) total_files > (buf->size - buf->index) / FILE_RECORD_SIZE) {
+        return 0;
+    }
+    data.files = malloc(sizeof(asset_bundle_file) * total_files);
+    data.is_outdated = calloc(total_files, sizeof(uint8_t));
+    if (!data.files || !data.is_outdated) {
+        return 0;
+    }
+    for (int i = 0; i < total_files; i++) {
+        asset_bundle_file *file = &data.files[i];
+        // The paths are stored with their terminator, so they are used straight from the mapping
+        uint16_t length = buffer_read_u16(buf);
+        if (buf->overflow || !length || length > buf->size - buf->index || buf->data[buf->index + length - 1]) {
+            return 0;
+        }
+        file->path = (const char *) &buf->data[buf->index];
+        buffer_skip(buf, length);
+        file->width = buffer_read_i32(buf);
+        file->height = buffer_read_i32(buf);
+        file->x_offset = buffer_read_i32(buf);
+        file->y_offset = buffer_read_i32(buf);
+        file->cropped_width = buffer_read_i32(buf);
+        file->cropped_height = buffer_read_i32(buf);
+        file->page = buffer_read_i32(buf);
+        file->page_x = buffer_read_i32(buf);
+        file->page_y = buffer_read_i32(buf);
+        if (buf->overflow) {
+            return 0;
+        }
+    }
+    data.total_files = total_files;
+    return 1;
+}
+
+static int read_pages(buffer *buf)
+{
+    int total_pages = buffer_read_i32(buf);
+    if (buf->overflow || total_pages < 0 || (size_t) total_pages > (buf->size - buf->index) / PAGE_RECORD_SIZE) {
+        return 0;
+    }
+    data.pages = calloc(total_pages ? total_pages : 1, sizeof(bundle_page));
+    if (!data.pages) {
+        return 0;
+    }
+    data.total_pages = total_pages;
+    size_t data_offset = buf->index + total_pages * PAGE_RECORD_SIZE;
+    for (int i = 0; i < total_pages; i++) {
+        bundle_page *page = &data.pages[i];
+        page->width = buffer_read_i32(buf);
+        page->height = buffer_read_i32(buf);
+        page->stored_size = buffer_read_i32(buf);
+        if (page->width <= 0 || page->height <= 0 || (size_t) page->width > INT_MAX / sizeof(color_t) / page->height ||
+            page->stored_size <= 0 || (size_t) page->stored_size > buf->size - data_offset) {
+            return 0;
+        }
+        page->stored = &buf->data[data_offset];
+        data_offset += page->stored_size;
+    }
+    return 1;
+}
+
+static int file_is_valid(const asset_bundle_file *file)
+{
+    if (file->width <= 0 || file->height <= 0 || file->x_offset < 0 || file->y_offset < 0 ||
+        file->cropped_width < 0 || file->cropped_height < 0 ||
+        file->cropped_width > file->width - file->x_offset || file->cropped_height > file->height - file->y_offset) {
+        return 0;
+    }
+    if (!file->cropped_width || !file->cropped_height) {
+        return 1;
+    }
+    if (file->page < 0 || file->page >= data.total_pages) {
+        return 0;
+    }
+    const bundle_page *page = &data.pages[file->page];
+    return file->page_x >= 0 && file->page_y >= 0 &&
+        file->cropped_width <= page->width - file->page_x && file->cropped_height <= page->height - file->page_y;
+}
+
+static void decompress_page(void *item)
+{
+    bundle_page *page = item;
+    int pixels_size = (int) (sizeof(color_t) * page->width * page->height);
+    // Pages that do not get smaller when compressed are stored as they are
+    if (page->stored_size == pixels_size) {
+        page->pixels = page->stored;
+        page->result = 1;
+        return;
+    }
+    page->decompressed = malloc(pixels_size);
+    if (!page->decompressed) {
+        page->result = 0;
+        return;
+    }
+    page->result = lz4_decompress(page->stored, page->stored_size, page->decompressed, pixels_size);
+    page->pixels = page->decompressed;
+}
+
+static int decompress_pages(void)
+{
+    thread_pool_run_for_each(decompress_page, data.pages, sizeof(bundle_page), data.total_pages);
+    for (int i = 0; i < data.total_pages; i++) {
+        if (!data.pages[i].result) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int find_file_index(const char *path)
+{
+    int first = 0;
+    int last = data.total_files - 1;
+    while (first <= last) {
+        int middle = first + (last - first) / 2;
+        int result = compare_paths(path, data.files[middle].path);
+        if (result == 0) {
+            return middle;
+        } else if (result < 0) {
+            last = middle - 1;
+        } else {
+            first = middle + 1;
+        }
+    }
+    return -1;
+}
+
+static const asset_bundle_file *get_file(const char *path)
+{
+    if (!data.total_files || !path) {
+        return 0;
+    }
+    int index = find_file_index(path);
+    return index >= 0 && !data.is_outdated[index] ? &data.files[index] : 0;
+}
+
+static int find_bundle_modified_time(void)
+{
+    const dir_listing *listing = dir_find_files_with_extension(ASSETS_DIRECTORY, "bundle");
+    for (int i = 0; i < listing->num_files; i++) {
+        if (compare_paths(listing->files[i].name, ASSET_BUNDLE_FILE_NAME) == 0) {
+            data.modified_time = listing->files[i].modified_time;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void mark_outdated_files_in_directory(const char *directory)
+{
+    char path[FILE_NAME_MAX];
+    snprintf(path, FILE_NAME_MAX, *directory ? "%s/%s" : "%s%s", ASSETS_DIRECTORY, directory);
+    const dir_listing *listing = dir_find_files_with_extension(path, "png");
+    for (int i = 0; i < listing->num_files; i++) {
+        if (listing->files[i].modified_time <= data.modified_time) {
+            continue;
+        }
+        snprintf(path, FILE_NAME_MAX, *directory ? "%s/%s" : "%s%s", directory, listing->files[i].name);
+        int index = find_file_index(path);
+        if (index >= 0) {
+            data.is_outdated[index] = 1;
+        }
+    }
+}
+
+static void mark_outdated_files(void)
+{
+    // Files are sorted by path, so the files of a directory are usually next to each other
+    char directory[FILE_NAME_MAX] = { 0 };
+    for (int i = 0; i < data.total_files; i++) {
+        const char *path = data.files[i].path;
+        int length = (int) (file_remove_path(path) - path);
+        if (length) {
+            length--;
+        }
+        if (i > 0 && strncmp(directory, path, length) == 0 && directory[length] == 0) {
+            continue;
+        }
+        snprintf(directory, FILE_NAME_MAX, "%.*s", length, path);
+        mark_outdated_files_in_directory(directory);
+    }
+}
+
+int asset_bundle_load(void)
+{
+    asset_bundle_unload();
+    if (!find_bundle_modified_time()) {
+        return 0;
+    }
+    FILE *fp = file_open_asset(ASSET_BUNDLE_FILE_NAME, "rb");
+    if (!fp) {
+        return 0;
+    }
+    int mapped = file_map(fp, &data.file);
+    file_close(fp);
+    if (!mapped) {
+        return 0;
+    }
+    buffer buf;
+    buffer_init(&buf, data.file.data, data.file.size);
+    char magic[BUNDLE_MAGIC_LENGTH];
+    buffer_read_raw(&buf, magic, BUNDLE_MAGIC_LENGTH);
+    int32_t version = buffer_read_i32(&buf);
+    if (buf.overflow || memcmp(magic, BUNDLE_MAGIC, BUNDLE_MAGIC_LENGTH) != 0 || version != BUNDLE_FORMAT_VERSION) {
+        log_info("The extra assets bundle is outdated and will not be used", 0, 0);
+        asset_bundle_unload();
+        return 0;
+    }
+    int result = read_files(&buf) && read_pages(&buf);
+    for (int i = 0; result && i < data.total_files; i++) {
+        result = file_is_valid(&data.files[i]);
+    }
+    if (!result || !decompress_pages()) {
+        log_error("The extra assets bundle is broken and will not be used", 0, 0);
+        asset_bundle_unload();
+        return 0;
+    }
+    mark_outdated_files();
+    return 1;
+}
+
+void asset_bundle_unload(void)
+{
+    for (int i = 0; i < data.total_pages; i++) {
+        free(data.pages[i].decompressed);
+    }
+    free(data.pages);
+    free(data.files);
+    free(data.is_outdated);
+    if (data.file.data) {
+        file_unmap(&data.file);
+    }
+    memset(&data, 0, sizeof(data));
+}
+
+int asset_bundle_has_file(const char *path)
+{
+    return get_file(path) != 0;
+}
+
+int asset_bundle_get_image_size(const char *path, int *width, int *height)
+{
+    const asset_bundle_file *file = get_file(path);
+    if (!file) {
+        return 0;
+    }
+    *width = file->width;
+    *height = file->height;
+    return 1;
+}
+
+int asset_bundle_read(const char *path, color_t *pixels, int src_x, int src_y, int width, int height)
+{
+    const asset_bundle_file *file = get_file(path);
+    if (!file) {
+        return 0;
+    }
+    // Only the part that overlaps the cropped pixels needs to be copied
+    int x_start = src_x > file->x_offset ? src_x : file->x_offset;
+    int y_start = src_y > file->y_offset ? src_y : file->y_offset;
+    int x_end = src_x + width < file->x_offset + file->cropped_width ?
+        src_x + width : file->x_offset + file->cropped_width;
+    int y_end = src_y + height < file->y_offset + file->cropped_height ?
+        src_y + height : file->y_offset + file->cropped_height;
+    if (x_start >= x_end || y_start >= y_end) {
+        return 1;
+    }
+    const bundle_page *page = &data.pages[file->page];
+    for (int y = y_start; y < y_end; y++) {
+        size_t page_offset = (size_t) (file->page_y + y - file->y_offset) * page->width +
+            file->page_x + x_start - file->x_offset;
+        memcpy(&pixels[(y - src_y) * width + x_start - src_x], &page->pixels[page_offset * sizeof(color_t)],
+            (x_end - x_start) * sizeof(color_t));
+    }
+    return 1;
+}
+
+#else
+
+static void write_file_record(buffer *buf, const asset_bundle_file *file)
+{
+    size_t length = strlen(file->path) + 1;
+    buffer_write_u16(buf, (uint16_t) length);
+    buffer_write_raw(buf, file->path, length);
+    buffer_write_i32(buf, file->width);
+    buffer_write_i32(buf, file->height);
+    buffer_write_i32(buf, file->x_offset);
+    buffer_write_i32(buf, file->y_offset);
+    buffer_write_i32(buf, file->cropped_width);
+    buffer_write_i32(buf, file->cropped_height);
+    buffer_write_i32(buf, file->page);
+    buffer_write_i32(buf, file->page_x);
+    buffer_write_i32(buf, file->page_y);
+}
+
+static int write_index(FILE *fp, const asset_bundle_file *files, int total_files)
+{
+    // Magic, format version and number of files
+    size_t size = BUNDLE_MAGIC_LENGTH + 2 * sizeof(int32_t);
+    for (int i = 0; i < total_files; i++) {
+        size_t length = strlen(files[i].path) + 1;
+        if (length > UINT16_MAX) {
+            log_error("Path too long for the bundle", files[i].path, 0);
+            return 0;
+        }
+        size += FILE_RECORD_SIZE + length;
+    }
+    uint8_t *index = malloc(size);
+    if (!index) {
+        log_error("Out of memory.", 0, 0);
+        return 0;
+    }
+    buffer buf;
+    buffer_init(&buf, index, size);
+    buffer_write_raw(&buf, BUNDLE_MAGIC, BUNDLE_MAGIC_LENGTH);
+    buffer_write_i32(&buf, BUNDLE_FORMAT_VERSION);
+    buffer_write_i32(&buf, total_files);
+    for (int i = 0; i < total_files; i++) {
+        write_file_record(&buf, &files[i]);
+    }
+    int written = fwrite(index, 1, size, fp) == size;
+    free(index);
+    return written;
+}
+
+static int write_pages(FILE *fp, color_t **pages, const int *page_widths, const int *page_heights, int total_pages)
+{
+    uint8_t **stored = calloc(total_pages ? total_pages : 1, sizeof(uint8_t *));
+    int *stored_sizes = calloc(total_pages ? total_pages : 1, sizeof(int));
+    if (!stored || !stored_sizes) {
+        free(stored);
+        free(stored_sizes);
+        log_error("Out of memory.", 0, 0);
+        return 0;
+    }
+    int result = 1;
+    for (int i = 0; result && i < total_pages; i++) {
+        size_t pixels_size = sizeof(color_t) * page_widths[i] * page_heights[i];
+        if (pixels_size > INT_MAX / 2) {
+            result = 0;
+            break;
+        }
+        int bound = lz4_compress_bound((int) pixels_size);
+        stored[i] = malloc(bound);
+        if (!stored[i]) {
+            log_error("Out of memory.", 0, 0);
+            result = 0;
+            break;
+        }
+        stored_sizes[i] = lz4_compress(pages[i], (int) pixels_size, stored[i], bound);
+        // Pages that do not get smaller when compressed are stored as they are
+        if (stored_sizes[i] <= 0 || stored_sizes[i] >= (int) pixels_size) {
+            free(stored[i]);
+            stored[i] = 0;
+            stored_sizes[i] = (int) pixels_size;
+        }
+    }
+    if (result) {
+        size_t records_size = sizeof(int32_t) + total_pages * PAGE_RECORD_SIZE;
+        uint8_t *records = malloc(records_size);
+        if (!records) {
+            log_error("Out of memory.", 0, 0);
+            result = 0;
+        } else {
+            buffer buf;
+            buffer_init(&buf, records, records_size);
+            buffer_write_i32(&buf, total_pages);
+            for (int i = 0; i < total_pages; i++) {
+                buffer_write_i32(&buf, page_widths[i]);
+                buffer_write_i32(&buf, page_heights[i]);
+                buffer_write_i32(&buf, stored_sizes[i]);
+            }
+            result = fwrite(records, 1, records_size, fp) == records_size;
+            free(records);
+        }
+    }
+    for (int i = 0; result && i < total_pages; i++) {
+        const void *page_data = stored[i] ? (const void *) stored[i] : (const void *) pages[i];
+        result = fwrite(page_data, 1, stored_sizes[i], fp) == (size_t) stored_sizes[i];
+    }
+    for (int i = 0; i < total_pages; i++) {
+        free(stored[i]);
+    }
+    free(stored);
+    free(stored_sizes);
+    return result;
+}
+
+int asset_bundle_write(const char *path, const asset_bundle_file *files, int total_files,
+    color_t **pages, const int *page_widths, const int *page_heights, int total_pages)
+{
+    for (int i = 1; i < total_files; i++) {
+        if (compare_paths(files[i - 1].path, files[i].path) >= 0) {
+            log_error("The bundle files are not sorted", files[i].path, 0);
+            return 0;
+        }
+    }
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        log_error("Failed to create file", path, 0);
+        return 0;
+    }
+    int written = write_index(fp, files, total_files) &&
+        write_pages(fp, pages, page_widths, page_heights, total_pages);
+    fclose(fp);
+    if (!written) {
+        log_error("Failed to write the bundle", path, 0);
+        remove(path);
+    }
+    return written;
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef ASSETS_BUNDLE_H
+#define ASSETS_BUNDLE_H
+
+#include "graphics/color.h"
+
+/**
+ * @file
+ * Bundle of the PNG files used by the extra assets, written by the asset packer into the assets directory.
+ *
+ * The bundle holds the cropped pixels of every PNG file packed into a few pages, which are LZ4 compressed
+ * unless that does not make them smaller, and an index of the files sorted by path. While the extra assets
+ * are loaded, the files are read from the bundle instead of being opened and decoded one by one.
+ * Files that are not in the bundle or that were changed after the bundle was written are still read
+ * from the disk, so modified and new files keep working.
+ */
+
+#define ASSET_BUNDLE_FILE_NAME "extra_assets.bundle"
+
+/**
+ * A PNG file in the bundle
+ */
+typedef struct {
+    const char *path; /**< Path of the file, relative to the assets directory */
+    int width; /**< Width of the whole PNG file */
+    int height; /**< Height of the whole PNG file */
+    int x_offset; /**< Position of the cropped pixels in the PNG file */
+    int y_offset;
+    int cropped_width; /**< Size of the cropped pixels, 0 when the file is fully transparent */
+    int cropped_height;
+    int page; /**< Page with the cropped pixels */
+    int page_x; /**< Position of the cropped pixels in the page */
+    int page_y;
+} asset_bundle_file;
+
+#ifndef BUILDING_ASSET_PACKER
+
+/**
+ * Maps the bundle and decompresses its pages, if the bundle exists
+ * @return Boolean true if the bundle was loaded, false otherwise
+ */
+int asset_bundle_load(void);
+
+/**
+ * Releases the bundle. Files are read from the disk again afterwards
+ */
+void asset_bundle_unload(void);
+
+/**
+ * Checks whether a file can be read from the bundle
+ * @param path The path of the file, relative to the assets directory
+ * @return Boolean true if the file is in the bundle and up to date, false otherwise
+ */
+int asset_bundle_has_file(const char *path);
+
+/**
+ * Gets the size of a PNG file from the bundle
+ * @param path The path of the file, relative to the assets directory
+ * @param width The width of the file
+ * @param height The height of the file
+ * @return Boolean true if the file is in the bundle and up to date, false otherwise
+ */
+int asset_bundle_get_image_size(const char *path, int *width, int *height);
+
+/**
+ * Reads part of a PNG file from the bundle, like png_read does.
+ * Pixels outside of the cropped part of the file are left untouched, so the destination should be cleared first
+ * @param path The path of the file, relative to the assets directory
+ * @param pixels The destination, with rows of width pixels
+ * @param src_x The position of the part to read
+ * @param src_y
+ * @param width The size of the part to read
+ * @param height
+ * @return Boolean true if the file is in the bundle and up to date, false otherwise
+ */
+int asset_bundle_read(const char *path, color_t *pixels, int src_x, int src_y, int width, int height);
+
+#else
+
+/**
+ * Writes the bundle to the given path
+ * @param path Where to write the bundle
+ * @param files The files, sorted by path with platform_file_manager_compare_filename
+ * @param total_files The number of files
+ * @param pages The pixels of the pages
+ * @param page_widths The width of every page
+ * @param page_heights The height of every page
+ * @param total_pages The number of pages
+ * @return Boolean true if the bundle was written, false otherwise
+ */
+int asset_bundle_write(const char *path, const asset_bundle_file *files, int total_files,
+    color_t **pages, const int *page_widths, const int *page_heights, int total_pages);
+
+#endif
+
+#endif // ASSETS_BUNDLE_H
@@ -0,0 +1,412 @@
+#include "cache.h"
+
+#include "assets/assets.h"
+#include "assets/group.h"
+#include "assets/image.h"
+#include "core/buffer.h"
+#include "core/dir.h"
+#include "core/file.h"
+#include "core/image.h"
+#include "core/image_cache.h"
+#include "core/log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_FILE_NAME "extra_assets.cache"
+#define CACHE_MAGIC "AUGASSET"
+#define CACHE_FORMAT_VERSION 1
+
+#define LAYER_RECORD_SIZE (11 * sizeof(int32_t))
+
+#define XML_READ_SIZE 4096
+
+static int hash_assetlists(uint64_t *hash)
+{
+    const dir_listing *xml_files = dir_find_files_with_extension(ASSETS_DIRECTORY "/" ASSETS_IMAGE_PATH, "xml");
+    *hash = image_cache_hash_int(*hash, xml_files->num_files);
+    for (int i = 0; i < xml_files->num_files; i++) {
+        char full_path[FILE_NAME_MAX];
+        snprintf(full_path, FILE_NAME_MAX, "%s/%s", ASSETS_IMAGE_PATH, xml_files->files[i].name);
+        FILE *fp = file_open_asset(full_path, "rb");
+        if (!fp) {
+            return 0;
+        }
+        *hash = image_cache_hash_string(*hash, xml_files->files[i].name);
+        uint8_t contents[XML_READ_SIZE];
+        size_t bytes_read;
+        while ((bytes_read = fread(contents, 1, XML_READ_SIZE, fp)) > 0) {
+            *hash = image_cache_hash_data(*hash, contents, bytes_read);
+        }
+        file_close(fp);
+    }
+    return 1;
+}
+
+static int hash_image_files(uint64_t *hash)
+{
+    // Every listing overwrites the previous one, so the directory names need to be copied first
+    const dir_listing *directories = dir_find_all_subdirectories(ASSETS_DIRECTORY "/" ASSETS_IMAGE_PATH);
+    int num_directories = directories->num_files;
+    char *names = malloc((size_t) num_directories * FILE_NAME_MAX + 1);
+    if (!names) {
+        return 0;
+    }
+    for (int i = 0; i < num_directories; i++) {
+        snprintf(&names[i * FILE_NAME_MAX], FILE_NAME_MAX, "%s", directories->files[i].name);
+    }
+    *hash = image_cache_hash_int(*hash, num_directories);
+    for (int i = 0; i < num_directories; i++) {
+        char directory[FILE_NAME_MAX];
+        snprintf(directory, FILE_NAME_MAX, "%s/%s/%s", ASSETS_DIRECTORY, ASSETS_IMAGE_PATH, &names[i * FILE_NAME_MAX]);
+        const dir_listing *png_files = dir_find_files_with_extension(directory, "png");
+        *hash = image_cache_hash_string(*hash, &names[i * FILE_NAME_MAX]);
+        *hash = image_cache_hash_int(*hash, png_files->num_files);
+        for (int j = 0; j < png_files->num_files; j++) {
+            *hash = image_cache_hash_string(*hash, png_files->files[j].name);
+            *hash = image_cache_hash_int(*hash, png_files->files[j].modified_time);
+            *hash = image_cache_hash_data(*hash, &png_files->files[j].size, sizeof(long));
+        }
+    }
+    free(names);
+    return 1;
+}
+
+static uint64_t hash_main_images(uint64_t hash)
+{
+    // Asset images copy pixels from and point to the main images, so their layout must not have changed
+    for (int i = 0; i < IMAGE_MAIN_ENTRIES; i++) {
+        const image *img = image_get(i);
+        int values[] = {
+            img->x_offset, img->y_offset, img->width, img->height, img->is_isometric,
+            img->atlas.id, img->atlas.x_offset, img->atlas.y_offset, img->top ? img->top->height : 0
+        };
+        hash = image_cache_hash_data(hash, values, sizeof(values));
+    }
+    return hash;
+}
+
+uint64_t asset_cache_get_key(int climate_id, int is_editor)
+{
+    int max_width, max_height;
+    graphics_renderer()->get_max_image_size(&max_width, &max_height);
+
+    uint64_t hash = IMAGE_CACHE_HASH_START;
+    hash = image_cache_hash_int(hash, climate_id);
+    hash = image_cache_hash_int(hash, is_editor);
+    hash = image_cache_hash_int(hash, max_width);
+    hash = image_cache_hash_int(hash, max_height);
+    if (!hash_assetlists(&hash) || !hash_image_files(&hash)) {
+        return 0;
+    }
+    hash = hash_main_images(hash);
+    // A key of 0 means there is no cache
+    return hash ? hash : 1;
+}
+
+static size_t string_size(const char *value)
+{
+    return sizeof(uint16_t) + (value ? strlen(value) : 0);
+}
+
+static void write_string(buffer *buf, const char *value)
+{
+    // The length is stored plus one, so a null string can be told apart from an empty one
+    size_t length = value ? strlen(value) : 0;
+    buffer_write_u16(buf, value ? (uint16_t) (length + 1) : 0);
+    buffer_write_raw(buf, value, length);
+}
+
+static int read_string(buffer *buf, char **value)
+{
+    *value = 0;
+    uint16_t length = buffer_read_u16(buf);
+    if (!length) {
+        return !buf->overflow;
+    }
+    length--;
+    char *result = malloc(length + 1);
+    if (!result) {
+        return 0;
+    }
+    if (buffer_read_raw(buf, result, length) != length) {
+        free(result);
+        return 0;
+    }
+    result[length] = 0;
+    *value = result;
+    return 1;
+}
+
+static void write_layer(buffer *buf, const layer *l)
+{
+    write_string(buf, l->asset_image_path);
+    buffer_write_i32(buf, l->calculated_image_id);
+    buffer_write_i32(buf, l->src_x);
+    buffer_write_i32(buf, l->src_y);
+    buffer_write_i32(buf, l->x_offset);
+    buffer_write_i32(buf, l->y_offset);
+    buffer_write_i32(buf, l->width);
+    buffer_write_i32(buf, l->height);
+    buffer_write_i32(buf, l->invert);
+    buffer_write_i32(buf, l->rotate);
+    buffer_write_i32(buf, l->part);
+    buffer_write_i32(buf, l->mask);
+}
+
+static int read_layer(buffer *buf, layer *l)
+{
+    if (!read_string(buf, &l->asset_image_path)) {
+        return 0;
+    }
+    l->calculated_image_id = buffer_read_i32(buf);
+    l->src_x = buffer_read_i32(buf);
+    l->src_y = buffer_read_i32(buf);
+    l->x_offset = buffer_read_i32(buf);
+    l->y_offset = buffer_read_i32(buf);
+    l->width = buffer_read_i32(buf);
+    l->height = buffer_read_i32(buf);
+    l->invert = buffer_read_i32(buf);
+    l->rotate = buffer_read_i32(buf);
+    l->part = buffer_read_i32(buf);
+    l->mask = buffer_read_i32(buf);
+    return !buf->overflow;
+}
+
+static unsigned int get_total_pixels(const asset_image *img)
+{
+    // Only images that are not packed keep their pixels, which are never cropped
+    if (img->is_reference || !img->data) {
+        return 0;
+    }
+    int height = img->img.height + (img->img.top ? img->img.top->height : 0);
+    return (unsigned int) (img->img.width * height);
+}
+
+static size_t asset_image_record_size(const asset_image *img)
+{
+    size_t size = sizeof(uint8_t);
+    if (!img->active) {
+        return size;
+    }
+    size += string_size(img->id) + sizeof(uint8_t) + IMAGE_CACHE_IMAGE_RECORD_SIZE;
+    size += sizeof(uint8_t) + (img->img.top && !img->is_reference ? IMAGE_CACHE_IMAGE_RECORD_SIZE : 0);
+    size += sizeof(uint8_t) + (img->img.animation ? IMAGE_CACHE_ANIMATION_RECORD_SIZE : 0);
+    if (img->is_reference) {
+        size += string_size(img->first_layer.asset_image_path) + LAYER_RECORD_SIZE;
+    }
+    size += sizeof(uint32_t) + get_total_pixels(img) * sizeof(color_t);
+    return size;
+}
+
+static void write_asset_image(buffer *buf, const asset_image *img)
+{
+    buffer_write_u8(buf, img->active);
+    if (!img->active) {
+        return;
+    }
+    write_string(buf, img->id);
+    buffer_write_u8(buf, img->is_reference);
+    image_cache_write_image(buf, &img->img);
+    // The top of a reference belongs to the referenced image, so it is linked again after loading
+    int has_top = img->img.top && !img->is_reference;
+    buffer_write_u8(buf, has_top);
+    if (has_top) {
+        image_cache_write_image(buf, img->img.top);
+    }
+    buffer_write_u8(buf, img->img.animation != 0);
+    if (img->img.animation) {
+        image_cache_write_animation(buf, img->img.animation);
+    }
+    if (img->is_reference) {
+        write_layer(buf, &img->first_layer);
+    }
+    unsigned int total_pixels = get_total_pixels(img);
+    buffer_write_u32(buf, total_pixels);
+    buffer_write_u32_array(buf, img->data, total_pixels);
+}
+
+static int read_asset_image(buffer *buf, asset_image *img)
+{
+    img->active = buffer_read_u8(buf);
+    if (!img->active) {
+        return !buf->overflow;
+    }
+    if (!read_string(buf, (char **) &img->id)) {
+        return 0;
+    }
+    img->is_reference = buffer_read_u8(buf);
+    image_cache_read_image(buf, &img->img);
+    if (buffer_read_u8(buf)) {
+        img->img.top = malloc(sizeof(image));
+        if (!img->img.top) {
+            return 0;
+        }
+        memset(img->img.top, 0, sizeof(image));
+        image_cache_read_image(buf, img->img.top);
+    }
+    if (buffer_read_u8(buf)) {
+        img->img.animation = malloc(sizeof(image_animation));
+        if (!img->img.animation) {
+            return 0;
+        }
+        image_cache_read_animation(buf, img->img.animation);
+    }
+    if (img->is_reference && !read_layer(buf, &img->first_layer)) {
+        return 0;
+    }
+    unsigned int total_pixels = buffer_read_u32(buf);
+    if (buf->overflow || total_pixels > (buf->size - buf->index) / sizeof(color_t)) {
+        return 0;
+    }
+    if (total_pixels) {
+        color_t *pixels = malloc(total_pixels * sizeof(color_t));
+        if (!pixels) {
+            return 0;
+        }
+        buffer_read_u32_array(buf, pixels, total_pixels);
+        img->data = pixels;
+    }
+    return !buf->overflow;
+}
+
+static void link_reference_tops(unsigned int total_images)
+{
+    for (unsigned int i = 0; i < total_images; i++) {
+        asset_image *img = asset_image_get_from_id(i);
+        if (!img->active || !img->is_reference) {
+            continue;
+        }
+        int image_id = img->first_layer.calculated_image_id;
+        if (image_id >= IMAGE_MAIN_ENTRIES) {
+            const asset_image *referenced = asset_image_get_from_id(image_id - IMAGE_MAIN_ENTRIES);
+            img->img.top = referenced ? referenced->img.top : 0;
+        } else {
+            img->img.top = image_get(image_id)->top;
+        }
+    }
+}
+
+static int read_groups(buffer *buf)
+{
+    int total_groups = buffer_read_i32(buf);
+    if (buf->overflow || total_groups < 0 || (size_t) total_groups > buf->size - buf->index) {
+        return 0;
+    }
+    if (!group_create_all(total_groups)) {
+        return 0;
+    }
+    for (int i = 0; i < total_groups; i++) {
+        image_groups *group = group_get_new();
+        if (!read_string(buf, (char **) &group->name) || !group->name) {
+            return 0;
+        }
+        group->first_image_index = buffer_read_i32(buf);
+        group->last_image_index = buffer_read_i32(buf);
+    }
+    return !buf->overflow;
+}
+
+static int read_asset_images(buffer *buf)
+{
+    unsigned int total_images = buffer_read_u32(buf);
+    if (buf->overflow || !total_images || total_images > buf->size - buf->index) {
+        return 0;
+    }
+    if (!asset_image_init_array()) {
+        return 0;
+    }
+    // Images are created in order, so every image gets back its original index
+    while (!asset_image_get_from_id(total_images - 1)) {
+        if (!asset_image_create()) {
+            return 0;
+        }
+    }
+    for (unsigned int i = 0; i < total_images; i++) {
+        asset_image *img = asset_image_get_from_id(i);
+        img->active = 0;
+        if (!read_asset_image(buf, img)) {
+            return 0;
+        }
+    }
+    link_reference_tops(total_images);
+    return 1;
+}
+
+static int read_atlas(buffer *buf, const uint8_t *file_data)
+{
+    const image_atlas_data *atlas_data = image_cache_read_atlas(buf, file_data, ATLAS_EXTRA_ASSET);
+    if (!atlas_data) {
+        return 0;
+    }
+    graphics_renderer()->create_image_atlas(atlas_data, 1);
+    return 1;
+}
+
+int asset_cache_load(uint64_t key)
+{
+    file_mapping file;
+    buffer buf;
+    if (!image_cache_open(CACHE_FILE_NAME, CACHE_MAGIC, CACHE_FORMAT_VERSION, key, &file, &buf)) {
+        return 0;
+    }
+    int result = read_groups(&buf) && read_asset_images(&buf) && read_atlas(&buf, file.data);
+    file_unmap(&file);
+    if (result) {
+        log_info("Extra assets loaded from the cache", 0, 0);
+    } else {
+        log_info("The extra assets cache is broken and will be rebuilt", 0, 0);
+    }
+    return result;
+}
+
+static size_t get_metadata_size(void)
+{
+    size_t size = sizeof(int32_t);
+    int total_groups = group_get_total();
+    for (int i = 0; i < total_groups; i++) {
+        size += string_size(group_get_from_id(i)->name) + 2 * sizeof(int32_t);
+    }
+    size += sizeof(uint32_t);
+    const asset_image *img;
+    for (unsigned int i = 0; (img = asset_image_get_from_id(i)) != 0; i++) {
+        size += asset_image_record_size(img);
+    }
+    return size;
+}
+
+void asset_cache_save(uint64_t key, const image_atlas_data *atlas_data)
+{
+    if (!key || !atlas_data) {
+        return;
+    }
+    size_t size = get_metadata_size();
+    uint8_t *metadata = malloc(size);
+    if (!metadata) {
+        log_error("Unable to allocate memory for the extra assets cache", 0, 0);
+        return;
+    }
+    buffer buf;
+    buffer_init(&buf, metadata, size);
+
+    int total_groups = group_get_total();
+    buffer_write_i32(&buf, total_groups);
+    for (int i = 0; i < total_groups; i++) {
+        const image_groups *group = group_get_from_id(i);
+        write_string(&buf, group->name);
+        buffer_write_i32(&buf, group->first_image_index);
+        buffer_write_i32(&buf, group->last_image_index);
+    }
+
+    unsigned int total_images = 0;
+    while (asset_image_get_from_id(total_images)) {
+        total_images++;
+    }
+    buffer_write_u32(&buf, total_images);
+    for (unsigned int i = 0; i < total_images; i++) {
+        write_asset_image(&buf, asset_image_get_from_id(i));
+    }
+
+    image_cache_write(CACHE_FILE_NAME, CACHE_MAGIC, CACHE_FORMAT_VERSION, key, metadata, size, atlas_data);
+    free(metadata);
+}
@@ -0,0 +1,39 @@
+#ifndef ASSETS_CACHE_H
+#define ASSETS_CACHE_H
+
+#include "graphics/renderer.h"
+
+#include <stdint.h>
+
+/**
+ * @file
+ * Cache of the packed extra assets, stored in the config directory.
+ *
+ * The cache holds the groups, the metadata of every asset image and the pixels of the packed atlas,
+ * so later starts skip parsing the assetlists, decoding the PNG files and packing the images.
+ */
+
+/**
+ * Calculates the key of the cache from the assetlists, the PNG files, the main images and the renderer limits
+ * @param climate_id The climate of the main images
+ * @param is_editor Whether the main images are the editor ones
+ * @return The key, or 0 when it could not be calculated and the cache should not be used
+ */
+uint64_t asset_cache_get_key(int climate_id, int is_editor);
+
+/**
+ * Loads the groups, images and packed atlas from the cache
+ * @param key The cache key
+ * @return Boolean true when the assets were loaded, false when the cache is missing, outdated or broken
+ */
+int asset_cache_load(uint64_t key);
+
+/**
+ * Saves the groups, images and packed atlas to the cache.
+ * Must be called after all images were packed and before the atlas buffers are passed on to the renderer
+ * @param key The cache key
+ * @param atlas_data The packed atlas
+ */
+void asset_cache_save(uint64_t key, const image_atlas_data *atlas_data);
+
+#endif // ASSETS_CACHE_H
@@ -3,17 +3,46 @@
 #include "assets/assets.h"
 #include "core/log.h"
 
+#ifndef BUILDING_ASSET_PACKER
+#include "core/image_cache.h"
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 
+#define NO_IMAGE -1
+
 static struct {
     int total_groups;
     int groups_in_memory;
     image_groups *groups;
 } data;
 
+#ifndef BUILDING_ASSET_PACKER
+typedef struct {
+    uint64_t hash;
+    int group_id;
+    int image_index;
+} name_index_entry;
+
+static struct {
+    name_index_entry *entries;
+    unsigned int size;
+    int total_groups;
+} name_index;
+
+static void clear_name_index(void)
+{
+    free(name_index.entries);
+    memset(&name_index, 0, sizeof(name_index));
+}
+#endif
+
 int group_create_all(int total)
 {
+#ifndef BUILDING_ASSET_PACKER
+    clear_name_index();
+#endif
     total += 1; // Create extra group for external files
     for (int i = 0; i < data.total_groups; i++) {
         free((char *) data.groups[i].name);
@@ -85,12 +114,107 @@ int group_get_total(void)
     return data.total_groups;
 }
 
+#ifndef BUILDING_ASSET_PACKER
+// Groups are indexed with NO_IMAGE as their image index, so the same table holds the groups and their images
+static uint64_t get_name_hash(int group_id, const char *name)
+{
+    uint64_t hash = image_cache_hash_int(IMAGE_CACHE_HASH_START, group_id);
+    hash = image_cache_hash_string(hash, name);
+    return hash ? hash : 1;
+}
+
+static const char *get_entry_name(const name_index_entry *entry)
+{
+    if (entry->image_index == NO_IMAGE) {
+        return data.groups[entry->group_id].name;
+    }
+    return asset_image_get_from_id(entry->image_index)->id;
+}
+
+static name_index_entry *find_name_index_slot(int group_id, const char *name, uint64_t hash)
+{
+    unsigned int mask = name_index.size - 1;
+    for (unsigned int index = (unsigned int) hash & mask; ; index = (index + 1) & mask) {
+        name_index_entry *entry = &name_index.entries[index];
+        if (!entry->hash) {
+            return entry;
+        }
+        int entry_group_id = entry->image_index == NO_IMAGE ? NO_IMAGE : entry->group_id;
+        if (entry->hash == hash && entry_group_id == group_id && strcmp(get_entry_name(entry), name) == 0) {
+            return entry;
+        }
+    }
+}
+
+static void add_to_name_index(int group_id, int image_index, const char *name)
+{
+    int key_group_id = image_index == NO_IMAGE ? NO_IMAGE : group_id;
+    uint64_t hash = get_name_hash(key_group_id, name);
+    name_index_entry *entry = find_name_index_slot(key_group_id, name, hash);
+    // Like the searches without the index, the first group or image with a name is the one that is found
+    if (!entry->hash) {
+        entry->hash = hash;
+        entry->group_id = group_id;
+        entry->image_index = image_index;
+    }
+}
+
+void group_build_name_index(void)
+{
+    clear_name_index();
+    unsigned int total_names = data.total_groups;
+    for (int i = 0; i < data.total_groups; i++) {
+        const image_groups *group = &data.groups[i];
+        if (group->first_image_index >= 0 && group->last_image_index >= group->first_image_index) {
+            total_names += group->last_image_index - group->first_image_index + 1;
+        }
+    }
+    unsigned int size = 1;
+    while (size < total_names * 2) {
+        size *= 2;
+    }
+    name_index.entries = malloc(size * sizeof(name_index_entry));
+    if (!name_index.entries) {
+        log_error("Not enough memory to index the asset names. Finding assets will be slower.", 0, 0);
+        return;
+    }
+    memset(name_index.entries, 0, size * sizeof(name_index_entry));
+    name_index.size = size;
+    name_index.total_groups = data.total_groups;
+    for (int i = 0; i < data.total_groups; i++) {
+        const image_groups *group = &data.groups[i];
+        if (!group->name) {
+            continue;
+        }
+        add_to_name_index(i, NO_IMAGE, group->name);
+        const asset_image *img = asset_image_get_from_id(group->first_image_index);
+        while (img && img->index <= (unsigned int) group->last_image_index) {
+            if (img->id) {
+                add_to_name_index(i, img->index, img->id);
+            }
+            img = asset_image_get_from_id(img->index + 1);
+        }
+    }
+}
+#endif
+
 image_groups *group_get_from_name(const char *name)
 {
     if (!name || !*name) {
         return 0;
     }
-    for (int i = 0; i < data.total_groups; i++) {
+    int first_group = 0;
+#ifndef BUILDING_ASSET_PACKER
+    if (name_index.entries) {
+        const name_index_entry *entry = find_name_index_slot(NO_IMAGE, name, get_name_hash(NO_IMAGE, name));
+        if (entry->hash) {
+            return &data.groups[entry->group_id];
+        }
+        // Only the groups created after the index was built still need to be searched
+        first_group = name_index.total_groups;
+    }
+#endif
+    for (int i = first_group; i < data.total_groups; i++) {
         image_groups *current = &data.groups[i];
         if (strcmp(current->name, name) == 0) {
             return current;
@@ -99,6 +223,28 @@ image_groups *group_get_from_name(const char *name)
     return 0;
 }
 
+int group_get_image_index(const image_groups *group, const char *image_name)
+{
+    if (!group || !image_name || !*image_name) {
+        return NO_IMAGE;
+    }
+#ifndef BUILDING_ASSET_PACKER
+    int group_id = (int) (group - data.groups);
+    if (name_index.entries && group_id < name_index.total_groups) {
+        const name_index_entry *entry = find_name_index_slot(group_id, image_name, get_name_hash(group_id, image_name));
+        return entry->hash ? entry->image_index : NO_IMAGE;
+    }
+#endif
+    const asset_image *img = asset_image_get_from_id(group->first_image_index);
+    while (img && img->index <= (unsigned int) group->last_image_index) {
+        if (img->id && strcmp(img->id, image_name) == 0) {
+            return img->index;
+        }
+        img = asset_image_get_from_id(img->index + 1);
+    }
+    return NO_IMAGE;
+}
+
 image_groups *group_get_from_image_index(int index)
 {
     for (int i = 0; i < data.total_groups; i++) {
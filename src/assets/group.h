@@ -30,4 +30,21 @@ image_groups *group_get_from_id(int id);
 image_groups *group_get_from_name(const char *name);
 image_groups *group_get_from_image_index(int index);
 
+/**
+ * Finds an image of a group by its name
+ * @param group The group
+ * @param image_name The name of the image
+ * @return The index of the asset image, or -1 if the group has no image with that name
+ */
+int group_get_image_index(const image_groups *group, const char *image_name);
+
+#ifndef BUILDING_ASSET_PACKER
+/**
+ * Indexes the names of all groups and their images, so they can be found without searching.
+ * Groups that are created afterwards are still found, but they are searched one by one.
+ * The index is discarded when the groups are created again
+ */
+void group_build_name_index(void);
+#endif
+
 #endif // ASSETS_GROUP_H
@@ -1,11 +1,15 @@
 #include "image.h"
 
+#include "assets/bundle.h"
+#include "assets/cache.h"
 #include "assets/group.h"
 #include "core/array.h"
 #include "core/image.h"
 #include "core/image_packer.h"
 #include "core/log.h"
 #include "core/png_read.h"
+#include "core/thread_pool.h"
+#include "core/trace.h"
 #include "game/campaign.h"
 #include "graphics/color.h"
 #include "graphics/graphics.h"
@@ -16,12 +20,21 @@
 #include <string.h>
 
 #define ASSET_ARRAY_SIZE 2000
+#define DECODED_PNG_FILES_MAX 32
+#define DECODED_PNG_PIXELS_MAX (16 * 1024 * 1024)
 
 static struct {
     array(asset_image) asset_images;
     int total_isometric_images;
 } data;
 
+typedef struct {
+    png_reader *readers;
+    int total;
+    int size;
+    unsigned int next_index;
+} decoded_png_files;
+
 typedef enum {
     IMAGE_ORIGINAL = 0,
     IMAGE_TRANSLATED_REFERENCE = 1,
@@ -209,8 +222,7 @@ static int load_image(asset_image *img, color_t **main_images, int *main_image_w
         layer *l = img->last_layer;
         if (!l->calculated_image_id && !img->img.is_isometric) {
             layer_load(l, main_images, main_image_widths);
-            img->data = l->data;
-            l->data = 0;
+            img->data = layer_take_data(l);
             make_similar_images_references(img);
             layer_unload(l);
             return 1;
@@ -363,6 +375,81 @@ static int load_image(asset_image *img, color_t **main_images, int *main_image_w
 
     return 1;
 }
+
+static void decode_png_file(void *reader)
+{
+    png_reader_decode(reader);
+}
+
+static void release_decoded_png_files(decoded_png_files *files)
+{
+    png_use_decoded_files(0, 0);
+    for (int i = 0; i < files->total; i++) {
+        png_reader_unload(&files->readers[i]);
+    }
+    files->total = 0;
+}
+
+static void add_png_file(decoded_png_files *files, const char *path, int *total_pixels)
+{
+    // Files in the bundle do not need to be decoded
+    if (asset_bundle_has_file(path)) {
+        return;
+    }
+    for (int i = 0; i < files->total; i++) {
+        if (strcmp(files->readers[i].cache.path, path) == 0) {
+            return;
+        }
+    }
+    if (files->total == files->size) {
+        int new_size = files->size ? files->size * 2 : DECODED_PNG_FILES_MAX;
+        png_reader *readers = realloc(files->readers, new_size * sizeof(png_reader));
+        if (!readers) {
+            return;
+        }
+        files->readers = readers;
+        files->size = new_size;
+    }
+    png_reader *reader = &files->readers[files->total];
+    memset(reader, 0, sizeof(png_reader));
+    int width, height;
+    // Failed files are left for the layer to load again, so it reports the problem as usual
+    if (!png_reader_load_from_file(reader, path, 1) || !png_reader_get_image_size(reader, &width, &height)) {
+        png_reader_unload(reader);
+        return;
+    }
+    *total_pixels += width * height;
+    files->total++;
+}
+
+/**
+ * Decodes, on the worker threads, the PNG files used by the layers of the images starting at first_index.
+ * The layers are still composed on the main thread and in the same order, so the result does not change.
+ * Files are decoded in batches to limit the memory that is needed at once.
+ */
+static void decode_png_files_from(decoded_png_files *files, unsigned int first_index)
+{
+    release_decoded_png_files(files);
+    int total_pixels = 0;
+    unsigned int index = first_index;
+    for (; index < data.asset_images.size; index++) {
+        if (files->total >= DECODED_PNG_FILES_MAX || total_pixels >= DECODED_PNG_PIXELS_MAX) {
+            break;
+        }
+        const asset_image *img = array_item(data.asset_images, index);
+        if (!img->active || img->is_reference) {
+            continue;
+        }
+        for (const layer *l = img->last_layer; l; l = l->prev) {
+            if (!l->calculated_image_id && l->asset_image_path && !layer_cache_has_pixels(l)) {
+                add_png_file(files, l->asset_image_path, &total_pixels);
+            }
+        }
+    }
+    files->next_index = index;
+    thread_pool_run_for_each(decode_png_file, files->readers, sizeof(png_reader), files->total);
+    png_use_decoded_files(files->readers, files->total);
+}
 #endif
 
 static inline int layer_is_empty(const layer *l)
@@ -493,7 +580,7 @@ asset_image *asset_image_create(void)
     return result;
 }
 
-int asset_image_load_all(color_t **main_images, int *main_image_widths)
+int asset_image_load_all(color_t **main_images, int *main_image_widths, uint64_t cache_key)
 {
 #ifndef BUILDING_ASSET_PACKER
     image_packer packer;
@@ -508,12 +595,29 @@ int asset_image_load_all(color_t **main_images, int *main_image_widths)
     packer.options.reduce_image_size = 1;
     packer.options.sort_by = IMAGE_PACKER_SORT_BY_AREA;
 
+    // With no workers, decoding the files first would only use more memory
+    int decode_in_parallel = thread_pool_total_workers() > 0;
+    decoded_png_files decoded_files = { 0 };
+
+    trace_begin("png");
     asset_image *current_image;
+    // Count the layers that load the same pixels, so they are only loaded once
+    array_foreach(data.asset_images, current_image) {
+        if (current_image->is_reference) {
+            continue;
+        }
+        for (const layer *l = current_image->last_layer; l; l = l->prev) {
+            layer_cache_add_use(l);
+        }
+    }
     int rect = 0;
     array_foreach(data.asset_images, current_image) {
         if (current_image->is_reference) {
             continue;
         }
+        if (decode_in_parallel && current_image->index >= decoded_files.next_index) {
+            decode_png_files_from(&decoded_files, current_image->index);
+        }
         load_image(current_image, main_images, main_image_widths);
         int top_height = current_image->img.top ? current_image->img.top->height : 0;
 
@@ -556,7 +660,12 @@ int asset_image_load_all(color_t **main_images, int *main_image_widths)
         }
     }
 
+    release_decoded_png_files(&decoded_files);
+    free(decoded_files.readers);
+    layer_cache_clear();
     png_unload();
+    trace_end("png");
+    trace_begin("pack");
     image_packer_pack(&packer);
 
     const image_atlas_data *atlas_data = graphics_renderer()->prepare_image_atlas(ATLAS_EXTRA_ASSET,
@@ -635,7 +744,13 @@ int asset_image_load_all(color_t **main_images, int *main_image_widths)
         }
     }
     image_packer_free(&packer);
+    trace_end("pack");
+    trace_begin("save_cache");
+    asset_cache_save(cache_key, atlas_data);
+    trace_end("save_cache");
+    trace_begin("upload");
     graphics_renderer()->create_image_atlas(atlas_data, 1);
+    trace_end("upload");
 #endif
     return 1;
 }
@@ -4,6 +4,8 @@
 #include "assets/layer.h"
 #include "assets/xml.h"
 
+#include <stdint.h>
+
 typedef struct {
     unsigned int index;
     int active;
@@ -29,7 +31,7 @@ asset_image *asset_image_get_from_id(unsigned int image_id);
 void asset_image_unload(asset_image *img);
 int asset_image_init_array(void);
 asset_image *asset_image_create(void);
-int asset_image_load_all(color_t **main_images, int *main_image_widths);
+int asset_image_load_all(color_t **main_images, int *main_image_widths, uint64_t cache_key);
 void asset_image_reload_climate(void);
 void asset_image_count_isometric(void);
 
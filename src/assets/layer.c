@@ -1,19 +1,48 @@
 #include "layer.h"
 
 #include "assets/assets.h"
+#include "assets/bundle.h"
 #include "assets/group.h"
 #include "assets/image.h"
 #include "assets/xml.h"
+#include "core/color_convert.h"
 #include "core/file.h"
+#include "core/image_cache.h"
 #include "core/log.h"
 #include "core/png_read.h"
 #include "core/string.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#define LAYER_CACHE_INITIAL_SIZE 1024
+
 static color_t DUMMY_LAYER_DATA = COLOR_BLACK;
 
+#ifndef BUILDING_ASSET_PACKER
+typedef struct layer_cache_entry {
+    uint64_t hash;
+    char *path;
+    int image_id;
+    int src_x;
+    int src_y;
+    int width;
+    int height;
+    layer_isometric_part part;
+    int grayscale;
+    int pending_loads;
+    int users;
+    color_t *data;
+} layer_cache_entry;
+
+static struct {
+    layer_cache_entry *entries;
+    unsigned int size;
+    unsigned int total;
+} cache;
+#endif
+
 static void load_dummy_layer(layer *l)
 {
     l->data = &DUMMY_LAYER_DATA;
@@ -23,20 +52,180 @@ static void load_dummy_layer(layer *l)
 }
 
 #ifndef BUILDING_ASSET_PACKER
-static void convert_layer_to_grayscale(color_t *pixels, int width, int height)
+static void get_cache_key(const layer *l, layer_cache_entry *key)
+{
+    memset(key, 0, sizeof(layer_cache_entry));
+    key->image_id = l->calculated_image_id;
+    if (key->image_id) {
+        key->part = l->part;
+    } else {
+        key->path = l->asset_image_path;
+        key->src_x = l->src_x;
+        key->src_y = l->src_y;
+    }
+    key->width = l->width;
+    key->height = l->height;
+    key->grayscale = l->mask == LAYER_MASK_GRAYSCALE;
+
+    uint64_t hash = IMAGE_CACHE_HASH_START;
+    hash = image_cache_hash_string(hash, key->path ? key->path : "");
+    hash = image_cache_hash_int(hash, key->image_id);
+    hash = image_cache_hash_int(hash, key->src_x);
+    hash = image_cache_hash_int(hash, key->src_y);
+    hash = image_cache_hash_int(hash, key->width);
+    hash = image_cache_hash_int(hash, key->height);
+    hash = image_cache_hash_int(hash, key->part);
+    hash = image_cache_hash_int(hash, key->grayscale);
+    key->hash = hash ? hash : 1;
+}
+
+static int cache_keys_match(const layer_cache_entry *a, const layer_cache_entry *b)
+{
+    if (a->hash != b->hash || a->image_id != b->image_id || a->src_x != b->src_x || a->src_y != b->src_y ||
+        a->width != b->width || a->height != b->height || a->part != b->part || a->grayscale != b->grayscale) {
+        return 0;
+    }
+    if (!a->path || !b->path) {
+        return a->path == b->path;
+    }
+    return strcmp(a->path, b->path) == 0;
+}
+
+static layer_cache_entry *find_cache_slot(layer_cache_entry *entries, unsigned int size,
+    const layer_cache_entry *key)
+{
+    unsigned int mask = size - 1;
+    for (unsigned int index = (unsigned int) key->hash & mask; ; index = (index + 1) & mask) {
+        layer_cache_entry *entry = &entries[index];
+        if (!entry->hash || cache_keys_match(entry, key)) {
+            return entry;
+        }
+    }
+}
+
+static int grow_cache(void)
 {
-    for (int y = 0; y < height; y++) {
-        color_t *color = &pixels[y * width];
-        for (int x = 0; x < width; x++) {
-            color_t r = (*color & COLOR_CHANNEL_RED) >> COLOR_BITSHIFT_RED;
-            color_t g = (*color & COLOR_CHANNEL_GREEN) >> COLOR_BITSHIFT_GREEN;
-            color_t b = (*color & COLOR_CHANNEL_BLUE) >> COLOR_BITSHIFT_BLUE;
-            color_t gray = (color_t) (r * 0.299f + g * 0.587f + b * 0.114f);
-            *color = (*color & COLOR_CHANNEL_ALPHA) | (gray << COLOR_BITSHIFT_RED) |
-                (gray << COLOR_BITSHIFT_GREEN) | (gray << COLOR_BITSHIFT_BLUE);
-            color++;
+    unsigned int new_size = cache.size ? cache.size * 2 : LAYER_CACHE_INITIAL_SIZE;
+    layer_cache_entry *entries = malloc(new_size * sizeof(layer_cache_entry));
+    if (!entries) {
+        return 0;
+    }
+    memset(entries, 0, new_size * sizeof(layer_cache_entry));
+    for (unsigned int i = 0; i < cache.size; i++) {
+        if (cache.entries[i].hash) {
+            *find_cache_slot(entries, new_size, &cache.entries[i]) = cache.entries[i];
+        }
+    }
+    free(cache.entries);
+    cache.entries = entries;
+    cache.size = new_size;
+    return 1;
+}
+
+static layer_cache_entry *find_cache_entry(const layer *l)
+{
+    if (!cache.total) {
+        return 0;
+    }
+    layer_cache_entry key;
+    get_cache_key(l, &key);
+    layer_cache_entry *entry = find_cache_slot(cache.entries, cache.size, &key);
+    // Pixels that are only loaded once are not worth keeping
+    return entry->hash && (entry->data || entry->pending_loads > 1) ? entry : 0;
+}
+
+void layer_cache_add_use(const layer *l)
+{
+    if (!l->calculated_image_id && !l->asset_image_path) {
+        return;
+    }
+    if ((cache.total + 1) * 2 > cache.size && !grow_cache()) {
+        return;
+    }
+    layer_cache_entry key;
+    get_cache_key(l, &key);
+    layer_cache_entry *entry = find_cache_slot(cache.entries, cache.size, &key);
+    if (!entry->hash) {
+        if (key.path) {
+            size_t length = strlen(key.path) + 1;
+            key.path = malloc(length);
+            if (!key.path) {
+                return;
+            }
+            memcpy(key.path, l->asset_image_path, length);
         }
+        *entry = key;
+        cache.total++;
     }
+    entry->pending_loads++;
+}
+
+int layer_cache_has_pixels(const layer *l)
+{
+    const layer_cache_entry *entry = find_cache_entry(l);
+    return entry && entry->data;
+}
+
+static int use_cached_pixels(layer *l, layer_cache_entry *entry)
+{
+    if (!entry || !entry->data) {
+        return 0;
+    }
+    l->data = entry->data;
+    l->cache_entry = entry;
+    entry->users++;
+    entry->pending_loads--;
+    return 1;
+}
+
+static void set_layer_pixels(layer *l, color_t *data, layer_cache_entry *entry)
+{
+    l->data = data;
+    if (entry) {
+        entry->data = data;
+        l->cache_entry = entry;
+        entry->users++;
+        entry->pending_loads--;
+    }
+}
+
+static void release_cached_pixels(layer *l)
+{
+    layer_cache_entry *entry = l->cache_entry;
+    l->cache_entry = 0;
+    l->data = 0;
+    entry->users--;
+    if (!entry->users && entry->pending_loads <= 0) {
+        free(entry->data);
+        entry->data = 0;
+    }
+}
+
+void layer_cache_clear(void)
+{
+    for (unsigned int i = 0; i < cache.size; i++) {
+        free(cache.entries[i].path);
+        free(cache.entries[i].data);
+    }
+    free(cache.entries);
+    memset(&cache, 0, sizeof(cache));
+}
+
+color_t *layer_take_data(layer *l)
+{
+    color_t *data = (color_t *) l->data; // Taking a const pointer. Ugly but necessary
+    if (l->cache_entry) {
+        size_t size = sizeof(color_t) * l->width * l->height;
+        data = malloc(size);
+        if (data) {
+            memcpy(data, l->data, size);
+        } else {
+            log_error("Problem copying layer - out of memory", l->asset_image_path, 0);
+        }
+        release_cached_pixels(l);
+    }
+    l->data = 0;
+    return data;
 }
 
 static void load_layer_from_another_image(layer *l, color_t **main_data, int *main_image_widths)
@@ -70,8 +259,7 @@ static void load_layer_from_another_image(layer *l, color_t **main_data, int *ma
                     int layer_image_id = asset_img_layer->calculated_image_id;
                     layer_load(asset_img_layer, main_data, main_image_widths);
                     asset_img_layer->calculated_image_id = layer_image_id;
-                    asset_img->data = asset_img_layer->data;
-                    asset_img_layer->data = 0;
+                    asset_img->data = layer_take_data(asset_img_layer);
                 }
                 break;
             }
@@ -84,6 +272,16 @@ static void load_layer_from_another_image(layer *l, color_t **main_data, int *ma
         }
     }
 
+    // The pixels only depend on the layer when they come from the main images or from an asset that is loaded
+    layer_cache_entry *cache_entry = 0;
+    if (type != ATLAS_EXTERNAL && (asset_img ? asset_img->data != 0 : type == ATLAS_MAIN)) {
+        cache_entry = find_cache_entry(l);
+        if (use_cached_pixels(l, cache_entry)) {
+            l->calculated_image_id = 0;
+            return;
+        }
+    }
+
     int width;
     int height;
     if (type == ATLAS_EXTERNAL && !asset_img) {
@@ -165,6 +363,8 @@ static void load_layer_from_another_image(layer *l, color_t **main_data, int *ma
             data = new_data;
         }****/
     } else if (type == ATLAS_MAIN) {
+        image_load_pixels(img);
+        image_load_pixels(img->top);
         int atlas_width = main_image_widths[img->atlas.id & IMAGE_ATLAS_BIT_MASK];
         const color_t *atlas_pixels = main_data[img->atlas.id & IMAGE_ATLAS_BIT_MASK];
         if (!atlas_width || !atlas_pixels) {
@@ -206,13 +406,24 @@ static void load_layer_from_another_image(layer *l, color_t **main_data, int *ma
     l->calculated_image_id = 0;
 
     if (l->mask == LAYER_MASK_GRAYSCALE) {
-        convert_layer_to_grayscale(data, l->width, l->height);
+        color_convert_to_grayscale(data, l->width * l->height);
     }
 
-    l->data = data;
+    set_layer_pixels(l, data, cache_entry);
 }
 #endif
 
+static int read_layer_file(const layer *l, color_t *data)
+{
+#ifndef BUILDING_ASSET_PACKER
+    if (asset_bundle_read(l->asset_image_path, data, l->src_x, l->src_y, l->width, l->height)) {
+        return 1;
+    }
+#endif
+    return png_load_from_file(l->asset_image_path, 1) &&
+        png_read(data, l->src_x, l->src_y, l->width, l->height, 0, 0, l->width, 0);
+}
+
 void layer_load(layer *l, color_t **main_data, int *main_image_widths)
 {
 #ifndef BUILDING_ASSET_PACKER
@@ -226,6 +437,12 @@ void layer_load(layer *l, color_t **main_data, int *main_image_widths)
         load_dummy_layer(l);
         return;
     }
+#ifndef BUILDING_ASSET_PACKER
+    layer_cache_entry *cache_entry = find_cache_entry(l);
+    if (use_cached_pixels(l, cache_entry)) {
+        return;
+    }
+#endif
 
     size_t size = sizeof(color_t) * l->width * l->height;
     color_t *data = malloc(size);
@@ -235,8 +452,7 @@ void layer_load(layer *l, color_t **main_data, int *main_image_widths)
         return;
     }
     memset(data, 0, size);
-    if (!png_load_from_file(l->asset_image_path, 1) ||
-        !png_read(data, l->src_x, l->src_y, l->width, l->height, 0, 0, l->width, 0)) {
+    if (!read_layer_file(l, data)) {
         free(data);
         log_error("Problem loading layer from file", l->asset_image_path, 0);
         load_dummy_layer(l);
@@ -244,11 +460,12 @@ void layer_load(layer *l, color_t **main_data, int *main_image_widths)
     }
 #ifndef BUILDING_ASSET_PACKER
     if (l->mask == LAYER_MASK_GRAYSCALE) {
-        convert_layer_to_grayscale(data, l->width, l->height);
+        color_convert_to_grayscale(data, l->width * l->height);
     }
-#endif
-
+    set_layer_pixels(l, data, cache_entry);
+#else
     l->data = data;
+#endif
 }
 
 void layer_unload(layer *l)
@@ -257,6 +474,11 @@ void layer_unload(layer *l)
 #ifdef BUILDING_ASSET_PACKER
     free(l->original_image_group);
     free(l->original_image_id);
+#endif
+#ifndef BUILDING_ASSET_PACKER
+    if (l->cache_entry) {
+        release_cached_pixels(l);
+    } else
 #endif
     if (!l->calculated_image_id && l->data != &DUMMY_LAYER_DATA) {
         free((color_t *) l->data); // Freeing a const pointer. Ugly but necessary
@@ -311,7 +533,8 @@ int layer_add_from_image_path(layer *l, const char *path,
     }
 #ifndef BUILDING_ASSET_PACKER
     if (!l->width || !l->height) {
-        if (!png_load_from_file(l->asset_image_path, 1) || !png_get_image_size(&width, &height)) {
+        if (!asset_bundle_get_image_size(l->asset_image_path, &width, &height) &&
+            (!png_load_from_file(l->asset_image_path, 1) || !png_get_image_size(&width, &height))) {
             log_info("Unable to load image", path, 0);
             layer_unload(l);
             return 0;
@@ -384,15 +607,10 @@ int layer_add_from_image_id(layer *l, const char *group_id, const char *image_id
             layer_unload(l);
             return 0;
         }
-        const image_groups *group = group_get_current();
-        const asset_image *img = asset_image_get_from_id(group->first_image_index);
-        while (img && img->index <= (unsigned int) group->last_image_index) {
-            if (img->id && strcmp(img->id, image_id) == 0) {
-                l->calculated_image_id = img->index + IMAGE_MAIN_ENTRIES;
-                original_image = &img->img;
-                break;
-            }
-            img = asset_image_get_from_id(img->index + 1);
+        int image_index = group_get_image_index(group_get_current(), image_id);
+        if (image_index >= 0) {
+            l->calculated_image_id = image_index + IMAGE_MAIN_ENTRIES;
+            original_image = &asset_image_get_from_id(image_index)->img;
         }
         if (!l->calculated_image_id) {
             log_error("Unable to find image on current group with id", image_id, 0);
@@ -52,12 +52,44 @@ typedef struct layer {
 #ifdef BUILDING_ASSET_PACKER
     char *original_image_group;
     char *original_image_id;
+#else
+    struct layer_cache_entry *cache_entry; // Set when the pixels are shared through the layer cache
 #endif
 } layer;
 
 void layer_load(layer *l, color_t **main_data, int *main_image_widths);
 void layer_unload(layer *l);
 
+#ifndef BUILDING_ASSET_PACKER
+/**
+ * Takes the pixels of a loaded layer. Shared pixels are copied first
+ * @param l The layer
+ * @return The pixels, which the caller must free, or 0 on memory error
+ */
+color_t *layer_take_data(layer *l);
+
+/**
+ * Tells the layer cache that the pixels of a layer will be loaded.
+ * Pixels that are loaded by more than one layer, with the same source, crop, isometric part and grayscale mask,
+ * are only decoded by the first layer and shared with the others. Transforms are applied when the layers
+ * are composed, so they do not matter.
+ * @param l The layer that will be loaded
+ */
+void layer_cache_add_use(const layer *l);
+
+/**
+ * Checks whether the pixels of a layer are already in the layer cache
+ * @param l The layer
+ * @return Boolean true if the layer will use the cached pixels, false otherwise
+ */
+int layer_cache_has_pixels(const layer *l);
+
+/**
+ * Frees all the pixels kept by the layer cache. Layers that use them must be unloaded first
+ */
+void layer_cache_clear(void);
+#endif
+
 const color_t *layer_get_color_for_image_position(const layer *l, int x, int y);
 
 int layer_add_from_image_path(layer *l, const char *path, int src_x, int src_y,
@@ -232,14 +232,10 @@ void building_state_save_to_buffer(buffer *buf, const building *b)
     buffer_write_u8(buf, b->fumigation_direction);
 
     // extra resources
-    for (int i = 0; i < RESOURCE_MAX; i++) {
-        buffer_write_i16(buf, b->resources[i]);
-    }
+    buffer_write_i16_array(buf, b->resources, RESOURCE_MAX);
 
     // accepted goods
-    for (int i = 0; i < RESOURCE_MAX; i++) {
-        buffer_write_u8(buf, b->accepted_goods[i]);
-    }
+    buffer_write_u8_array(buf, b->accepted_goods, RESOURCE_MAX);
 
     // latrines
     buffer_write_u8(buf, b->has_latrines_access);
@@ -44,6 +44,7 @@ static struct {
 } data;
 
 static int view_to_grid_offset_lookup[VIEW_X_MAX][VIEW_Y_MAX];
+static view_tile grid_offset_to_view_lookup[GRID_SIZE * GRID_SIZE];
 
 static void check_camera_boundaries(void)
 {
@@ -106,6 +107,17 @@ static void reset_lookup(void)
             view_to_grid_offset_lookup[x][y] = -1;
         }
     }
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+        grid_offset_to_view_lookup[i].x = -1;
+        grid_offset_to_view_lookup[i].y = -1;
+    }
+}
+
+static void set_lookup(int x_view, int y_view, int grid_offset)
+{
+    view_to_grid_offset_lookup[x_view][y_view] = grid_offset;
+    grid_offset_to_view_lookup[grid_offset].x = x_view;
+    grid_offset_to_view_lookup[grid_offset].y = y_view;
 }
 
 static void calculate_lookup(void)
@@ -161,7 +173,7 @@ static void calculate_lookup(void)
             if (map_image_at(grid_offset) < 6) {
                 view_to_grid_offset_lookup[x_view / 2][y_view] = -1;
             } else {
-                view_to_grid_offset_lookup[x_view / 2][y_view] = grid_offset;
+                set_lookup(x_view / 2, y_view, grid_offset);
             }
             x_view += x_view_step;
             y_view += y_view_step;
@@ -187,7 +199,7 @@ void city_view_set_custom_lookup(int start_offset, int width, int height, int bo
         int x_view = x_view_start + start_x;
         int y_view = y_view_start + start_x;
         for (int x = start_x; x < end_x; x++) {
-            view_to_grid_offset_lookup[x_view / 2][y_view] = x + GRID_SIZE * y;
+            set_lookup(x_view / 2, y_view, x + GRID_SIZE * y);
             x_view++;
             y_view++;
         }
@@ -462,15 +474,26 @@ void city_view_scroll(int x, int y)
 void city_view_grid_offset_to_xy_view(int grid_offset, int *x_view, int *y_view)
 {
     *x_view = *y_view = 0;
-    for (int y = 0; y < VIEW_Y_MAX; y++) {
-        for (int x = 0; x < VIEW_X_MAX; x++) {
-            if (view_to_grid_offset_lookup[x][y] == grid_offset) {
-                *x_view = x;
-                *y_view = y;
-                return;
-            }
-        }
+    if (grid_offset < 0 || grid_offset >= GRID_SIZE * GRID_SIZE || grid_offset_to_view_lookup[grid_offset].x < 0) {
+        return;
+    }
+    *x_view = grid_offset_to_view_lookup[grid_offset].x;
+    *y_view = grid_offset_to_view_lookup[grid_offset].y;
+}
+
+int city_view_grid_offset_to_pixels(int grid_offset, int *x_pixels, int *y_pixels)
+{
+    if (grid_offset < 0 || grid_offset >= GRID_SIZE * GRID_SIZE || grid_offset_to_view_lookup[grid_offset].x < 0) {
+        return 0;
     }
+    const view_tile *tile = &grid_offset_to_view_lookup[grid_offset];
+    // Same position as city_view_get_camera_in_pixels, the camera always being on an even row
+    *x_pixels = TILE_WIDTH_PIXELS * tile->x;
+    if (tile->y & 1) {
+        *x_pixels -= HALF_TILE_WIDTH_PIXELS;
+    }
+    *y_pixels = HALF_TILE_HEIGHT_PIXELS * tile->y - HALF_TILE_HEIGHT_PIXELS;
+    return 1;
 }
 
 void city_view_get_selected_tile_pixels(int *x_pixels, int *y_pixels)
@@ -804,6 +827,30 @@ void city_view_foreach_valid_map_tile_row(map_callback *callback1, map_callback
     }
 }
 
+void city_view_foreach_map_tile_in_area(int x, int y, int width, int height, map_callback *callback)
+{
+    // Use the same margins as when going through the viewport, so images larger than their tile are included
+    int y_view_start = calc_bound((y + HALF_TILE_HEIGHT_PIXELS) / HALF_TILE_HEIGHT_PIXELS - 8, 0, VIEW_Y_MAX - 1);
+    int y_view_end = calc_bound((y + height + HALF_TILE_HEIGHT_PIXELS) / HALF_TILE_HEIGHT_PIXELS + 13,
+        0, VIEW_Y_MAX - 1);
+    int x_view_start = calc_bound(x / TILE_WIDTH_PIXELS - 6, 0, VIEW_X_MAX - 1);
+    int x_view_end = calc_bound((x + width + HALF_TILE_WIDTH_PIXELS) / TILE_WIDTH_PIXELS + 3, 0, VIEW_X_MAX - 1);
+    for (int y_view = y_view_start; y_view <= y_view_end; y_view++) {
+        int y_graphic = HALF_TILE_HEIGHT_PIXELS * y_view - HALF_TILE_HEIGHT_PIXELS - y;
+        int x_graphic = TILE_WIDTH_PIXELS * x_view_start - x;
+        if (y_view & 1) {
+            x_graphic -= HALF_TILE_WIDTH_PIXELS;
+        }
+        for (int x_view = x_view_start; x_view <= x_view_end; x_view++) {
+            int grid_offset = view_to_grid_offset_lookup[x_view][y_view];
+            if (grid_offset >= 0) {
+                callback(x_graphic, y_graphic, grid_offset);
+            }
+            x_graphic += TILE_WIDTH_PIXELS;
+        }
+    }
+}
+
 static void do_valid_callback(int view_x, int view_y, int grid_offset, map_callback *callback)
 {
     if (grid_offset >= 0 && map_image_at(grid_offset) >= 6) {
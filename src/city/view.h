@@ -49,6 +49,7 @@ void city_view_set_camera_from_pixel_position(int x, int y);
 void city_view_scroll(int x, int y);
 
 void city_view_grid_offset_to_xy_view(int grid_offset, int *x_view, int *y_view);
+int city_view_grid_offset_to_pixels(int grid_offset, int *x_pixels, int *y_pixels);
 
 void city_view_get_selected_tile_pixels(int *x_pixels, int *y_pixels);
 
@@ -87,6 +88,8 @@ void city_view_foreach_valid_map_tile(map_callback *callback);
 
 void city_view_foreach_valid_map_tile_row(map_callback *callback1, map_callback *callback2, map_callback *callback3);
 
+void city_view_foreach_map_tile_in_area(int x, int y, int width, int height, map_callback *callback);
+
 void city_view_foreach_tile_in_range(int grid_offset, int size, int radius, map_callback *callback);
 
 void city_view_foreach_minimap_tile(
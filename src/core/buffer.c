@@ -31,6 +31,37 @@ static int check_size(buffer *buf, size_t size)
     return 1;
 }
 
+static int is_little_endian(void)
+{
+    const uint16_t value = 1;
+    return *(const uint8_t *) &value == 1;
+}
+
+/**
+ * Copies a whole array when the host stores integers the same way as the buffer.
+ * When that's not possible, returns false and the caller converts the values one by one,
+ * which also handles arrays that don't fully fit exactly as the single value functions do.
+ */
+static int write_array(buffer *buf, const void *values, size_t size)
+{
+    if (!is_little_endian() || buf->index + size > buf->size) {
+        return 0;
+    }
+    memcpy(&buf->data[buf->index], values, size);
+    buf->index += size;
+    return 1;
+}
+
+static int read_array(buffer *buf, void *values, size_t size)
+{
+    if (!is_little_endian() || buf->index + size > buf->size) {
+        return 0;
+    }
+    memcpy(values, &buf->data[buf->index], size);
+    buf->index += size;
+    return 1;
+}
+
 void buffer_write_u8(buffer *buf, uint8_t value)
 {
     if (check_size(buf, 1)) {
@@ -89,6 +120,56 @@ void buffer_write_raw(buffer *buf, const void *value, size_t size)
     }
 }
 
+void buffer_write_u8_array(buffer *buf, const uint8_t *values, size_t count)
+{
+    if (write_array(buf, values, count)) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        buffer_write_u8(buf, values[i]);
+    }
+}
+
+void buffer_write_u16_array(buffer *buf, const uint16_t *values, size_t count)
+{
+    if (write_array(buf, values, count * sizeof(uint16_t))) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        buffer_write_u16(buf, values[i]);
+    }
+}
+
+void buffer_write_u32_array(buffer *buf, const uint32_t *values, size_t count)
+{
+    if (write_array(buf, values, count * sizeof(uint32_t))) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        buffer_write_u32(buf, values[i]);
+    }
+}
+
+void buffer_write_i16_array(buffer *buf, const int16_t *values, size_t count)
+{
+    if (write_array(buf, values, count * sizeof(int16_t))) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        buffer_write_i16(buf, values[i]);
+    }
+}
+
+void buffer_write_i32_array(buffer *buf, const int32_t *values, size_t count)
+{
+    if (write_array(buf, values, count * sizeof(int32_t))) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        buffer_write_i32(buf, values[i]);
+    }
+}
+
 uint8_t buffer_read_u8(buffer *buf)
 {
     if (check_size(buf, 1)) {
@@ -155,6 +236,56 @@ int32_t buffer_read_i32(buffer *buf)
     }
 }
 
+void buffer_read_u8_array(buffer *buf, uint8_t *values, size_t count)
+{
+    if (read_array(buf, values, count)) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        values[i] = buffer_read_u8(buf);
+    }
+}
+
+void buffer_read_u16_array(buffer *buf, uint16_t *values, size_t count)
+{
+    if (read_array(buf, values, count * sizeof(uint16_t))) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        values[i] = buffer_read_u16(buf);
+    }
+}
+
+void buffer_read_u32_array(buffer *buf, uint32_t *values, size_t count)
+{
+    if (read_array(buf, values, count * sizeof(uint32_t))) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        values[i] = buffer_read_u32(buf);
+    }
+}
+
+void buffer_read_i16_array(buffer *buf, int16_t *values, size_t count)
+{
+    if (read_array(buf, values, count * sizeof(int16_t))) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        values[i] = buffer_read_i16(buf);
+    }
+}
+
+void buffer_read_i32_array(buffer *buf, int32_t *values, size_t count)
+{
+    if (read_array(buf, values, count * sizeof(int32_t))) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        values[i] = buffer_read_i32(buf);
+    }
+}
+
 size_t buffer_read_raw(buffer *buf, void *value, size_t max_size)
 {
     size_t size = buf->size - buf->index;
@@ -90,6 +90,50 @@ void buffer_write_i32(buffer *buffer, int32_t value);
  */
 void buffer_write_raw(buffer *buffer, const void *value, size_t size);
 
+/**
+ * Writes an array of unsigned 8-bit integers
+ * @param buffer Buffer
+ * @param values Values to write
+ * @param count Number of values
+ */
+void buffer_write_u8_array(buffer *buffer, const uint8_t *values, size_t count);
+
+/**
+ * Writes an array of unsigned 16-bit integers.
+ * Copies the values as they are on little-endian hosts, converts them one by one elsewhere.
+ * @param buffer Buffer
+ * @param values Values to write
+ * @param count Number of values
+ */
+void buffer_write_u16_array(buffer *buffer, const uint16_t *values, size_t count);
+
+/**
+ * Writes an array of unsigned 32-bit integers.
+ * Copies the values as they are on little-endian hosts, converts them one by one elsewhere.
+ * @param buffer Buffer
+ * @param values Values to write
+ * @param count Number of values
+ */
+void buffer_write_u32_array(buffer *buffer, const uint32_t *values, size_t count);
+
+/**
+ * Writes an array of signed 16-bit integers.
+ * Copies the values as they are on little-endian hosts, converts them one by one elsewhere.
+ * @param buffer Buffer
+ * @param values Values to write
+ * @param count Number of values
+ */
+void buffer_write_i16_array(buffer *buffer, const int16_t *values, size_t count);
+
+/**
+ * Writes an array of signed 32-bit integers.
+ * Copies the values as they are on little-endian hosts, converts them one by one elsewhere.
+ * @param buffer Buffer
+ * @param values Values to write
+ * @param count Number of values
+ */
+void buffer_write_i32_array(buffer *buffer, const int32_t *values, size_t count);
+
 /**
  * Reads an unsigned 8-bit integer
  * @param buffer Buffer
@@ -132,6 +176,51 @@ int16_t buffer_read_i16(buffer *buffer);
  */
 int32_t buffer_read_i32(buffer *buffer);
 
+/**
+ * Reads an array of unsigned 8-bit integers.
+ * Values past the end of the buffer are set to 0, the same as when reading them one by one.
+ * @param buffer Buffer
+ * @param values Values to read into
+ * @param count Number of values
+ */
+void buffer_read_u8_array(buffer *buffer, uint8_t *values, size_t count);
+
+/**
+ * Reads an array of unsigned 16-bit integers.
+ * Values past the end of the buffer are set to 0, the same as when reading them one by one.
+ * @param buffer Buffer
+ * @param values Values to read into
+ * @param count Number of values
+ */
+void buffer_read_u16_array(buffer *buffer, uint16_t *values, size_t count);
+
+/**
+ * Reads an array of unsigned 32-bit integers.
+ * Values past the end of the buffer are set to 0, the same as when reading them one by one.
+ * @param buffer Buffer
+ * @param values Values to read into
+ * @param count Number of values
+ */
+void buffer_read_u32_array(buffer *buffer, uint32_t *values, size_t count);
+
+/**
+ * Reads an array of signed 16-bit integers.
+ * Values past the end of the buffer are set to 0, the same as when reading them one by one.
+ * @param buffer Buffer
+ * @param values Values to read into
+ * @param count Number of values
+ */
+void buffer_read_i16_array(buffer *buffer, int16_t *values, size_t count);
+
+/**
+ * Reads an array of signed 32-bit integers.
+ * Values past the end of the buffer are set to 0, the same as when reading them one by one.
+ * @param buffer Buffer
+ * @param values Values to read into
+ * @param count Number of values
+ */
+void buffer_read_i32_array(buffer *buffer, int32_t *values, size_t count);
+
 /**
  * Reads raw data
  * @param buffer Buffer
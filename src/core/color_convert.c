@@ -0,0 +1,254 @@
+#include "color_convert.h"
+
+#ifndef COLOR_CONVERT_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2
+#include <emmintrin.h>
+#elif ((defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__ARM_BIG_ENDIAN)) || defined(_M_ARM64)
+#define USE_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+// The weights are 0.299, 0.587 and 0.114 in 16 bit fixed point, so every version gives exactly the same result
+#define GRAYSCALE_RED 19595
+#define GRAYSCALE_GREEN 38470
+#define GRAYSCALE_BLUE 7471
+#define GRAYSCALE_SHIFT 16
+
+// The plain C versions are the reference for the vectorized ones and also convert what is left after them
+
+static void convert_sg2_pixels_scalar(const uint8_t *src, color_t *dst, int total_pixels,
+    int use_transparent_color)
+{
+    for (int i = 0; i < total_pixels; i++) {
+        uint16_t c = (uint16_t) (src[0] | (src[1] << 8));
+        color_t color = ALPHA_OPAQUE |
+            ((c & 0x7c00) << 9) | ((c & 0x7000) << 4) |
+            ((c & 0x3e0) << 6) | ((c & 0x380) << 1) |
+            ((c & 0x1f) << 3) | ((c & 0x1c) >> 2);
+        dst[i] = use_transparent_color && color == COLOR_SG2_TRANSPARENT ? ALPHA_TRANSPARENT : color;
+        src += 2;
+    }
+}
+
+static void convert_to_white_scalar(color_t *pixels, int total_pixels)
+{
+    for (int i = 0; i < total_pixels; i++) {
+        if ((pixels[i] & COLOR_CHANNEL_ALPHA) != ALPHA_TRANSPARENT) {
+            pixels[i] |= COLOR_CHANNEL_RGB;
+        }
+    }
+}
+
+static void convert_to_grayscale_scalar(color_t *pixels, int total_pixels)
+{
+    for (int i = 0; i < total_pixels; i++) {
+        color_t r = (pixels[i] & COLOR_CHANNEL_RED) >> COLOR_BITSHIFT_RED;
+        color_t g = (pixels[i] & COLOR_CHANNEL_GREEN) >> COLOR_BITSHIFT_GREEN;
+        color_t b = (pixels[i] & COLOR_CHANNEL_BLUE) >> COLOR_BITSHIFT_BLUE;
+        color_t gray = (r * GRAYSCALE_RED + g * GRAYSCALE_GREEN + b * GRAYSCALE_BLUE) >> GRAYSCALE_SHIFT;
+        pixels[i] = (pixels[i] & COLOR_CHANNEL_ALPHA) | (gray << COLOR_BITSHIFT_RED) |
+            (gray << COLOR_BITSHIFT_GREEN) | (gray << COLOR_BITSHIFT_BLUE);
+    }
+}
+
+static void convert_rgba_to_argb_scalar(color_t *pixels, int total_pixels)
+{
+    const uint8_t *src = (const uint8_t *) pixels;
+    for (int i = 0; i < total_pixels; i++) {
+        pixels[i] = ((color_t) src[0] << COLOR_BITSHIFT_RED) | ((color_t) src[1] << COLOR_BITSHIFT_GREEN) |
+            ((color_t) src[2] << COLOR_BITSHIFT_BLUE) | ((color_t) src[3] << COLOR_BITSHIFT_ALPHA);
+        src += sizeof(color_t);
+    }
+}
+
+#if defined(USE_SSE2)
+
+static __m128i expand_5_bits(__m128i value)
+{
+    return _mm_or_si128(_mm_slli_epi16(value, 3), _mm_srli_epi16(value, 2));
+}
+
+void color_convert_sg2_pixels(const uint8_t *src, color_t *dst, int total_pixels, int use_transparent_color)
+{
+    const __m128i low_5_bits = _mm_set1_epi16(0x1f);
+    const __m128i alpha = _mm_set1_epi16((short) (ALPHA_OPAQUE >> 16));
+    const __m128i transparent = _mm_set1_epi32((int) COLOR_SG2_TRANSPARENT);
+    int i = 0;
+    for (; i + 8 <= total_pixels; i += 8) {
+        __m128i c = _mm_loadu_si128((const __m128i *) &src[i * 2]);
+        __m128i r = expand_5_bits(_mm_and_si128(_mm_srli_epi16(c, 10), low_5_bits));
+        __m128i g = expand_5_bits(_mm_and_si128(_mm_srli_epi16(c, 5), low_5_bits));
+        __m128i b = expand_5_bits(_mm_and_si128(c, low_5_bits));
+        // Each color is made of a low half with green and blue and a high half with alpha and red
+        __m128i low = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+        __m128i high = _mm_or_si128(alpha, r);
+        __m128i first = _mm_unpacklo_epi16(low, high);
+        __m128i second = _mm_unpackhi_epi16(low, high);
+        if (use_transparent_color) {
+            first = _mm_andnot_si128(_mm_cmpeq_epi32(first, transparent), first);
+            second = _mm_andnot_si128(_mm_cmpeq_epi32(second, transparent), second);
+        }
+        _mm_storeu_si128((__m128i *) &dst[i], first);
+        _mm_storeu_si128((__m128i *) &dst[i + 4], second);
+    }
+    convert_sg2_pixels_scalar(&src[i * 2], &dst[i], total_pixels - i, use_transparent_color);
+}
+
+void color_convert_to_white(color_t *pixels, int total_pixels)
+{
+    const __m128i alpha_channel = _mm_set1_epi32((int) COLOR_CHANNEL_ALPHA);
+    const __m128i transparent = _mm_set1_epi32(ALPHA_TRANSPARENT);
+    const __m128i white = _mm_set1_epi32(COLOR_CHANNEL_RGB);
+    int i = 0;
+    for (; i + 4 <= total_pixels; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *) &pixels[i]);
+        __m128i is_transparent = _mm_cmpeq_epi32(_mm_and_si128(p, alpha_channel), transparent);
+        _mm_storeu_si128((__m128i *) &pixels[i], _mm_or_si128(p, _mm_andnot_si128(is_transparent, white)));
+    }
+    convert_to_white_scalar(&pixels[i], total_pixels - i);
+}
+
+void color_convert_to_grayscale(color_t *pixels, int total_pixels)
+{
+    const __m128i alpha_channel = _mm_set1_epi32((int) COLOR_CHANNEL_ALPHA);
+    const __m128i low_byte = _mm_set1_epi32(0xff);
+    // The green weight doesn't fit in a signed 16 bit number, so green is multiplied by half of it twice
+    const __m128i red_green_weights = _mm_set1_epi32(GRAYSCALE_RED | (GRAYSCALE_GREEN / 2) << 16);
+    const __m128i green_blue_weights = _mm_set1_epi32((GRAYSCALE_GREEN / 2) | GRAYSCALE_BLUE << 16);
+    int i = 0;
+    for (; i + 4 <= total_pixels; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *) &pixels[i]);
+        __m128i r = _mm_and_si128(_mm_srli_epi32(p, COLOR_BITSHIFT_RED), low_byte);
+        __m128i g = _mm_and_si128(_mm_srli_epi32(p, COLOR_BITSHIFT_GREEN), low_byte);
+        __m128i b = _mm_and_si128(_mm_srli_epi32(p, COLOR_BITSHIFT_BLUE), low_byte);
+        // Each color becomes two pairs of 16 bit channels, which are multiplied by their weights and added up
+        __m128i sum = _mm_add_epi32(_mm_madd_epi16(_mm_or_si128(r, _mm_slli_epi32(g, 16)), red_green_weights),
+            _mm_madd_epi16(_mm_or_si128(g, _mm_slli_epi32(b, 16)), green_blue_weights));
+        __m128i gray = _mm_srli_epi32(sum, GRAYSCALE_SHIFT);
+        __m128i result = _mm_or_si128(_mm_slli_epi32(gray, COLOR_BITSHIFT_RED),
+            _mm_or_si128(_mm_slli_epi32(gray, COLOR_BITSHIFT_GREEN), _mm_slli_epi32(gray, COLOR_BITSHIFT_BLUE)));
+        _mm_storeu_si128((__m128i *) &pixels[i], _mm_or_si128(_mm_and_si128(p, alpha_channel), result));
+    }
+    convert_to_grayscale_scalar(&pixels[i], total_pixels - i);
+}
+
+void color_convert_rgba_to_argb(color_t *pixels, int total_pixels)
+{
+    const __m128i alpha_green = _mm_set1_epi32((int) (COLOR_CHANNEL_ALPHA | COLOR_CHANNEL_GREEN));
+    const __m128i low_byte = _mm_set1_epi32(0xff);
+    int i = 0;
+    for (; i + 4 <= total_pixels; i += 4) {
+        // Read as little endian numbers the pixels are ABGR, so only red and blue need to be swapped
+        __m128i p = _mm_loadu_si128((const __m128i *) &pixels[i]);
+        __m128i red = _mm_slli_epi32(_mm_and_si128(p, low_byte), 16);
+        __m128i blue = _mm_and_si128(_mm_srli_epi32(p, 16), low_byte);
+        _mm_storeu_si128((__m128i *) &pixels[i], _mm_or_si128(_mm_and_si128(p, alpha_green), _mm_or_si128(red, blue)));
+    }
+    convert_rgba_to_argb_scalar(&pixels[i], total_pixels - i);
+}
+
+#elif defined(USE_NEON)
+
+static uint16x8_t expand_5_bits(uint16x8_t value)
+{
+    return vorrq_u16(vshlq_n_u16(value, 3), vshrq_n_u16(value, 2));
+}
+
+void color_convert_sg2_pixels(const uint8_t *src, color_t *dst, int total_pixels, int use_transparent_color)
+{
+    const uint16x8_t low_5_bits = vdupq_n_u16(0x1f);
+    const uint16x8_t alpha = vdupq_n_u16(ALPHA_OPAQUE >> 16);
+    const uint32x4_t transparent = vdupq_n_u32(COLOR_SG2_TRANSPARENT);
+    int i = 0;
+    for (; i + 8 <= total_pixels; i += 8) {
+        uint16x8_t c = vreinterpretq_u16_u8(vld1q_u8(&src[i * 2]));
+        uint16x8_t r = expand_5_bits(vandq_u16(vshrq_n_u16(c, 10), low_5_bits));
+        uint16x8_t g = expand_5_bits(vandq_u16(vshrq_n_u16(c, 5), low_5_bits));
+        uint16x8_t b = expand_5_bits(vandq_u16(c, low_5_bits));
+        // Each color is made of a low half with green and blue and a high half with alpha and red
+        uint16x8x2_t colors = vzipq_u16(vorrq_u16(vshlq_n_u16(g, 8), b), vorrq_u16(alpha, r));
+        uint32x4_t first = vreinterpretq_u32_u16(colors.val[0]);
+        uint32x4_t second = vreinterpretq_u32_u16(colors.val[1]);
+        if (use_transparent_color) {
+            first = vbicq_u32(first, vceqq_u32(first, transparent));
+            second = vbicq_u32(second, vceqq_u32(second, transparent));
+        }
+        vst1q_u32(&dst[i], first);
+        vst1q_u32(&dst[i + 4], second);
+    }
+    convert_sg2_pixels_scalar(&src[i * 2], &dst[i], total_pixels - i, use_transparent_color);
+}
+
+void color_convert_to_white(color_t *pixels, int total_pixels)
+{
+    const uint32x4_t alpha_channel = vdupq_n_u32(COLOR_CHANNEL_ALPHA);
+    const uint32x4_t transparent = vdupq_n_u32(ALPHA_TRANSPARENT);
+    const uint32x4_t white = vdupq_n_u32(COLOR_CHANNEL_RGB);
+    int i = 0;
+    for (; i + 4 <= total_pixels; i += 4) {
+        uint32x4_t p = vld1q_u32(&pixels[i]);
+        uint32x4_t is_transparent = vceqq_u32(vandq_u32(p, alpha_channel), transparent);
+        vst1q_u32(&pixels[i], vorrq_u32(p, vbicq_u32(white, is_transparent)));
+    }
+    convert_to_white_scalar(&pixels[i], total_pixels - i);
+}
+
+void color_convert_to_grayscale(color_t *pixels, int total_pixels)
+{
+    const uint32x4_t alpha_channel = vdupq_n_u32(COLOR_CHANNEL_ALPHA);
+    const uint32x4_t low_byte = vdupq_n_u32(0xff);
+    int i = 0;
+    for (; i + 4 <= total_pixels; i += 4) {
+        uint32x4_t p = vld1q_u32(&pixels[i]);
+        uint32x4_t r = vandq_u32(vshrq_n_u32(p, COLOR_BITSHIFT_RED), low_byte);
+        uint32x4_t g = vandq_u32(vshrq_n_u32(p, COLOR_BITSHIFT_GREEN), low_byte);
+        uint32x4_t b = vandq_u32(p, low_byte);
+        uint32x4_t sum = vmlaq_n_u32(vmlaq_n_u32(vmulq_n_u32(r, GRAYSCALE_RED), g, GRAYSCALE_GREEN), b, GRAYSCALE_BLUE);
+        uint32x4_t gray = vshrq_n_u32(sum, GRAYSCALE_SHIFT);
+        uint32x4_t result = vorrq_u32(vshlq_n_u32(gray, COLOR_BITSHIFT_RED),
+            vorrq_u32(vshlq_n_u32(gray, COLOR_BITSHIFT_GREEN), gray));
+        vst1q_u32(&pixels[i], vorrq_u32(vandq_u32(p, alpha_channel), result));
+    }
+    convert_to_grayscale_scalar(&pixels[i], total_pixels - i);
+}
+
+void color_convert_rgba_to_argb(color_t *pixels, int total_pixels)
+{
+    const uint32x4_t alpha_green = vdupq_n_u32(COLOR_CHANNEL_ALPHA | COLOR_CHANNEL_GREEN);
+    const uint32x4_t low_byte = vdupq_n_u32(0xff);
+    int i = 0;
+    for (; i + 4 <= total_pixels; i += 4) {
+        // Read as little endian numbers the pixels are ABGR, so only red and blue need to be swapped
+        uint32x4_t p = vld1q_u32(&pixels[i]);
+        uint32x4_t red = vshlq_n_u32(vandq_u32(p, low_byte), 16);
+        uint32x4_t blue = vandq_u32(vshrq_n_u32(p, 16), low_byte);
+        vst1q_u32(&pixels[i], vorrq_u32(vandq_u32(p, alpha_green), vorrq_u32(red, blue)));
+    }
+    convert_rgba_to_argb_scalar(&pixels[i], total_pixels - i);
+}
+
+#else
+
+void color_convert_sg2_pixels(const uint8_t *src, color_t *dst, int total_pixels, int use_transparent_color)
+{
+    convert_sg2_pixels_scalar(src, dst, total_pixels, use_transparent_color);
+}
+
+void color_convert_to_white(color_t *pixels, int total_pixels)
+{
+    convert_to_white_scalar(pixels, total_pixels);
+}
+
+void color_convert_to_grayscale(color_t *pixels, int total_pixels)
+{
+    convert_to_grayscale_scalar(pixels, total_pixels);
+}
+
+void color_convert_rgba_to_argb(color_t *pixels, int total_pixels)
+{
+    convert_rgba_to_argb_scalar(pixels, total_pixels);
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef CORE_COLOR_CONVERT_H
+#define CORE_COLOR_CONVERT_H
+
+#include "graphics/color.h"
+
+#include <stdint.h>
+
+/**
+ * @file
+ * Pixel conversion loops used while loading images.
+ *
+ * Each function has a plain C version and, when the compiler targets SSE2 or NEON, a vectorized version
+ * that gives exactly the same result. Defining COLOR_CONVERT_NO_SIMD always uses the plain C versions.
+ */
+
+/**
+ * Converts little endian 16 bit sg2 pixels to 32 bit colors
+ * @param src The sg2 pixels
+ * @param dst Where to write the colors
+ * @param total_pixels The number of pixels to convert
+ * @param use_transparent_color Whether pixels with the sg2 transparent color become fully transparent
+ */
+void color_convert_sg2_pixels(const uint8_t *src, color_t *dst, int total_pixels, int use_transparent_color);
+
+/**
+ * Turns every pixel that is not fully transparent white, keeping its alpha
+ * @param pixels The pixels to change
+ * @param total_pixels The number of pixels
+ */
+void color_convert_to_white(color_t *pixels, int total_pixels);
+
+/**
+ * Turns the pixels gray, keeping their alpha
+ * @param pixels The pixels to change
+ * @param total_pixels The number of pixels
+ */
+void color_convert_to_grayscale(color_t *pixels, int total_pixels);
+
+/**
+ * Converts pixels stored as R, G, B, A bytes to colors
+ * @param pixels The pixels to change
+ * @param total_pixels The number of pixels
+ */
+void color_convert_rgba_to_argb(color_t *pixels, int total_pixels);
+
+#endif // CORE_COLOR_CONVERT_H
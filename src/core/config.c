@@ -146,7 +146,13 @@ static const char *ini_keys[] = {
     [CONFIG_UI_AUTO_DELETE_OLD_COMMON_MESSAGES] = "ui_auto_delete_old_common_messages",
     [CONFIG_UI_SCROLL_CAMERA_UNLOCKED] = "ui_scroll_camera_unlocked",
     [CONFIG_UI_SCROLL_CAMERA_UNLOCKED] = "ui_scroll_camera_unlocked",
-    [CONFIG_UI_SCROLL_LEGACY_SCROLLBAR] = "ui_scroll_old_scroll", // keep comma after last entry please
+    [CONFIG_UI_SCROLL_LEGACY_SCROLLBAR] = "ui_scroll_old_scroll",
+    [CONFIG_GENERAL_SAVE_COMPRESSION] = "general_save_compression",
+    [CONFIG_GENERAL_AUTOSAVE_HISTORY] = "general_autosave_history",
+    [CONFIG_GENERAL_AUTOSAVE_COMPACTION] = "general_autosave_compaction",
+    [CONFIG_GENERAL_SNAPSHOT_MEMORY] = "general_snapshot_memory_mb",
+    [CONFIG_SCREEN_LAZY_MAIN_IMAGES] = "screen_lazy_main_images",
+    [CONFIG_SCREEN_CACHE_TERRAIN] = "screen_cache_terrain", // keep comma after last entry please
 };
 
 static const char *ini_string_keys[] = {
@@ -225,7 +231,13 @@ static int default_values[CONFIG_MAX_ENTRIES] = {
     [CONFIG_UI_CLIMATE_GRID_COLORS] = 1,
     [CONFIG_UI_SCROLL_CAMERA_UNLOCKED] = 1,
     [CONFIG_UI_SCROLL_CAMERA_UNLOCKED] = 1,
-    [CONFIG_UI_SCROLL_LEGACY_SCROLLBAR] = 0, //keep the comma after last entry please
+    [CONFIG_UI_SCROLL_LEGACY_SCROLLBAR] = 0,
+    [CONFIG_GENERAL_SAVE_COMPRESSION] = 0,
+    [CONFIG_GENERAL_AUTOSAVE_HISTORY] = 0,
+    [CONFIG_GENERAL_AUTOSAVE_COMPACTION] = 12,
+    [CONFIG_GENERAL_SNAPSHOT_MEMORY] = 0,
+    [CONFIG_SCREEN_LAZY_MAIN_IMAGES] = 0,
+    [CONFIG_SCREEN_CACHE_TERRAIN] = 0, //keep the comma after last entry please
 };
 
 static const char default_string_values[CONFIG_STRING_MAX_ENTRIES][CONFIG_STRING_VALUE_MAX] = { 0 };
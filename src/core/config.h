@@ -136,6 +136,12 @@ typedef enum {
     CONFIG_UI_AUTO_DELETE_OLD_COMMON_MESSAGES,
     CONFIG_UI_SCROLL_CAMERA_UNLOCKED,
     CONFIG_UI_SCROLL_LEGACY_SCROLLBAR,
+    CONFIG_GENERAL_SAVE_COMPRESSION,
+    CONFIG_GENERAL_AUTOSAVE_HISTORY,
+    CONFIG_GENERAL_AUTOSAVE_COMPACTION,
+    CONFIG_GENERAL_SNAPSHOT_MEMORY,
+    CONFIG_SCREEN_LAZY_MAIN_IMAGES,
+    CONFIG_SCREEN_CACHE_TERRAIN,
     CONFIG_MAX_ENTRIES
 } config_key;
 
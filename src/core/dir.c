@@ -37,6 +37,7 @@ static void clear_dir_listing(void)
         for (int i = 0; i < data.max_files; i++) {
             data.listing.files[i].name[0] = 0;
             data.listing.files[i].modified_time = 0;
+            data.listing.files[i].size = 0;
         }
     }
 }
@@ -58,13 +59,14 @@ static int compare_lower(const void *va, const void *vb)
     return platform_file_manager_compare_filename(a->name, b->name);
 }
 
-static int add_to_listing(const char *filename, long modified_time)
+static int add_to_listing(const char *filename, long modified_time, long size)
 {
     if (data.listing.num_files >= data.max_files) {
         expand_dir_listing();
     }
     snprintf(data.listing.files[data.listing.num_files].name, FILE_NAME_MAX, "%s", filename);
     data.listing.files[data.listing.num_files].modified_time = modified_time;
+    data.listing.files[data.listing.num_files].size = size;
     ++data.listing.num_files;
     return LIST_CONTINUE;
 }
@@ -97,7 +99,7 @@ const dir_listing *dir_find_all_subdirectories_at_location(int location)
     return dir_find_all_subdirectories(platform_file_manager_get_directory_for_location(location, 0));
 }
 
-static int compare_case(const char *filename, long unused)
+static int compare_case(const char *filename, long unused, long unused_size)
 {
     if (platform_file_manager_compare_filename(filename, data.cased_filename) == 0) {
         // We are copying anyway because the comparison is case insensitive, so we can't use the original filename
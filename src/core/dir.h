@@ -40,13 +40,14 @@ enum {
 typedef struct {
     char *name; /**< Filenames in UTF-8 encoding */
     unsigned int modified_time; /**< Timestamp */
+    long size; /**< File size in bytes, or 0 when unknown */
 } dir_entry;
 
 /**
  * Directory listing
  */
 typedef struct {
-    dir_entry *files; /**< Filenames and last modified time */
+    dir_entry *files; /**< Filenames, last modified time and size */
     int num_files; /**< Number of files in the list */
 } dir_listing;
 
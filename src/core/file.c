@@ -28,6 +28,49 @@ int file_close(FILE *stream)
     return platform_file_manager_close_file(stream);
 }
 
+int file_map(FILE *stream, file_mapping *mapping)
+{
+    mapping->handle = 0;
+    mapping->data = platform_file_manager_map_file(stream, &mapping->size, &mapping->handle);
+    if (mapping->data) {
+        return 1;
+    }
+    mapping->handle = 0;
+    mapping->size = 0;
+    long start = ftell(stream);
+    if (start < 0 || fseek(stream, 0, SEEK_END)) {
+        return 0;
+    }
+    long end = ftell(stream);
+    if (end < start || fseek(stream, start, SEEK_SET)) {
+        return 0;
+    }
+    size_t size = (size_t) (end - start);
+    mapping->data = malloc(size ? size : 1);
+    if (!mapping->data) {
+        return 0;
+    }
+    if (fread(mapping->data, 1, size, stream) != size) {
+        free(mapping->data);
+        mapping->data = 0;
+        return 0;
+    }
+    mapping->size = size;
+    return 1;
+}
+
+void file_unmap(file_mapping *mapping)
+{
+    if (mapping->handle) {
+        platform_file_manager_unmap_file(mapping->handle);
+    } else {
+        free(mapping->data);
+    }
+    mapping->data = 0;
+    mapping->size = 0;
+    mapping->handle = 0;
+}
+
 int file_has_extension(const char *filename, const char *extension)
 {
     if (!extension || !*extension) {
@@ -92,3 +135,8 @@ int file_remove(const char *filename)
 {
     return platform_file_manager_remove_file(filename);
 }
+
+int file_rename(const char *old_filename, const char *new_filename)
+{
+    return platform_file_manager_rename_file(old_filename, new_filename);
+}
@@ -18,6 +18,12 @@
 
 #define FILE_NAME_MAX 300
 
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    void *handle;
+} file_mapping;
+
 /**
  * Wrapper for fopen converting filename to path in current working directory
  * @param filename Filename
@@ -34,6 +40,22 @@ FILE *file_open(const char *filename, const char *mode);
  */
 FILE *file_open_asset(const char *asset, const char *mode);
 
+/**
+ * Maps the contents of a file into memory, from the current position of the stream until the end of the file.
+ * If the platform doesn't support memory-mapped files, the contents are read into memory instead.
+ * The data can be changed, but the changes are never written back to the file.
+ * @param stream The file to map. It can be closed while the mapping is in use
+ * @param mapping The mapping to fill in, which must be released with file_unmap
+ * @return boolean true on success, false otherwise
+ */
+int file_map(FILE *stream, file_mapping *mapping);
+
+/**
+ * Releases the memory of a file mapping
+ * @param mapping The mapping to release
+ */
+void file_unmap(file_mapping *mapping);
+
 /**
  * Wrapper to fclose
  * @return See fclose (If the stream is successfully closed, a zero value is returned.
@@ -93,4 +115,12 @@ int file_exists(const char *filename, int localizable);
  */
 int file_remove(const char *filename);
 
+/**
+ * Rename a file, replacing the file that has the new name if there is one
+ * @param old_filename Filename to rename
+ * @param new_filename New filename
+ * @return boolean true if the file was renamed, false otherwise
+ */
+int file_rename(const char *old_filename, const char *new_filename);
+
 #endif // CORE_FILE_H
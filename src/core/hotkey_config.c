@@ -145,7 +145,8 @@ static const char *ini_keys[] = {
     "editor_empire_tool_land_point",
     "editor_empire_tool_sea_point",
     "editor_empire_tool_selection",
-    "editor_empire_pick_tool"
+    "editor_empire_pick_tool",
+    "rewind_to_snapshot"
 };
 
 static struct {
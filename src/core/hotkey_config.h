@@ -131,6 +131,7 @@ typedef enum {
     HOTKEY_EDITOR_EMPIRE_TOOL_SEA_POINT,
     HOTKEY_EDITOR_EMPIRE_TOOL_SELECTION,
     HOTKEY_EDITOR_EMPIRE_PICK_TOOL,
+    HOTKEY_REWIND_TO_SNAPSHOT,
     HOTKEY_MAX_ITEMS
 } hotkey_action;
 
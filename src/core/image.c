@@ -4,10 +4,15 @@
 #include "building/building.h"
 #include "building/image.h"
 #include "core/buffer.h"
+#include "core/color_convert.h"
+#include "core/config.h"
 #include "core/file.h"
+#include "core/image_cache.h"
 #include "core/image_packer.h"
 #include "core/io.h"
 #include "core/log.h"
+#include "core/thread_pool.h"
+#include "core/trace.h"
 #include "graphics/font.h"
 #include "graphics/renderer.h"
 #include "map/building_tiles.h"
@@ -35,6 +40,11 @@
 
 #define JAPANESE_HALF_WIDTH_CHARS 63
 
+// Glyphs of each multibyte font style kept in the font atlas when they are loaded on demand,
+// the atlas grows by as many glyphs when a frame draws more of them
+#define GLYPH_CACHE_SLOTS 512
+#define GLYPH_CACHE_COLUMNS 32
+
 #define MAIN_DATA_SIZE 12100000
 #define ENEMY_DATA_SIZE 2400000
 #define EXTERNAL_FONT_DATA_SIZE 1500000
@@ -50,6 +60,12 @@
 
 #define IMAGE_TYPE_ISOMETRIC 30
 
+#define ALL_ATLAS_IMAGES -1
+
+#define MAIN_CACHE_MAGIC "AUGIMAGE"
+#define MAIN_CACHE_FORMAT_VERSION 1
+#define DRAW_DATA_RECORD_SIZE (7 * sizeof(int32_t))
+
 enum {
     NO_EXTRA_FONT = 0,
     FULL_CHARSET_IN_FONT = 1,
@@ -67,12 +83,36 @@ typedef struct {
     void *buffer;
 } image_draw_data;
 
+typedef enum {
+    ATLAS_IMAGE_PENDING = 0,
+    ATLAS_IMAGE_DECODED = 1,
+    ATLAS_IMAGE_LOADED = 2
+} atlas_image_state;
+
+typedef struct {
+    int index;
+    atlas_image_state state;
+    thread_pool_job *job;
+} lazy_atlas_image;
+
 typedef struct {
     int width;
     int height;
     int half_width;
 } multibyte_font_sizes;
 
+typedef void (*multibyte_glyph_parser)(buffer *input, color_t *pixels, int row_width,
+    const multibyte_font_sizes *font_size, int width, int letter_spacing, image *img);
+
+typedef struct {
+    int glyph;
+    int x;
+    int y;
+    int previous;
+    int next;
+    int frame;
+} glyph_cache_slot;
+
 typedef struct {
     const char *name;
     const char *file_v1;
@@ -226,6 +266,14 @@ static multibyte_font_data multibyte_font_info[MULTIBYTE_FONT_MAX] = {
 
 static const image DUMMY_IMAGE = { 0 };
 
+// Groups that are drawn almost everywhere, so their atlas images are decoded first when loading lazily
+static const int COMMON_GROUPS[] = {
+    GROUP_FONT, GROUP_PANEL_WINDOWS, GROUP_PANEL_BUTTON, GROUP_BORDERED_BUTTON, GROUP_OK_CANCEL_SCROLL_BUTTONS,
+    GROUP_SUNKEN_TEXTBOX_BACKGROUND, GROUP_DIALOG_BACKGROUND, GROUP_TOP_MENU, GROUP_SIDE_PANEL,
+    GROUP_SIDEBAR_BUTTONS, GROUP_MESSAGE_ICON, GROUP_TERRAIN_GRASS_1, GROUP_TERRAIN_TREE, GROUP_TERRAIN_WATER,
+    GROUP_TERRAIN_ROAD, GROUP_TERRAIN_FLAT_TILE
+};
+
 static struct {
     int current_climate;
     int current_enemy;
@@ -248,6 +296,37 @@ static struct {
     image_packer packer;
     int max_image_width;
     int max_image_height;
+
+    struct {
+        int active;
+        int textures_created;
+        int images_left;
+        uint8_t *file_data;
+        int file_size;
+        image_draw_data *draw_data;
+        const image_atlas_data *atlas_data;
+        lazy_atlas_image *images;
+    } lazy;
+
+    struct {
+        int active;
+        uint8_t *file_data;
+        int file_size;
+        int num_chars;
+        int letter_spacing;
+        const multibyte_font_sizes *font_sizes;
+        multibyte_glyph_parser parse_glyph;
+        int *file_offsets;
+        int *glyph_slots;
+        glyph_cache_slot *slots;
+        int total_slots;
+        int frame;
+        struct {
+            int most_recent;
+            int least_recent;
+        } styles[FONT_STYLES];
+        const image_atlas_data *atlas_data;
+    } glyphs;
 } data;
 
 static void read_header(buffer *buf)
@@ -427,23 +506,23 @@ static int crop_and_pack_images(buffer *buf, image *images, image_draw_data *dra
     return 1;
 }
 
-static color_t to_32_bit(uint16_t c)
+static void read_pixels(buffer *buf, color_t *dst, int total_pixels, int use_transparent_color)
 {
-    return ALPHA_OPAQUE |
-        ((c & 0x7c00) << 9) | ((c & 0x7000) << 4) |
-        ((c & 0x3e0) << 6) | ((c & 0x380) << 1) |
-        ((c & 0x1f) << 3) | ((c & 0x1c) >> 2);
+    int available = buf->index < buf->size ? (int) ((buf->size - buf->index) / sizeof(uint16_t)) : 0;
+    int converted = total_pixels < available ? total_pixels : available;
+    color_convert_sg2_pixels(&buf->data[buf->index], dst, converted, use_transparent_color);
+    buffer_skip(buf, converted * sizeof(uint16_t));
+    // Pixels past the end of a truncated file are black, the same as an sg2 pixel read as zero
+    for (int i = converted; i < total_pixels; i++) {
+        dst[i] = ALPHA_OPAQUE;
+    }
 }
 
 static void convert_uncompressed(buffer *buf, int width, int height, int x_offset, int y_offset,
     color_t *dst, int dst_width)
 {
     for (int y = 0; y < height; y++) {
-        color_t *pixel = &dst[(y_offset + y) * dst_width + x_offset];
-        for (int x = 0; x < width; x++) {
-            color_t color = to_32_bit(buffer_read_u16(buf));
-            pixel[x] = color == COLOR_SG2_TRANSPARENT ? ALPHA_TRANSPARENT : color;
-        }
+        read_pixels(buf, &dst[(y_offset + y) * dst_width + x_offset], width, 1);
     }
 }
 
@@ -478,9 +557,12 @@ static void convert_compressed(buffer *buf, int width, int height, int x_offset,
             buf_length -= 2;
         } else {
             // control = number of concrete pixels
-            for (int i = 0; i < control; i++) {
-                dst[(y + y_offset) * dst_width + x_offset + x] = to_32_bit(buffer_read_u16(buf));
-                x++;
+            buf_length -= control * 2 + 1;
+            while (control > 0) {
+                int pixels = width - x < control ? width - x : control;
+                read_pixels(buf, &dst[(y + y_offset) * dst_width + x_offset + x], pixels, 0);
+                control -= pixels;
+                x += pixels;
                 if (x >= width) {
                     y++;
                     if (y >= height) {
@@ -489,7 +571,6 @@ static void convert_compressed(buffer *buf, int width, int height, int x_offset,
                     x -= width;
                 }
             }
-            buf_length -= control * 2 + 1;
         }
     }
 }
@@ -500,10 +581,8 @@ static void convert_footprint_tile(buffer *buf, const image *img,
     for (int y = 0; y < FOOTPRINT_HEIGHT; y++) {
         int x_start = FOOTPRINT_X_START_PER_HEIGHT[y];
         int x_max = FOOTPRINT_WIDTH - x_start;
-        for (int x = x_start; x < x_max; x++) {
-            dst[(y + y_offset + img->atlas.y_offset) * dst_width + img->atlas.x_offset + x + x_offset] =
-                to_32_bit(buffer_read_u16(buf));
-        }
+        color_t *row = &dst[(y + y_offset + img->atlas.y_offset) * dst_width + img->atlas.x_offset + x_offset];
+        read_pixels(buf, &row[x_start], x_max - x_start, 0);
     }
 }
 
@@ -530,22 +609,21 @@ static void convert_isometric_footprint(buffer *buf, const image *img, color_t *
     }
 }
 
-static void convert_images(image *images, image_draw_data *draw_datas, int size, buffer *buf,
-    const image_atlas_data *atlas_data)
+static void convert_image(image *img, int index, image_draw_data *draw_data, buffer *buf,
+    const image_atlas_data *atlas_data, int atlas_index)
 {
-    for (int i = 0; i < size; i++) {
-        image *img = &images[i];
-        image_draw_data *draw_data = &draw_datas[i];
-        if (image_is_external(img)) {
-            continue;
-        }
-        // Don't load original placeholder images
-        if (atlas_data->type == ATLAS_MAIN && i >= 6145 && i <= 6192) {
-            continue;
-        }
+    if (image_is_external(img)) {
+        return;
+    }
+    // Don't load original placeholder images
+    if (atlas_data->type == ATLAS_MAIN && index >= 6145 && index <= 6192) {
+        return;
+    }
+    int img_atlas_index = img->atlas.id & IMAGE_ATLAS_BIT_MASK;
+    if (atlas_index == ALL_ATLAS_IMAGES || img_atlas_index == atlas_index) {
         buffer_set(buf, draw_data->offset);
-        color_t *dst = atlas_data->buffers[img->atlas.id & IMAGE_ATLAS_BIT_MASK];
-        int dst_width = atlas_data->image_widths[img->atlas.id & IMAGE_ATLAS_BIT_MASK];
+        color_t *dst = atlas_data->buffers[img_atlas_index];
+        int dst_width = atlas_data->image_widths[img_atlas_index];
         if (draw_data->is_compressed) {
             if (draw_data->buffer) {
                 copy_compressed(img, draw_data, dst, dst_width);
@@ -557,51 +635,63 @@ static void convert_images(image *images, image_draw_data *draw_datas, int size,
             }
         } else if (img->is_isometric) {
             convert_isometric_footprint(buf, img, dst, dst_width);
-            if (img->top) {
-                color_t *dst_top = atlas_data->buffers[img->top->atlas.id & IMAGE_ATLAS_BIT_MASK];
-                int dst_width_top = atlas_data->image_widths[img->top->atlas.id & IMAGE_ATLAS_BIT_MASK];
-                copy_compressed(img->top, draw_data, dst_top, dst_width_top);
-            }
         } else {
-            convert_uncompressed(buf, img->width, img->height, img->atlas.x_offset, img->atlas.y_offset,
+            // Uncompressed images are never cropped, but fix_animation_offsets may change the width before
+            // a lazily loaded image is converted
+            convert_uncompressed(buf, img->original.width, img->height, img->atlas.x_offset, img->atlas.y_offset,
                 dst, dst_width);
         }
     }
+    if (!draw_data->is_compressed && img->is_isometric && img->top) {
+        int top_atlas_index = img->top->atlas.id & IMAGE_ATLAS_BIT_MASK;
+        if (atlas_index == ALL_ATLAS_IMAGES || top_atlas_index == atlas_index) {
+            copy_compressed(img->top, draw_data, atlas_data->buffers[top_atlas_index],
+                atlas_data->image_widths[top_atlas_index]);
+        }
+    }
+}
+
+static void convert_images(image *images, image_draw_data *draw_datas, int size, buffer *buf,
+    const image_atlas_data *atlas_data)
+{
+    for (int i = 0; i < size; i++) {
+        convert_image(&images[i], i, &draw_datas[i], buf, atlas_data, ALL_ATLAS_IMAGES);
+    }
 }
 
-static void make_font_white(const image *img, const image_atlas_data *atlas_data)
+static void make_font_white(const image *img, const image_atlas_data *atlas_data, int atlas_index)
 {
+    if (atlas_index != ALL_ATLAS_IMAGES && (img->atlas.id & IMAGE_ATLAS_BIT_MASK) != atlas_index) {
+        return;
+    }
     color_t *pixels = atlas_data->buffers[img->atlas.id & IMAGE_ATLAS_BIT_MASK];
     int width = atlas_data->image_widths[img->atlas.id & IMAGE_ATLAS_BIT_MASK];
     pixels += img->atlas.y_offset * width + img->atlas.x_offset;
     for (int y = 0; y < img->height; y++) {
-        for (int x = 0; x < img->width; x++) {
-            if ((pixels[x] & COLOR_CHANNEL_ALPHA) != ALPHA_TRANSPARENT) {
-                pixels[x] |= 0x00ffffff;
-            }
-        }
+        color_convert_to_white(pixels, img->width);
         pixels += width;
     }
 }
 
-static void make_plain_fonts_white(const image *img_info, const image_atlas_data *atlas_data, int start_offset)
+static void make_plain_fonts_white(const image *img_info, const image_atlas_data *atlas_data, int start_offset,
+    int atlas_index)
 {
     int limit = font_definition_for(FONT_NORMAL_BLACK)->image_offset -
         font_definition_for(FONT_NORMAL_PLAIN)->image_offset;
     for (int i = 0; i < limit; i++) {
-        make_font_white(&img_info[i + start_offset], atlas_data);
+        make_font_white(&img_info[i + start_offset], atlas_data, atlas_index);
     }
     int start_font_offset = start_offset + font_definition_for(FONT_LARGE_PLAIN)->image_offset;
     limit = font_definition_for(FONT_LARGE_BLACK)->image_offset -
         font_definition_for(FONT_LARGE_PLAIN)->image_offset;
     for (int i = 0; i < limit; i++) {
-        make_font_white(&img_info[i + start_font_offset], atlas_data);
+        make_font_white(&img_info[i + start_font_offset], atlas_data, atlas_index);
     }
     start_font_offset = start_offset + font_definition_for(FONT_SMALL_PLAIN)->image_offset;
     limit = font_definition_for(FONT_NORMAL_GREEN)->image_offset -
         font_definition_for(FONT_SMALL_PLAIN)->image_offset;
     for (int i = 0; i < limit; i++) {
-        make_font_white(&img_info[i + start_font_offset], atlas_data);
+        make_font_white(&img_info[i + start_font_offset], atlas_data, atlas_index);
     }
 }
 
@@ -676,14 +766,154 @@ static void fix_animation_offsets(void)
     data.main[image_group(GROUP_BUILDING_ENGINEERS_POST)].animation->sprite_offset_y += 1;
 }
 
-int image_load_climate(int climate_id, int is_editor, int force_reload, int keep_atlas_buffers)
+static void release_lazy_loading(void)
 {
-    if (climate_id == data.current_climate && is_editor == data.is_editor && !force_reload &&
-        graphics_renderer()->has_image_atlas(ATLAS_MAIN)) {
-        return 1;
+    if (!data.lazy.active) {
+        return;
     }
-    graphics_renderer()->get_max_image_size(&data.max_image_width, &data.max_image_height);
+    for (int i = 0; i < data.lazy.atlas_data->num_images; i++) {
+        thread_pool_finish_job(data.lazy.images[i].job);
+    }
+    free(data.lazy.images);
+    free_draw_data(data.lazy.draw_data, IMAGE_MAIN_ENTRIES);
+    free(data.lazy.file_data);
+    memset(&data.lazy, 0, sizeof(data.lazy));
+}
 
+static void decode_lazy_atlas_image(void *item)
+{
+    const lazy_atlas_image *atlas_image = item;
+    buffer buf;
+    buffer_init(&buf, data.lazy.file_data, data.lazy.file_size);
+    for (int i = 0; i < IMAGE_MAIN_ENTRIES; i++) {
+        convert_image(&data.main[i], i, &data.lazy.draw_data[i], &buf, data.lazy.atlas_data, atlas_image->index);
+    }
+    make_plain_fonts_white(data.main, data.lazy.atlas_data, image_group(GROUP_FONT), atlas_image->index);
+}
+
+static void load_lazy_atlas_image(lazy_atlas_image *atlas_image)
+{
+    if (atlas_image->state == ATLAS_IMAGE_PENDING) {
+        if (atlas_image->job) {
+            thread_pool_finish_job(atlas_image->job);
+            atlas_image->job = 0;
+        } else {
+            decode_lazy_atlas_image(atlas_image);
+        }
+        atlas_image->state = ATLAS_IMAGE_DECODED;
+    }
+    if (!data.lazy.textures_created ||
+        !graphics_renderer()->update_image_atlas(data.lazy.atlas_data, atlas_image->index, 1)) {
+        return;
+    }
+    atlas_image->state = ATLAS_IMAGE_LOADED;
+    data.lazy.images_left--;
+    if (!data.lazy.images_left) {
+        release_lazy_loading();
+    }
+}
+
+static int start_lazy_loading(uint8_t *file_data, int file_size, image_draw_data *draw_data,
+    const image_atlas_data *atlas_data)
+{
+    data.lazy.images = malloc(sizeof(lazy_atlas_image) * atlas_data->num_images);
+    if (!data.lazy.images) {
+        return 0;
+    }
+    memset(data.lazy.images, 0, sizeof(lazy_atlas_image) * atlas_data->num_images);
+    for (int i = 0; i < atlas_data->num_images; i++) {
+        data.lazy.images[i].index = i;
+    }
+    data.lazy.active = 1;
+    data.lazy.textures_created = 0;
+    data.lazy.images_left = atlas_data->num_images;
+    data.lazy.file_data = file_data;
+    data.lazy.file_size = file_size;
+    data.lazy.draw_data = draw_data;
+    data.lazy.atlas_data = atlas_data;
+    return 1;
+}
+
+static void create_lazy_atlas(void)
+{
+    const image_atlas_data *atlas_data = data.lazy.atlas_data;
+    if (graphics_renderer()->create_empty_image_atlas(atlas_data)) {
+        data.lazy.textures_created = 1;
+        // Images already decoded for the extra assets can be uploaded right away
+        for (int i = 0; data.lazy.active && i < atlas_data->num_images; i++) {
+            if (data.lazy.images[i].state == ATLAS_IMAGE_DECODED) {
+                load_lazy_atlas_image(&data.lazy.images[i]);
+            }
+        }
+        return;
+    }
+    log_error("Unable to load the main images lazily, loading them all now", 0, 0);
+    for (int i = 0; i < atlas_data->num_images; i++) {
+        if (data.lazy.images[i].state == ATLAS_IMAGE_PENDING) {
+            decode_lazy_atlas_image(&data.lazy.images[i]);
+        }
+    }
+    graphics_renderer()->create_image_atlas(atlas_data, 1);
+    release_lazy_loading();
+}
+
+static void prefetch_lazy_atlas_image(int atlas_id)
+{
+    if ((atlas_id >> IMAGE_ATLAS_BIT_OFFSET) != ATLAS_MAIN) {
+        return;
+    }
+    lazy_atlas_image *atlas_image = &data.lazy.images[atlas_id & IMAGE_ATLAS_BIT_MASK];
+    if (atlas_image->state == ATLAS_IMAGE_PENDING && !atlas_image->job) {
+        atlas_image->job = thread_pool_start_job(decode_lazy_atlas_image, atlas_image);
+    }
+}
+
+static void start_lazy_prefetching(void)
+{
+    if (!data.lazy.active || !thread_pool_total_workers()) {
+        return;
+    }
+    for (int i = 0; i < sizeof(COMMON_GROUPS) / sizeof(COMMON_GROUPS[0]); i++) {
+        const image *img = &data.main[image_group(COMMON_GROUPS[i])];
+        prefetch_lazy_atlas_image(img->atlas.id);
+        if (img->top) {
+            prefetch_lazy_atlas_image(img->top->atlas.id);
+        }
+    }
+    for (int i = 0; i < data.lazy.atlas_data->num_images; i++) {
+        prefetch_lazy_atlas_image((ATLAS_MAIN << IMAGE_ATLAS_BIT_OFFSET) + i);
+    }
+}
+
+void image_start_frame(void)
+{
+    data.glyphs.frame++;
+}
+
+void image_update_lazy_loading(void)
+{
+    if (!data.lazy.active || !data.lazy.textures_created) {
+        return;
+    }
+    for (int i = 0; i < data.lazy.atlas_data->num_images; i++) {
+        lazy_atlas_image *atlas_image = &data.lazy.images[i];
+        if (atlas_image->state == ATLAS_IMAGE_LOADED || (atlas_image->state == ATLAS_IMAGE_PENDING &&
+            (!atlas_image->job || !thread_pool_job_is_done(atlas_image->job)))) {
+            continue;
+        }
+        // Only upload one atlas image per frame, to prevent stutters
+        load_lazy_atlas_image(atlas_image);
+        return;
+    }
+}
+
+void image_stop_lazy_loading(void)
+{
+    release_lazy_loading();
+}
+
+static void clear_main_images(void)
+{
     for (int i = 0; i < IMAGE_MAIN_ENTRIES; i++) {
         free(data.main[i].top);
         free(data.main[i].animation);
@@ -695,9 +925,158 @@ int image_load_climate(int climate_id, int is_editor, int force_reload, int keep
     data.external_draw_data = 0;
     data.total_external_images = 0;
     data.images_with_tops = 0;
+}
 
-    const char *filename_bmp = is_editor ? EDITOR_GRAPHICS_555[climate_id] : MAIN_GRAPHICS_555[climate_id];
-    const char *filename_idx = is_editor ? EDITOR_GRAPHICS_SG2[climate_id] : MAIN_GRAPHICS_SG2[climate_id];
+static const char *get_main_cache_file_name(int climate_id, int is_editor)
+{
+    static char filename[FILE_NAME_MAX];
+    snprintf(filename, FILE_NAME_MAX, "main_images_%s%d.cache", is_editor ? "editor_" : "", climate_id);
+    return filename;
+}
+
+static uint64_t get_main_cache_key(int climate_id, int is_editor, const char *filename_idx, const char *filename_bmp)
+{
+    uint64_t hash = IMAGE_CACHE_HASH_START;
+    hash = image_cache_hash_int(hash, climate_id);
+    hash = image_cache_hash_int(hash, is_editor);
+    hash = image_cache_hash_int(hash, data.max_image_width);
+    hash = image_cache_hash_int(hash, data.max_image_height);
+    if (!image_cache_hash_file(&hash, filename_idx, MAY_BE_LOCALIZED) ||
+        !image_cache_hash_file(&hash, filename_bmp, MAY_BE_LOCALIZED)) {
+        return 0;
+    }
+    // A key of 0 means there is no cache
+    return hash ? hash : 1;
+}
+
+static size_t get_main_cache_metadata_size(void)
+{
+    size_t size = sizeof(data.group_image_ids) + sizeof(data.bitmaps);
+    for (int i = 0; i < IMAGE_MAIN_ENTRIES; i++) {
+        const image *img = &data.main[i];
+        size += IMAGE_CACHE_IMAGE_RECORD_SIZE + 2 * sizeof(uint8_t);
+        size += img->top ? IMAGE_CACHE_IMAGE_RECORD_SIZE : 0;
+        size += img->animation ? IMAGE_CACHE_ANIMATION_RECORD_SIZE : 0;
+    }
+    return size + sizeof(int32_t) + data.total_external_images * DRAW_DATA_RECORD_SIZE;
+}
+
+static void save_main_images_to_cache(uint64_t key, int climate_id, int is_editor,
+    const image_atlas_data *atlas_data)
+{
+    if (!key) {
+        return;
+    }
+    size_t size = get_main_cache_metadata_size();
+    uint8_t *metadata = malloc(size);
+    if (!metadata) {
+        log_error("Unable to allocate memory for the main images cache", 0, 0);
+        return;
+    }
+    buffer buf;
+    buffer_init(&buf, metadata, size);
+    buffer_write_u16_array(&buf, data.group_image_ids, IMAGE_MAX_GROUPS);
+    buffer_write_raw(&buf, data.bitmaps, sizeof(data.bitmaps));
+    for (int i = 0; i < IMAGE_MAIN_ENTRIES; i++) {
+        const image *img = &data.main[i];
+        image_cache_write_image(&buf, img);
+        buffer_write_u8(&buf, img->top != 0);
+        if (img->top) {
+            image_cache_write_image(&buf, img->top);
+        }
+        buffer_write_u8(&buf, img->animation != 0);
+        if (img->animation) {
+            image_cache_write_animation(&buf, img->animation);
+        }
+    }
+    buffer_write_i32(&buf, data.total_external_images);
+    for (int i = 0; i < data.total_external_images; i++) {
+        const image_draw_data *draw_data = &data.external_draw_data[i];
+        buffer_write_i32(&buf, draw_data->offset);
+        buffer_write_i32(&buf, draw_data->is_compressed);
+        buffer_write_i32(&buf, draw_data->data_length);
+        buffer_write_i32(&buf, draw_data->uncompressed_length);
+        buffer_write_i32(&buf, draw_data->bitmap_id);
+        buffer_write_i32(&buf, draw_data->width);
+        buffer_write_i32(&buf, draw_data->height);
+    }
+    image_cache_write(get_main_cache_file_name(climate_id, is_editor), MAIN_CACHE_MAGIC, MAIN_CACHE_FORMAT_VERSION,
+        key, metadata, size, atlas_data);
+    free(metadata);
+}
+
+static int read_main_images_from_cache(buffer *buf)
+{
+    buffer_read_u16_array(buf, data.group_image_ids, IMAGE_MAX_GROUPS);
+    buffer_read_raw(buf, data.bitmaps, sizeof(data.bitmaps));
+    for (int i = 0; i < IMAGE_MAIN_ENTRIES; i++) {
+        image *img = &data.main[i];
+        image_cache_read_image(buf, img);
+        if (buffer_read_u8(buf)) {
+            img->top = malloc(sizeof(image));
+            if (!img->top) {
+                return 0;
+            }
+            memset(img->top, 0, sizeof(image));
+            image_cache_read_image(buf, img->top);
+        }
+        if (buffer_read_u8(buf)) {
+            img->animation = malloc(sizeof(image_animation));
+            if (!img->animation) {
+                return 0;
+            }
+            image_cache_read_animation(buf, img->animation);
+        }
+    }
+    int total_external_images = buffer_read_i32(buf);
+    if (buf->overflow || total_external_images < 0 || total_external_images > IMAGE_MAIN_ENTRIES) {
+        return 0;
+    }
+    data.external_draw_data = malloc((total_external_images ? total_external_images : 1) * sizeof(image_draw_data));
+    if (!data.external_draw_data) {
+        return 0;
+    }
+    memset(data.external_draw_data, 0, total_external_images * sizeof(image_draw_data));
+    data.total_external_images = total_external_images;
+    for (int i = 0; i < total_external_images; i++) {
+        image_draw_data *draw_data = &data.external_draw_data[i];
+        draw_data->offset = buffer_read_i32(buf);
+        draw_data->is_compressed = buffer_read_i32(buf);
+        draw_data->data_length = buffer_read_i32(buf);
+        draw_data->uncompressed_length = buffer_read_i32(buf);
+        draw_data->bitmap_id = buffer_read_i32(buf);
+        draw_data->width = buffer_read_i32(buf);
+        draw_data->height = buffer_read_i32(buf);
+    }
+    return !buf->overflow;
+}
+
+static const image_atlas_data *load_main_images_from_cache(uint64_t key, int climate_id, int is_editor)
+{
+    file_mapping file;
+    buffer buf;
+    if (!image_cache_open(get_main_cache_file_name(climate_id, is_editor), MAIN_CACHE_MAGIC,
+        MAIN_CACHE_FORMAT_VERSION, key, &file, &buf)) {
+        return 0;
+    }
+    const image_atlas_data *atlas_data = 0;
+    if (read_main_images_from_cache(&buf)) {
+        atlas_data = image_cache_read_atlas(&buf, file.data, ATLAS_MAIN);
+    }
+    file_unmap(&file);
+    if (atlas_data) {
+        log_info("Main images loaded from the cache", 0, 0);
+    } else {
+        log_info("The main images cache is broken and will be rebuilt", 0, 0);
+        clear_main_images();
+    }
+    return atlas_data;
+}
+
+static const image_atlas_data *convert_main_images(const char *filename_idx, const char *filename_bmp,
+    int keep_atlas_buffers, uint64_t cache_key, int climate_id, int is_editor)
+{
+    trace_begin("read");
     uint8_t *tmp_data = malloc(MAIN_DATA_SIZE * sizeof(uint8_t));
     image_draw_data *draw_data = malloc(IMAGE_MAIN_ENTRIES * sizeof(image_draw_data));
     if (!tmp_data || !draw_data ||
@@ -706,6 +1085,7 @@ int image_load_climate(int climate_id, int is_editor, int force_reload, int keep
         free(draw_data);
         return 0;
     }
+    trace_end("read");
     memset(data.main, 0, sizeof(data.main));
     memset(draw_data, 0, IMAGE_MAIN_ENTRIES * sizeof(image_draw_data));
 
@@ -713,13 +1093,17 @@ int image_load_climate(int climate_id, int is_editor, int force_reload, int keep
     buffer_init(&buf, tmp_data, HEADER_SIZE);
     read_header(&buf);
     buffer_init(&buf, &tmp_data[HEADER_SIZE], ENTRY_SIZE * IMAGE_MAIN_ENTRIES);
+    trace_begin("prepare");
     if (!prepare_images(&buf, data.main, draw_data, IMAGE_MAIN_ENTRIES, ATLAS_MAIN)) {
         free(tmp_data);
         free(draw_data);
         return 0;
     }
+    trace_end("prepare");
 
+    trace_begin("read");
     int data_size = io_read_file_into_buffer(filename_bmp, MAY_BE_LOCALIZED, tmp_data, MAIN_DATA_SIZE);
+    trace_end("read");
     if (!data_size) {
         free(tmp_data);
         free_draw_data(draw_data, IMAGE_MAIN_ENTRIES);
@@ -730,6 +1114,7 @@ int image_load_climate(int climate_id, int is_editor, int force_reload, int keep
     }
 
     buffer_init(&buf, tmp_data, data_size);
+    trace_begin("crop_and_pack");
     if (!crop_and_pack_images(&buf, data.main, draw_data, IMAGE_MAIN_ENTRIES, ATLAS_MAIN)) {
         free(tmp_data);
         free_draw_data(draw_data, IMAGE_MAIN_ENTRIES);
@@ -738,6 +1123,7 @@ int image_load_climate(int climate_id, int is_editor, int force_reload, int keep
         data.external_draw_data = 0;
         return 0;
     }
+    trace_end("crop_and_pack");
 
     const image_atlas_data *atlas_data = graphics_renderer()->prepare_image_atlas(ATLAS_MAIN,
         data.packer.result.images_needed, data.packer.result.last_image_width, data.packer.result.last_image_height);
@@ -751,14 +1137,60 @@ int image_load_climate(int climate_id, int is_editor, int force_reload, int keep
         return 0;
     }
 
-    convert_images(data.main, draw_data, IMAGE_MAIN_ENTRIES, &buf, atlas_data);
-    free_draw_data(draw_data, IMAGE_MAIN_ENTRIES);
-    free(tmp_data);
-    make_plain_fonts_white(data.main, atlas_data, image_group(GROUP_FONT));
+    // When loading lazily, the images are only converted to the atlas when they are first needed
+    int load_lazily = config_get(CONFIG_SCREEN_LAZY_MAIN_IMAGES) && !keep_atlas_buffers &&
+        graphics_renderer()->create_empty_image_atlas && graphics_renderer()->update_image_atlas;
+    if (!load_lazily || !start_lazy_loading(tmp_data, data_size, draw_data, atlas_data)) {
+        trace_begin("convert");
+        convert_images(data.main, draw_data, IMAGE_MAIN_ENTRIES, &buf, atlas_data);
+        free_draw_data(draw_data, IMAGE_MAIN_ENTRIES);
+        free(tmp_data);
+        make_plain_fonts_white(data.main, atlas_data, image_group(GROUP_FONT), ALL_ATLAS_IMAGES);
+        trace_end("convert");
+        trace_begin("save_cache");
+        save_main_images_to_cache(cache_key, climate_id, is_editor, atlas_data);
+        trace_end("save_cache");
+    }
+    return atlas_data;
+}
+
+int image_load_climate(int climate_id, int is_editor, int force_reload, int keep_atlas_buffers)
+{
+    if (climate_id == data.current_climate && is_editor == data.is_editor && !force_reload &&
+        graphics_renderer()->has_image_atlas(ATLAS_MAIN)) {
+        return 1;
+    }
+    graphics_renderer()->get_max_image_size(&data.max_image_width, &data.max_image_height);
+    release_lazy_loading();
+    clear_main_images();
+
+    const char *filename_bmp = is_editor ? EDITOR_GRAPHICS_555[climate_id] : MAIN_GRAPHICS_555[climate_id];
+    const char *filename_idx = is_editor ? EDITOR_GRAPHICS_SG2[climate_id] : MAIN_GRAPHICS_SG2[climate_id];
+
+    // Converting the images always gives the same result, so it is only done when the cache is missing or outdated
+    trace_begin("load_cache");
+    uint64_t cache_key = get_main_cache_key(climate_id, is_editor, filename_idx, filename_bmp);
+    const image_atlas_data *atlas_data = load_main_images_from_cache(cache_key, climate_id, is_editor);
+    trace_end("load_cache");
+    if (!atlas_data) {
+        atlas_data = convert_main_images(filename_idx, filename_bmp, keep_atlas_buffers,
+            cache_key, climate_id, is_editor);
+        if (!atlas_data) {
+            return 0;
+        }
+    }
     if (!keep_atlas_buffers) {
-        assets_init(data.is_editor != is_editor, atlas_data->buffers, atlas_data->image_widths);
+        trace_begin("assets_init");
+        assets_init(data.is_editor != is_editor, climate_id, is_editor, atlas_data->buffers, atlas_data->image_widths);
+        trace_end("assets_init");
+    }
+    trace_begin("upload");
+    if (data.lazy.active) {
+        create_lazy_atlas();
+    } else {
+        graphics_renderer()->create_image_atlas(atlas_data, !keep_atlas_buffers);
     }
-    graphics_renderer()->create_image_atlas(atlas_data, !keep_atlas_buffers);
+    trace_end("upload");
     image_packer_free(&data.packer);
 
     // Update native huts alternative images after climate change.
@@ -772,12 +1204,24 @@ int image_load_climate(int climate_id, int is_editor, int force_reload, int keep
     if (!is_editor) {
         fix_animation_offsets();
     }
+    // Only start decoding in the background now, as the fixes above change the images
+    start_lazy_prefetching();
 
     return 1;
 }
 
+static void release_glyph_cache(void)
+{
+    free(data.glyphs.file_data);
+    free(data.glyphs.file_offsets);
+    free(data.glyphs.glyph_slots);
+    free(data.glyphs.slots);
+    memset(&data.glyphs, 0, sizeof(data.glyphs));
+}
+
 static void free_font_memory(void)
 {
+    release_glyph_cache();
     graphics_renderer()->free_image_atlas(ATLAS_FONT);
     free(data.font);
     data.font = 0;
@@ -851,7 +1295,7 @@ static int load_external_fonts(int base_offset)
     convert_images(data.font, draw_data, EXTERNAL_FONT_ENTRIES, &buf, atlas_data);
     free(tmp_data);
     free_draw_data(draw_data, EXTERNAL_FONT_ENTRIES);
-    make_plain_fonts_white(data.font, atlas_data, base_offset);
+    make_plain_fonts_white(data.font, atlas_data, base_offset, ALL_ATLAS_IMAGES);
     graphics_renderer()->create_image_atlas(atlas_data, 1);
     image_packer_free(&data.packer);
 
@@ -860,59 +1304,108 @@ static int load_external_fonts(int base_offset)
     return 1;
 }
 
-static int parse_4bit_multibyte_font(buffer *input, color_t *pixels, multibyte_font_sizes *font_size,
-    int letter_spacing, int num_chars, int num_half_width, int offset)
+static void set_multibyte_glyph_size(image *img, int width, int height,
+    int x_first_opaque, int x_last_opaque, int y_first_opaque, int y_last_opaque)
 {
-    int pixel_offset = 0;
-    for (int i = 0; i < num_chars; i++) {
-        int width = i < num_half_width ? font_size->half_width : font_size->width;
-        color_t *letter = &pixels[pixel_offset];
-        int x_first_opaque = width;
-        int x_last_opaque = -1;
-        int y_first_opaque = font_size->height;
-        int y_last_opaque = -1;
-        for (int row = 0; row < font_size->height; row++) {
-            color_t *pixel = &letter[row * width];
-            uint8_t bits = 0;
-            for (int col = 0; col < font_size->width - letter_spacing; col++) {
-                if (col % 2 == 0) {
-                    bits = buffer_read_u8(input);
+    img->width = x_last_opaque - x_first_opaque + 1;
+    img->x_offset = x_first_opaque;
+    img->original.width = width;
+    img->original.height = height;
+    img->y_offset = y_first_opaque;
+    img->height = y_last_opaque - y_first_opaque + 1;
+
+    if (img->width < 0) {
+        img->width = 0;
+    }
+    if (img->height < 0) {
+        img->height = 0;
+    }
+}
+
+static void parse_4bit_multibyte_glyph(buffer *input, color_t *pixels, int row_width,
+    const multibyte_font_sizes *font_size, int width, int letter_spacing, image *img)
+{
+    int x_first_opaque = width;
+    int x_last_opaque = -1;
+    int y_first_opaque = font_size->height;
+    int y_last_opaque = -1;
+    for (int row = 0; row < font_size->height; row++) {
+        uint8_t bits = 0;
+        for (int col = 0; col < font_size->width - letter_spacing; col++) {
+            if (col % 2 == 0) {
+                bits = buffer_read_u8(input);
+            }
+            uint8_t value = bits & 0xf;
+            if (col < width && value != 0) {
+                if (pixels) {
+                    uint32_t color_value = (value * 16 + value);
+                    pixels[row * row_width + col] = (color_value << COLOR_BITSHIFT_ALPHA) | COLOR_CHANNEL_RGB;
                 }
-                if (col < width) {
-                    uint8_t value = bits & 0xf;
-                    if (value != 0) {
-                        uint32_t color_value = (value * 16 + value);
-                        *pixel = (color_value << COLOR_BITSHIFT_ALPHA) | COLOR_CHANNEL_RGB;
-                        if (col < x_first_opaque) {
-                            x_first_opaque = col;
-                        }
-                        if (col > x_last_opaque) {
-                            x_last_opaque = col;
-                        }
-                        if (row < y_first_opaque) {
-                            y_first_opaque = row;
-                        }
-                        y_last_opaque = row;
-                    }
-                    pixel++;
+                if (col < x_first_opaque) {
+                    x_first_opaque = col;
+                }
+                if (col > x_last_opaque) {
+                    x_last_opaque = col;
                 }
-                bits >>= 4;
+                if (row < y_first_opaque) {
+                    y_first_opaque = row;
+                }
+                y_last_opaque = row;
             }
+            bits >>= 4;
         }
-        image *img = &data.font[offset + i];
-        img->width = x_last_opaque - x_first_opaque + 1;
-        img->x_offset = x_first_opaque;
-        img->original.width = width;
-        img->original.height = font_size->height;
-        img->y_offset = y_first_opaque;
-        img->height = y_last_opaque - y_first_opaque + 1;
-
-        if (img->width < 0) {
-            img->width = 0;
+    }
+    set_multibyte_glyph_size(img, width, font_size->height,
+        x_first_opaque, x_last_opaque, y_first_opaque, y_last_opaque);
+}
+
+static void parse_1bit_multibyte_glyph(buffer *input, color_t *pixels, int row_width,
+    const multibyte_font_sizes *font_size, int width, int letter_spacing, image *img)
+{
+    int bytes_per_row = (width - 1) <= 16 ? 2 : 3;
+    int x_first_opaque = width;
+    int x_last_opaque = -1;
+    int y_first_opaque = font_size->height;
+    int y_last_opaque = -1;
+    for (int row = 0; row < font_size->height; row++) {
+        unsigned int bits = buffer_read_u16(input);
+        if (bytes_per_row == 3) {
+            bits += buffer_read_u8(input) << 16;
         }
-        if (img->height < 0) {
-            img->height = 0;
+        int prev_set = 0;
+        for (int col = 0; col < font_size->width - letter_spacing; col++) {
+            int set = bits & 1;
+            if (set || prev_set) {
+                if (pixels) {
+                    pixels[row * row_width + col] = set ? COLOR_WHITE : ALPHA_FONT_SEMI_TRANSPARENT;
+                }
+                if (col < x_first_opaque) {
+                    x_first_opaque = col;
+                }
+                if (col > x_last_opaque) {
+                    x_last_opaque = col;
+                }
+                if (row < y_first_opaque) {
+                    y_first_opaque = row;
+                }
+                y_last_opaque = row;
+            }
+            bits >>= 1;
+            prev_set = set;
         }
+    }
+    set_multibyte_glyph_size(img, width, font_size->height,
+        x_first_opaque, x_last_opaque, y_first_opaque, y_last_opaque);
+}
+
+static int parse_multibyte_font(buffer *input, color_t *pixels, const multibyte_font_sizes *font_size,
+    int letter_spacing, int num_chars, int num_half_width, int offset, multibyte_glyph_parser parse_glyph)
+{
+    int pixel_offset = 0;
+    for (int i = 0; i < num_chars; i++) {
+        int width = i < num_half_width ? font_size->half_width : font_size->width;
+        image *img = &data.font[offset + i];
+        parse_glyph(input, &pixels[pixel_offset], width, font_size, width, letter_spacing, img);
 
         image_packer_rect *rect = &data.packer.rects[offset + i];
         rect->input.width = img->width;
@@ -923,67 +1416,244 @@ static int parse_4bit_multibyte_font(buffer *input, color_t *pixels, multibyte_f
     return pixel_offset;
 }
 
-static int parse_1bit_multibyte_font(buffer *input, color_t *pixels, multibyte_font_sizes *font_size,
-    int letter_spacing, int num_chars, int num_half_width, int offset)
+static int create_glyph_cache_atlas(const multibyte_font_sizes *font_sizes, int slots_per_style)
 {
-    int pixel_offset = 0;
-    for (int i = 0; i < num_chars; i++) {
-        int width = i < num_half_width ? font_size->half_width : font_size->width;
-        int bytes_per_row = (width - 1) <= 16 ? 2 : 3;
-        color_t *letter = &pixels[pixel_offset];
-        int x_first_opaque = width;
-        int x_last_opaque = -1;
-        int y_first_opaque = font_size->height;
-        int y_last_opaque = -1;
-        for (int row = 0; row < font_size->height; row++) {
-            color_t *pixel = &letter[row * width];
-            unsigned int bits = buffer_read_u16(input);
-            if (bytes_per_row == 3) {
-                bits += buffer_read_u8(input) << 16;
-            }
-            int prev_set = 0;
-            for (int col = 0; col < font_size->width - letter_spacing; col++) {
-                int set = bits & 1;
-                if (set || prev_set) {
-                    *pixel = set ? COLOR_WHITE : ALPHA_FONT_SEMI_TRANSPARENT;
-                    if (col < x_first_opaque) {
-                        x_first_opaque = col;
-                    }
-                    if (col > x_last_opaque) {
-                        x_last_opaque = col;
-                    }
-                    if (row < y_first_opaque) {
-                        y_first_opaque = row;
-                    }
-                    y_last_opaque = row;
-                }
-                pixel++;
-                bits >>= 1;
-                prev_set = set;
-            }
+    int rows = (slots_per_style + GLYPH_CACHE_COLUMNS - 1) / GLYPH_CACHE_COLUMNS;
+    int width = 0;
+    int height = 0;
+    for (int i = 0; i < FONT_STYLES; i++) {
+        if (font_sizes[i].width * GLYPH_CACHE_COLUMNS > width) {
+            width = font_sizes[i].width * GLYPH_CACHE_COLUMNS;
         }
-        image *img = &data.font[offset + i];
-        img->width = x_last_opaque - x_first_opaque + 1;
-        img->x_offset = x_first_opaque;
-        img->original.width = width;
-        img->original.height = font_size->height;
-        img->y_offset = y_first_opaque;
-        img->height = y_last_opaque - y_first_opaque + 1;
-
-        if (img->width < 0) {
-            img->width = 0;
+        for (int slot = 0; slot < slots_per_style; slot++) {
+            glyph_cache_slot *cache_slot = &data.glyphs.slots[i * slots_per_style + slot];
+            cache_slot->glyph = -1;
+            cache_slot->frame = 0;
+            cache_slot->x = (slot % GLYPH_CACHE_COLUMNS) * font_sizes[i].width;
+            cache_slot->y = height + (slot / GLYPH_CACHE_COLUMNS) * font_sizes[i].height;
+            cache_slot->previous = slot > 0 ? i * slots_per_style + slot - 1 : -1;
+            cache_slot->next = slot < slots_per_style - 1 ? i * slots_per_style + slot + 1 : -1;
+        }
+        data.glyphs.styles[i].most_recent = i * slots_per_style;
+        data.glyphs.styles[i].least_recent = (i + 1) * slots_per_style - 1;
+        height += rows * font_sizes[i].height;
+    }
+    data.glyphs.total_slots = FONT_STYLES * slots_per_style;
+    if (width > data.max_image_width || height > data.max_image_height) {
+        return 0;
+    }
+    data.glyphs.atlas_data = graphics_renderer()->prepare_image_atlas(ATLAS_FONT, 1, width, height);
+    if (!data.glyphs.atlas_data) {
+        return 0;
+    }
+    if (!graphics_renderer()->create_empty_image_atlas(data.glyphs.atlas_data)) {
+        graphics_renderer()->free_image_atlas(ATLAS_FONT);
+        return 0;
+    }
+    return 1;
+}
+
+static int start_glyph_cache(const multibyte_font_data *font_info, const multibyte_font_sizes *font_sizes,
+    multibyte_glyph_parser parse_glyph, uint8_t *file_data, int file_size)
+{
+    if (!graphics_renderer()->create_empty_image_atlas || !graphics_renderer()->update_image_atlas_region) {
+        return 0;
+    }
+    int num_chars = font_info->chars;
+    int entries = FONT_STYLES * num_chars;
+    int slots_per_style = num_chars < GLYPH_CACHE_SLOTS ? num_chars : GLYPH_CACHE_SLOTS;
+
+    data.glyphs.file_offsets = malloc(sizeof(int) * entries);
+    data.glyphs.glyph_slots = malloc(sizeof(int) * entries);
+    data.glyphs.slots = malloc(sizeof(glyph_cache_slot) * FONT_STYLES * slots_per_style);
+    if (!data.glyphs.file_offsets || !data.glyphs.glyph_slots || !data.glyphs.slots ||
+        !create_glyph_cache_atlas(font_sizes, slots_per_style)) {
+        release_glyph_cache();
+        return 0;
+    }
+
+    // Only the size of every glyph is needed now, its pixels are decoded when it is first drawn
+    buffer input;
+    buffer_init(&input, file_data, file_size);
+    for (int i = 0; i < FONT_STYLES; i++) {
+        for (int j = 0; j < num_chars; j++) {
+            int width = j < font_info->half_width_chars ? font_sizes[i].half_width : font_sizes[i].width;
+            int glyph = i * num_chars + j;
+            image *img = &data.font[glyph];
+            data.glyphs.file_offsets[glyph] = (int) input.index;
+            data.glyphs.glyph_slots[glyph] = -1;
+            parse_glyph(&input, 0, 0, &font_sizes[i], width, font_info->letter_spacing, img);
+            img->atlas.id = ATLAS_FONT << IMAGE_ATLAS_BIT_OFFSET;
+        }
+    }
+
+    uint8_t *shrunk_data = realloc(file_data, file_size);
+    data.glyphs.file_data = shrunk_data ? shrunk_data : file_data;
+    data.glyphs.file_size = file_size;
+    data.glyphs.num_chars = num_chars;
+    data.glyphs.letter_spacing = font_info->letter_spacing;
+    data.glyphs.font_sizes = font_sizes;
+    data.glyphs.parse_glyph = parse_glyph;
+    data.glyphs.frame = 1;
+    data.glyphs.active = 1;
+    return 1;
+}
+
+static void use_glyph_cache_slot(int style, int slot)
+{
+    glyph_cache_slot *slots = data.glyphs.slots;
+    if (data.glyphs.styles[style].most_recent == slot) {
+        return;
+    }
+    slots[slots[slot].previous].next = slots[slot].next;
+    if (slots[slot].next != -1) {
+        slots[slots[slot].next].previous = slots[slot].previous;
+    } else {
+        data.glyphs.styles[style].least_recent = slots[slot].previous;
+    }
+    slots[slot].previous = -1;
+    slots[slot].next = data.glyphs.styles[style].most_recent;
+    slots[data.glyphs.styles[style].most_recent].previous = slot;
+    data.glyphs.styles[style].most_recent = slot;
+}
+
+static int recreate_glyph_cache_atlas(const color_t *pixels, int width, int height, int new_height)
+{
+    const image_atlas_data *atlas_data = graphics_renderer()->prepare_image_atlas(ATLAS_FONT, 1, width, new_height);
+    if (!atlas_data) {
+        return 0;
+    }
+    memcpy(atlas_data->buffers[0], pixels, sizeof(color_t) * width * height);
+    if (!graphics_renderer()->create_image_atlas(atlas_data, 0)) {
+        graphics_renderer()->free_image_atlas(ATLAS_FONT);
+        return 0;
+    }
+    data.glyphs.atlas_data = atlas_data;
+    return 1;
+}
+
+// Adds empty slots below the font atlas, which are the first to be used for the style's new glyphs
+static int grow_glyph_cache(int style)
+{
+    const multibyte_font_sizes *font_size = &data.glyphs.font_sizes[style];
+    const image_atlas_data *atlas_data = data.glyphs.atlas_data;
+    int width = atlas_data->image_widths[0];
+    int height = atlas_data->image_heights[0];
+    int new_height = height + GLYPH_CACHE_SLOTS / GLYPH_CACHE_COLUMNS * font_size->height;
+    if (new_height > data.max_image_height) {
+        return 0;
+    }
+    glyph_cache_slot *slots = realloc(data.glyphs.slots,
+        sizeof(glyph_cache_slot) * (data.glyphs.total_slots + GLYPH_CACHE_SLOTS));
+    color_t *pixels = malloc(sizeof(color_t) * width * height);
+    if (!slots || !pixels) {
+        if (slots) {
+            data.glyphs.slots = slots;
         }
-        if (img->height < 0) {
-            img->height = 0;
+        free(pixels);
+        return 0;
+    }
+    data.glyphs.slots = slots;
+    memcpy(pixels, atlas_data->buffers[0], sizeof(color_t) * width * height);
+    if (!recreate_glyph_cache_atlas(pixels, width, height, new_height)) {
+        log_error("Unable to grow the font atlas", 0, 0);
+        // The old atlas was already released, so it has to be brought back as it was
+        int restored = recreate_glyph_cache_atlas(pixels, width, height, height);
+        free(pixels);
+        if (!restored) {
+            data.glyphs.active = 0;
         }
+        return 0;
+    }
+    free(pixels);
+
+    int first = data.glyphs.total_slots;
+    for (int i = 0; i < GLYPH_CACHE_SLOTS; i++) {
+        glyph_cache_slot *cache_slot = &slots[first + i];
+        cache_slot->glyph = -1;
+        cache_slot->frame = 0;
+        cache_slot->x = (i % GLYPH_CACHE_COLUMNS) * font_size->width;
+        cache_slot->y = height + (i / GLYPH_CACHE_COLUMNS) * font_size->height;
+        cache_slot->previous = i > 0 ? first + i - 1 : data.glyphs.styles[style].least_recent;
+        cache_slot->next = i < GLYPH_CACHE_SLOTS - 1 ? first + i + 1 : -1;
+    }
+    slots[data.glyphs.styles[style].least_recent].next = first;
+    data.glyphs.styles[style].least_recent = first + GLYPH_CACHE_SLOTS - 1;
+    data.glyphs.total_slots += GLYPH_CACHE_SLOTS;
+    return 1;
+}
 
-        image_packer_rect *rect = &data.packer.rects[offset + i];
-        rect->input.width = img->width;
-        rect->input.height = img->height;
+static void load_multibyte_glyph(int glyph)
+{
+    int style = glyph / data.glyphs.num_chars;
+    int slot = data.glyphs.glyph_slots[glyph];
+    if (slot != -1) {
+        data.glyphs.slots[slot].frame = data.glyphs.frame;
+        use_glyph_cache_slot(style, slot);
+        return;
+    }
+    image *img = &data.font[glyph];
+    if (!img->width || !img->height) {
+        return;
+    }
+    // Replace the glyph that was drawn the longest time ago, unless it is still needed for this frame.
+    // Only when the atlas cannot grow anymore is it replaced after all, which then draws a wrong glyph
+    slot = data.glyphs.styles[style].least_recent;
+    if (data.glyphs.slots[slot].glyph != -1 && data.glyphs.slots[slot].frame == data.glyphs.frame) {
+        if (grow_glyph_cache(style)) {
+            slot = data.glyphs.styles[style].least_recent;
+        } else if (!data.glyphs.active) {
+            return;
+        }
+    }
+    glyph_cache_slot *cache_slot = &data.glyphs.slots[slot];
+    if (cache_slot->glyph != -1) {
+        data.glyphs.glyph_slots[cache_slot->glyph] = -1;
+        cache_slot->glyph = -1;
+    }
 
-        pixel_offset += width * font_size->height;
+    const multibyte_font_sizes *font_size = &data.glyphs.font_sizes[style];
+    const image_atlas_data *atlas_data = data.glyphs.atlas_data;
+    int row_width = atlas_data->image_widths[0];
+    color_t *pixels = &atlas_data->buffers[0][cache_slot->y * row_width + cache_slot->x];
+    for (int y = 0; y < font_size->height; y++) {
+        memset(&pixels[y * row_width], 0, sizeof(color_t) * font_size->width);
+    }
+    buffer input;
+    buffer_init(&input, data.glyphs.file_data, data.glyphs.file_size);
+    buffer_set(&input, data.glyphs.file_offsets[glyph]);
+    data.glyphs.parse_glyph(&input, pixels, row_width, font_size, img->original.width,
+        data.glyphs.letter_spacing, img);
+
+    if (!graphics_renderer()->update_image_atlas_region(atlas_data, 0,
+        cache_slot->x, cache_slot->y, font_size->width, font_size->height)) {
+        return;
+    }
+    img->atlas.x_offset = cache_slot->x + img->x_offset;
+    img->atlas.y_offset = cache_slot->y + img->y_offset;
+    cache_slot->glyph = glyph;
+    cache_slot->frame = data.glyphs.frame;
+    data.glyphs.glyph_slots[glyph] = slot;
+    use_glyph_cache_slot(style, slot);
+}
+
+void image_load_pixels(const image *img)
+{
+    if (!img) {
+        return;
+    }
+    if (data.glyphs.active && (img->atlas.id >> IMAGE_ATLAS_BIT_OFFSET) == ATLAS_FONT &&
+        img >= data.font && img < data.font + FONT_STYLES * data.glyphs.num_chars) {
+        load_multibyte_glyph((int) (img - data.font));
+        return;
+    }
+    if (!data.lazy.active || (img->atlas.id >> IMAGE_ATLAS_BIT_OFFSET) != ATLAS_MAIN) {
+        return;
+    }
+    int index = img->atlas.id & IMAGE_ATLAS_BIT_MASK;
+    if (index < data.lazy.atlas_data->num_images && data.lazy.images[index].state != ATLAS_IMAGE_LOADED) {
+        load_lazy_atlas_image(&data.lazy.images[index]);
     }
-    return pixel_offset;
 }
 
 static int load_multibyte_font(multibyte_font_type type)
@@ -1015,6 +1685,23 @@ static int load_multibyte_font(multibyte_font_type type)
         }
     }
 
+    multibyte_font_sizes *font_sizes;
+    multibyte_glyph_parser parse_glyph;
+    if (file_version == 2) {
+        font_sizes = font_info->sizes.v2;
+        parse_glyph = parse_4bit_multibyte_glyph;
+    } else {
+        font_sizes = font_info->sizes.v1;
+        parse_glyph = parse_1bit_multibyte_glyph;
+    }
+
+    if (start_glyph_cache(font_info, font_sizes, parse_glyph, tmp_data, data_size)) {
+        log_info("Done parsing font, glyphs are loaded when first drawn", font_info->name, 0);
+        data.fonts_enabled = MULTIBYTE_IN_FONT;
+        data.font_base_offset = 0;
+        return 1;
+    }
+
     buffer input;
     buffer_init(&input, tmp_data, data_size);
     int num_chars = font_info->chars;
@@ -1031,17 +1718,6 @@ static int load_multibyte_font(multibyte_font_type type)
     data.packer.options.reduce_image_size = 1;
     data.packer.options.sort_by = IMAGE_PACKER_SORT_BY_AREA;
 
-    multibyte_font_sizes *font_sizes;
-    int (*parse_multibyte_font)(buffer * input, color_t * pixels, multibyte_font_sizes * font_size,
-        int letter_spacing, int num_chars, int num_half_width, int offset);
-    if (file_version == 2) {
-        font_sizes = font_info->sizes.v2;
-        parse_multibyte_font = parse_4bit_multibyte_font;
-    } else {
-        font_sizes = font_info->sizes.v1;
-        parse_multibyte_font = parse_1bit_multibyte_font;
-    }
-
     size_t font_data_size = sizeof(color_t) * (font_sizes[0].width * font_sizes[0].height + font_sizes[1].width * font_sizes[1].height +
         font_sizes[2].width * font_sizes[2].height) * num_full_width;
     font_data_size += sizeof(color_t) * (font_sizes[0].half_width * font_sizes[0].height +
@@ -1060,7 +1736,7 @@ static int load_multibyte_font(multibyte_font_type type)
     color_t *font_offset = font_data;
     for (int i = 0; i < FONT_STYLES; i++) {
         font_offset += parse_multibyte_font(&input, font_offset, &font_sizes[i], font_info->letter_spacing,
-            num_chars, num_half_width, num_chars * i);
+            num_chars, num_half_width, num_chars * i, parse_glyph);
     }
 
     image_packer_pack(&data.packer);
@@ -99,6 +99,33 @@ typedef struct {
  */
 int image_load_climate(int climate_id, int is_editor, int force_reload, int keep_atlas_buffers);
 
+/**
+ * Makes sure the pixels of an image are in its atlas.
+ * When the main images are loaded lazily, their atlas images are only decoded when first needed.
+ * Glyphs of multibyte fonts are decoded into the font atlas when first drawn, replacing the least recently used ones
+ * that were not drawn in the current frame.
+ * Must be called from the main thread before drawing the image or reading its pixels from the atlas
+ * @param img The image
+ */
+void image_load_pixels(const image *img);
+
+/**
+ * Starts a new frame, so the multibyte glyphs drawn in the previous one may be replaced
+ * Must be called once per frame, before drawing
+ */
+void image_start_frame(void);
+
+/**
+ * Continues loading the main images lazily, uploading an atlas image that was decoded in the background.
+ * Should be called once per frame
+ */
+void image_update_lazy_loading(void);
+
+/**
+ * Stops loading the main images lazily, waiting for the background decoding to finish
+ */
+void image_stop_lazy_loading(void);
+
 /**
  * Loads external fonts file (Cyrillic and Traditional Chinese)
  * @return boolean true on success, false on failure
@@ -0,0 +1,337 @@
+#include "image_cache.h"
+
+#include "core/dir.h"
+#include "core/log.h"
+#include "core/lz4.h"
+#include "core/thread_pool.h"
+#include "platform/file_manager.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HASH_PRIME 1099511628211ull
+
+#define HEADER_SIZE (IMAGE_CACHE_MAGIC_LENGTH + sizeof(int32_t) + sizeof(uint64_t))
+#define PAGE_RECORD_SIZE (3 * sizeof(int32_t))
+
+typedef struct {
+    color_t *pixels;
+    int pixels_size;
+    uint8_t *compressed;
+    int compressed_size;
+    int result;
+} atlas_page;
+
+uint64_t image_cache_hash_data(uint64_t hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * HASH_PRIME;
+    }
+    return hash;
+}
+
+uint64_t image_cache_hash_int(uint64_t hash, int value)
+{
+    return image_cache_hash_data(hash, &value, sizeof(int));
+}
+
+uint64_t image_cache_hash_string(uint64_t hash, const char *value)
+{
+    return image_cache_hash_data(hash, value, strlen(value) + 1);
+}
+
+static struct {
+    const char *name;
+    long modified_time;
+    long size;
+    int found;
+} file_search;
+
+static int find_file_info(const char *name, long modified_time, long size)
+{
+    if (platform_file_manager_compare_filename(name, file_search.name) != 0) {
+        return LIST_NO_MATCH;
+    }
+    file_search.modified_time = modified_time;
+    file_search.size = size;
+    file_search.found = 1;
+    return LIST_MATCH;
+}
+
+int image_cache_hash_file(uint64_t *hash, const char *filepath, int localizable)
+{
+    const char *cased_file = dir_get_file(filepath, localizable);
+    if (!cased_file) {
+        return 0;
+    }
+    char path[FILE_NAME_MAX];
+    snprintf(path, FILE_NAME_MAX, "%s", cased_file);
+
+    // The size and modification time come from the directory entry, so the file itself is never opened.
+    // The listing from core/dir is not used, as callers may still be using it
+    char directory[FILE_NAME_MAX];
+    const char *name = file_remove_path(path);
+    snprintf(directory, FILE_NAME_MAX, "%.*s", (int) (name - path), path);
+    const char *extension = strrchr(name, '.');
+    file_search.name = name;
+    file_search.modified_time = 0;
+    file_search.size = 0;
+    file_search.found = 0;
+    platform_file_manager_list_directory_contents(directory, TYPE_FILE, extension ? extension + 1 : 0,
+        find_file_info);
+    if (!file_search.found) {
+        return 0;
+    }
+
+    *hash = image_cache_hash_string(*hash, path);
+    *hash = image_cache_hash_data(*hash, &file_search.size, sizeof(long));
+    *hash = image_cache_hash_data(*hash, &file_search.modified_time, sizeof(long));
+    return 1;
+}
+
+void image_cache_write_image(buffer *buf, const image *img)
+{
+    buffer_write_i32(buf, img->x_offset);
+    buffer_write_i32(buf, img->y_offset);
+    buffer_write_i32(buf, img->width);
+    buffer_write_i32(buf, img->height);
+    buffer_write_i32(buf, img->original.width);
+    buffer_write_i32(buf, img->original.height);
+    buffer_write_i32(buf, img->is_isometric);
+    buffer_write_i32(buf, img->atlas.id);
+    buffer_write_i32(buf, img->atlas.x_offset);
+    buffer_write_i32(buf, img->atlas.y_offset);
+}
+
+void image_cache_read_image(buffer *buf, image *img)
+{
+    img->x_offset = buffer_read_i32(buf);
+    img->y_offset = buffer_read_i32(buf);
+    img->width = buffer_read_i32(buf);
+    img->height = buffer_read_i32(buf);
+    img->original.width = buffer_read_i32(buf);
+    img->original.height = buffer_read_i32(buf);
+    img->is_isometric = buffer_read_i32(buf);
+    img->atlas.id = buffer_read_i32(buf);
+    img->atlas.x_offset = buffer_read_i32(buf);
+    img->atlas.y_offset = buffer_read_i32(buf);
+}
+
+void image_cache_write_animation(buffer *buf, const image_animation *animation)
+{
+    buffer_write_i32(buf, animation->num_sprites);
+    buffer_write_i32(buf, animation->sprite_offset_x);
+    buffer_write_i32(buf, animation->sprite_offset_y);
+    buffer_write_i32(buf, animation->can_reverse);
+    buffer_write_i32(buf, animation->speed_id);
+    buffer_write_i32(buf, animation->start_offset);
+}
+
+void image_cache_read_animation(buffer *buf, image_animation *animation)
+{
+    animation->num_sprites = buffer_read_i32(buf);
+    animation->sprite_offset_x = buffer_read_i32(buf);
+    animation->sprite_offset_y = buffer_read_i32(buf);
+    animation->can_reverse = buffer_read_i32(buf);
+    animation->speed_id = buffer_read_i32(buf);
+    animation->start_offset = buffer_read_i32(buf);
+}
+
+int image_cache_open(const char *filename, const char *magic, int version, uint64_t key,
+    file_mapping *file, buffer *buf)
+{
+    if (!key) {
+        return 0;
+    }
+    const char *path = dir_get_file_at_location(filename, PATH_LOCATION_CONFIG);
+    if (!path) {
+        return 0;
+    }
+    FILE *fp = file_open(path, "rb");
+    if (!fp) {
+        return 0;
+    }
+    int mapped = file_map(fp, file);
+    file_close(fp);
+    if (!mapped) {
+        return 0;
+    }
+    buffer_init(buf, file->data, file->size);
+    char file_magic[IMAGE_CACHE_MAGIC_LENGTH];
+    buffer_read_raw(buf, file_magic, IMAGE_CACHE_MAGIC_LENGTH);
+    int32_t file_version = buffer_read_i32(buf);
+    uint64_t file_key;
+    buffer_read_raw(buf, &file_key, sizeof(uint64_t));
+    if (buf->overflow || memcmp(file_magic, magic, IMAGE_CACHE_MAGIC_LENGTH) != 0 ||
+        file_version != version || file_key != key) {
+        file_unmap(file);
+        return 0;
+    }
+    return 1;
+}
+
+static void compress_page(void *item)
+{
+    atlas_page *page = item;
+    page->result = lz4_compress(page->pixels, page->pixels_size, page->compressed, page->compressed_size);
+}
+
+static void decompress_page(void *item)
+{
+    atlas_page *page = item;
+    page->result = lz4_decompress(page->compressed, page->compressed_size, page->pixels, page->pixels_size);
+}
+
+const image_atlas_data *image_cache_read_atlas(buffer *buf, const uint8_t *file_data, atlas_type type)
+{
+    int num_pages = buffer_read_i32(buf);
+    if (buf->overflow || num_pages < 0 || (size_t) num_pages > (buf->size - buf->index) / PAGE_RECORD_SIZE) {
+        return 0;
+    }
+    atlas_page *pages = malloc(sizeof(atlas_page) * (num_pages ? num_pages : 1));
+    int *widths = malloc(sizeof(int) * (num_pages ? num_pages : 1));
+    int *heights = malloc(sizeof(int) * (num_pages ? num_pages : 1));
+    if (!pages || !widths || !heights) {
+        free(pages);
+        free(widths);
+        free(heights);
+        return 0;
+    }
+    size_t data_offset = buf->index + num_pages * PAGE_RECORD_SIZE;
+    int valid = 1;
+    for (int i = 0; i < num_pages; i++) {
+        widths[i] = buffer_read_i32(buf);
+        heights[i] = buffer_read_i32(buf);
+        pages[i].compressed_size = buffer_read_i32(buf);
+        if (widths[i] <= 0 || heights[i] <= 0 || pages[i].compressed_size <= 0 ||
+            (size_t) pages[i].compressed_size > buf->size - data_offset) {
+            valid = 0;
+            break;
+        }
+        pages[i].compressed = (uint8_t *) &file_data[data_offset];
+        data_offset += pages[i].compressed_size;
+    }
+    const image_atlas_data *atlas_data = 0;
+    if (valid) {
+        atlas_data = graphics_renderer()->prepare_image_atlas(type, num_pages,
+            num_pages ? widths[num_pages - 1] : 0, num_pages ? heights[num_pages - 1] : 0);
+    }
+    for (int i = 0; atlas_data && i < num_pages; i++) {
+        // The renderer decides the row length of every page, which has to match the cached one
+        if (atlas_data->image_widths[i] != widths[i] || atlas_data->image_heights[i] != heights[i]) {
+            atlas_data = 0;
+            break;
+        }
+        pages[i].pixels = atlas_data->buffers[i];
+        pages[i].pixels_size = (int) (sizeof(color_t) * widths[i] * heights[i]);
+        pages[i].result = 0;
+    }
+    if (atlas_data) {
+        thread_pool_run_for_each(decompress_page, pages, sizeof(atlas_page), num_pages);
+        for (int i = 0; i < num_pages; i++) {
+            if (!pages[i].result) {
+                atlas_data = 0;
+                break;
+            }
+        }
+    }
+    free(pages);
+    free(widths);
+    free(heights);
+    if (!atlas_data) {
+        graphics_renderer()->free_image_atlas(type);
+        return 0;
+    }
+    buf->index = data_offset;
+    return atlas_data;
+}
+
+static int compress_atlas(const image_atlas_data *atlas_data, atlas_page *pages)
+{
+    for (int i = 0; i < atlas_data->num_images; i++) {
+        size_t pixels_size = sizeof(color_t) * atlas_data->image_widths[i] * atlas_data->image_heights[i];
+        if (pixels_size > INT_MAX / 2) {
+            return 0;
+        }
+        pages[i].pixels = atlas_data->buffers[i];
+        pages[i].pixels_size = (int) pixels_size;
+        pages[i].compressed_size = lz4_compress_bound(pages[i].pixels_size);
+        pages[i].compressed = malloc(pages[i].compressed_size);
+        if (!pages[i].compressed) {
+            return 0;
+        }
+    }
+    thread_pool_run_for_each(compress_page, pages, sizeof(atlas_page), atlas_data->num_images);
+    for (int i = 0; i < atlas_data->num_images; i++) {
+        if (pages[i].result <= 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int write_file(FILE *fp, const char *magic, int version, uint64_t key,
+    const uint8_t *metadata, size_t metadata_size, const image_atlas_data *atlas_data, const atlas_page *pages)
+{
+    uint8_t header[HEADER_SIZE];
+    buffer buf;
+    buffer_init(&buf, header, HEADER_SIZE);
+    buffer_write_raw(&buf, magic, IMAGE_CACHE_MAGIC_LENGTH);
+    buffer_write_i32(&buf, version);
+    buffer_write_raw(&buf, &key, sizeof(uint64_t));
+
+    size_t records_size = sizeof(int32_t) + atlas_data->num_images * PAGE_RECORD_SIZE;
+    uint8_t *records = malloc(records_size);
+    if (!records) {
+        return 0;
+    }
+    buffer_init(&buf, records, records_size);
+    buffer_write_i32(&buf, atlas_data->num_images);
+    for (int i = 0; i < atlas_data->num_images; i++) {
+        buffer_write_i32(&buf, atlas_data->image_widths[i]);
+        buffer_write_i32(&buf, atlas_data->image_heights[i]);
+        buffer_write_i32(&buf, pages[i].result);
+    }
+
+    int written = fwrite(header, 1, HEADER_SIZE, fp) == HEADER_SIZE &&
+        fwrite(metadata, 1, metadata_size, fp) == metadata_size &&
+        fwrite(records, 1, records_size, fp) == records_size;
+    for (int i = 0; written && i < atlas_data->num_images; i++) {
+        written = fwrite(pages[i].compressed, 1, pages[i].result, fp) == (size_t) pages[i].result;
+    }
+    free(records);
+    return written;
+}
+
+void image_cache_write(const char *filename, const char *magic, int version, uint64_t key,
+    const uint8_t *metadata, size_t metadata_size, const image_atlas_data *atlas_data)
+{
+    if (!key || !atlas_data) {
+        return;
+    }
+    atlas_page *pages = calloc(atlas_data->num_images ? atlas_data->num_images : 1, sizeof(atlas_page));
+    if (!pages) {
+        return;
+    }
+    if (!compress_atlas(atlas_data, pages)) {
+        log_error("Unable to compress the image cache", filename, 0);
+    } else {
+        FILE *fp = file_open(dir_append_location(filename, PATH_LOCATION_CONFIG), "wb");
+        if (!fp) {
+            log_error("Unable to write the image cache", filename, 0);
+        } else {
+            int written = write_file(fp, magic, version, key, metadata, metadata_size, atlas_data, pages);
+            file_close(fp);
+            if (!written) {
+                log_error("Unable to write the image cache", filename, 0);
+                file_remove(dir_append_location(filename, PATH_LOCATION_CONFIG));
+            }
+        }
+    }
+    for (int i = 0; i < atlas_data->num_images; i++) {
+        free(pages[i].compressed);
+    }
+    free(pages);
+}
@@ -0,0 +1,81 @@
+#ifndef CORE_IMAGE_CACHE_H
+#define CORE_IMAGE_CACHE_H
+
+#include "core/buffer.h"
+#include "core/file.h"
+#include "core/image.h"
+#include "graphics/renderer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file
+ * Common code for the files that cache converted and packed images in the config directory.
+ *
+ * A cache file has a header with a magic string, a format version and a key, followed by the metadata
+ * of its owner and the LZ4 compressed pixels of every atlas image.
+ */
+
+#define IMAGE_CACHE_MAGIC_LENGTH 8
+
+#define IMAGE_CACHE_HASH_START 14695981039346656037ull
+
+#define IMAGE_CACHE_IMAGE_RECORD_SIZE (10 * sizeof(int32_t))
+#define IMAGE_CACHE_ANIMATION_RECORD_SIZE (6 * sizeof(int32_t))
+
+uint64_t image_cache_hash_data(uint64_t hash, const void *data, size_t size);
+uint64_t image_cache_hash_int(uint64_t hash, int value);
+uint64_t image_cache_hash_string(uint64_t hash, const char *value);
+
+/**
+ * Adds the location, size and last modification time of a file to the hash
+ * @param hash The hash to update
+ * @param filepath The file, looked up the same way as io_read_file_into_buffer does
+ * @param localizable Whether the file may be localized
+ * @return Boolean true if the file exists, false otherwise
+ */
+int image_cache_hash_file(uint64_t *hash, const char *filepath, int localizable);
+
+void image_cache_write_image(buffer *buf, const image *img);
+void image_cache_read_image(buffer *buf, image *img);
+
+void image_cache_write_animation(buffer *buf, const image_animation *animation);
+void image_cache_read_animation(buffer *buf, image_animation *animation);
+
+/**
+ * Opens a cache file from the config directory and checks its header
+ * @param filename The name of the cache file
+ * @param magic The magic string of the cache, IMAGE_CACHE_MAGIC_LENGTH characters long
+ * @param version The current format version of the cache
+ * @param key The expected key
+ * @param file The mapping of the file, which must be unmapped when the function succeeds
+ * @param buf The buffer over the file, set right after the header
+ * @return Boolean true if the cache exists and is up to date, false otherwise
+ */
+int image_cache_open(const char *filename, const char *magic, int version, uint64_t key,
+    file_mapping *file, buffer *buf);
+
+/**
+ * Reads the atlas of a cache into a newly prepared image atlas
+ * @param buf The buffer over the file, set at the atlas
+ * @param file_data The start of the file
+ * @param type The atlas type
+ * @return The prepared atlas, which still needs to be created by the caller, or 0 if the atlas is broken
+ */
+const image_atlas_data *image_cache_read_atlas(buffer *buf, const uint8_t *file_data, atlas_type type);
+
+/**
+ * Writes a cache file to the config directory
+ * @param filename The name of the cache file
+ * @param magic The magic string of the cache, IMAGE_CACHE_MAGIC_LENGTH characters long
+ * @param version The current format version of the cache
+ * @param key The cache key
+ * @param metadata The metadata to write after the header
+ * @param metadata_size The size of the metadata
+ * @param atlas_data The atlas to write after the metadata, whose buffers must still exist
+ */
+void image_cache_write(const char *filename, const char *magic, int version, uint64_t key,
+    const uint8_t *metadata, size_t metadata_size, const image_atlas_data *atlas_data);
+
+#endif // CORE_IMAGE_CACHE_H
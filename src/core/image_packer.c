@@ -5,6 +5,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+typedef struct {
+    unsigned int x, y;
+    unsigned int width;
+} skyline_node;
+
 typedef struct empty_area {
     unsigned int x, y;
     unsigned int width, height;
@@ -25,6 +30,13 @@ struct internal_data {
         unsigned int size;
         void (*set_comparator)(empty_area *area);
     } empty_areas;
+    struct {
+        skyline_node *nodes;
+        unsigned int total;
+        unsigned int width;
+        unsigned int height;
+    } skyline;
+    image_packer_algorithm algorithm;
 };
 
 static int compare_rect_perimeters(const void *a, const void *b)
@@ -316,6 +328,161 @@ static int pack_rect(internal_data *data, image_packer_rect *rect, int allow_rot
     return 0;
 }
 
+static void reset_skyline(internal_data *data, unsigned int width, unsigned int height)
+{
+    data->skyline.nodes[0].x = 0;
+    data->skyline.nodes[0].y = 0;
+    data->skyline.nodes[0].width = width;
+    data->skyline.total = 1;
+    data->skyline.width = width;
+    data->skyline.height = height;
+}
+
+static int skyline_fit(const internal_data *data, unsigned int index, unsigned int width, unsigned int height,
+    unsigned int *y)
+{
+    const skyline_node *node = &data->skyline.nodes[index];
+    if (node->x + width > data->skyline.width) {
+        return 0;
+    }
+    // The rect rests on the highest node below it. The nodes always cover the whole width of the image.
+    unsigned int top = 0;
+    unsigned int width_left = width;
+    while (1) {
+        if (node->y > top) {
+            top = node->y;
+        }
+        if (top + height > data->skyline.height) {
+            return 0;
+        }
+        if (node->width >= width_left) {
+            break;
+        }
+        width_left -= node->width;
+        node++;
+    }
+    *y = top;
+    return 1;
+}
+
+static void remove_skyline_node(internal_data *data, unsigned int index)
+{
+    data->skyline.total--;
+    memmove(&data->skyline.nodes[index], &data->skyline.nodes[index + 1],
+        (data->skyline.total - index) * sizeof(skyline_node));
+}
+
+static void add_skyline_node(internal_data *data, unsigned int index, unsigned int y,
+    unsigned int width, unsigned int height)
+{
+    skyline_node *nodes = data->skyline.nodes;
+    memmove(&nodes[index + 1], &nodes[index], (data->skyline.total - index) * sizeof(skyline_node));
+    data->skyline.total++;
+    nodes[index].y = y + height;
+    nodes[index].width = width;
+
+    // Cut the nodes that are now below the new one
+    unsigned int end = nodes[index].x + width;
+    while (index + 1 < data->skyline.total && nodes[index + 1].x < end) {
+        skyline_node *node = &nodes[index + 1];
+        unsigned int covered = end - node->x;
+        if (node->width > covered) {
+            node->x += covered;
+            node->width -= covered;
+            break;
+        }
+        remove_skyline_node(data, index + 1);
+    }
+    for (unsigned int i = 0; i + 1 < data->skyline.total;) {
+        if (nodes[i].y == nodes[i + 1].y) {
+            nodes[i].width += nodes[i + 1].width;
+            remove_skyline_node(data, i + 1);
+        } else {
+            i++;
+        }
+    }
+}
+
+static int find_skyline_position(const internal_data *data, unsigned int width, unsigned int height,
+    unsigned int *best_index, unsigned int *best_y, unsigned int *best_top, unsigned int *best_node_width)
+{
+    int found = 0;
+    for (unsigned int i = 0; i < data->skyline.total; i++) {
+        unsigned int y;
+        if (!skyline_fit(data, i, width, height, &y)) {
+            continue;
+        }
+        // Keep the skyline as low as possible, preferring the narrowest fitting node to leave room for wider rects
+        unsigned int top = y + height;
+        unsigned int node_width = data->skyline.nodes[i].width;
+        if (!found || top < *best_top || (top == *best_top && node_width < *best_node_width)) {
+            *best_index = i;
+            *best_y = y;
+            *best_top = top;
+            *best_node_width = node_width;
+            found = 1;
+        }
+    }
+    return found;
+}
+
+static int pack_rect_on_skyline(internal_data *data, image_packer_rect *rect, int allow_rotation)
+{
+    unsigned int width = rect->input.width;
+    unsigned int height = rect->input.height;
+
+    if (!width || !height) {
+        return 1;
+    }
+
+    unsigned int index, y, top, node_width;
+    int rotated = 0;
+    int found = find_skyline_position(data, width, height, &index, &y, &top, &node_width);
+    if (allow_rotation && width != height) {
+        unsigned int rotated_index, rotated_y, rotated_top, rotated_node_width;
+        if (find_skyline_position(data, height, width, &rotated_index, &rotated_y, &rotated_top,
+                &rotated_node_width) &&
+            (!found || rotated_top < top || (rotated_top == top && rotated_node_width < node_width))) {
+            index = rotated_index;
+            y = rotated_y;
+            rotated = 1;
+            found = 1;
+        }
+    }
+    if (!found) {
+        rect->output.rotated = 0;
+        return 0;
+    }
+    if (rotated) {
+        width = rect->input.height;
+        height = rect->input.width;
+    }
+    rect->output.x = data->skyline.nodes[index].x;
+    rect->output.y = y;
+    rect->output.rotated = rotated;
+    rect->output.packed = 1;
+    add_skyline_node(data, index, y, width, height);
+    return 1;
+}
+
+static void reset_image(internal_data *data, unsigned int width, unsigned int height)
+{
+    if (data->algorithm == IMAGE_PACKER_SKYLINE) {
+        reset_skyline(data, width, height);
+    } else {
+        reset_empty_areas(data, width, height);
+    }
+}
+
+static int place_rect(internal_data *data, image_packer_rect *rect, int allow_rotation)
+{
+    if (data->algorithm == IMAGE_PACKER_SKYLINE) {
+        return pack_rect_on_skyline(data, rect, allow_rotation);
+    } else {
+        return pack_rect(data, rect, allow_rotation);
+    }
+}
+
 static unsigned int create_last_image(image_packer *packer, uint64_t remaining_area)
 {
     internal_data *data = packer->internal_data;
@@ -345,7 +512,7 @@ static unsigned int create_last_image(image_packer *packer, uint64_t remaining_a
         unsigned int images_packed_in_loop = 0;
         uint64_t area_packed_in_loop = 0;
 
-        reset_empty_areas(data, packer->result.last_image_width, packer->result.last_image_height);
+        reset_image(data, packer->result.last_image_width, packer->result.last_image_height);
 
         int failed = 0;
 
@@ -355,7 +522,9 @@ static unsigned int create_last_image(image_packer *packer, uint64_t remaining_a
             if (rect->output.packed && rect->output.image_index != packer->result.images_needed) {
                 continue;
             }
-            if (!pack_rect(data, rect, packer->options.allow_rotation)) {
+            if (!place_rect(data, rect, packer->options.allow_rotation)) {
+                // The rect may still be marked as packed by an earlier try with a smaller image
+                rect->output.packed = 0;
                 failed = 1;
                 if (packer->result.last_image_width < data->image_width ||
                     packer->result.last_image_height < data->image_height) {
@@ -441,6 +610,14 @@ int image_packer_pack(image_packer *packer)
             return IMAGE_PACKER_ERROR_NO_MEMORY;
         }
     }
+    data->algorithm = packer->options.algorithm;
+    if (data->algorithm == IMAGE_PACKER_SKYLINE && !data->skyline.nodes) {
+        // Each packed rect adds at most one node to the skyline
+        data->skyline.nodes = (skyline_node *) malloc((data->num_rects + 1) * sizeof(skyline_node));
+        if (!data->skyline.nodes) {
+            return IMAGE_PACKER_ERROR_NO_MEMORY;
+        }
+    }
     unsigned int packed_rects = 0;
     uint64_t area_used_in_last_image = 0;
     uint64_t remaining_area = 0;
@@ -453,7 +630,7 @@ int image_packer_pack(image_packer *packer)
         (uint64_t) data->image_width * data->image_height : 0;
 
     while (remaining_area > available_area) {
-        reset_empty_areas(data, data->image_width, data->image_height);
+        reset_image(data, data->image_width, data->image_height);
 
         area_used_in_last_image = 0;
 
@@ -464,7 +641,7 @@ int image_packer_pack(image_packer *packer)
                 continue;
             }
             rect->output.packed = 0;
-            if (!pack_rect(data, rect, packer->options.allow_rotation)) {
+            if (!place_rect(data, rect, packer->options.allow_rotation)) {
                 if (packer->options.fail_policy == IMAGE_PACKER_CONTINUE) {
                     remaining_area -= rect->input.width * rect->input.height;
                     continue;
@@ -473,8 +650,8 @@ int image_packer_pack(image_packer *packer)
                     packer->result.last_image_height = data->image_height;
                     return i;
                 }
-                if (data->empty_areas.first->width == data->image_width &&
-                    data->empty_areas.first->height == data->image_height) {
+                // Nothing fits in an empty image, so the rect is larger than the image
+                if (!area_used_in_last_image) {
                     packer->result.images_needed--;
                     packer->result.last_image_width = data->image_width;
                     packer->result.last_image_height = data->image_height;
@@ -501,11 +678,30 @@ int image_packer_pack(image_packer *packer)
     return packed_rects;
 }
 
+double image_packer_get_occupancy(const image_packer *packer)
+{
+    const internal_data *data = packer->internal_data;
+    if (!data || !packer->result.images_needed) {
+        return 0;
+    }
+    uint64_t used_area = 0;
+    for (unsigned int i = 0; i < data->num_rects; i++) {
+        const image_packer_rect *rect = &packer->rects[i];
+        if (rect->output.packed) {
+            used_area += (uint64_t) rect->input.width * rect->input.height;
+        }
+    }
+    uint64_t total_area = (uint64_t) (packer->result.images_needed - 1) * data->image_width * data->image_height +
+        (uint64_t) packer->result.last_image_width * packer->result.last_image_height;
+    return total_area ? used_area / (double) total_area : 0;
+}
+
 void image_packer_free(image_packer *packer)
 {
     internal_data *data = packer->internal_data;
     if (data) {
         free(data->empty_areas.list);
+        free(data->skyline.nodes);
         free(data->sorted_rects);
         free(data);
     }
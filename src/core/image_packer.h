@@ -21,6 +21,11 @@ typedef enum {
     IMAGE_PACKER_SORT_BY_WIDTH = 3
 } image_packer_sort_type;
 
+typedef enum {
+    IMAGE_PACKER_EMPTY_AREAS = 0, /**< Keeps a sorted list of the empty areas, splitting and merging them */
+    IMAGE_PACKER_SKYLINE = 1 /**< Places each rect as low as possible on the skyline of the packed rects */
+} image_packer_algorithm;
+
 typedef enum {
     IMAGE_PACKER_OK = 0,
     IMAGE_PACKER_ERROR_WRONG_PARAMETERS = -1,
@@ -51,6 +56,7 @@ typedef struct {
         int reduce_image_size;
         image_packer_sort_type sort_by;
         image_packer_fail_policy fail_policy;
+        image_packer_algorithm algorithm;
     } options;
     struct {
         unsigned int images_needed;
@@ -100,6 +106,16 @@ void image_packer_resize_image(image_packer *packer, unsigned int image_width, u
 */
 int image_packer_pack(image_packer *packer);
 
+/**
+ * @brief Calculates how much of the destination images is covered by the packed rects.
+ *
+ * Only meaningful after image_packer_pack() was called.
+ *
+ * @param packer The image_packer struct that was packed.
+ * @return The covered share of the destination images, from 0 to 1.
+ */
+double image_packer_get_occupancy(const image_packer *packer);
+
 /**
  * @brief Frees the memory associated with an image_packer object.
  * @param packer The object to free.
@@ -0,0 +1,195 @@
+#include "core/lz4.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MIN_MATCH 4
+#define LAST_LITERALS 5
+#define MATCH_FIND_LIMIT 12
+#define MAX_OFFSET 65535
+#define RUN_MASK 15
+#define HASH_BITS 12
+#define SKIP_TRIGGER 6
+
+static uint32_t read_u32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static unsigned int hash_sequence(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static uint8_t *write_length(uint8_t *dst, size_t length)
+{
+    while (length >= 255) {
+        *dst++ = 255;
+        length -= 255;
+    }
+    *dst++ = (uint8_t) length;
+    return dst;
+}
+
+static int read_length(const uint8_t **src, const uint8_t *src_end, size_t *length)
+{
+    uint8_t value;
+    do {
+        if (*src >= src_end) {
+            return 0;
+        }
+        value = *(*src)++;
+        *length += value;
+    } while (value == 255);
+    return 1;
+}
+
+static size_t sequence_size(size_t literal_length, size_t match_length)
+{
+    // token + literal length bytes + literals + offset + match length bytes
+    return 1 + (literal_length / 255 + 1) + literal_length + 2 + (match_length / 255 + 1);
+}
+
+static uint8_t *write_literals(uint8_t *dst, uint8_t *token, const uint8_t *literals, size_t length)
+{
+    if (length >= RUN_MASK) {
+        *token = RUN_MASK << 4;
+        dst = write_length(dst, length - RUN_MASK);
+    } else {
+        *token = (uint8_t) (length << 4);
+    }
+    memcpy(dst, literals, length);
+    return dst + length;
+}
+
+int lz4_compress_bound(int input_length)
+{
+    return input_length + input_length / 255 + 16;
+}
+
+int lz4_compress(const void *input_buffer, int input_length, void *output_buffer, int output_length)
+{
+    const uint8_t *src = input_buffer;
+    const uint8_t *src_end = src + input_length;
+    const uint8_t *anchor = src;
+    uint8_t *dst = output_buffer;
+    uint8_t *dst_end = dst + output_length;
+
+    if (input_length >= MATCH_FIND_LIMIT + 1) {
+        // The last match must start at least MATCH_FIND_LIMIT bytes before the end,
+        // and the last LAST_LITERALS bytes are always literals
+        const uint8_t *match_start_limit = src_end - MATCH_FIND_LIMIT;
+        const uint8_t *match_end_limit = src_end - LAST_LITERALS;
+        int32_t positions[1 << HASH_BITS];
+        memset(positions, 0, sizeof(positions));
+
+        const uint8_t *current = src;
+        unsigned int misses = 0;
+        while (current <= match_start_limit) {
+            uint32_t sequence = read_u32(current);
+            unsigned int hash = hash_sequence(sequence);
+            const uint8_t *match = src + positions[hash];
+            positions[hash] = (int32_t) (current - src);
+            if (match >= current || current - match > MAX_OFFSET || read_u32(match) != sequence) {
+                // Skip faster through data that doesn't compress
+                current += 1 + (misses++ >> SKIP_TRIGGER);
+                continue;
+            }
+            misses = 0;
+            while (current > anchor && match > src && current[-1] == match[-1]) {
+                current--;
+                match--;
+            }
+            const uint8_t *match_end = current + MIN_MATCH;
+            const uint8_t *reference = match + MIN_MATCH;
+            while (match_end < match_end_limit && *match_end == *reference) {
+                match_end++;
+                reference++;
+            }
+            size_t literal_length = current - anchor;
+            size_t match_length = match_end - current - MIN_MATCH;
+            if (sequence_size(literal_length, match_length) > (size_t) (dst_end - dst)) {
+                return 0;
+            }
+            uint8_t *token = dst++;
+            dst = write_literals(dst, token, anchor, literal_length);
+            size_t offset = current - match;
+            *dst++ = (uint8_t) (offset & 0xff);
+            *dst++ = (uint8_t) (offset >> 8);
+            if (match_length >= RUN_MASK) {
+                *token |= RUN_MASK;
+                dst = write_length(dst, match_length - RUN_MASK);
+            } else {
+                *token |= (uint8_t) match_length;
+            }
+            current = match_end;
+            anchor = current;
+            if (current - 2 > src) {
+                positions[hash_sequence(read_u32(current - 2))] = (int32_t) (current - 2 - src);
+            }
+        }
+    }
+    size_t literal_length = src_end - anchor;
+    if (1 + (literal_length / 255 + 1) + literal_length > (size_t) (dst_end - dst)) {
+        return 0;
+    }
+    uint8_t *token = dst++;
+    dst = write_literals(dst, token, anchor, literal_length);
+    return (int) (dst - (uint8_t *) output_buffer);
+}
+
+int lz4_decompress(const void *input_buffer, int input_length, void *output_buffer, int output_length)
+{
+    const uint8_t *src = input_buffer;
+    const uint8_t *src_end = src + input_length;
+    uint8_t *dst = output_buffer;
+    uint8_t *dst_end = dst + output_length;
+
+    while (src < src_end) {
+        uint8_t token = *src++;
+        size_t length = token >> 4;
+        if (length == RUN_MASK && !read_length(&src, src_end, &length)) {
+            return 0;
+        }
+        if (length > (size_t) (src_end - src) || length > (size_t) (dst_end - dst)) {
+            return 0;
+        }
+        memcpy(dst, src, length);
+        dst += length;
+        src += length;
+        if (src == src_end) {
+            // The last sequence only has literals
+            break;
+        }
+        if (src_end - src < 2) {
+            return 0;
+        }
+        size_t offset = src[0] | (src[1] << 8);
+        src += 2;
+        if (!offset || offset > (size_t) (dst - (uint8_t *) output_buffer)) {
+            return 0;
+        }
+        length = token & RUN_MASK;
+        if (length == RUN_MASK && !read_length(&src, src_end, &length)) {
+            return 0;
+        }
+        length += MIN_MATCH;
+        if (length > (size_t) (dst_end - dst)) {
+            return 0;
+        }
+        const uint8_t *match = dst - offset;
+        if (offset >= length) {
+            memcpy(dst, match, length);
+            dst += length;
+        } else {
+            // Overlapping match: repeats the last offset bytes
+            while (length--) {
+                *dst++ = *match++;
+            }
+        }
+    }
+    return dst == dst_end;
+}
@@ -0,0 +1,37 @@
+#ifndef CORE_LZ4_H
+#define CORE_LZ4_H
+
+/**
+ * @file
+ * Fast compression using the LZ4 block format.
+ * Trades compression ratio for speed: both compressing and decompressing are much faster than deflate.
+ */
+
+/**
+ * Gets the maximum size of the compressed data for an input of the given length
+ * @param input_length Length of the data to compress
+ * @return The worst-case compressed size
+ */
+int lz4_compress_bound(int input_length);
+
+/**
+ * Compresses the input buffer
+ * @param input_buffer Input buffer to compress
+ * @param input_length Length of the input buffer
+ * @param output_buffer Output buffer to write compressed data to
+ * @param output_length Available length of the output buffer
+ * @return The length of the compressed data, or 0 if it doesn't fit in the output buffer
+ */
+int lz4_compress(const void *input_buffer, int input_length, void *output_buffer, int output_length);
+
+/**
+ * Decompresses the input buffer
+ * @param input_buffer Input buffer to decompress
+ * @param input_length Length of the input buffer
+ * @param output_buffer Output buffer to write decompressed data to
+ * @param output_length Exact length of the decompressed data
+ * @return boolean true on success, false on corrupt data or if the output length does not match
+ */
+int lz4_decompress(const void *input_buffer, int input_length, void *output_buffer, int output_length);
+
+#endif // CORE_LZ4_H
@@ -0,0 +1,81 @@
+#include "memory_arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define BLOCK_SIZE (1024 * 1024)
+#define ALIGNMENT 16
+#define ALIGN(size) (((size) + ALIGNMENT - 1) & ~((size_t) ALIGNMENT - 1))
+
+struct memory_arena_block {
+    memory_arena_block *next;
+    size_t size;
+};
+
+static uint8_t *block_data(memory_arena_block *block)
+{
+    return (uint8_t *) block + ALIGN(sizeof(memory_arena_block));
+}
+
+static memory_arena_block *add_block(memory_arena *arena, size_t size)
+{
+    if (size < BLOCK_SIZE) {
+        size = BLOCK_SIZE;
+    }
+    memory_arena_block *block = malloc(ALIGN(sizeof(memory_arena_block)) + size);
+    if (!block) {
+        return 0;
+    }
+    block->next = 0;
+    block->size = size;
+    if (arena->last) {
+        arena->last->next = block;
+    } else {
+        arena->first = block;
+    }
+    arena->last = block;
+    return block;
+}
+
+void *core_memory_arena_alloc(memory_arena *arena, size_t size)
+{
+    size = ALIGN(size ? size : 1);
+    // Blocks kept from before the last reset are reused in order; a block too small is skipped for this round
+    while (arena->current && arena->used + size > arena->current->size) {
+        arena->current = arena->current->next;
+        arena->used = 0;
+    }
+    if (!arena->current) {
+        arena->current = add_block(arena, size);
+        if (!arena->current) {
+            // Stay at the end of the last block, so later allocations also try to add a block
+            arena->current = arena->last;
+            arena->used = arena->last ? arena->last->size : 0;
+            return 0;
+        }
+        arena->used = 0;
+    }
+    void *memory = block_data(arena->current) + arena->used;
+    arena->used += size;
+    return memory;
+}
+
+void core_memory_arena_reset(memory_arena *arena)
+{
+    arena->current = arena->first;
+    arena->used = 0;
+}
+
+void core_memory_arena_free(memory_arena *arena)
+{
+    memory_arena_block *block = arena->first;
+    while (block) {
+        memory_arena_block *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->first = 0;
+    arena->current = 0;
+    arena->last = 0;
+    arena->used = 0;
+}
@@ -0,0 +1,45 @@
+#ifndef CORE_MEMORY_ARENA_H
+#define CORE_MEMORY_ARENA_H
+
+#include <stddef.h>
+
+/**
+ * @file
+ * Bump allocator for short-lived memory that is thrown away all at once.
+ *
+ * Memory is handed out from large blocks that are kept when the arena is reset,
+ * so the same work done again does not touch the heap.
+ * A zero-initialized arena is ready to use.
+ */
+
+typedef struct memory_arena_block memory_arena_block;
+
+typedef struct {
+    memory_arena_block *first;
+    memory_arena_block *current;
+    memory_arena_block *last;
+    size_t used;
+} memory_arena;
+
+/**
+ * Allocates memory from the arena. The memory is not initialized
+ * @param arena The arena
+ * @param size Number of bytes to allocate
+ * @return Pointer to the memory, or 0 when no memory is available
+ */
+void *core_memory_arena_alloc(memory_arena *arena, size_t size);
+
+/**
+ * Marks all memory of the arena as unused, keeping the blocks for later allocations.
+ * All pointers previously returned by the arena become invalid
+ * @param arena The arena
+ */
+void core_memory_arena_reset(memory_arena *arena);
+
+/**
+ * Returns all memory of the arena to the system
+ * @param arena The arena
+ */
+void core_memory_arena_free(memory_arena *arena);
+
+#endif // CORE_MEMORY_ARENA_H
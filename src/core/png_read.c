@@ -1,5 +1,6 @@
 #include "core/png_read.h"
 
+#include "core/color_convert.h"
 #include "core/dir.h"
 #include "core/file.h"
 #include "core/log.h"
@@ -11,167 +12,150 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define BYTES_PER_PIXEL 4
-
-typedef enum {
-    CACHE_TYPE_NONE = 0,
-    CACHE_TYPE_FILE,
-    CACHE_TYPE_MEMORY
-} cache_type;
-
 static struct {
-    spng_ctx *ctx;
-    FILE *fp;
-    struct {
-        cache_type type;
-        char path[FILE_NAME_MAX];
-        const uint8_t *buffer;
-        int width;
-        int height;
-        color_t *pixels;
-    } cache;
-} data;
+    png_reader reader;
+    png_reader *current;
+    png_reader *decoded_files;
+    int total_decoded_files;
+} data = { .current = &data.reader };
 
-int png_load_from_file(const char *path, int is_asset)
+int png_reader_load_from_file(png_reader *reader, const char *path, int is_asset)
 {
-    if (data.cache.type == CACHE_TYPE_FILE && strcmp(path, data.cache.path) == 0) {
+    if (reader->cache.type == PNG_SOURCE_FILE && strcmp(path, reader->cache.path) == 0) {
         return 1;
     }
-    png_unload();
-    data.fp = is_asset ? file_open_asset(path, "rb") : file_open(path, "rb");
-    if (!data.fp) {
+    png_reader_unload(reader);
+    reader->fp = is_asset ? file_open_asset(path, "rb") : file_open(path, "rb");
+    if (!reader->fp) {
         log_error("Unable to open png file", path, 0);
         return 0;
     }
-    data.ctx = spng_ctx_new(0);
-    if (!data.ctx) {
+    reader->ctx = spng_ctx_new(0);
+    if (!reader->ctx) {
         log_error("Unable to create a png handle context", 0, 0);
-        png_unload();
+        png_reader_unload(reader);
         return 0;
     }
-    if (spng_set_png_file(data.ctx, data.fp)) {
+    if (spng_set_png_file(reader->ctx, reader->fp)) {
         log_error("Unable to set png file stream", 0, 0);
-        png_unload();
+        png_reader_unload(reader);
         return 0;
     }
-    data.cache.type = CACHE_TYPE_FILE;
-    snprintf(data.cache.path, FILE_NAME_MAX, "%s", path);
+    reader->cache.type = PNG_SOURCE_FILE;
+    snprintf(reader->cache.path, FILE_NAME_MAX, "%s", path);
     return 1;
 }
 
-int png_load_from_buffer(const uint8_t *buffer, size_t length)
+int png_reader_load_from_buffer(png_reader *reader, const uint8_t *buffer, size_t length)
 {
-    if (data.cache.type == CACHE_TYPE_MEMORY && buffer == data.cache.buffer) {
+    if (reader->cache.type == PNG_SOURCE_MEMORY && buffer == reader->cache.buffer) {
         return 1;
     }
-    png_unload();
+    png_reader_unload(reader);
     if (!buffer) {
         log_error("Unable to open png file - no buffer provided", 0, 0);
         return 0;
     }
-    data.ctx = spng_ctx_new(0);
-    if (!data.ctx) {
+    reader->ctx = spng_ctx_new(0);
+    if (!reader->ctx) {
         log_error("Unable to create a png handle context", 0, 0);
-        png_unload();
+        png_reader_unload(reader);
         return 0;
     }
-    if (spng_set_png_buffer(data.ctx, buffer, length)) {
+    if (spng_set_png_buffer(reader->ctx, buffer, length)) {
         log_error("Unable to set png buffer", 0, 0);
-        png_unload();
+        png_reader_unload(reader);
         return 0;
     }
-    data.cache.type = CACHE_TYPE_MEMORY;
-    data.cache.buffer = buffer;
+    reader->cache.type = PNG_SOURCE_MEMORY;
+    reader->cache.buffer = buffer;
     return 1;
 }
 
-int png_get_image_size(int *width, int *height)
+int png_reader_get_image_size(png_reader *reader, int *width, int *height)
 {
-    if (data.cache.width && data.cache.height) {
-        *width = data.cache.width;
-        *height = data.cache.height;
+    if (reader->cache.width && reader->cache.height) {
+        *width = reader->cache.width;
+        *height = reader->cache.height;
         return 1;
     }
     *width = 0;
     *height = 0;
-    if (!data.ctx) {
+    if (!reader->ctx) {
         return 0;
     }
     struct spng_ihdr ihdr;
-    if (spng_get_ihdr(data.ctx, &ihdr)) {
+    if (spng_get_ihdr(reader->ctx, &ihdr)) {
         return 0;
     }
-    data.cache.width = *width = (int) ihdr.width;
-    data.cache.height = *height = (int) ihdr.height;
+    reader->cache.width = *width = (int) ihdr.width;
+    reader->cache.height = *height = (int) ihdr.height;
 
     return 1;
 }
 
-static void convert_image_to_argb(color_t *pixels, int total_pixels)
-{
-    uint8_t *src = (uint8_t *) pixels;
-    for (int i = 0; i < total_pixels; ++i) {
-        color_t pixel = ((color_t) * (src + 0)) << COLOR_BITSHIFT_RED;
-        pixel |= ((color_t) * (src + 1)) << COLOR_BITSHIFT_GREEN;
-        pixel |= ((color_t) * (src + 2)) << COLOR_BITSHIFT_BLUE;
-        pixel |= ((color_t) * (src + 3)) << COLOR_BITSHIFT_ALPHA;
-        *pixels = pixel;
-        pixels++;
-        src += BYTES_PER_PIXEL;
-    }
-}
-
-static void close_png(void)
+static void close_png(png_reader *reader)
 {
-    spng_ctx_free(data.ctx);
-    data.ctx = 0;
-    if (data.fp) {
-        file_close(data.fp);
-        data.fp = 0;
+    spng_ctx_free(reader->ctx);
+    reader->ctx = 0;
+    if (reader->fp) {
+        file_close(reader->fp);
+        reader->fp = 0;
     }
 }
 
-static int load_image(void)
+static int load_image(png_reader *reader)
 {
     size_t image_size;
-    if (spng_decoded_image_size(data.ctx, SPNG_FMT_RGBA8, &image_size)) {
+    if (spng_decoded_image_size(reader->ctx, SPNG_FMT_RGBA8, &image_size)) {
         log_error("Unable to retrieve png image size", 0, 0);
-        png_unload();
+        png_reader_unload(reader);
         return 0;
     }
-    int total_pixels = data.cache.width * data.cache.height;
-    data.cache.pixels = malloc(image_size);
-    if (!data.cache.pixels) {
+    int total_pixels = reader->cache.width * reader->cache.height;
+    reader->cache.pixels = malloc(image_size);
+    if (!reader->cache.pixels) {
         log_error("Unable to load png file. Out of memory", 0, 0);
-        png_unload();
+        png_reader_unload(reader);
         return 0;
     }
-    if (spng_decode_image(data.ctx, data.cache.pixels, image_size, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS)) {
+    if (spng_decode_image(reader->ctx, reader->cache.pixels, image_size, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS)) {
         log_error("Unable to start decoding png file", 0, 0);
-        png_unload();
+        png_reader_unload(reader);
         return 0;
     }
-    convert_image_to_argb(data.cache.pixels, total_pixels);
-    close_png();
+    color_convert_rgba_to_argb(reader->cache.pixels, total_pixels);
+    close_png(reader);
     return 1;
 }
 
-static void set_pixels(color_t *pixels,
+int png_reader_decode(png_reader *reader)
+{
+    if (reader->cache.pixels) {
+        return 1;
+    }
+    if (!reader->ctx) {
+        return 0;
+    }
+    return png_reader_get_image_size(reader, &reader->cache.width, &reader->cache.height) && load_image(reader);
+}
+
+static void set_pixels(const png_reader *reader, color_t *pixels,
     int src_x, int src_y, int width, int height, int dst_x, int dst_y, int dst_row_width, int rotate)
 {
-    int readable_height = (height + src_y <= data.cache.height) ?
-        height : (data.cache.height - src_y);
-    int readable_width = (width + src_x <= data.cache.width) ? width : (data.cache.width - src_x);
+    int readable_height = (height + src_y <= reader->cache.height) ?
+        height : (reader->cache.height - src_y);
+    int readable_width = (width + src_x <= reader->cache.width) ? width : (reader->cache.width - src_x);
 
     if (!rotate) {
         for (int y = 0; y < readable_height; y++) {
             memcpy(&pixels[(y + dst_y) * dst_row_width + dst_x],
-                &data.cache.pixels[(src_y + y) * data.cache.width + src_x],
+                &reader->cache.pixels[(src_y + y) * reader->cache.width + src_x],
                 readable_width * sizeof(color_t));
         }
     } else {
         for (int y = 0; y < readable_height; y++) {
-            color_t *src_pixel = &data.cache.pixels[(src_y + y) * data.cache.width + src_x];
+            const color_t *src_pixel = &reader->cache.pixels[(src_y + y) * reader->cache.width + src_x];
             color_t *dst_pixel = &pixels[(dst_y + width - 1) *
                 dst_row_width + y + dst_x];
             for (int x = 0; x < readable_width; x++) {
@@ -182,24 +166,62 @@ static void set_pixels(color_t *pixels,
     }
 }
 
-int png_read(color_t *pixels, int src_x, int src_y, int width, int height,
+int png_reader_read(png_reader *reader, color_t *pixels, int src_x, int src_y, int width, int height,
     int dst_x, int dst_y, int dst_row_width, int rotate)
 {
-    if (!data.cache.pixels) {
-        if (!data.ctx) {
-            return 0;
-        }
-        if (!png_get_image_size(&data.cache.width, &data.cache.height) || !load_image()) {
-            return 0;
-        }
+    if (!png_reader_decode(reader)) {
+        return 0;
     }
-    set_pixels(pixels, src_x, src_y, width, height, dst_x, dst_y, dst_row_width, rotate);
+    set_pixels(reader, pixels, src_x, src_y, width, height, dst_x, dst_y, dst_row_width, rotate);
     return 1;
 }
 
+void png_reader_unload(png_reader *reader)
+{
+    close_png(reader);
+    free(reader->cache.pixels);
+    memset(&reader->cache, 0, sizeof(reader->cache));
+}
+
+int png_load_from_file(const char *path, int is_asset)
+{
+    for (int i = 0; i < data.total_decoded_files; i++) {
+        png_reader *reader = &data.decoded_files[i];
+        if (reader->cache.pixels && strcmp(path, reader->cache.path) == 0) {
+            data.current = reader;
+            return 1;
+        }
+    }
+    data.current = &data.reader;
+    return png_reader_load_from_file(&data.reader, path, is_asset);
+}
+
+int png_load_from_buffer(const uint8_t *buffer, size_t length)
+{
+    data.current = &data.reader;
+    return png_reader_load_from_buffer(&data.reader, buffer, length);
+}
+
+int png_get_image_size(int *width, int *height)
+{
+    return png_reader_get_image_size(data.current, width, height);
+}
+
+int png_read(color_t *pixels, int src_x, int src_y, int width, int height,
+    int dst_x, int dst_y, int dst_row_width, int rotate)
+{
+    return png_reader_read(data.current, pixels, src_x, src_y, width, height, dst_x, dst_y, dst_row_width, rotate);
+}
+
 void png_unload(void)
 {
-    close_png();
-    free(data.cache.pixels);
-    memset(&data.cache, 0, sizeof(data.cache));
+    png_reader_unload(&data.reader);
+    data.current = &data.reader;
+}
+
+void png_use_decoded_files(png_reader *readers, int total_readers)
+{
+    data.decoded_files = readers;
+    data.total_decoded_files = total_readers;
+    data.current = &data.reader;
 }
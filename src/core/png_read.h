@@ -1,10 +1,56 @@
 #ifndef CORE_PNG_H
 #define CORE_PNG_H
 
+#include "core/file.h"
 #include "graphics/color.h"
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
+
+typedef enum {
+    PNG_SOURCE_NONE = 0,
+    PNG_SOURCE_FILE,
+    PNG_SOURCE_MEMORY
+} png_source_type;
+
+/**
+ * State of a single PNG image being read. Different readers can be used from different threads at the same time.
+ * A reader must start zeroed and be released with png_reader_unload.
+ */
+typedef struct {
+    struct spng_ctx *ctx;
+    FILE *fp;
+    struct {
+        png_source_type type;
+        char path[FILE_NAME_MAX];
+        const uint8_t *buffer;
+        int width;
+        int height;
+        color_t *pixels;
+    } cache;
+} png_reader;
+
+int png_reader_load_from_file(png_reader *reader, const char *path, int is_asset);
+int png_reader_load_from_buffer(png_reader *reader, const uint8_t *buffer, size_t length);
+
+int png_reader_get_image_size(png_reader *reader, int *width, int *height);
+
+/**
+ * Decodes the whole image, so later reads only copy the pixels
+ * @param reader The reader, with a file or buffer already loaded
+ * @return Boolean true if the image was decoded, false otherwise
+ */
+int png_reader_decode(png_reader *reader);
+
+int png_reader_read(png_reader *reader, color_t *pixels, int src_x, int src_y, int width, int height,
+    int dst_x, int dst_y, int dst_row_width, int rotate);
+
+void png_reader_unload(png_reader *reader);
+
+/**
+ * The functions below use a single shared reader and may only be called from the main thread.
+ */
 
 int png_load_from_file(const char *path, int is_asset);
 int png_load_from_buffer(const uint8_t *buffer, size_t length);
@@ -16,4 +62,12 @@ int png_read(color_t *pixels, int src_x, int src_y, int width, int height,
 
 void png_unload(void);
 
+/**
+ * Makes png_load_from_file use already decoded files instead of opening them again.
+ * The readers stay owned by the caller, who must call this again with no readers before releasing them.
+ * @param readers The readers with the decoded files, matched by path
+ * @param total_readers The number of readers, or 0 to stop using them
+ */
+void png_use_decoded_files(png_reader *readers, int total_readers);
+
 #endif // CORE_PNG_H
@@ -0,0 +1,98 @@
+#ifndef CORE_THREAD_H
+#define CORE_THREAD_H
+
+#include <stdint.h>
+
+/**
+ * @file
+ * Threading primitives. These functions should be implemented by the underlying platform.
+ */
+
+typedef struct thread_handle thread_handle;
+typedef struct thread_mutex thread_mutex;
+typedef struct thread_condition thread_condition;
+
+/**
+ * Creates and starts a new thread
+ * @param function The function to run in the new thread
+ * @param name The name of the thread, for debugging purposes
+ * @param data Data to pass to the function
+ * @return The thread handle, or 0 if the thread could not be created
+ */
+thread_handle *thread_create(int (*function)(void *), const char *name, void *data);
+
+/**
+ * Waits for a thread to finish and releases its resources
+ * @param thread The thread to wait for
+ * @return The return value of the thread function
+ */
+int thread_wait(thread_handle *thread);
+
+/**
+ * Gets the number of logical CPU cores available
+ * @return The number of logical cores, at least 1
+ */
+int thread_cpu_count(void);
+
+/**
+ * Gets an identifier of the calling thread, which differs from those of the other running threads
+ * @return The identifier of the thread
+ */
+uint64_t thread_current_id(void);
+
+/**
+ * Creates a new mutex
+ * @return The mutex, or 0 on error
+ */
+thread_mutex *thread_mutex_create(void);
+
+/**
+ * Locks a mutex, waiting if it is locked by another thread
+ * @param mutex The mutex to lock
+ */
+void thread_mutex_lock(thread_mutex *mutex);
+
+/**
+ * Unlocks a mutex
+ * @param mutex The mutex to unlock
+ */
+void thread_mutex_unlock(thread_mutex *mutex);
+
+/**
+ * Destroys a mutex
+ * @param mutex The mutex to destroy
+ */
+void thread_mutex_destroy(thread_mutex *mutex);
+
+/**
+ * Creates a new condition variable
+ * @return The condition variable, or 0 on error
+ */
+thread_condition *thread_condition_create(void);
+
+/**
+ * Waits on a condition variable. The mutex must be locked and will be locked again when the function returns
+ * @param condition The condition variable to wait on
+ * @param mutex The locked mutex that protects the condition
+ */
+void thread_condition_wait(thread_condition *condition, thread_mutex *mutex);
+
+/**
+ * Wakes up one thread waiting on the condition variable
+ * @param condition The condition variable
+ */
+void thread_condition_signal(thread_condition *condition);
+
+/**
+ * Wakes up all threads waiting on the condition variable
+ * @param condition The condition variable
+ */
+void thread_condition_broadcast(thread_condition *condition);
+
+/**
+ * Destroys a condition variable
+ * @param condition The condition variable to destroy
+ */
+void thread_condition_destroy(thread_condition *condition);
+
+#endif // CORE_THREAD_H
@@ -0,0 +1,276 @@
+#include "thread_pool.h"
+
+#include "core/log.h"
+#include "core/thread.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MAX_WORKERS 15
+
+static struct {
+    int initialized;
+    int stopping;
+    int num_workers;
+    thread_handle *workers[MAX_WORKERS];
+    thread_mutex *mutex;
+    thread_condition *work_available;
+    thread_condition *work_finished;
+    thread_pool_job *first;
+    thread_pool_job *last;
+} data;
+
+static void add_to_queue(thread_pool_job *job)
+{
+    job->next_in_queue = 0;
+    if (data.last) {
+        data.last->next_in_queue = job;
+    } else {
+        data.first = job;
+    }
+    data.last = job;
+}
+
+static void remove_from_queue(thread_pool_job *job)
+{
+    thread_pool_job *previous = 0;
+    for (thread_pool_job *current = data.first; current; current = current->next_in_queue) {
+        if (current != job) {
+            previous = current;
+            continue;
+        }
+        if (previous) {
+            previous->next_in_queue = job->next_in_queue;
+        } else {
+            data.first = job->next_in_queue;
+        }
+        if (data.last == job) {
+            data.last = previous;
+        }
+        job->next_in_queue = 0;
+        return;
+    }
+}
+
+// Must be called with the mutex locked
+static int claim_item(thread_pool_job *job, void **item)
+{
+    if (job->next >= job->total) {
+        return 0;
+    }
+    *item = job->items + job->next * job->item_size;
+    job->next++;
+    if (job->next == job->total) {
+        remove_from_queue(job);
+    }
+    return 1;
+}
+
+// Must be called with the mutex locked. The job may be released by its owner as soon as this returns
+static void finish_item(thread_pool_job *job)
+{
+    job->remaining--;
+    if (!job->remaining) {
+        thread_condition_broadcast(data.work_finished);
+    }
+}
+
+static int run_worker(void *unused)
+{
+    thread_mutex_lock(data.mutex);
+    while (1) {
+        while (!data.first && !data.stopping) {
+            thread_condition_wait(data.work_available, data.mutex);
+        }
+        // The queued jobs are still run when stopping, so that their owners can finish them
+        if (!data.first) {
+            break;
+        }
+        thread_pool_job *job = data.first;
+        void *item;
+        claim_item(job, &item);
+        thread_mutex_unlock(data.mutex);
+        job->task(item);
+        thread_mutex_lock(data.mutex);
+        finish_item(job);
+    }
+    thread_mutex_unlock(data.mutex);
+    return 0;
+}
+
+static void destroy_sync_objects(void)
+{
+    if (data.mutex) {
+        thread_mutex_destroy(data.mutex);
+        data.mutex = 0;
+    }
+    if (data.work_available) {
+        thread_condition_destroy(data.work_available);
+        data.work_available = 0;
+    }
+    if (data.work_finished) {
+        thread_condition_destroy(data.work_finished);
+        data.work_finished = 0;
+    }
+}
+
+int thread_pool_init(void)
+{
+    if (data.initialized) {
+        return data.num_workers > 0;
+    }
+    data.initialized = 1;
+    int workers = thread_cpu_count() - 1;
+    if (workers > MAX_WORKERS) {
+        workers = MAX_WORKERS;
+    }
+    if (workers <= 0) {
+        return 0;
+    }
+    data.mutex = thread_mutex_create();
+    data.work_available = thread_condition_create();
+    data.work_finished = thread_condition_create();
+    if (!data.mutex || !data.work_available || !data.work_finished) {
+        log_error("Unable to create worker pool, tasks will run on a single thread", 0, 0);
+        destroy_sync_objects();
+        return 0;
+    }
+    for (int i = 0; i < workers; i++) {
+        data.workers[i] = thread_create(run_worker, "worker", 0);
+        if (!data.workers[i]) {
+            break;
+        }
+        data.num_workers++;
+    }
+    if (!data.num_workers) {
+        log_error("Unable to create worker threads, tasks will run on a single thread", 0, 0);
+        destroy_sync_objects();
+        return 0;
+    }
+    log_info("Worker threads created:", 0, data.num_workers);
+    return 1;
+}
+
+void thread_pool_shutdown(void)
+{
+    if (data.num_workers) {
+        thread_mutex_lock(data.mutex);
+        data.stopping = 1;
+        thread_condition_broadcast(data.work_available);
+        thread_mutex_unlock(data.mutex);
+        for (int i = 0; i < data.num_workers; i++) {
+            thread_wait(data.workers[i]);
+            data.workers[i] = 0;
+        }
+        data.num_workers = 0;
+        data.stopping = 0;
+        destroy_sync_objects();
+    }
+    data.initialized = 0;
+}
+
+void thread_pool_run_for_each(thread_pool_task task, void *items, size_t item_size, unsigned int total_items)
+{
+    if (!total_items) {
+        return;
+    }
+    if (total_items == 1 || !data.num_workers) {
+        for (unsigned int i = 0; i < total_items; i++) {
+            task((uint8_t *) items + i * item_size);
+        }
+        return;
+    }
+    thread_pool_job job = { task, items, item_size, total_items, 0, total_items, 0 };
+
+    thread_mutex_lock(data.mutex);
+    add_to_queue(&job);
+    thread_condition_broadcast(data.work_available);
+
+    void *item;
+    while (claim_item(&job, &item)) {
+        thread_mutex_unlock(data.mutex);
+        task(item);
+        thread_mutex_lock(data.mutex);
+        finish_item(&job);
+    }
+    while (job.remaining) {
+        thread_condition_wait(data.work_finished, data.mutex);
+    }
+    thread_mutex_unlock(data.mutex);
+}
+
+void thread_pool_start_job_in(thread_pool_job *job, thread_pool_task task, void *item)
+{
+    job->task = task;
+    job->items = item;
+    job->item_size = 0;
+    job->total = 1;
+    job->next = 0;
+    job->remaining = 1;
+    job->next_in_queue = 0;
+
+    if (!data.num_workers) {
+        job->next = 1;
+        task(item);
+        job->remaining = 0;
+        return;
+    }
+    thread_mutex_lock(data.mutex);
+    add_to_queue(job);
+    thread_condition_signal(data.work_available);
+    thread_mutex_unlock(data.mutex);
+}
+
+thread_pool_job *thread_pool_start_job(thread_pool_task task, void *item)
+{
+    thread_pool_job *job = malloc(sizeof(thread_pool_job));
+    if (!job) {
+        return 0;
+    }
+    thread_pool_start_job_in(job, task, item);
+    return job;
+}
+
+int thread_pool_job_is_done(thread_pool_job *job)
+{
+    if (!data.num_workers) {
+        return !job->remaining;
+    }
+    thread_mutex_lock(data.mutex);
+    int done = !job->remaining;
+    thread_mutex_unlock(data.mutex);
+    return done;
+}
+
+void thread_pool_wait_for_job(thread_pool_job *job)
+{
+    if (data.num_workers) {
+        thread_mutex_lock(data.mutex);
+        // If no worker picked up the job yet, run it here instead of waiting
+        void *item;
+        if (claim_item(job, &item)) {
+            thread_mutex_unlock(data.mutex);
+            job->task(item);
+            thread_mutex_lock(data.mutex);
+            finish_item(job);
+        }
+        while (job->remaining) {
+            thread_condition_wait(data.work_finished, data.mutex);
+        }
+        thread_mutex_unlock(data.mutex);
+    }
+}
+
+void thread_pool_finish_job(thread_pool_job *job)
+{
+    if (!job) {
+        return;
+    }
+    thread_pool_wait_for_job(job);
+    free(job);
+}
+
+int thread_pool_total_workers(void)
+{
+    return data.num_workers;
+}
@@ -0,0 +1,103 @@
+#ifndef CORE_THREAD_POOL_H
+#define CORE_THREAD_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file
+ * Pool of worker threads to run independent tasks in parallel.
+ *
+ * The workers are created by thread_pool_init, one less than the number of CPU cores.
+ * Until then, after thread_pool_shutdown, or if no workers can be created, every task is run synchronously
+ * on the calling thread.
+ */
+
+/**
+ * A task to run on the pool
+ * @param item The item to process
+ */
+typedef void (*thread_pool_task)(void *item);
+
+typedef struct thread_pool_job thread_pool_job;
+
+/**
+ * A job run by the pool. It is only public so that callers can keep jobs in their own memory,
+ * its fields must not be used outside the pool
+ */
+struct thread_pool_job {
+    thread_pool_task task;
+    uint8_t *items;
+    size_t item_size;
+    unsigned int total;
+    unsigned int next;
+    unsigned int remaining;
+    thread_pool_job *next_in_queue;
+};
+
+/**
+ * Creates the worker threads. Must be called from the main thread, before any task is started
+ * @return Boolean true if there are workers, false if tasks are run synchronously
+ */
+int thread_pool_init(void);
+
+/**
+ * Runs the jobs that are still queued, then stops the worker threads and waits for them to exit.
+ * Must be called from the main thread, and no task may be started while it runs
+ */
+void thread_pool_shutdown(void);
+
+/**
+ * Runs a task for every item of an array, spreading the items over the worker threads.
+ * The calling thread also processes items, and the function only returns when all items are done.
+ * It is safe to call this function from within a running task.
+ * @param task The task to run
+ * @param items The array of items
+ * @param item_size The size of each item, in bytes
+ * @param total_items The number of items in the array
+ */
+void thread_pool_run_for_each(thread_pool_task task, void *items, size_t item_size, unsigned int total_items);
+
+/**
+ * Starts running a task in the background
+ * @param task The task to run
+ * @param item The item to pass to the task
+ * @return The job, which must always be finished with thread_pool_finish_job, or 0 on memory error
+ */
+thread_pool_job *thread_pool_start_job(thread_pool_task task, void *item);
+
+/**
+ * Starts running a task in the background, keeping the job in memory owned by the caller, so nothing is allocated
+ * @param job The memory for the job, which must be kept until the job is waited for with thread_pool_wait_for_job
+ * @param task The task to run
+ * @param item The item to pass to the task
+ */
+void thread_pool_start_job_in(thread_pool_job *job, thread_pool_task task, void *item);
+
+/**
+ * Waits for a background job started with thread_pool_start_job_in to finish.
+ * Afterwards the memory of the job can be reused
+ * @param job The job to wait for
+ */
+void thread_pool_wait_for_job(thread_pool_job *job);
+
+/**
+ * Checks whether a background job has finished running, without waiting for it
+ * @param job The job to check
+ * @return Whether the job is done
+ */
+int thread_pool_job_is_done(thread_pool_job *job);
+
+/**
+ * Waits for a background job to finish and releases it
+ * @param job The job to finish
+ */
+void thread_pool_finish_job(thread_pool_job *job);
+
+/**
+ * Gets the number of worker threads available to the pool
+ * @return The number of workers, or 0 if tasks are run synchronously
+ */
+int thread_pool_total_workers(void);
+
+#endif // CORE_THREAD_POOL_H
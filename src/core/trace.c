@@ -0,0 +1,167 @@
+#include "trace.h"
+
+#include "core/file.h"
+#include "core/log.h"
+#include "core/thread.h"
+#include "game/system.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_EVENTS 256
+#define MAX_OPEN_SPANS 32
+#define MAX_THREADS 8
+
+typedef struct {
+    const char *name;
+    uint64_t start;
+    uint64_t duration;
+    int thread;
+} trace_event;
+
+typedef struct {
+    uint64_t id;
+    int open_spans[MAX_OPEN_SPANS];
+    int num_open_spans;
+} trace_thread;
+
+// Created once and never destroyed, so a thread still tracing while the trace finishes can safely use it
+static thread_mutex *mutex;
+
+static struct {
+    int active;
+    char filename[FILE_NAME_MAX];
+    uint64_t start_time;
+    trace_event events[MAX_EVENTS];
+    int num_events;
+    trace_thread threads[MAX_THREADS];
+    int num_threads;
+} data;
+
+void trace_start(const char *filename)
+{
+    if (!mutex) {
+        mutex = thread_mutex_create();
+        if (!mutex) {
+            log_error("Unable to start the trace", filename, 0);
+            return;
+        }
+    }
+    thread_mutex_lock(mutex);
+    memset(&data, 0, sizeof(data));
+    snprintf(data.filename, FILE_NAME_MAX, "%s", filename);
+    data.start_time = system_get_precise_ticks();
+    // The thread that starts the trace is the first one shown
+    data.threads[0].id = thread_current_id();
+    data.num_threads = 1;
+    data.active = 1;
+    thread_mutex_unlock(mutex);
+}
+
+static trace_thread *get_current_thread(int add)
+{
+    uint64_t id = thread_current_id();
+    for (int i = 0; i < data.num_threads; i++) {
+        if (data.threads[i].id == id) {
+            return &data.threads[i];
+        }
+    }
+    if (!add || data.num_threads >= MAX_THREADS) {
+        return 0;
+    }
+    trace_thread *thread = &data.threads[data.num_threads++];
+    thread->id = id;
+    thread->num_open_spans = 0;
+    return thread;
+}
+
+void trace_begin(const char *name)
+{
+    if (!mutex) {
+        return;
+    }
+    thread_mutex_lock(mutex);
+    trace_thread *thread = data.active && data.num_events < MAX_EVENTS ? get_current_thread(1) : 0;
+    if (thread && thread->num_open_spans < MAX_OPEN_SPANS) {
+        trace_event *event = &data.events[data.num_events];
+        event->name = name;
+        event->start = system_get_precise_ticks() - data.start_time;
+        event->duration = 0;
+        event->thread = (int) (thread - data.threads);
+        thread->open_spans[thread->num_open_spans++] = data.num_events++;
+    }
+    thread_mutex_unlock(mutex);
+}
+
+static void close_spans(trace_thread *thread, int num_open_spans)
+{
+    uint64_t now = system_get_precise_ticks() - data.start_time;
+    while (thread->num_open_spans > num_open_spans) {
+        trace_event *event = &data.events[thread->open_spans[--thread->num_open_spans]];
+        event->duration = now - event->start;
+    }
+}
+
+void trace_end(const char *name)
+{
+    if (!mutex) {
+        return;
+    }
+    thread_mutex_lock(mutex);
+    trace_thread *thread = data.active ? get_current_thread(0) : 0;
+    // Spans left open by an early return are closed along with the span around them
+    for (int i = thread ? thread->num_open_spans - 1 : -1; i >= 0; i--) {
+        if (strcmp(data.events[thread->open_spans[i]].name, name) == 0) {
+            close_spans(thread, i);
+            break;
+        }
+    }
+    thread_mutex_unlock(mutex);
+}
+
+static int write_trace(void)
+{
+    FILE *fp = file_open(data.filename, "w");
+    if (!fp) {
+        log_error("Unable to write trace file", data.filename, 0);
+        return 0;
+    }
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (int i = 0; i < data.num_events; i++) {
+        const trace_event *event = &data.events[i];
+        fprintf(fp, "{\"name\":\"%s\",\"cat\":\"augustus\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%d},\n",
+            event->name, (unsigned long long) event->start, (unsigned long long) event->duration, event->thread + 1);
+    }
+    // The thread that started the trace is shown as the main thread
+    for (int i = 0; i < data.num_threads; i++) {
+        if (i) {
+            fprintf(fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}%s\n",
+                i + 1, i, i < data.num_threads - 1 ? "," : "");
+        } else {
+            fprintf(fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}%s\n",
+                data.num_threads > 1 ? "," : "");
+        }
+    }
+    fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+    file_close(fp);
+    log_info("Trace written to", data.filename, 0);
+    return 1;
+}
+
+int trace_finish(void)
+{
+    if (!mutex) {
+        return 0;
+    }
+    thread_mutex_lock(mutex);
+    int result = 0;
+    if (data.active) {
+        for (int i = 0; i < data.num_threads; i++) {
+            close_spans(&data.threads[i], 0);
+        }
+        data.active = 0;
+        result = write_trace();
+    }
+    thread_mutex_unlock(mutex);
+    return result;
+}
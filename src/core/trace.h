@@ -0,0 +1,38 @@
+#ifndef CORE_TRACE_H
+#define CORE_TRACE_H
+
+/**
+ * @file
+ * Timeline of how long the phases of a task take, written as a Chrome trace-event JSON file.
+ *
+ * The file can be opened with chrome://tracing or https://ui.perfetto.dev. Every thread that opens spans
+ * gets its own track, and a span opened while another one of the same thread is still open is shown
+ * inside it. Nothing is recorded unless trace_start was called, so the spans can stay in the code.
+ */
+
+/**
+ * Starts recording spans. Must be called from the main thread
+ * @param filename The file the trace is written to by trace_finish
+ */
+void trace_start(const char *filename);
+
+/**
+ * Opens a span on the track of the calling thread
+ * @param name The name of the span, which must stay valid until the trace is finished
+ */
+void trace_begin(const char *name);
+
+/**
+ * Closes the innermost span with the name that the calling thread opened,
+ * along with the spans it still has open inside it
+ * @param name The name given to trace_begin
+ */
+void trace_end(const char *name);
+
+/**
+ * Closes the spans that are still open on every thread, writes the trace file and stops recording
+ * @return Boolean true if the file was written, false otherwise
+ */
+int trace_finish(void);
+
+#endif // CORE_TRACE_H
@@ -28,13 +28,13 @@ int zlib_helper_decompress(void *input_buffer, const int input_length, void *out
     return 1;
 }
 
-int zlib_helper_compress(void *input_buffer, const int input_length, void *output_buffer, const int output_buffer_length, int *output_length)
+int zlib_helper_compress(void *input_buffer, const int input_length, void *output_buffer, const int output_buffer_length, int *output_length, int level)
 {
     z_stream strm;
     strm.zalloc = Z_NULL;
     strm.zfree = Z_NULL;
     strm.opaque = Z_NULL;
-    if (deflateInit(&strm, Z_BEST_SPEED) != Z_OK) {
+    if (deflateInit(&strm, level) != Z_OK) {
         return 0;
     }
 
@@ -51,3 +51,8 @@ int zlib_helper_compress(void *input_buffer, const int input_length, void *outpu
     *output_length = output_buffer_length - strm.avail_out;
     return 1;
 }
+
+int zlib_helper_compress_bound(const int input_length)
+{
+    return (int) compressBound(input_length);
+}
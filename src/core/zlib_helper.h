@@ -3,6 +3,11 @@
 
 int zlib_helper_decompress(void *input_buffer, const int input_length, void *output_buffer, const int output_buffer_length, int *output_length);
 
-int zlib_helper_compress(void *input_buffer, const int input_length, void *output_buffer, const int output_buffer_length, int *output_length);
+#define ZLIB_HELPER_BEST_SPEED 1
+#define ZLIB_HELPER_BEST_COMPRESSION 9
+
+int zlib_helper_compress(void *input_buffer, const int input_length, void *output_buffer, const int output_buffer_length, int *output_length, int level);
+
+int zlib_helper_compress_bound(const int input_length);
 
 #endif // CORE_ZLIB_HELPER_H
@@ -38,7 +38,9 @@
 #include "game/campaign.h"
 #include "game/difficulty.h"
 #include "game/file_io.h"
+#include "game/loading.h"
 #include "game/settings.h"
+#include "game/snapshot.h"
 #include "game/state.h"
 #include "game/time.h"
 #include "game/tutorial.h"
@@ -82,6 +84,7 @@
 #include "sound/city.h"
 #include "sound/music.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 static const char MISSION_SAVED_GAMES[][32] = {
@@ -143,6 +146,23 @@ static void clear_scenario_data(void)
     map_random_init();
 }
 
+static int load_climate_images(void)
+{
+    return image_load_climate(scenario_property_climate(), 0, 0, 0);
+}
+
+static int load_enemy_images(void)
+{
+    return image_load_enemy(scenario_property_enemy());
+}
+
+static void load_scenario_images(void)
+{
+    static const game_loading_step steps[] = { load_climate_images, load_enemy_images };
+    int results[2];
+    game_loading_run(steps, results, 2);
+}
+
 static void initialize_scenario_data(const uint8_t *scenario_name)
 {
     scenario_set_name(scenario_name);
@@ -163,8 +183,8 @@ static void initialize_scenario_data(const uint8_t *scenario_name)
     map_tiles_update_all_walls();
     map_tiles_update_all_aqueducts(0);
 
-    // Load climate before to prevent climate related images blinking
-    image_load_climate(scenario_property_climate(), 0, 0, 0);
+    // Load climate and enemy images before to prevent climate related images blinking
+    load_scenario_images();
 
     map_natives_init();
 
@@ -201,7 +221,6 @@ static void initialize_scenario_data(const uint8_t *scenario_name)
     scenario_demand_change_init();
     scenario_price_change_init();
     building_menu_update();
-    image_load_enemy(scenario_property_enemy());
 
     city_data_init_scenario();
 
@@ -301,8 +320,7 @@ static void initialize_saved_game(void)
     city_mission_tutorial_set_fire_message_shown(1);
     city_mission_tutorial_set_disease_message_shown(1);
 
-    image_load_climate(scenario_property_climate(), 0, 0, 0);
-    image_load_enemy(scenario_property_enemy());
+    load_scenario_images();
     city_military_determine_distant_battle_city();
 
     migrate_altar_rotations(); // this has to go after all image loading since it migrates data from image_ids
@@ -323,6 +341,7 @@ static int start_scenario(const uint8_t *scenario_name, const char *scenario_fil
     int mission = scenario_campaign_mission();
     int rank = scenario_campaign_rank();
     map_bookmarks_clear();
+    game_snapshot_clear();
     int is_save_game = 0;
     const char *full_scenario_file = dir_get_file_at_location(scenario_file, PATH_LOCATION_SCENARIO);
     if (!full_scenario_file) {
@@ -374,6 +393,7 @@ int game_file_start_scenario_from_buffer(uint8_t *data, int length, int is_save_
     int mission = scenario_campaign_mission();
     int rank = scenario_campaign_rank();
     map_bookmarks_clear();
+    game_snapshot_clear();
 
     if (is_save_game) {
         if (game_file_io_read_save_game_from_buffer(&buf) != FILE_LOAD_SUCCESS) {
@@ -443,6 +463,16 @@ int game_file_start_scenario_by_name(const uint8_t *scenario_name)
     return start_scenario(scenario_name, get_scenario_filename(scenario_name, "mapx", 1));
 }
 
+// Everything that follows reading a saved game, for both a saved game file and a snapshot
+static void finish_loading_saved_game(void)
+{
+    check_backward_compatibility();
+    initialize_saved_game();
+    building_storage_reset_building_ids();
+
+    sound_music_update(1);
+}
+
 int game_file_load_saved_game(const char *filename)
 {
     game_campaign_suspend();
@@ -454,11 +484,23 @@ int game_file_load_saved_game(const char *filename)
     if (!game_campaign_is_active()) {
         game_campaign_clear();
     }
-    check_backward_compatibility();
-    initialize_saved_game();
-    building_storage_reset_building_ids();
+    game_snapshot_clear();
+    finish_loading_saved_game();
+    return 1;
+}
 
-    sound_music_update(1);
+int game_file_rewind_to_snapshot(void)
+{
+    buffer buf;
+    if (!game_snapshot_pop_latest(&buf)) {
+        return 0;
+    }
+    int result = game_file_io_read_save_game_from_buffer(&buf);
+    free(buf.data);
+    if (result != FILE_LOAD_SUCCESS) {
+        return 0;
+    }
+    finish_loading_saved_game();
     return 1;
 }
 
@@ -467,6 +509,40 @@ int game_file_write_saved_game(const char *filename)
     return game_file_io_write_saved_game(filename);
 }
 
+int game_file_make_monthly_autosave(void)
+{
+    char autosave_name[FILE_NAME_MAX];
+    snprintf(autosave_name, FILE_NAME_MAX, "%s%s",
+        platform_file_manager_get_directory_for_location(PATH_LOCATION_SAVEGAME, 0), "autosave.svx");
+
+    int history = config_get(CONFIG_GENERAL_AUTOSAVE_HISTORY);
+    if (history <= 0) {
+        return game_file_write_saved_game(autosave_name);
+    }
+    int compaction = config_get(CONFIG_GENERAL_AUTOSAVE_COMPACTION);
+    if (compaction <= 0) {
+        compaction = 1;
+    }
+    // Enough bases are kept so that every delta in the history still has its base
+    int total_months = game_time_total_months();
+    int total_bases = history / compaction + 2;
+    int base_slot = (total_months / compaction) % total_bases;
+
+    char base_name[FILE_NAME_MAX];
+    char history_name[FILE_NAME_MAX];
+    snprintf(base_name, FILE_NAME_MAX, "%s%s%d%s",
+        platform_file_manager_get_directory_for_location(PATH_LOCATION_SAVEGAME, 0), "autosave-base-",
+        base_slot, ".svx");
+    snprintf(history_name, FILE_NAME_MAX, "%s%s%d%s",
+        platform_file_manager_get_directory_for_location(PATH_LOCATION_SAVEGAME, 0), "autosave-month-",
+        total_months % history, ".svx");
+
+    if (!game_file_io_write_saved_game_delta(autosave_name, base_name, total_months % compaction == 0)) {
+        return 0;
+    }
+    return platform_file_manager_copy_file(autosave_name, history_name);
+}
+
 int game_file_make_yearly_autosave(void)
 {
     int next_autosave_slot = config_get(CONFIG_GENERAL_NEXT_AUTOSAVE_SLOT);
@@ -34,6 +34,13 @@ int game_file_start_scenario_by_name(const uint8_t *scenario_name);
  */
 int game_file_load_saved_game(const char *filename);
 
+/**
+ * Rewinds the current game to the latest in-memory snapshot, which is then dropped,
+ * so rewinding again goes back one more snapshot
+ * @return Boolean true on success, false if there is no snapshot or it could not be loaded
+ */
+int game_file_rewind_to_snapshot(void);
+
 /**
  * Write saved game to disk
  * @param filename File to save to
@@ -41,6 +48,13 @@ int game_file_load_saved_game(const char *filename);
  */
 int game_file_write_saved_game(const char *filename);
 
+/**
+ * Write the monthly autosave. When a history is kept, only the changes since the last full autosave
+ * are written and the autosave is also kept in a rolling history slot
+ * @return Boolean true on success, false on failure
+ */
+int game_file_make_monthly_autosave(void);
+
 int game_file_make_yearly_autosave(void);
 
 /**
@@ -12,12 +12,15 @@
 #include "city/finance.h"
 #include "city/message.h"
 #include "city/view.h"
+#include "core/config.h"
 #include "core/dir.h"
 #include "core/file.h"
 #include "core/log.h"
-#include "core/memory_block.h"
+#include "core/lz4.h"
+#include "core/memory_arena.h"
 #include "core/random.h"
 #include "core/string.h"
+#include "core/thread_pool.h"
 #include "core/zip.h"
 #include "core/zlib_helper.h"
 #include "empire/city.h"
@@ -33,6 +36,7 @@
 #include "figure/visited_buildings.h"
 #include "game/file.h"
 #include "game/save_version.h"
+#include "game/system.h"
 #include "game/time.h"
 #include "game/tutorial.h"
 #include "map/aqueduct.h"
@@ -78,13 +82,87 @@
 #define GRID_SIZE_BUF_U8 GRID_SIZE * GRID_SIZE
 #define GRID_SIZE_BUF_U16 GRID_SIZE * GRID_SIZE * 2
 #define GRID_SIZE_BUF_U32 GRID_SIZE * GRID_SIZE * 4
+#define DELTA_SAVE_MAGIC "AUGDELTA"
+#define DELTA_SAVE_MAGIC_LENGTH 8
+// The primes of the 64 bit xxHash
+#define HASH_PRIME_1 0x9e3779b185ebca87ull
+#define HASH_PRIME_2 0xc2b2ae3d27d4eb4full
+#define HASH_PRIME_3 0x165667b19e3779f9ull
+#define HASH_PRIME_4 0x85ebca77c2b2ae63ull
+#define HASH_PRIME_5 0x27d4eb2f165667c5ull
+// Limits the size of the pieces compressed at the same time, which bounds the memory held by their output
+#define MAX_BYTES_COMPRESSING 4000000
 
 typedef struct {
     buffer buf;
     int compressed;
     int dynamic;
+    int mapped;
+    uint8_t *arena_data;
+    int skipped;
+    memory_arena *arena;
 } file_piece;
 
+// Stored in the file before every compressed piece, so never change the values
+typedef enum {
+    PIECE_CODEC_ZLIB = 0,
+    PIECE_CODEC_LZ4 = 1,
+    PIECE_CODEC_MAX
+} piece_codec;
+
+typedef enum {
+    PIECE_FORMAT_ZIP = 0,
+    PIECE_FORMAT_ZLIB = 1,
+    PIECE_FORMAT_CODEC_TAGGED = 2
+} piece_format;
+
+typedef struct {
+    file_piece *piece;
+    save_compression compression;
+    uint8_t *output;
+    int capacity;
+    int size;
+    uint64_t time;
+    int compressing;
+    thread_pool_job job;
+} compressed_piece;
+
+/**
+ * Writes the pieces to the file while they are still being created: every piece handed over is
+ * compressed in the background, and the pieces are written in order as soon as they are compressed.
+ * When release_pieces is set, the data of every piece is released once it is written.
+ */
+typedef struct {
+    FILE *fp;
+    file_piece *pieces;
+    int num_pieces;
+    save_compression compression;
+    int write_codec;
+    int release_pieces;
+    compressed_piece *compressed;
+    uint8_t *submitted;
+    int bytes_compressing;
+    int next_to_write;
+    int write_failed;
+    game_file_io_piece_timings *piece_timings;
+} piece_writer;
+
+typedef struct {
+    file_piece *piece;
+    int index;
+    const uint8_t *input;
+    int input_size;
+    piece_format format;
+    piece_codec codec;
+    int result;
+    uint64_t time;
+} decompressed_piece;
+
+typedef struct {
+    const file_piece *piece;
+    uint64_t hash;
+} hashed_piece;
+
 typedef struct {
     buffer *resource_version;
     buffer *graphic_ids;
@@ -123,6 +201,8 @@ static struct {
     int num_pieces;
     file_piece pieces[sizeof(scenario_state) / sizeof(buffer *) + 1];
     scenario_state state;
+    file_mapping file;
+    memory_arena arena;
 } scenario_data;
 
 typedef struct {
@@ -240,6 +320,14 @@ typedef struct {
     buffer *finance_ledger;
 } savegame_state;
 
+typedef void (*grid_loader)(const savegame_state *state, savegame_version_t version);
+
+typedef struct {
+    grid_loader load;
+    const savegame_state *state;
+    savegame_version_t version;
+} grid_loader_task;
+
 typedef struct {
     struct {
         int burning_totals;
@@ -307,8 +395,24 @@ static struct {
     int num_pieces;
     file_piece pieces[sizeof(savegame_state) / sizeof(buffer *) + 1];
     savegame_state state;
+    file_mapping file;
+    memory_arena arena;
 } savegame_data;
 
+static struct {
+    char filename[FILE_NAME_MAX];
+    int num_pieces;
+    uint64_t hashes[sizeof(savegame_state) / sizeof(buffer *) + 1];
+    uint64_t id;
+} delta_base;
+
+static game_file_io_piece_timings piece_timings[sizeof(savegame_state) / sizeof(buffer *) + 1];
+static game_file_io_timings timings = { .pieces = piece_timings };
+
+static void hand_over_pieces(piece_writer *writer, buffer *const *buffers, int total);
+
+static memory_arena compress_arena;
+
 static struct {
     minimap_functions functions;
     savegame_version_t version;
@@ -318,15 +422,22 @@ static struct {
     scenario_climate climate;
 } minimap_data;
 
-static void init_file_piece(file_piece *piece, int size, int compressed)
+static void init_file_piece(file_piece *piece, int size, int compressed, memory_arena *arena)
 {
     piece->compressed = compressed;
     piece->dynamic = size == PIECE_SIZE_DYNAMIC;
+    piece->mapped = 0;
+    piece->arena_data = 0;
+    piece->skipped = 0;
+    piece->arena = arena;
     if (piece->dynamic) {
         buffer_init(&piece->buf, 0, 0);
     } else {
-        void *data = malloc(size);
-        memset(data, 0, size);
+        void *data = core_memory_arena_alloc(arena, size);
+        if (data) {
+            memset(data, 0, size);
+            piece->arena_data = data;
+        }
         buffer_init(&piece->buf, data, size);
     }
 }
@@ -334,25 +445,38 @@ static void init_file_piece(file_piece *piece, int size, int compressed)
 static buffer *create_scenario_piece(int size, int compressed)
 {
     file_piece *piece = &scenario_data.pieces[scenario_data.num_pieces++];
-    init_file_piece(piece, size, compressed);
+    init_file_piece(piece, size, compressed, &scenario_data.arena);
     return &piece->buf;
 }
 
 static buffer *create_savegame_piece(int size, int compressed)
 {
     file_piece *piece = &savegame_data.pieces[savegame_data.num_pieces++];
-    init_file_piece(piece, size, compressed);
+    init_file_piece(piece, size, compressed, &savegame_data.arena);
     return &piece->buf;
 }
 
+static void free_piece_data(file_piece *piece)
+{
+    // Memory from the arena is only released when the arena is reset. Some save functions replace
+    // the data of a piece with their own allocation, which must still be freed
+    if (!piece->mapped && piece->buf.data != piece->arena_data) {
+        free(piece->buf.data);
+    }
+    piece->buf.data = 0;
+    piece->mapped = 0;
+    piece->arena_data = 0;
+}
+
 static void clear_savegame_pieces(void)
 {
     for (int i = 0; i < savegame_data.num_pieces; i++) {
         buffer_reset(&savegame_data.pieces[i].buf);
-        free(savegame_data.pieces[i].buf.data);
-        savegame_data.pieces[i].buf.data = 0;
+        free_piece_data(&savegame_data.pieces[i]);
     }
     savegame_data.num_pieces = 0;
+    core_memory_arena_reset(&savegame_data.arena);
+    file_unmap(&savegame_data.file);
 }
 
 static void clear_scenario_pieces(void)
@@ -360,9 +484,11 @@ static void clear_scenario_pieces(void)
     scenario_data.version = 0;
     for (int i = 0; i < scenario_data.num_pieces; i++) {
         buffer_reset(&scenario_data.pieces[i].buf);
-        free(scenario_data.pieces[i].buf.data);
+        free_piece_data(&scenario_data.pieces[i]);
     }
     scenario_data.num_pieces = 0;
+    core_memory_arena_reset(&scenario_data.arena);
+    file_unmap(&scenario_data.file);
 }
 
 static void init_scenario_data(scenario_version_t version)
@@ -840,7 +966,7 @@ static void scenario_load_from_state(scenario_state *file, scenario_version_t ve
     buffer_skip(file->end_marker, 4);
 }
 
-static void scenario_save_to_state(scenario_state *file)
+static void scenario_save_to_state(scenario_state *file, piece_writer *writer)
 {
     buffer_write_u32(file->resource_version, RESOURCE_CURRENT_VERSION);
 
@@ -849,6 +975,11 @@ static void scenario_save_to_state(scenario_state *file)
     map_property_save_state(file->bitfields, file->edge);
     map_random_save_state(file->random);
     map_elevation_save_state(file->elevation);
+    buffer *const map_pieces[] = {
+        file->resource_version, file->graphic_ids, file->terrain, file->bitfields, file->edge, file->random,
+        file->elevation
+    };
+    hand_over_pieces(writer, map_pieces, sizeof(map_pieces) / sizeof(buffer *));
     city_view_save_scenario_state(file->camera);
     random_save_state(file->random_iv);
     scenario_save_state(file->scenario);
@@ -862,6 +993,13 @@ static void scenario_save_to_state(scenario_state *file)
     custom_messages_save_state(file->custom_messages);
     custom_media_save_state(file->custom_media);
     message_media_text_blob_save_state(file->message_media_text_blob, file->message_media_metadata);
+    buffer *const scenario_pieces[] = {
+        file->camera, file->random_iv, file->scenario, file->requests, file->invasions, file->demand_changes,
+        file->price_changes, file->allowed_buildings, file->custom_variables, file->scenario_events,
+        file->scenario_conditions, file->scenario_actions, file->scenario_formulas, file->scenario_texts,
+        file->custom_messages, file->custom_media, file->message_media_text_blob, file->message_media_metadata
+    };
+    hand_over_pieces(writer, scenario_pieces, sizeof(scenario_pieces) / sizeof(buffer *));
     empire_object_save(file->empire);
     empire_save_custom_map(file->empire_map);
     model_save_model_data(file->model_data);
@@ -883,6 +1021,80 @@ static scenario_version_t save_version_to_scenario_version(savegame_version_t sa
     return buffer_read_i32(buf);
 }
 
+static void load_building_grids(const savegame_state *state, savegame_version_t version)
+{
+    map_building_load_state(state->building_grid, state->building_damage_grid, state->rubble_grid, version);
+}
+
+static void load_terrain_grid(const savegame_state *state, savegame_version_t version)
+{
+    map_terrain_load_state(state->terrain_grid, version > SAVE_GAME_LAST_ORIGINAL_TERRAIN_DATA_SIZE_VERSION,
+        version <= SAVE_GAME_LAST_STORED_IMAGE_IDS ? state->image_grid : 0,
+        version <= SAVE_GAME_LAST_SMALLER_IMAGE_ID_VERSION);
+}
+
+static void load_aqueduct_grids(const savegame_state *state, savegame_version_t version)
+{
+    map_aqueduct_load_state(state->aqueduct_grid, state->aqueduct_backup_grid);
+}
+
+static void load_figure_grid(const savegame_state *state, savegame_version_t version)
+{
+    map_figure_load_state(state->figure_grid);
+}
+
+static void load_sprite_grids(const savegame_state *state, savegame_version_t version)
+{
+    map_sprite_load_state(state->sprite_grid, state->sprite_backup_grid);
+}
+
+static void load_property_grids(const savegame_state *state, savegame_version_t version)
+{
+    if (version > SAVE_GAME_LAST_NO_FORMULAS_AND_MODEL_DATA) {
+        map_property_load_state(state->bitfields_grid, state->edge_grid);
+    } else {
+        map_property_load_state_u8(state->bitfields_grid, state->edge_grid);
+    }
+}
+
+static void load_random_grid(const savegame_state *state, savegame_version_t version)
+{
+    map_random_load_state(state->random_grid);
+}
+
+static void load_desirability_grid(const savegame_state *state, savegame_version_t version)
+{
+    map_desirability_load_state(state->desirability_grid);
+}
+
+static void load_elevation_grid(const savegame_state *state, savegame_version_t version)
+{
+    map_elevation_load_state(state->elevation_grid);
+}
+
+static void run_grid_loader(void *item)
+{
+    grid_loader_task *task = item;
+    task->load(task->state, task->version);
+}
+
+static void savegame_load_map_grids(const savegame_state *state, savegame_version_t version)
+{
+    // Every loader only touches its own grids, so they can all run at the same time
+    static const grid_loader loaders[] = {
+        load_building_grids, load_terrain_grid, load_aqueduct_grids, load_figure_grid, load_sprite_grids,
+        load_property_grids, load_random_grid, load_desirability_grid, load_elevation_grid
+    };
+    grid_loader_task tasks[sizeof(loaders) / sizeof(grid_loader)];
+    unsigned int total_tasks = sizeof(loaders) / sizeof(grid_loader);
+    for (unsigned int i = 0; i < total_tasks; i++) {
+        tasks[i].load = loaders[i];
+        tasks[i].state = state;
+        tasks[i].version = version;
+    }
+    thread_pool_run_for_each(run_grid_loader, tasks, sizeof(grid_loader_task), total_tasks);
+}
+
 static void savegame_load_from_state(savegame_state *state, savegame_version_t version)
 {
     scenario_version_t scenario_version = save_version_to_scenario_version(version, state->scenario_version);
@@ -924,21 +1136,7 @@ static void savegame_load_from_state(savegame_state *state, savegame_version_t v
         building_monument_load_stages(state->monument_stages);
     }
 
-    map_building_load_state(state->building_grid, state->building_damage_grid, state->rubble_grid, version);
-    map_terrain_load_state(state->terrain_grid, version > SAVE_GAME_LAST_ORIGINAL_TERRAIN_DATA_SIZE_VERSION,
-        version <= SAVE_GAME_LAST_STORED_IMAGE_IDS ? state->image_grid : 0,
-        version <= SAVE_GAME_LAST_SMALLER_IMAGE_ID_VERSION);
-    map_aqueduct_load_state(state->aqueduct_grid, state->aqueduct_backup_grid);
-    map_figure_load_state(state->figure_grid);
-    map_sprite_load_state(state->sprite_grid, state->sprite_backup_grid);
-    if (version > SAVE_GAME_LAST_NO_FORMULAS_AND_MODEL_DATA) {
-        map_property_load_state(state->bitfields_grid, state->edge_grid);
-    } else {
-        map_property_load_state_u8(state->bitfields_grid, state->edge_grid);
-    }
-    map_random_load_state(state->random_grid);
-    map_desirability_load_state(state->desirability_grid);
-    map_elevation_load_state(state->elevation_grid);
+    savegame_load_map_grids(state, version);
     figure_load_state(state->figures, state->figure_sequence, version);
     figure_route_load_state(state->route_figures, state->route_paths, version);
     formations_load_state(state->formations, state->formation_totals, version);
@@ -1064,7 +1262,10 @@ static void savegame_load_from_state(savegame_state *state, savegame_version_t v
     }
 }
 
-static void savegame_save_to_state(savegame_state *state)
+/**
+ * Fills the pieces with the current game. When writer is set, finished pieces are handed over to it along the way.
+ */
+static void savegame_save_to_state(savegame_state *state, piece_writer *writer)
 {
     buffer_write_i32(state->file_version, SAVE_GAME_CURRENT_VERSION);
     buffer_write_u32(state->resource_version, RESOURCE_CURRENT_VERSION);
@@ -1086,10 +1287,24 @@ static void savegame_save_to_state(savegame_state *state)
     map_random_save_state(state->random_grid);
     map_desirability_save_state(state->desirability_grid);
     map_elevation_save_state(state->elevation_grid);
+    buffer *const map_pieces[] = {
+        state->file_version, state->resource_version, state->scenario_version, state->scenario_campaign_mission,
+        state->scenario_settings, state->scenario_is_custom, state->player_name, state->scenario_name,
+        state->campaign_name, state->building_grid, state->building_damage_grid, state->rubble_grid,
+        state->terrain_grid, state->aqueduct_grid, state->aqueduct_backup_grid, state->figure_grid,
+        state->sprite_grid, state->sprite_backup_grid, state->bitfields_grid, state->edge_grid, state->random_grid,
+        state->desirability_grid, state->elevation_grid
+    };
+    hand_over_pieces(writer, map_pieces, sizeof(map_pieces) / sizeof(buffer *));
 
     figure_save_state(state->figures, state->figure_sequence);
     figure_route_save_state(state->route_figures, state->route_paths);
     formations_save_state(state->formations, state->formation_totals);
+    buffer *const figure_pieces[] = {
+        state->figures, state->figure_sequence, state->route_figures, state->route_paths, state->formations,
+        state->formation_totals
+    };
+    hand_over_pieces(writer, figure_pieces, sizeof(figure_pieces) / sizeof(buffer *));
 
     city_data_save_state(state->city_data,
         state->city_graph_order,
@@ -1101,6 +1316,12 @@ static void savegame_save_to_state(savegame_state *state)
         state->building_extra_highest_id_ever,
         state->building_extra_sequence,
         state->building_extra_corrupt_houses);
+    buffer *const building_pieces[] = {
+        state->city_data, state->city_graph_order, state->city_entry_exit_xy, state->city_entry_exit_grid_offset,
+        state->buildings, state->building_extra_highest_id, state->building_extra_highest_id_ever,
+        state->building_extra_sequence, state->building_extra_corrupt_houses
+    };
+    hand_over_pieces(writer, building_pieces, sizeof(building_pieces) / sizeof(buffer *));
     city_view_save_state(state->city_view_orientation, state->city_view_camera);
     game_time_save_state(state->game_time);
     random_save_state(state->random_iv);
@@ -1113,6 +1334,12 @@ static void savegame_save_to_state(savegame_state *state)
     trade_prices_save_state(state->trade_prices);
     figure_name_save_state(state->figure_names);
     city_culture_save_state(state->culture_coverage);
+    buffer *const empire_pieces[] = {
+        state->city_view_orientation, state->city_view_camera, state->game_time, state->random_iv,
+        state->model_data, state->emperor_change_time, state->emperor_change_state, state->empire,
+        state->empire_map, state->empire_cities, state->trade_prices, state->figure_names, state->culture_coverage
+    };
+    hand_over_pieces(writer, empire_pieces, sizeof(empire_pieces) / sizeof(buffer *));
 
     scenario_save_state(state->scenario);
     scenario_request_save_state(state->requests);
@@ -1125,6 +1352,13 @@ static void savegame_save_to_state(savegame_state *state)
     custom_messages_save_state(state->custom_messages);
     custom_media_save_state(state->custom_media);
     message_media_text_blob_save_state(state->message_media_text_blob, state->message_media_metadata);
+    buffer *const scenario_pieces[] = {
+        state->scenario, state->requests, state->invasions, state->demand_changes, state->price_changes,
+        state->allowed_buildings, state->custom_variables, state->scenario_events, state->scenario_conditions,
+        state->scenario_actions, state->scenario_formulas, state->scenario_texts, state->custom_messages,
+        state->custom_media, state->message_media_text_blob, state->message_media_metadata
+    };
+    hand_over_pieces(writer, scenario_pieces, sizeof(scenario_pieces) / sizeof(buffer *));
 
     scenario_criteria_save_state(state->max_game_year);
     scenario_earthquake_save_state(state->earthquake);
@@ -1137,6 +1371,13 @@ static void savegame_save_to_state(savegame_state *state)
         state->building_list_burning, state->building_list_burning_totals);
 
     tutorial_save_state(state->tutorial_part1, state->tutorial_part2, state->tutorial_part3);
+    buffer *const message_pieces[] = {
+        state->max_game_year, state->earthquake, state->messages, state->message_extra, state->message_counts,
+        state->message_delays, state->population_messages, state->figure_traders, state->building_list_small,
+        state->building_list_large, state->building_list_burning, state->building_list_burning_totals,
+        state->tutorial_part1, state->tutorial_part2, state->tutorial_part3
+    };
+    hand_over_pieces(writer, message_pieces, sizeof(message_pieces) / sizeof(buffer *));
 
     building_storage_save_state(state->building_storages);
     scenario_gladiator_revolt_save_state(state->gladiator_revolt);
@@ -1159,132 +1400,287 @@ static void savegame_save_to_state(savegame_state *state)
     building_monument_save_stages(state->monument_stages);
 }
 
-static int get_scenario_version(FILE *fp)
+static int write_int32(FILE *fp, int value)
 {
-    char version_magic[8];
-    size_t read = fread(version_magic, 1, 8, fp);
-    if (read != sizeof(version_magic)) {
-        log_error("Unable to read version header from file", 0, 0);
-        return 0;
+    uint8_t data[4];
+    buffer buf;
+    buffer_init(&buf, data, 4);
+    buffer_write_i32(&buf, value);
+    return fwrite(&data, 1, 4, fp) == 4;
+}
+
+static game_file_io_piece_timings *start_piece_timings(int num_pieces)
+{
+    memset(piece_timings, 0, num_pieces * sizeof(game_file_io_piece_timings));
+    timings.num_pieces = num_pieces;
+    return piece_timings;
+}
+
+/**
+ * The compression scratch space is kept between saves and reused, so it is reset here for the next save
+ */
+static compressed_piece *create_compressed_pieces(int num_pieces)
+{
+    core_memory_arena_reset(&compress_arena);
+    compressed_piece *compressed = core_memory_arena_alloc(&compress_arena, num_pieces * sizeof(compressed_piece));
+    if (compressed) {
+        memset(compressed, 0, num_pieces * sizeof(compressed_piece));
     }
-    if (strcmp(version_magic, "VERSION") != 0) {
-        rewind(fp);
-        return SCENARIO_LAST_UNVERSIONED;
+    return compressed;
+}
+
+static void add_compressed_piece(compressed_piece *compressed, file_piece *piece, save_compression compression)
+{
+    int size = (int) piece->buf.size;
+    // Anything that doesn't fit in the old shared compression buffer is stored uncompressed
+    int capacity = compression == SAVE_COMPRESSION_LZ4 ? lz4_compress_bound(size) : zlib_helper_compress_bound(size);
+    if (capacity > COMPRESS_BUFFER_INITIAL_SIZE) {
+        capacity = COMPRESS_BUFFER_INITIAL_SIZE;
+    }
+    compressed->piece = piece;
+    compressed->compression = compression;
+    // The output only lives until the piece is written, so it isn't taken from the arena
+    compressed->output = malloc(capacity);
+    compressed->capacity = compressed->output ? capacity : 0;
+}
+
+static void release_compressed_piece(compressed_piece *compressed)
+{
+    free(compressed->output);
+    compressed->output = 0;
+    compressed->capacity = 0;
+}
+
+static void compress_piece(void *item)
+{
+    compressed_piece *compressed = item;
+    const buffer *buf = &compressed->piece->buf;
+    compressed->size = 0;
+    if (!compressed->output) {
+        return;
+    }
+    uint64_t start_time = system_get_precise_ticks();
+    if (compressed->compression == SAVE_COMPRESSION_LZ4) {
+        compressed->size = lz4_compress(buf->data, (int) buf->size, compressed->output, compressed->capacity);
+    } else {
+        int level = compressed->compression == SAVE_COMPRESSION_DEFLATE_BEST ?
+            ZLIB_HELPER_BEST_COMPRESSION : ZLIB_HELPER_BEST_SPEED;
+        if (!zlib_helper_compress(buf->data, (int) buf->size, compressed->output, compressed->capacity,
+                &compressed->size, level)) {
+            compressed->size = 0;
+        }
     }
+    // Only keep the memory actually used, as the output may have to wait for earlier pieces to be written
+    if (compressed->size && compressed->size < compressed->capacity) {
+        uint8_t *output = realloc(compressed->output, compressed->size);
+        if (output) {
+            compressed->output = output;
+            compressed->capacity = compressed->size;
+        }
+    }
+    compressed->time = system_get_precise_ticks() - start_time;
+}
 
-    buffer buf;
-    uint8_t version_data[4];
-    buffer_init(&buf, version_data, 4);
-    read = fread(version_data, 1, 4, fp);
-    if (read != sizeof(version_data)) {
-        log_error("Unable to read version number from file", 0, 0);
+static int start_piece_writer(piece_writer *writer, FILE *fp, file_piece *pieces, int num_pieces,
+    save_compression compression, int write_codec)
+{
+    memset(writer, 0, sizeof(piece_writer));
+    writer->fp = fp;
+    writer->pieces = pieces;
+    writer->num_pieces = num_pieces;
+    writer->compression = compression;
+    writer->write_codec = write_codec;
+    writer->compressed = create_compressed_pieces(num_pieces);
+    writer->submitted = core_memory_arena_alloc(&compress_arena, num_pieces * sizeof(uint8_t));
+    if (!writer->compressed || !writer->submitted) {
+        log_error("Unable to allocate memory for compressing the file", 0, 0);
         return 0;
     }
-    return buffer_read_i32(&buf);
+    memset(writer->submitted, 0, num_pieces * sizeof(uint8_t));
+    return 1;
 }
 
-static int read_int32(FILE *fp)
+static void wait_for_compression(piece_writer *writer, int index)
 {
-    uint8_t data[4];
-    if (fread(&data, 1, 4, fp) != 4) {
-        return 0;
+    compressed_piece *compressed = &writer->compressed[index];
+    if (!compressed->compressing) {
+        return;
     }
-    buffer buf;
-    buffer_init(&buf, data, 4);
-    return buffer_read_i32(&buf);
+    uint64_t start_time = system_get_precise_ticks();
+    thread_pool_wait_for_job(&compressed->job);
+    timings.deflate += system_get_precise_ticks() - start_time;
+    compressed->compressing = 0;
+    writer->bytes_compressing -= (int) compressed->piece->buf.size;
 }
 
-static void write_int32(FILE *fp, int value)
+static void submit_piece(piece_writer *writer, int index)
 {
-    uint8_t data[4];
-    buffer buf;
-    buffer_init(&buf, data, 4);
-    buffer_write_i32(&buf, value);
-    fwrite(&data, 1, 4, fp);
+    writer->submitted[index] = 1;
+    file_piece *piece = &writer->pieces[index];
+    if (!piece->compressed || !piece->buf.size) {
+        return;
+    }
+    int size = (int) piece->buf.size;
+    for (int i = 0; i < writer->num_pieces && writer->bytes_compressing &&
+        writer->bytes_compressing + size > MAX_BYTES_COMPRESSING; i++) {
+        wait_for_compression(writer, i);
+    }
+    compressed_piece *compressed = &writer->compressed[index];
+    add_compressed_piece(compressed, piece, writer->compression);
+    if (!compressed->output) {
+        return;
+    }
+    compressed->compressing = 1;
+    writer->bytes_compressing += size;
+    thread_pool_start_job_in(&compressed->job, compress_piece, compressed);
 }
 
-static int read_compressed_chunk_from_buffer(buffer *buf, void *dst, size_t bytes_to_read, int read_as_zlib,
-    memory_block *compress_buffer)
+static int write_piece(piece_writer *writer, int index)
 {
-    int input_size = buffer_read_i32(buf);
-    if ((unsigned int) input_size == UNCOMPRESSED) {
-        return buffer_read_raw(buf, dst, (int) bytes_to_read) == bytes_to_read;
-    } else {
-        if (!core_memory_block_ensure_size(compress_buffer, input_size)) {
+    FILE *fp = writer->fp;
+    const file_piece *piece = &writer->pieces[index];
+    const compressed_piece *compressed = &writer->compressed[index];
+    if (piece->dynamic) {
+        if (!write_int32(fp, (int) piece->buf.size)) {
             return 0;
         }
-        if (buffer_read_raw(buf, compress_buffer->memory, input_size) != input_size) {
+        if (!piece->buf.size) {
+            return 1;
+        }
+    }
+    if (!piece->compressed) {
+        return fwrite(piece->buf.data, 1, piece->buf.size, fp) == piece->buf.size;
+    } else if (compressed->size) {
+        if (!write_int32(fp, compressed->size)) {
             return 0;
         }
-
-        if (!read_as_zlib) {
-            return zip_decompress(compress_buffer->memory, input_size, dst, (int) bytes_to_read);
-        } else {
-            int output_size = 0;
-            return zlib_helper_decompress(compress_buffer->memory, input_size, dst, (int) bytes_to_read, &output_size);
+        if (writer->write_codec &&
+            fputc(writer->compression == SAVE_COMPRESSION_LZ4 ? PIECE_CODEC_LZ4 : PIECE_CODEC_ZLIB, fp) == EOF) {
+            return 0;
         }
+        return fwrite(compressed->output, 1, compressed->size, fp) == (size_t) compressed->size;
+    } else {
+        // unable to compress: write uncompressed
+        return write_int32(fp, UNCOMPRESSED) && fwrite(piece->buf.data, 1, piece->buf.size, fp) == piece->buf.size;
     }
 }
 
-static int read_compressed_chunk(FILE *fp, void *dst, size_t bytes_to_read, int read_as_zlib,
-    memory_block *compress_buffer)
+static void write_pieces_in_order(piece_writer *writer, int wait)
 {
-    int input_size = read_int32(fp);
-    if ((unsigned int) input_size == UNCOMPRESSED) {
-        return fread(dst, 1, bytes_to_read, fp) == bytes_to_read;
-    } else {
-        if (!core_memory_block_ensure_size(compress_buffer, input_size)) {
-            return 0;
+    while (writer->next_to_write < writer->num_pieces && writer->submitted[writer->next_to_write]) {
+        int index = writer->next_to_write;
+        file_piece *piece = &writer->pieces[index];
+        compressed_piece *compressed = &writer->compressed[index];
+        if (compressed->compressing && !wait && !thread_pool_job_is_done(&compressed->job)) {
+            return;
         }
-        if (fread(compress_buffer->memory, 1, input_size, fp) != input_size) {
-            return 0;
+        wait_for_compression(writer, index);
+        uint64_t start_time = system_get_precise_ticks();
+        // After a failed write, the file is thrown away, but the pieces still have to be released
+        if (!writer->write_failed && !write_piece(writer, index)) {
+            log_error("Unable to write the file", 0, 0);
+            writer->write_failed = 1;
+        }
+        uint64_t write_time = system_get_precise_ticks() - start_time;
+        timings.write += write_time;
+        if (writer->piece_timings) {
+            game_file_io_piece_timings *piece_timing = &writer->piece_timings[index];
+            piece_timing->size = (int) piece->buf.size;
+            piece_timing->stored_size = compressed->size ? compressed->size : (int) piece->buf.size;
+            piece_timing->deflate = compressed->time;
+            piece_timing->write = write_time;
         }
+        release_compressed_piece(compressed);
+        if (writer->release_pieces) {
+            free_piece_data(piece);
+        }
+        writer->next_to_write++;
+    }
+}
 
-        if (!read_as_zlib) {
-            return zip_decompress(compress_buffer->memory, input_size, dst, (int) bytes_to_read);
-        } else {
-            int output_size = 0;
-            return zlib_helper_decompress(compress_buffer->memory, input_size, dst, (int) bytes_to_read, &output_size);
+/**
+ * Hands pieces that were completely filled over to the writer. Every save step hands over the pieces
+ * it filled, so that they are compressed and written while the next steps run.
+ * Pieces that were already handed over are ignored. Does nothing when writer is not set.
+ */
+static void hand_over_pieces(piece_writer *writer, buffer *const *buffers, int total)
+{
+    if (!writer) {
+        return;
+    }
+    for (int i = 0; i < total; i++) {
+        if (!buffers[i]) {
+            continue;
+        }
+        // The buffers of the state are the first member of their piece
+        int index = (int) ((const file_piece *) buffers[i] - writer->pieces);
+        if (index >= 0 && index < writer->num_pieces && !writer->submitted[index]) {
+            submit_piece(writer, index);
         }
     }
+    write_pieces_in_order(writer, 0);
 }
 
-static int read_compressed_savegame_chunk(FILE *fp, void *buf, size_t bytes_to_read,
-    savegame_version_t version, memory_block *compress_buffer)
+/**
+ * Hands the pieces that were not handed over yet to the writer and writes all remaining pieces
+ * @return Boolean true if all pieces were written to the file, false if writing any of them failed
+ */
+static int finish_piece_writer(piece_writer *writer)
 {
-    int read_as_zlib = version > SAVE_GAME_LAST_ZIP_COMPRESSION;
-    return read_compressed_chunk(fp, buf, bytes_to_read, read_as_zlib, compress_buffer);
+    for (int i = 0; i < writer->num_pieces; i++) {
+        if (!writer->submitted[i]) {
+            submit_piece(writer, i);
+        }
+    }
+    write_pieces_in_order(writer, 1);
+    return !writer->write_failed;
 }
 
-static int write_compressed_chunk(FILE *fp, void *buf, size_t bytes_to_write, memory_block *compress_buffer)
+/**
+ * Opens a temporary file next to the file, which replaces the file once it was completely written.
+ * This way a failed save leaves the previous file untouched.
+ */
+static FILE *open_temporary_file(const char *filename, char *temporary_filename)
 {
-    if (!core_memory_block_ensure_size(compress_buffer, bytes_to_write)) {
+    if (snprintf(temporary_filename, FILE_NAME_MAX, "%s.tmp", filename) >= FILE_NAME_MAX) {
+        log_error("Filename too long", filename, 0);
         return 0;
     }
-    int output_size = 0;
-    if (zlib_helper_compress(buf, (int) bytes_to_write, compress_buffer->memory, COMPRESS_BUFFER_INITIAL_SIZE, &output_size)) {
-        write_int32(fp, output_size);
-        fwrite(compress_buffer->memory, 1, output_size, fp);
-    } else {
-        // unable to compress: write uncompressed
-        write_int32(fp, UNCOMPRESSED);
-        fwrite(buf, 1, bytes_to_write, fp);
+    return file_open(temporary_filename, "wb");
+}
+
+/**
+ * Closes the temporary file and, when everything was written, moves it over the file. Otherwise it is removed.
+ * @return Boolean true if the file was replaced
+ */
+static int close_temporary_file(FILE *fp, const char *temporary_filename, const char *filename, int result)
+{
+    if (!file_close(fp)) {
+        log_error("Unable to finish writing the file", filename, 0);
+        result = 0;
     }
-    return 1;
+    if (result && !file_rename(temporary_filename, filename)) {
+        log_error("Unable to replace the file", filename, 0);
+        result = 0;
+    }
+    if (!result) {
+        file_remove(temporary_filename);
+    }
+    return result;
 }
 
-static int prepare_dynamic_piece_from_file(FILE *fp, file_piece *piece)
+/**
+ * Writes all pieces to the file. When write_codec is not set, only SAVE_COMPRESSION_DEFLATE_FAST
+ * can be used, as the loader has no way of knowing how the pieces were compressed.
+ */
+static int write_pieces_to_file(FILE *fp, file_piece *pieces, int num_pieces, save_compression compression,
+    int write_codec)
 {
-    if (piece->dynamic) {
-        int size = read_int32(fp);
-        if (!size) {
-            return 0;
-        }
-        uint8_t *data = malloc(size);
-        memset(data, 0, size);
-        buffer_init(&piece->buf, data, size);
+    piece_writer writer;
+    if (!start_piece_writer(&writer, fp, pieces, num_pieces, compression, write_codec)) {
+        return 0;
     }
-    return 1;
+    return finish_piece_writer(&writer);
 }
 
 static int prepare_dynamic_piece_from_buffer(buffer *buf, file_piece *piece)
@@ -1294,120 +1690,337 @@ static int prepare_dynamic_piece_from_buffer(buffer *buf, file_piece *piece)
         if (!size) {
             return 0;
         }
-        uint8_t *data = malloc(size);
-        memset(data, 0, size);
-        buffer_init(&piece->buf, data, size);
+        // The memory is only allocated when the piece can't point into the file
+        buffer_init(&piece->buf, 0, size);
     }
     return 1;
 }
 
-static int get_scenario_version_from_buffer(buffer *buf)
+static int allocate_piece(file_piece *piece)
 {
-    char version_magic[8];
-    size_t read = buffer_read_raw(buf, version_magic, 8);
-    if (read != sizeof(version_magic)) {
-        log_error("Unable to read version header from file", 0, 0);
+    if (piece->buf.data) {
+        return 1;
+    }
+    uint8_t *data = core_memory_arena_alloc(piece->arena, piece->buf.size);
+    if (!data) {
+        log_error("Unable to allocate memory for the file piece", 0, (int) piece->buf.size);
         return 0;
     }
-    if (strcmp(version_magic, "VERSION") != 0) {
-        buffer_reset(buf);
-        return SCENARIO_LAST_UNVERSIONED;
+    memset(data, 0, piece->buf.size);
+    buffer_init(&piece->buf, data, piece->buf.size);
+    piece->arena_data = data;
+    return 1;
+}
+
+static int read_uncompressed_piece(buffer *buf, file_piece *piece, int map_pieces)
+{
+    size_t size = piece->buf.size;
+    if (piece->skipped) {
+        buffer_skip(buf, size);
+        return buf->index <= buf->size;
+    }
+    if (map_pieces && !buf->overflow && buf->index + size <= buf->size) {
+        free_piece_data(piece);
+        buffer_init(&piece->buf, &buf->data[buf->index], size);
+        piece->mapped = 1;
+        buffer_skip(buf, size);
+        return 1;
+    }
+    if (!allocate_piece(piece)) {
+        return 0;
     }
+    return buffer_read_raw(buf, piece->buf.data, size) == size;
+}
 
-    return buffer_read_i32(buf);
+static void decompress_piece(void *item)
+{
+    decompressed_piece *decompressed = item;
+    buffer *buf = &decompressed->piece->buf;
+    uint64_t start_time = system_get_precise_ticks();
+    if (decompressed->format == PIECE_FORMAT_ZIP) {
+        decompressed->result = zip_decompress(decompressed->input, decompressed->input_size,
+            buf->data, (int) buf->size);
+    } else if (decompressed->codec == PIECE_CODEC_LZ4) {
+        decompressed->result = lz4_decompress(decompressed->input, decompressed->input_size,
+            buf->data, (int) buf->size);
+    } else {
+        int output_size = 0;
+        decompressed->result = zlib_helper_decompress((void *) decompressed->input, decompressed->input_size,
+            buf->data, (int) buf->size, &output_size);
+    }
+    decompressed->time = system_get_precise_ticks() - start_time;
 }
 
-static int load_scenario_from_buffer(buffer *buf)
+static int read_piece_from_buffer(buffer *buf, file_piece *piece, decompressed_piece *decompressed,
+    piece_format format, int map_pieces)
 {
-    scenario_version_t version = get_scenario_version_from_buffer(buf);
-    init_scenario_data(version);
-    if (version > SCENARIO_CURRENT_VERSION) {
-        log_error("Scenario version incompatible with current version, got version", 0, version);
-        return 0;
+    if (!piece->compressed) {
+        return read_uncompressed_piece(buf, piece, map_pieces);
     }
-    memory_block compress_buffer;
-    core_memory_block_init(&compress_buffer, COMPRESS_BUFFER_INITIAL_SIZE);
-    for (int i = 0; i < scenario_data.num_pieces; i++) {
-        file_piece *piece = &scenario_data.pieces[i];
-        int result = 0;
-        if (!prepare_dynamic_piece_from_buffer(buf, piece)) {
-            continue;
-        }
-        if (piece->compressed) {
-            result = read_compressed_chunk_from_buffer(buf, piece->buf.data, piece->buf.size, 1, &compress_buffer);
-        } else {
-            result = buffer_read_raw(buf, piece->buf.data, piece->buf.size) == piece->buf.size;
-        }
-        if (!result) {
-            log_info("Incorrect buffer size, got", 0, result);
-            log_info("Incorrect buffer size, expected", 0, (int) piece->buf.size);
-            core_memory_block_free(&compress_buffer);
+    int input_size = buffer_read_i32(buf);
+    if ((unsigned int) input_size == UNCOMPRESSED) {
+        return read_uncompressed_piece(buf, piece, map_pieces);
+    }
+    piece_codec codec = PIECE_CODEC_ZLIB;
+    if (format == PIECE_FORMAT_CODEC_TAGGED) {
+        codec = buffer_read_u8(buf);
+        if (codec >= PIECE_CODEC_MAX) {
+            log_error("Unknown compression codec in file:", 0, codec);
             return 0;
         }
     }
-    core_memory_block_free(&compress_buffer);
+    if (input_size < 0 || buf->overflow || buf->index + input_size > buf->size) {
+        return 0;
+    }
+    if (piece->skipped) {
+        buffer_skip(buf, input_size);
+        return 1;
+    }
+    if (!allocate_piece(piece)) {
+        return 0;
+    }
+    decompressed->piece = piece;
+    decompressed->input = &buf->data[buf->index];
+    decompressed->input_size = input_size;
+    decompressed->format = format;
+    decompressed->codec = codec;
+    buffer_skip(buf, input_size);
     return 1;
 }
 
-static int load_scenario_to_buffers(const char *filename)
+/**
+ * Reads all pieces from the buffer. The compressed pieces are first located in the buffer
+ * and then inflated at the same time, as each of them is an independent stream.
+ * When last_piece_may_be_short is set, failing to fully read the last piece is not an error.
+ * When map_pieces is set, uncompressed pieces point straight into the buffer instead of being copied,
+ * so the buffer must be kept until the pieces are cleared. Skipped pieces are stepped over without being read.
+ * When record_timings is set, the size and inflate time of every piece are kept in the piece timings.
+ */
+static int read_pieces_from_buffer(buffer *buf, file_piece *pieces, int num_pieces, piece_format format,
+    int last_piece_may_be_short, int map_pieces, int record_timings)
 {
-    FILE *fp = file_open(filename, "rb");
-    if (!fp) {
+    decompressed_piece *decompressed = calloc(num_pieces, sizeof(decompressed_piece));
+    if (!decompressed) {
+        log_error("Unable to allocate memory for decompressing the file", 0, 0);
         return 0;
     }
-    scenario_version_t version = get_scenario_version(fp);
-    init_scenario_data(version);
-    if (version > SCENARIO_CURRENT_VERSION) {
-        log_error("Scenario version incompatible with current version, got version", 0, version);
-        return 0;
-    }
-    memory_block compress_buffer;
-    core_memory_block_init(&compress_buffer, COMPRESS_BUFFER_INITIAL_SIZE);
-    for (int i = 0; i < scenario_data.num_pieces; i++) {
-        file_piece *piece = &scenario_data.pieces[i];
-        int result = 0;
-        if (!prepare_dynamic_piece_from_file(fp, piece)) {
+    unsigned int total_decompressed = 0;
+    for (int i = 0; i < num_pieces; i++) {
+        file_piece *piece = &pieces[i];
+        if (!prepare_dynamic_piece_from_buffer(buf, piece)) {
             continue;
         }
-        if (piece->compressed) {
-            result = read_compressed_chunk(fp, piece->buf.data, piece->buf.size, 1, &compress_buffer);
-        } else {
-            size_t bytes_read = fread(piece->buf.data, 1, piece->buf.size, fp);
-            result = bytes_read == piece->buf.size;
-        }
-        if (!result) {
+        decompressed_piece *current = &decompressed[total_decompressed];
+        current->index = i;
+        int result = read_piece_from_buffer(buf, piece, current, format, map_pieces);
+        if (current->piece) {
+            total_decompressed++;
+        } else if (!result && !(last_piece_may_be_short && i == num_pieces - 1)) {
             log_info("Incorrect buffer size, got", 0, result);
             log_info("Incorrect buffer size, expected", 0, (int) piece->buf.size);
-            file_close(fp);
-            core_memory_block_free(&compress_buffer);
+            free(decompressed);
             return 0;
         }
     }
-    core_memory_block_free(&compress_buffer);
-    file_close(fp);
-    return 1;
-}
 
-int game_file_io_read_scenario_from_buffer(buffer *buf)
-{
-    if (!load_scenario_from_buffer(buf)) {
-        return 0;
+    thread_pool_run_for_each(decompress_piece, decompressed, sizeof(decompressed_piece), total_decompressed);
+
+    if (record_timings) {
+        start_piece_timings(num_pieces);
+        for (int i = 0; i < num_pieces; i++) {
+            int size = pieces[i].skipped ? 0 : (int) pieces[i].buf.size;
+            piece_timings[i].size = size;
+            piece_timings[i].stored_size = size;
+        }
+        for (unsigned int i = 0; i < total_decompressed; i++) {
+            piece_timings[decompressed[i].index].stored_size = decompressed[i].input_size;
+            piece_timings[decompressed[i].index].inflate = decompressed[i].time;
+        }
     }
-    scenario_load_from_state(&scenario_data.state, scenario_data.version);
-    return 1;
+
+    int result = 1;
+    for (unsigned int i = 0; i < total_decompressed; i++) {
+        const decompressed_piece *current = &decompressed[i];
+        if (!current->result && !(last_piece_may_be_short && current->index == num_pieces - 1)) {
+            log_info("Incorrect buffer size, got", 0, current->result);
+            log_info("Incorrect buffer size, expected", 0, (int) current->piece->buf.size);
+            result = 0;
+            break;
+        }
+    }
+    free(decompressed);
+    return result;
 }
 
-int game_file_io_read_scenario(const char *filename)
+static uint64_t rotate_left(uint64_t value, int bits)
 {
-    log_info("Loading scenario", filename, 0);
-    if (!load_scenario_to_buffers(filename)) {
-        return 0;
-    }
-    scenario_load_from_state(&scenario_data.state, scenario_data.version);
-    return 1;
+    return (value << bits) | (value >> (64 - bits));
 }
 
-static int scenario_terrain_at(int grid_offset)
+// Mixes every bit of the word into the hash, so that any change to a piece changes its hash
+static uint64_t hash_word(uint64_t hash, uint64_t word)
+{
+    word = rotate_left(word * HASH_PRIME_2, 31) * HASH_PRIME_1;
+    return rotate_left(hash ^ word, 27) * HASH_PRIME_1 + HASH_PRIME_4;
+}
+
+static uint64_t finish_hash(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= HASH_PRIME_2;
+    hash ^= hash >> 29;
+    hash *= HASH_PRIME_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+static void hash_piece(void *item)
+{
+    hashed_piece *hashed = item;
+    const uint8_t *data = hashed->piece->buf.data;
+    size_t size = hashed->piece->buf.size;
+    uint64_t hash = HASH_PRIME_5 + size;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, &data[i], sizeof(uint64_t));
+        hash = hash_word(hash, word);
+    }
+    for (; i < size; i++) {
+        hash = rotate_left(hash ^ (data[i] * HASH_PRIME_5), 11) * HASH_PRIME_1;
+    }
+    hashed->hash = finish_hash(hash);
+}
+
+/**
+ * Hashes the contents of all pieces and returns a hash of the hashes, which identifies the whole file
+ */
+static uint64_t hash_pieces(const file_piece *pieces, int num_pieces, uint64_t *hashes)
+{
+    hashed_piece *hashed = calloc(num_pieces, sizeof(hashed_piece));
+    if (!hashed) {
+        log_error("Unable to allocate memory for hashing the file", 0, 0);
+        return 0;
+    }
+    for (int i = 0; i < num_pieces; i++) {
+        hashed[i].piece = &pieces[i];
+    }
+    thread_pool_run_for_each(hash_piece, hashed, sizeof(hashed_piece), num_pieces);
+
+    uint64_t id = HASH_PRIME_5 + num_pieces;
+    for (int i = 0; i < num_pieces; i++) {
+        hashes[i] = hashed[i].hash;
+        id = hash_word(id, hashed[i].hash);
+    }
+    free(hashed);
+    return finish_hash(id);
+}
+
+static void reset_load_timings(void)
+{
+    timings.read = 0;
+    timings.inflate = 0;
+    timings.decode = 0;
+    timings.num_pieces = 0;
+}
+
+static void reset_save_timings(void)
+{
+    timings.encode = 0;
+    timings.deflate = 0;
+    timings.write = 0;
+    timings.num_pieces = 0;
+}
+
+static int map_file(const char *filename, int offset, file_mapping *file)
+{
+    FILE *fp = file_open(filename, "rb");
+    if (!fp) {
+        return 0;
+    }
+    if (offset) {
+        fseek(fp, offset, SEEK_SET);
+    }
+    int result = file_map(fp, file);
+    file_close(fp);
+    return result;
+}
+
+static int get_scenario_version_from_buffer(buffer *buf)
+{
+    char version_magic[8];
+    size_t read = buffer_read_raw(buf, version_magic, 8);
+    if (read != sizeof(version_magic)) {
+        log_error("Unable to read version header from file", 0, 0);
+        return 0;
+    }
+    if (strcmp(version_magic, "VERSION") != 0) {
+        buffer_reset(buf);
+        return SCENARIO_LAST_UNVERSIONED;
+    }
+
+    return buffer_read_i32(buf);
+}
+
+/**
+ * Loads the scenario pieces from the buffer. If file is set, the buffer holds the contents of that file,
+ * which are then owned by the scenario pieces and released when they are cleared.
+ */
+static int load_scenario_from_buffer(buffer *buf, file_mapping *file)
+{
+    scenario_version_t version = get_scenario_version_from_buffer(buf);
+    init_scenario_data(version);
+    if (file) {
+        scenario_data.file = *file;
+    }
+    if (version > SCENARIO_CURRENT_VERSION) {
+        log_error("Scenario version incompatible with current version, got version", 0, version);
+        return 0;
+    }
+    uint64_t start_time = system_get_precise_ticks();
+    int result = read_pieces_from_buffer(buf, scenario_data.pieces, scenario_data.num_pieces, PIECE_FORMAT_ZLIB, 0,
+        file != 0, 1);
+    timings.inflate = system_get_precise_ticks() - start_time;
+    return result;
+}
+
+static int load_scenario_to_buffers(const char *filename)
+{
+    uint64_t start_time = system_get_precise_ticks();
+    file_mapping file;
+    if (!map_file(filename, 0, &file)) {
+        return 0;
+    }
+    timings.read = system_get_precise_ticks() - start_time;
+    buffer buf;
+    buffer_init(&buf, file.data, file.size);
+    return load_scenario_from_buffer(&buf, &file);
+}
+
+int game_file_io_read_scenario_from_buffer(buffer *buf)
+{
+    if (!load_scenario_from_buffer(buf, 0)) {
+        return 0;
+    }
+    scenario_load_from_state(&scenario_data.state, scenario_data.version);
+    return 1;
+}
+
+int game_file_io_read_scenario(const char *filename)
+{
+    log_info("Loading scenario", filename, 0);
+    reset_load_timings();
+    int result = load_scenario_to_buffers(filename);
+    if (result) {
+        uint64_t start_time = system_get_precise_ticks();
+        scenario_load_from_state(&scenario_data.state, scenario_data.version);
+        timings.decode = system_get_precise_ticks() - start_time;
+    }
+    clear_scenario_pieces();
+    return result;
+}
+
+static int scenario_terrain_at(int grid_offset)
 {
     if (scenario_data.version <= SCENARIO_LAST_LEGACY_TERRAIN) {
         return map_terrain_get_from_buffer_16(scenario_data.state.terrain, grid_offset);
@@ -1515,7 +2128,9 @@ int game_file_io_read_scenario_info(const char *filename, saved_game_info *info)
     }
 
     if (!load_scenario_to_buffers(filename)) {
-        if (scenario_data.version > SCENARIO_CURRENT_VERSION) {
+        int is_newer_version = scenario_data.version > SCENARIO_CURRENT_VERSION;
+        clear_scenario_pieces();
+        if (is_newer_version) {
             return SAVEGAME_STATUS_NEWER_VERSION;
         }
         return game_file_io_read_saved_game_info(filename, 0, info);
@@ -1531,7 +2146,7 @@ int game_file_io_read_scenario_info_from_buffer(buffer *buf, saved_game_info *in
     if (!info) {
         return SAVEGAME_STATUS_INVALID;
     }
-    if (!load_scenario_from_buffer(buf)) {
+    if (!load_scenario_from_buffer(buf, 0)) {
         if (scenario_data.version > SCENARIO_CURRENT_VERSION) {
             return SAVEGAME_STATUS_NEWER_VERSION;
         }
@@ -1543,111 +2158,51 @@ int game_file_io_read_scenario_info_from_buffer(buffer *buf, saved_game_info *in
 int game_file_io_write_scenario(const char *filename)
 {
     log_info("Saving scenario", filename, 0);
+    reset_save_timings();
     resource_set_mapping(RESOURCE_CURRENT_VERSION);
     init_scenario_data(SCENARIO_CURRENT_VERSION);// SCENARIO_CURRENT_VERSION
-    scenario_save_to_state(&scenario_data.state);
 
-    FILE *fp = file_open(filename, "wb");
+    char temporary_filename[FILE_NAME_MAX];
+    FILE *fp = open_temporary_file(filename, temporary_filename);
     if (!fp) {
         log_error("Unable to save scenario", 0, 0);
         return 0;
     }
-    memory_block compress_buffer;
-    core_memory_block_init(&compress_buffer, COMPRESS_BUFFER_INITIAL_SIZE);
     uint8_t header[8];
     string_copy(string_from_ascii("VERSION"), header, sizeof(header));
-    fwrite(header, 1, 8, fp);
-    write_int32(fp, SCENARIO_CURRENT_VERSION); // SCENARIO_CURRENT_VERSION
-    for (int i = 0; i < scenario_data.num_pieces; i++) {
-        file_piece *piece = &scenario_data.pieces[i];
-        if (piece->dynamic) {
-            write_int32(fp, (int) piece->buf.size);
-            if (!piece->buf.size) {
-                continue;
-            }
-        }
-        if (piece->compressed) {
-            write_compressed_chunk(fp, piece->buf.data, piece->buf.size, &compress_buffer);
-        } else {
-            fwrite(piece->buf.data, 1, piece->buf.size, fp);
-        }
-    }
-    core_memory_block_free(&compress_buffer);
-    file_close(fp);
-    return 1;
+    int result = fwrite(header, 1, 8, fp) == 8 && write_int32(fp, SCENARIO_CURRENT_VERSION);
+    piece_writer writer;
+    result = result && start_piece_writer(&writer, fp, scenario_data.pieces, scenario_data.num_pieces,
+        SAVE_COMPRESSION_DEFLATE_FAST, 0);
+    if (result) {
+        writer.release_pieces = 1;
+        writer.piece_timings = start_piece_timings(scenario_data.num_pieces);
+        uint64_t start_time = system_get_precise_ticks();
+        scenario_save_to_state(&scenario_data.state, &writer);
+        // Compressing and writing are partly done while creating the pieces
+        timings.encode = system_get_precise_ticks() - start_time - timings.deflate - timings.write;
+        result = finish_piece_writer(&writer);
+    }
+    return close_temporary_file(fp, temporary_filename, filename, result);
 }
 
-static int savegame_read_from_buffer(buffer *buf, savegame_version_t version)
+/**
+ * Reads the savegame pieces from the buffer. If file is set, the buffer holds the contents of that file,
+ * which are then owned by the savegame pieces and released when they are cleared.
+ */
+static int savegame_read_from_buffer(buffer *buf, savegame_version_t version, file_mapping *file)
 {
-    memory_block compress_buffer;
-    core_memory_block_init(&compress_buffer, COMPRESS_BUFFER_INITIAL_SIZE);
-    for (int i = 0; i < savegame_data.num_pieces; i++) {
-        file_piece *piece = &savegame_data.pieces[i];
-        size_t result = 0;
-        if (!prepare_dynamic_piece_from_buffer(buf, piece)) {
-            continue;
-        }
-        if (piece->compressed) {
-            result = read_compressed_chunk_from_buffer(buf, piece->buf.data, piece->buf.size,
-                version > SAVE_GAME_LAST_ZIP_COMPRESSION, &compress_buffer);
-        } else {
-            result = buffer_read_raw(buf, piece->buf.data, piece->buf.size) == piece->buf.size;
-        }
-        // The last piece may be smaller than buf.size
-        if (!result && i != (savegame_data.num_pieces - 1)) {
-            log_info("Incorrect buffer size, got", 0, (int) result);
-            log_info("Incorrect buffer size, expected", 0, (int) piece->buf.size);
-            core_memory_block_free(&compress_buffer);
-            return 0;
-        }
-    }
-    core_memory_block_free(&compress_buffer);
-    return 1;
-}
-
-static int savegame_read_from_file(FILE *fp, savegame_version_t version)
-{
-    memory_block compress_buffer;
-    core_memory_block_init(&compress_buffer, COMPRESS_BUFFER_INITIAL_SIZE);
-    for (int i = 0; i < savegame_data.num_pieces; i++) {
-        file_piece *piece = &savegame_data.pieces[i];
-        int result = 0;
-        if (!prepare_dynamic_piece_from_file(fp, piece)) {
-            continue;
-        }
-        if (piece->compressed) {
-            result = read_compressed_savegame_chunk(fp, piece->buf.data, piece->buf.size, version, &compress_buffer);
-        } else {
-            result = fread(piece->buf.data, 1, piece->buf.size, fp) == piece->buf.size;
-        }
-        // The last piece may be smaller than buf.size
-        if (!result && i != (savegame_data.num_pieces - 1)) {
-            log_info("Incorrect buffer size, got", 0, result);
-            log_info("Incorrect buffer size, expected", 0, (int) piece->buf.size);
-            core_memory_block_free(&compress_buffer);
-            return 0;
-        }
+    if (file) {
+        savegame_data.file = *file;
     }
-    core_memory_block_free(&compress_buffer);
-    return 1;
-}
-
-static void savegame_write_to_file(FILE *fp, memory_block *compress_buffer)
-{
-    for (int i = 0; i < savegame_data.num_pieces; i++) {
-        file_piece *piece = &savegame_data.pieces[i];
-        if (piece->dynamic) {
-            write_int32(fp, (int) piece->buf.size);
-            if (!piece->buf.size) {
-                continue;
-            }
-        }
-        if (piece->compressed) {
-            write_compressed_chunk(fp, piece->buf.data, piece->buf.size, compress_buffer);
-        } else {
-            fwrite(piece->buf.data, 1, piece->buf.size, fp);
-        }
+    piece_format format = PIECE_FORMAT_ZIP;
+    if (version > SAVE_GAME_LAST_NO_PIECE_CODEC) {
+        format = PIECE_FORMAT_CODEC_TAGGED;
+    } else if (version > SAVE_GAME_LAST_ZIP_COMPRESSION) {
+        format = PIECE_FORMAT_ZLIB;
     }
+    // The last piece may be smaller than buf.size
+    return read_pieces_from_buffer(buf, savegame_data.pieces, savegame_data.num_pieces, format, 1, file != 0, 1);
 }
 
 static int get_savegame_versions_from_buffer(buffer *buf, savegame_version_t *save_version,
@@ -1664,90 +2219,218 @@ static int get_savegame_versions_from_buffer(buffer *buf, savegame_version_t *sa
     return *save_version != 0;
 }
 
-static int get_savegame_versions(FILE *fp, savegame_version_t *save_version, resource_version_t *resource_version)
+static int is_delta_save(const buffer *buf)
+{
+    return buf->size >= DELTA_SAVE_MAGIC_LENGTH && memcmp(buf->data, DELTA_SAVE_MAGIC, DELTA_SAVE_MAGIC_LENGTH) == 0;
+}
+
+static int is_valid_delta_base_name(const char *base_name)
 {
+    // The base must be next to the delta save
+    return *base_name && !strchr(base_name, '/') && !strchr(base_name, '\\') && !strchr(base_name, ':') &&
+        !strstr(base_name, "..");
+}
+
+static savegame_load_status read_delta_base(const char *filename, const char *base_name, uint64_t base_id,
+    savegame_version_t version, resource_version_t resource_version)
+{
+    char base_filename[FILE_NAME_MAX];
+    size_t dir_length = file_remove_path(filename) - filename;
+    if (dir_length + strlen(base_name) >= FILE_NAME_MAX) {
+        return SAVEGAME_STATUS_INVALID;
+    }
+    memcpy(base_filename, filename, dir_length);
+    strcpy(&base_filename[dir_length], base_name);
+
+    file_mapping file;
+    if (!map_file(base_filename, 0, &file)) {
+        log_error("Unable to find the base save of the delta save", base_filename, 0);
+        return SAVEGAME_STATUS_INVALID;
+    }
     buffer buf;
-    uint8_t data[4];
-    buffer_init(&buf, data, 4);
-    if (fseek(fp, 4, SEEK_CUR) ||
-        fread(data, 1, 4, fp) != 4) {
-        return 0;
+    buffer_init(&buf, file.data, file.size);
+    savegame_version_t base_version;
+    resource_version_t base_resource_version;
+    if (is_delta_save(&buf) || !get_savegame_versions_from_buffer(&buf, &base_version, &base_resource_version) ||
+        base_version != version || base_resource_version != resource_version) {
+        log_error("The base save of the delta save has a different version", base_filename, 0);
+        file_unmap(&file);
+        return SAVEGAME_STATUS_INVALID;
     }
-    *save_version = buffer_read_i32(&buf);
-    int seek_back_bytes = -8;
-    if (*save_version > SAVE_GAME_LAST_STATIC_RESOURCES) {
-        buffer_reset(&buf);
-        if (fread(data, 1, 4, fp) != 4) {
-            return 0;
+    resource_set_mapping(resource_version);
+    init_savegame_data(version);
+    uint64_t hashes[sizeof(savegame_state) / sizeof(buffer *) + 1];
+    if (!savegame_read_from_buffer(&buf, version, &file) ||
+        hash_pieces(savegame_data.pieces, savegame_data.num_pieces, hashes) != base_id) {
+        log_error("The base save of the delta save has been changed", base_filename, 0);
+        clear_savegame_pieces();
+        return SAVEGAME_STATUS_INVALID;
+    }
+    return SAVEGAME_STATUS_OK;
+}
+
+/**
+ * Reads a delta save: the pieces are loaded from its base save,
+ * after which the pieces that changed since the base was written are replaced by the ones in the delta.
+ * The delta pieces are copied, so the buffer can be released afterwards.
+ */
+static savegame_load_status read_delta_save(buffer *buf, const char *filename, savegame_version_t *save_version)
+{
+    if (!filename) {
+        log_error("Delta saves can only be loaded from a file", 0, 0);
+        return SAVEGAME_STATUS_INVALID;
+    }
+    buffer_skip(buf, DELTA_SAVE_MAGIC_LENGTH);
+    savegame_version_t version = buffer_read_i32(buf);
+    resource_version_t resource_version = buffer_read_i32(buf);
+    uint64_t base_id = buffer_read_u32(buf);
+    base_id |= (uint64_t) buffer_read_u32(buf) << 32;
+    char base_name[FILE_NAME_MAX];
+    size_t base_name_length = buffer_read_u8(buf);
+    buffer_read_raw(buf, base_name, base_name_length);
+    base_name[base_name_length] = 0;
+    if (buf->overflow) {
+        return SAVEGAME_STATUS_INVALID;
+    }
+    if (!is_valid_delta_base_name(base_name)) {
+        log_error("Invalid base save name in the delta save", base_name, 0);
+        return SAVEGAME_STATUS_INVALID;
+    }
+    if (version > SAVE_GAME_CURRENT_VERSION || resource_version > RESOURCE_CURRENT_VERSION) {
+        log_error("Newer save game version than supported. Please update Augustus. Version:", 0, version);
+        return SAVEGAME_STATUS_NEWER_VERSION;
+    }
+    if (version <= SAVE_GAME_LAST_NO_PIECE_CODEC) {
+        return SAVEGAME_STATUS_INVALID;
+    }
+    savegame_load_status status = read_delta_base(filename, base_name, base_id, version, resource_version);
+    if (status != SAVEGAME_STATUS_OK) {
+        return status;
+    }
+    int num_pieces = buffer_read_i32(buf);
+    if (num_pieces != savegame_data.num_pieces) {
+        clear_savegame_pieces();
+        return SAVEGAME_STATUS_INVALID;
+    }
+    file_piece changed[sizeof(savegame_state) / sizeof(buffer *) + 1];
+    int changed_index[sizeof(savegame_state) / sizeof(buffer *) + 1];
+    int total_changed = 0;
+    for (int i = 0; i < num_pieces; i++) {
+        if (!buffer_read_u8(buf)) {
+            continue;
         }
-        *resource_version = buffer_read_i32(&buf);
-        seek_back_bytes = -12;
-    } else {
-        *resource_version = RESOURCE_ORIGINAL_VERSION;
+        file_piece *piece = &changed[total_changed];
+        *piece = savegame_data.pieces[i];
+        piece->mapped = 0;
+        piece->arena_data = 0;
+        buffer_init(&piece->buf, 0, piece->dynamic ? 0 : savegame_data.pieces[i].buf.size);
+        changed_index[total_changed++] = i;
+    }
+    if (buf->overflow ||
+        !read_pieces_from_buffer(buf, changed, total_changed, PIECE_FORMAT_CODEC_TAGGED, 0, 0, 0)) {
+        for (int i = 0; i < total_changed; i++) {
+            free_piece_data(&changed[i]);
+        }
+        clear_savegame_pieces();
+        return SAVEGAME_STATUS_INVALID;
     }
-    if (fseek(fp, seek_back_bytes, SEEK_CUR)) {
-        return 0;
+    for (int i = 0; i < total_changed; i++) {
+        file_piece *piece = &savegame_data.pieces[changed_index[i]];
+        free_piece_data(piece);
+        *piece = changed[i];
     }
-    return 1;
+    *save_version = version;
+    return SAVEGAME_STATUS_OK;
 }
 
-int game_file_io_read_save_game_from_buffer(buffer *buf)
+static int load_saved_game(buffer *buf, file_mapping *file, const char *filename)
 {
     int result = 0;
     savegame_version_t save_version;
     resource_version_t resource_version;
-    if (get_savegame_versions_from_buffer(buf, &save_version, &resource_version)) {
+    uint64_t start_time = system_get_precise_ticks();
+    if (is_delta_save(buf)) {
+        savegame_load_status status = read_delta_save(buf, filename, &save_version);
+        if (file) {
+            file_unmap(file);
+        }
+        if (status == SAVEGAME_STATUS_NEWER_VERSION) {
+            return FILE_LOAD_INCOMPATIBLE_VERSION;
+        }
+        result = status == SAVEGAME_STATUS_OK;
+    } else if (get_savegame_versions_from_buffer(buf, &save_version, &resource_version)) {
         if (save_version > SAVE_GAME_CURRENT_VERSION || resource_version > RESOURCE_CURRENT_VERSION) {
             log_error("Newer save game version than supported. Please update Augustus. Version:", 0, save_version);
+            if (file) {
+                file_unmap(file);
+            }
             return FILE_LOAD_INCOMPATIBLE_VERSION;
         }
         log_info("Savegame version", 0, save_version);
         resource_set_mapping(resource_version);
         init_savegame_data(save_version);
-        result = savegame_read_from_buffer(buf, save_version);
+        result = savegame_read_from_buffer(buf, save_version, file);
+    } else if (file) {
+        file_unmap(file);
     }
     if (!result) {
         log_error("Unable to load game, incompatible savefile.", 0, 0);
+        clear_savegame_pieces();
         return FILE_LOAD_WRONG_FILE_FORMAT;
     }
+    uint64_t inflated_time = system_get_precise_ticks();
+    timings.inflate = inflated_time - start_time;
     savegame_load_from_state(&savegame_data.state, save_version);
+    timings.decode = system_get_precise_ticks() - inflated_time;
     clear_savegame_pieces();
     return FILE_LOAD_SUCCESS;
 }
 
+int game_file_io_read_save_game_from_buffer(buffer *buf)
+{
+    reset_load_timings();
+    return load_saved_game(buf, 0, 0);
+}
+
 int game_file_io_read_saved_game(const char *filename, int offset)
 {
     log_info("Loading saved game", filename, 0);
-    FILE *fp = file_open(filename, "rb");
-    if (!fp) {
+    reset_load_timings();
+    uint64_t start_time = system_get_precise_ticks();
+    file_mapping file;
+    if (!map_file(filename, offset, &file)) {
         log_error("Unable to load game, unable to open file.", 0, 0);
         return FILE_LOAD_DOES_NOT_EXIST;
     }
-    if (offset) {
-        fseek(fp, offset, SEEK_SET);
+    timings.read = system_get_precise_ticks() - start_time;
+    buffer buf;
+    buffer_init(&buf, file.data, file.size);
+    return load_saved_game(&buf, &file, filename);
+}
+
+int game_file_io_read_saved_game_state_id(const char *filename, uint64_t *id)
+{
+    file_mapping file;
+    if (!map_file(filename, 0, &file)) {
+        return 0;
     }
-    int result = 0;
+    buffer buf;
+    buffer_init(&buf, file.data, file.size);
     savegame_version_t save_version;
     resource_version_t resource_version;
-    if (get_savegame_versions(fp, &save_version, &resource_version)) {
-        if (save_version > SAVE_GAME_CURRENT_VERSION || resource_version > RESOURCE_CURRENT_VERSION) {
-            log_error("Newer save game version than supported. Please update Augustus. Version:", 0, save_version);
-            file_close(fp);
-            return FILE_LOAD_INCOMPATIBLE_VERSION;
-        }
-        log_info("Savegame version", 0, save_version);
-        resource_set_mapping(resource_version);
-        init_savegame_data(save_version);
-        result = savegame_read_from_file(fp, save_version);
+    if (is_delta_save(&buf) || !get_savegame_versions_from_buffer(&buf, &save_version, &resource_version) ||
+        save_version != SAVE_GAME_CURRENT_VERSION || resource_version != RESOURCE_CURRENT_VERSION) {
+        file_unmap(&file);
+        return 0;
     }
-    file_close(fp);
-    if (!result) {
-        log_error("Unable to load game, incompatible savefile.", 0, 0);
-        return FILE_LOAD_WRONG_FILE_FORMAT;
+    init_savegame_data(save_version);
+    int result = savegame_read_from_buffer(&buf, save_version, &file);
+    if (result) {
+        uint64_t hashes[sizeof(savegame_state) / sizeof(buffer *) + 1];
+        *id = hash_pieces(savegame_data.pieces, savegame_data.num_pieces, hashes);
     }
-    savegame_load_from_state(&savegame_data.state, save_version);
     clear_savegame_pieces();
-    return 1;
+    return result;
 }
 
 static int savegame_terrain_at(int grid_offset)
@@ -1830,13 +2513,13 @@ static void get_saved_game_origin(saved_game_info *info, const savegame_state *s
     file_remove_extension(info->origin.campaign_name);
 }
 
-static savegame_load_status savegame_read_file_info(saved_game_info *info, savegame_version_t version)
+static scenario_version_t read_saved_game_basic_info(saved_game_info *info, savegame_version_t version,
+    unsigned int *caravanserai_id)
 {
     const savegame_state *state = &savegame_data.state;
     scenario_version_t scenario_version = save_version_to_scenario_version(version, state->scenario_version);
 
-    city_data_load_basic_info(state->city_data, &info->population, &info->treasury,
-        &minimap_data.caravanserai_id, version);
+    city_data_load_basic_info(state->city_data, &info->population, &info->treasury, caravanserai_id, version);
     game_time_load_basic_info(state->game_time, &info->month, &info->year);
 
     scenario_description_from_buffer(state->scenario, info->description, scenario_version);
@@ -1857,13 +2540,25 @@ static savegame_load_status savegame_read_file_info(saved_game_info *info, saveg
 
     get_saved_game_origin(info, state);
 
+    int height;
+    int grid_start;
+    int grid_border_size;
+    scenario_map_data_from_buffer(state->scenario, &info->map_size, &height, &grid_start, &grid_border_size,
+        scenario_version);
+    return scenario_version;
+}
+
+static savegame_load_status savegame_read_file_info(saved_game_info *info, savegame_version_t version)
+{
+    const savegame_state *state = &savegame_data.state;
+    scenario_version_t scenario_version = read_saved_game_basic_info(info, version, &minimap_data.caravanserai_id);
+
     int grid_start;
     int grid_border_size;
 
     minimap_data.version = version;
     scenario_map_data_from_buffer(state->scenario, &minimap_data.city_width, &minimap_data.city_height,
         &grid_start, &grid_border_size, scenario_version);
-    info->map_size = minimap_data.city_width;
     minimap_data.climate = scenario_climate_from_buffer(state->scenario, scenario_version);
     minimap_data.functions.building = savegame_building;
     minimap_data.functions.climate = get_climate;
@@ -1893,35 +2588,110 @@ int game_file_io_read_saved_game_info(const char *filename, int offset, saved_ga
     if (!info) {
         return SAVEGAME_STATUS_INVALID;
     }
-    memset(info, 0, sizeof(saved_game_info));
-    FILE *fp = file_open(filename, "rb");
-    if (!fp) {
+    file_mapping file;
+    if (!map_file(filename, offset, &file)) {
         return SAVEGAME_STATUS_INVALID;
     }
-    if (offset) {
-        fseek(fp, offset, SEEK_SET);
-    }
+    buffer buf;
+    buffer_init(&buf, file.data, file.size);
     savegame_load_status result = SAVEGAME_STATUS_INVALID;
     savegame_version_t save_version;
     resource_version_t resource_version;
-    if (!get_savegame_versions(fp, &save_version, &resource_version)) {
-        file_close(fp);
+    if (is_delta_save(&buf)) {
+        result = read_delta_save(&buf, filename, &save_version);
+        file_unmap(&file);
+        if (result != SAVEGAME_STATUS_OK) {
+            return result;
+        }
+        return savegame_read_file_info(info, save_version);
+    }
+    if (!get_savegame_versions_from_buffer(&buf, &save_version, &resource_version)) {
+        file_unmap(&file);
         return SAVEGAME_STATUS_INVALID;
     }
     if (save_version > SAVE_GAME_CURRENT_VERSION || resource_version > RESOURCE_CURRENT_VERSION) {
-        file_close(fp);
+        file_unmap(&file);
         return SAVEGAME_STATUS_NEWER_VERSION;
     }
     resource_set_mapping(resource_version);
     init_savegame_data(save_version);
-    result = savegame_read_from_file(fp, save_version);
-    file_close(fp);
+    result = savegame_read_from_buffer(&buf, save_version, &file);
     if (result != SAVEGAME_STATUS_OK) {
+        clear_savegame_pieces();
         return FILE_LOAD_WRONG_FILE_FORMAT;
     }
     return savegame_read_file_info(info, save_version);
 }
 
+/**
+ * Marks the pieces that aren't needed for the basic saved game info as skipped, so they aren't inflated
+ */
+static void skip_pieces_for_basic_info(void)
+{
+    const savegame_state *state = &savegame_data.state;
+    const buffer *needed[] = {
+        state->scenario_campaign_mission, state->file_version, state->scenario_version, state->city_data,
+        state->game_time, state->scenario, state->invasions, state->scenario_is_custom, state->scenario_name,
+        state->campaign_name
+    };
+    for (int i = 0; i < savegame_data.num_pieces; i++) {
+        file_piece *piece = &savegame_data.pieces[i];
+        piece->skipped = 1;
+        for (size_t j = 0; j < sizeof(needed) / sizeof(needed[0]); j++) {
+            if (&piece->buf == needed[j]) {
+                piece->skipped = 0;
+                break;
+            }
+        }
+        if (piece->skipped) {
+            free_piece_data(piece);
+        }
+    }
+}
+
+int game_file_io_read_saved_game_basic_info(const char *filename, saved_game_info *info)
+{
+    memset(info, 0, sizeof(saved_game_info));
+
+    file_mapping file;
+    if (!map_file(filename, 0, &file)) {
+        return SAVEGAME_STATUS_INVALID;
+    }
+    buffer buf;
+    buffer_init(&buf, file.data, file.size);
+    savegame_version_t save_version;
+    resource_version_t resource_version;
+    unsigned int caravanserai_id;
+    if (is_delta_save(&buf)) {
+        savegame_load_status result = read_delta_save(&buf, filename, &save_version);
+        file_unmap(&file);
+        if (result != SAVEGAME_STATUS_OK) {
+            return result;
+        }
+        read_saved_game_basic_info(info, save_version, &caravanserai_id);
+        clear_savegame_pieces();
+        return SAVEGAME_STATUS_OK;
+    }
+    if (!get_savegame_versions_from_buffer(&buf, &save_version, &resource_version)) {
+        file_unmap(&file);
+        return SAVEGAME_STATUS_INVALID;
+    }
+    if (save_version > SAVE_GAME_CURRENT_VERSION || resource_version > RESOURCE_CURRENT_VERSION) {
+        file_unmap(&file);
+        return SAVEGAME_STATUS_NEWER_VERSION;
+    }
+    resource_set_mapping(resource_version);
+    init_savegame_data(save_version);
+    skip_pieces_for_basic_info();
+    if (!savegame_read_from_buffer(&buf, save_version, &file)) {
+        clear_savegame_pieces();
+        return SAVEGAME_STATUS_INVALID;
+    }
+    read_saved_game_basic_info(info, save_version, &caravanserai_id);
+    clear_savegame_pieces();
+    return SAVEGAME_STATUS_OK;
+}
+
 int game_file_io_read_saved_game_info_from_buffer(buffer *buf, saved_game_info *info)
 {
     memset(info, 0, sizeof(saved_game_info));
@@ -1940,7 +2710,7 @@ int game_file_io_read_saved_game_info_from_buffer(buffer *buf, saved_game_info *
         log_info("Savegame version", 0, save_version);
         resource_set_mapping(resource_version);
         init_savegame_data(save_version);
-        result = savegame_read_from_buffer(buf, save_version);
+        result = savegame_read_from_buffer(buf, save_version, 0);
     }
     if (!result) {
         log_error("Unable to load game, incompatible savefile.", 0, 0);
@@ -1949,28 +2719,297 @@ int game_file_io_read_saved_game_info_from_buffer(buffer *buf, saved_game_info *
     return savegame_read_file_info(info, save_version);
 }
 
+static save_compression get_save_compression(void)
+{
+    save_compression compression = config_get(CONFIG_GENERAL_SAVE_COMPRESSION);
+    if (compression < 0 || compression >= SAVE_COMPRESSION_MAX) {
+        compression = SAVE_COMPRESSION_DEFLATE_FAST;
+    }
+    return compression;
+}
+
+static int write_savegame_pieces(const char *filename, save_compression compression)
+{
+    char temporary_filename[FILE_NAME_MAX];
+    FILE *fp = open_temporary_file(filename, temporary_filename);
+    if (!fp) {
+        log_error("Unable to save game", 0, 0);
+        return 0;
+    }
+    int result = write_pieces_to_file(fp, savegame_data.pieces, savegame_data.num_pieces, compression, 1);
+    return close_temporary_file(fp, temporary_filename, filename, result);
+}
+
 int game_file_io_write_saved_game(const char *filename)
 {
+    uint64_t start_time = system_get_ticks();
     resource_set_mapping(RESOURCE_CURRENT_VERSION);
     init_savegame_data(SAVE_GAME_CURRENT_VERSION);
 
     log_info("Saving game", filename, 0);
-    savegame_save_to_state(&savegame_data.state);
+    reset_save_timings();
+    char temporary_filename[FILE_NAME_MAX];
+    FILE *fp = open_temporary_file(filename, temporary_filename);
+    if (!fp) {
+        log_error("Unable to save game", 0, 0);
+        clear_savegame_pieces();
+        return 0;
+    }
+    piece_writer writer;
+    int result = start_piece_writer(&writer, fp, savegame_data.pieces, savegame_data.num_pieces,
+        get_save_compression(), 1);
+    if (result) {
+        writer.release_pieces = 1;
+        writer.piece_timings = start_piece_timings(savegame_data.num_pieces);
+        uint64_t encode_start_time = system_get_precise_ticks();
+        savegame_save_to_state(&savegame_data.state, &writer);
+        // Compressing and writing are partly done while creating the pieces
+        timings.encode = system_get_precise_ticks() - encode_start_time - timings.deflate - timings.write;
+        result = finish_piece_writer(&writer);
+    }
+    result = close_temporary_file(fp, temporary_filename, filename, result);
+    clear_savegame_pieces();
+    log_info("Game saved, time in ms:", 0, (int) (system_get_ticks() - start_time));
+    return result;
+}
+
+static int write_delta_header(FILE *fp, const char *base_filename, const uint8_t *changed, int num_pieces)
+{
+    const char *base_name = file_remove_path(base_filename);
+    size_t base_name_length = strlen(base_name);
+    if (base_name_length > UINT8_MAX) {
+        log_error("Base save name too long", base_name, 0);
+        return 0;
+    }
+    size_t size = DELTA_SAVE_MAGIC_LENGTH + 16 + 1 + base_name_length + 4 + num_pieces;
+    uint8_t *data = malloc(size);
+    if (!data) {
+        log_error("Unable to allocate memory for the delta save", 0, 0);
+        return 0;
+    }
+    buffer buf;
+    buffer_init(&buf, data, size);
+    buffer_write_raw(&buf, DELTA_SAVE_MAGIC, DELTA_SAVE_MAGIC_LENGTH);
+    buffer_write_i32(&buf, SAVE_GAME_CURRENT_VERSION);
+    buffer_write_i32(&buf, RESOURCE_CURRENT_VERSION);
+    buffer_write_u32(&buf, (uint32_t) delta_base.id);
+    buffer_write_u32(&buf, (uint32_t) (delta_base.id >> 32));
+    buffer_write_u8(&buf, (uint8_t) base_name_length);
+    buffer_write_raw(&buf, base_name, base_name_length);
+    buffer_write_i32(&buf, num_pieces);
+    buffer_write_raw(&buf, changed, num_pieces);
+    int result = fwrite(data, 1, size, fp) == size;
+    free(data);
+    return result;
+}
+
+/**
+ * Uses the base save already in the file as the base of the next delta saves,
+ * so that the deltas written in earlier sessions still find the base they were made from.
+ */
+static int use_existing_delta_base(const char *base_filename)
+{
+    file_mapping file;
+    if (strlen(base_filename) >= FILE_NAME_MAX || !map_file(base_filename, 0, &file)) {
+        return 0;
+    }
+    buffer buf;
+    buffer_init(&buf, file.data, file.size);
+    savegame_version_t version;
+    resource_version_t resource_version;
+    if (is_delta_save(&buf) || !get_savegame_versions_from_buffer(&buf, &version, &resource_version) ||
+        version != SAVE_GAME_CURRENT_VERSION || resource_version != RESOURCE_CURRENT_VERSION) {
+        file_unmap(&file);
+        return 0;
+    }
+    resource_set_mapping(resource_version);
+    init_savegame_data(version);
+    delta_base.num_pieces = 0;
+    if (savegame_read_from_buffer(&buf, version, &file)) {
+        delta_base.id = hash_pieces(savegame_data.pieces, savegame_data.num_pieces, delta_base.hashes);
+        if (delta_base.id) {
+            strcpy(delta_base.filename, base_filename);
+            delta_base.num_pieces = savegame_data.num_pieces;
+            log_info("Using the existing base for delta saves", base_filename, 0);
+        }
+    }
+    clear_savegame_pieces();
+    return delta_base.num_pieces != 0;
+}
+
+int game_file_io_write_saved_game_delta(const char *filename, const char *base_filename, int rebase)
+{
+    uint64_t start_time = system_get_ticks();
+    // A base is only replaced when it is due, as the deltas in the history may still need it
+    if (!rebase && strcmp(delta_base.filename, base_filename) != 0) {
+        use_existing_delta_base(base_filename);
+    }
+    resource_set_mapping(RESOURCE_CURRENT_VERSION);
+    init_savegame_data(SAVE_GAME_CURRENT_VERSION);
+
+    log_info("Saving game delta", filename, 0);
+    reset_save_timings();
+    uint64_t encode_start_time = system_get_precise_ticks();
+    savegame_save_to_state(&savegame_data.state, 0);
+    timings.encode = system_get_precise_ticks() - encode_start_time;
+
+    save_compression compression = get_save_compression();
+    uint64_t hashes[sizeof(savegame_state) / sizeof(buffer *) + 1];
+    uint64_t id = hash_pieces(savegame_data.pieces, savegame_data.num_pieces, hashes);
+
+    if (rebase || delta_base.num_pieces != savegame_data.num_pieces ||
+        strcmp(delta_base.filename, base_filename) != 0) {
+        delta_base.num_pieces = 0;
+        log_info("Saving new base for delta saves", base_filename, 0);
+        if (strlen(base_filename) >= FILE_NAME_MAX || !write_savegame_pieces(base_filename, compression)) {
+            clear_savegame_pieces();
+            return 0;
+        }
+        strcpy(delta_base.filename, base_filename);
+        memcpy(delta_base.hashes, hashes, sizeof(uint64_t) * savegame_data.num_pieces);
+        delta_base.num_pieces = savegame_data.num_pieces;
+        delta_base.id = id;
+    }
+
+    uint8_t changed[sizeof(savegame_state) / sizeof(buffer *) + 1];
+    file_piece changed_pieces[sizeof(savegame_state) / sizeof(buffer *) + 1];
+    int total_changed = 0;
+    for (int i = 0; i < savegame_data.num_pieces; i++) {
+        changed[i] = hashes[i] != delta_base.hashes[i];
+        if (changed[i]) {
+            changed_pieces[total_changed++] = savegame_data.pieces[i];
+        }
+    }
 
-    FILE *fp = file_open(filename, "wb");
+    char temporary_filename[FILE_NAME_MAX];
+    FILE *fp = open_temporary_file(filename, temporary_filename);
     if (!fp) {
         log_error("Unable to save game", 0, 0);
+        clear_savegame_pieces();
         return 0;
     }
-    memory_block compress_buffer;
-    core_memory_block_init(&compress_buffer, COMPRESS_BUFFER_INITIAL_SIZE);
-    savegame_write_to_file(fp, &compress_buffer);
-    core_memory_block_free(&compress_buffer);
+    int result = write_delta_header(fp, base_filename, changed, savegame_data.num_pieces);
+    if (result && total_changed) {
+        result = write_pieces_to_file(fp, changed_pieces, total_changed, compression, 1);
+    }
+    result = close_temporary_file(fp, temporary_filename, filename, result);
     clear_savegame_pieces();
-    file_close(fp);
+    log_info("Changed pieces in delta save:", 0, total_changed);
+    log_info("Game delta saved, time in ms:", 0, (int) (system_get_ticks() - start_time));
+    return result;
+}
+
+static int encode_piece(const file_piece *piece, const compressed_piece *compressed, saved_game_piece *encoded)
+{
+    int size = (int) piece->buf.size;
+    int encoded_size = piece->dynamic ? 4 : 0;
+    if (!compressed) {
+        encoded_size += size;
+    } else if (compressed->size) {
+        encoded_size += 4 + 1 + compressed->size;
+    } else {
+        encoded_size += 4 + size;
+    }
+    encoded->data = malloc(encoded_size);
+    if (!encoded->data) {
+        return 0;
+    }
+    encoded->size = encoded_size;
+    buffer buf;
+    buffer_init(&buf, encoded->data, encoded_size);
+    if (piece->dynamic) {
+        buffer_write_i32(&buf, size);
+    }
+    if (compressed && compressed->size) {
+        buffer_write_i32(&buf, compressed->size);
+        buffer_write_u8(&buf, compressed->compression == SAVE_COMPRESSION_LZ4 ? PIECE_CODEC_LZ4 : PIECE_CODEC_ZLIB);
+        buffer_write_raw(&buf, compressed->output, compressed->size);
+    } else {
+        if (compressed) {
+            buffer_write_i32(&buf, (int32_t) UNCOMPRESSED);
+        }
+        buffer_write_raw(&buf, piece->buf.data, size);
+    }
     return 1;
 }
 
+int game_file_io_write_saved_game_to_memory(saved_game_piece **pieces, const saved_game_piece *previous,
+    int num_previous)
+{
+    uint64_t start_time = system_get_ticks();
+    resource_set_mapping(RESOURCE_CURRENT_VERSION);
+    init_savegame_data(SAVE_GAME_CURRENT_VERSION);
+    savegame_save_to_state(&savegame_data.state, 0);
+
+    int num_pieces = savegame_data.num_pieces;
+    saved_game_piece *encoded = calloc(num_pieces, sizeof(saved_game_piece));
+    compressed_piece *compressed = create_compressed_pieces(num_pieces);
+    if (!encoded || !compressed) {
+        log_error("Unable to allocate memory for the game snapshot", 0, 0);
+        free(encoded);
+        clear_savegame_pieces();
+        return 0;
+    }
+    uint64_t hashes[sizeof(savegame_state) / sizeof(buffer *) + 1];
+    hash_pieces(savegame_data.pieces, num_pieces, hashes);
+    // The previous pieces are only kept compressed, so they are compared through their hash. It mixes every bit
+    // of the piece, so pieces with the same hash are the same
+    int unchanged[sizeof(savegame_state) / sizeof(buffer *) + 1];
+    for (int i = 0; i < num_pieces; i++) {
+        unchanged[i] = i < num_previous && previous[i].hash == hashes[i];
+    }
+
+    // Only the pieces that changed are compressed, using the fastest codec
+    int total_compressed = 0;
+    for (int i = 0; i < num_pieces; i++) {
+        encoded[i].hash = hashes[i];
+        file_piece *piece = &savegame_data.pieces[i];
+        if (unchanged[i]) {
+            continue;
+        }
+        if (piece->compressed && piece->buf.size) {
+            add_compressed_piece(&compressed[total_compressed++], piece, SAVE_COMPRESSION_LZ4);
+        }
+    }
+    thread_pool_run_for_each(compress_piece, compressed, sizeof(compressed_piece), total_compressed);
+
+    int result = 1;
+    compressed_piece *current = compressed;
+    for (int i = 0; i < num_pieces; i++) {
+        const file_piece *piece = &savegame_data.pieces[i];
+        if (unchanged[i]) {
+            continue;
+        }
+        int is_compressed = piece->compressed && piece->buf.size;
+        if (result && !encode_piece(piece, is_compressed ? current : 0, &encoded[i])) {
+            log_error("Unable to allocate memory for the game snapshot", 0, 0);
+            result = 0;
+        }
+        if (is_compressed) {
+            current++;
+        }
+    }
+    for (int i = 0; i < total_compressed; i++) {
+        release_compressed_piece(&compressed[i]);
+    }
+    clear_savegame_pieces();
+    if (!result) {
+        for (int i = 0; i < num_pieces; i++) {
+            free(encoded[i].data);
+        }
+        free(encoded);
+        return 0;
+    }
+    *pieces = encoded;
+    log_info("Game written to memory, time in ms:", 0, (int) (system_get_ticks() - start_time));
+    return num_pieces;
+}
+
+const game_file_io_timings *game_file_io_get_timings(void)
+{
+    return &timings;
+}
+
 int game_file_io_delete_saved_game(const char *filename)
 {
     log_info("Deleting game", filename, 0);
@@ -10,6 +10,13 @@ typedef enum {
     SAVEGAME_FROM_CUSTOM_CAMPAIGN = 2
 } saved_game_origin;
 
+typedef enum {
+    SAVE_COMPRESSION_DEFLATE_FAST = 0,
+    SAVE_COMPRESSION_LZ4 = 1,
+    SAVE_COMPRESSION_DEFLATE_BEST = 2,
+    SAVE_COMPRESSION_MAX
+} save_compression;
+
 typedef struct {
     struct {
         int mission;
@@ -33,6 +40,31 @@ typedef struct {
     scenario_win_criteria win_criteria;
 } saved_game_info;
 
+typedef struct {
+    uint64_t hash;
+    uint8_t *data;
+    int size;
+} saved_game_piece;
+
+typedef struct {
+    int size;
+    int stored_size;
+    uint64_t inflate;
+    uint64_t deflate;
+    uint64_t write;
+} game_file_io_piece_timings;
+
+typedef struct {
+    uint64_t read;
+    uint64_t inflate;
+    uint64_t decode;
+    uint64_t encode;
+    uint64_t deflate;
+    uint64_t write;
+    int num_pieces;
+    const game_file_io_piece_timings *pieces;
+} game_file_io_timings;
+
 int game_file_io_read_scenario(const char *filename);
 
 int game_file_io_read_scenario_from_buffer(buffer *buf);
@@ -47,12 +79,66 @@ int game_file_io_read_saved_game(const char *filename, int offset);
 
 int game_file_io_read_save_game_from_buffer(buffer *buf);
 
+/**
+ * Reads the game state pieces of a saved game without decoding them, and gets an id of their contents.
+ * Saved games with the same id hold the same game state.
+ * @param filename File to read
+ * @param id Set to the id of the pieces
+ * @return Boolean true on success, false when the file can't be read, is a delta save or was written
+ *         by another version, as the pieces are then laid out differently
+ */
+int game_file_io_read_saved_game_state_id(const char *filename, uint64_t *id);
+
 int game_file_io_read_saved_game_info(const char *filename, int offset, saved_game_info *info);
 
 int game_file_io_read_saved_game_info_from_buffer(buffer *buf, saved_game_info *info);
 
+/**
+ * Reads the saved game info without rendering the minimap, only inflating the pieces it needs.
+ * Like every other function in this file, it uses shared state, so it must never run at the same time as them.
+ * @param filename File to read
+ * @param info Info to fill in
+ * @return Savegame load status
+ */
+int game_file_io_read_saved_game_basic_info(const char *filename, saved_game_info *info);
+
 int game_file_io_write_saved_game(const char *filename);
 
+/**
+ * Writes a delta save, which only contains the pieces that changed since its base save was written.
+ * The base save is (re)written first when rebase is set or when the last base that was written
+ * in this session is not base_filename. Both files must be in the same directory.
+ * @param filename File to write the delta to
+ * @param base_filename Full saved game the delta refers to
+ * @param rebase Whether to always write a new base save
+ * @return Boolean true on success, false on failure
+ */
+int game_file_io_write_saved_game_delta(const char *filename, const char *base_filename, int rebase);
+
+/**
+ * Writes the current game to memory, one piece at a time. Every piece is encoded the same way as in a saved game
+ * file, so the pieces put one after the other can be loaded with game_file_io_read_save_game_from_buffer().
+ * Pieces with the same contents as the piece at the same position in previous are not encoded again:
+ * their data is left empty so the caller can keep using the previous copy.
+ * @param pieces Set to the newly allocated pieces. Both the array and the data of every piece must be freed
+ * @param previous Pieces written by an earlier call to compare with, or 0
+ * @param num_previous Number of previous pieces
+ * @return The number of pieces, or 0 on failure
+ */
+int game_file_io_write_saved_game_to_memory(saved_game_piece **pieces, const saved_game_piece *previous,
+    int num_previous);
+
+/**
+ * Gets how long every stage of the last load and of the last save of a saved game or scenario took.
+ * Loading sets read, inflate and decode, saving sets encode, deflate and write. All times are in microseconds.
+ * The pieces of the last load or save are also timed one by one: their size in memory and in the file,
+ * and how long inflating, or deflating and writing them took. Decoding and encoding are only timed as
+ * a whole, as the game state is read from and written to several pieces at once. Writing a delta save
+ * times no pieces, and loading one only times the pieces of its base.
+ * @return The timings
+ */
+const game_file_io_timings *game_file_io_get_timings(void);
+
 int game_file_io_delete_saved_game(const char *filename);
 
 #endif // GAME_FILE_IO_H
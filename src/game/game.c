@@ -12,12 +12,15 @@
 #include "core/log.h"
 #include "core/random.h"
 #include "core/string.h"
+#include "core/thread_pool.h"
+#include "core/trace.h"
 #include "editor/editor.h"
 #include "figure/type.h"
 #include "game/animation.h"
 #include "game/campaign.h"
 #include "game/file.h"
 #include "game/file_editor.h"
+#include "game/loading.h"
 #include "game/settings.h"
 #include "game/speed.h"
 #include "game/state.h"
@@ -81,19 +84,29 @@ static encoding_type update_encoding(int is_editor)
 
 int game_pre_init(void)
 {
+    trace_begin("game_pre_init");
+    thread_pool_init();
+    trace_begin("settings_load");
     settings_load();
+    trace_end("settings_load");
+    trace_begin("config_load");
     config_load();
     hotkey_config_load();
+    trace_end("config_load");
     scenario_settings_init();
     game_campaign_clear();
     game_state_unpause();
 
+    trace_begin("lang_load");
     if (!lang_load(0)) {
         errlog("'c3.eng' or 'c3_mm.eng' files not found or too large.");
+        trace_end("game_pre_init");
         return 0;
     }
+    trace_end("lang_load");
     update_encoding(0);
     random_init();
+    trace_end("game_pre_init");
     return 1;
 }
 
@@ -109,18 +122,54 @@ static int is_unpatched(void)
     return difficulty_option == help_menu || delete_game == option_menu;
 }
 
+enum {
+    STARTUP_STEP_CLIMATE,
+    STARTUP_STEP_ENEMY,
+    STARTUP_STEP_FONTS,
+    STARTUP_STEPS
+};
+
+static int load_climate_images(void)
+{
+    trace_begin("image_load_climate");
+    int result = image_load_climate(CLIMATE_CENTRAL, 0, 1, 0);
+    trace_end("image_load_climate");
+    return result;
+}
+
+static int load_enemy_images(void)
+{
+    trace_begin("image_load_enemy");
+    int result = image_load_enemy(ENEMY_0_BARBARIAN);
+    trace_end("image_load_enemy");
+    return result;
+}
+
+static int load_font_images(void)
+{
+    trace_begin("image_load_fonts");
+    int result = image_load_fonts(encoding_get());
+    trace_end("image_load_fonts");
+    return result;
+}
+
 int game_init(void)
 {
-    if (!image_load_climate(CLIMATE_CENTRAL, 0, 1, 0)) {
+    static const game_loading_step steps[STARTUP_STEPS] = {
+        load_climate_images, load_enemy_images, load_font_images
+    };
+    int results[STARTUP_STEPS];
+    game_loading_run(steps, results, STARTUP_STEPS);
+    if (!results[STARTUP_STEP_CLIMATE]) {
         errlog("unable to load main graphics");
         return 0;
     }
-    if (!image_load_enemy(ENEMY_0_BARBARIAN)) {
+    if (!results[STARTUP_STEP_ENEMY]) {
         errlog("unable to load enemy graphics");
         return 0;
     }
     int missing_fonts = 0;
-    if (!image_load_fonts(encoding_get())) {
+    if (!results[STARTUP_STEP_FONTS]) {
         errlog("unable to load font graphics");
         if (encoding_get() == ENCODING_KOREAN || encoding_get() == ENCODING_JAPANESE) {
             missing_fonts = 1;
@@ -134,7 +183,9 @@ int game_init(void)
 
     building_properties_init();
     load_augustus_messages();
+    trace_begin("sound_system_init");
     sound_system_init();
+    trace_end("sound_system_init");
     game_state_init();
     resource_init();
     int actions = ACTION_NONE;
@@ -240,6 +291,8 @@ void game_run(void)
 
 void game_draw(void)
 {
+    image_start_frame();
+    image_update_lazy_loading();
     window_draw(0);
     sound_city_play();
 }
@@ -257,6 +310,8 @@ void game_display_fps(int fps)
 
 void game_exit(void)
 {
+    image_stop_lazy_loading();
+    thread_pool_shutdown();
     video_shutdown();
     settings_save();
     config_save();
@@ -0,0 +1,118 @@
+#include "loading.h"
+
+#include "core/thread.h"
+#include "core/thread_pool.h"
+#include "game/system.h"
+#include "graphics/color.h"
+#include "graphics/graphics.h"
+#include "graphics/renderer.h"
+#include "graphics/screen.h"
+#include "graphics/window.h"
+
+#include <stdint.h>
+
+// The progress bar is only shown when loading takes long enough to be noticed,
+// so quick reloads do not flash it over the city
+#define PROGRESS_DELAY_MILLIS 100
+#define FRAME_MILLIS 16
+#define PROGRESS_BAR_HEIGHT 12
+
+static struct {
+    const game_loading_step *steps;
+    int *results;
+    int total_steps;
+    int finished_steps;
+    thread_mutex *mutex;
+} data;
+
+static void run_steps(void *unused)
+{
+    for (int i = 0; i < data.total_steps; i++) {
+        data.results[i] = data.steps[i]();
+        if (data.mutex) {
+            thread_mutex_lock(data.mutex);
+            data.finished_steps = i + 1;
+            thread_mutex_unlock(data.mutex);
+        }
+    }
+}
+
+static int get_finished_steps(void)
+{
+    thread_mutex_lock(data.mutex);
+    int finished_steps = data.finished_steps;
+    thread_mutex_unlock(data.mutex);
+    return finished_steps;
+}
+
+static void draw_progress(int finished_steps)
+{
+    int width = screen_width() / 3;
+    int x = (screen_width() - width) / 2;
+    int y = (screen_height() - PROGRESS_BAR_HEIGHT) / 2;
+    graphics_reset_dialog();
+    graphics_reset_clip_rectangle();
+    graphics_fill_rect(x - 2, y - 2, width + 4, PROGRESS_BAR_HEIGHT + 4, COLOR_BLACK);
+    graphics_draw_rect(x - 1, y - 1, width + 2, PROGRESS_BAR_HEIGHT + 2, COLOR_LIGHT_GRAY);
+    int done_width = width * finished_steps / data.total_steps;
+    if (done_width > 0) {
+        graphics_fill_rect(x, y, done_width, PROGRESS_BAR_HEIGHT, COLOR_WHITE);
+    }
+}
+
+static int start_background_loading(void)
+{
+    if (!thread_pool_total_workers()) {
+        return 0;
+    }
+    if (!data.mutex) {
+        data.mutex = thread_mutex_create();
+        if (!data.mutex) {
+            return 0;
+        }
+    }
+    return graphics_renderer_start_forwarding();
+}
+
+void game_loading_run(const game_loading_step *steps, int *results, int total_steps)
+{
+    data.steps = steps;
+    data.results = results;
+    data.total_steps = total_steps;
+    data.finished_steps = 0;
+
+    if (total_steps <= 0) {
+        return;
+    }
+    if (!start_background_loading()) {
+        run_steps(0);
+        return;
+    }
+    thread_pool_job *job = thread_pool_start_job(run_steps, 0);
+    if (!job) {
+        graphics_renderer_stop_forwarding();
+        run_steps(0);
+        return;
+    }
+    // Loading started by the input of a window happens halfway through drawing a frame, which must not be
+    // presented nor have its viewport and clip rectangle reset, so only the window events are handled then
+    int can_show_progress = !window_is_drawing();
+    uint64_t start_time = system_get_ticks();
+    uint64_t last_frame_time = 0;
+    int shown_steps = -1;
+    while (!thread_pool_job_is_done(job)) {
+        graphics_renderer_run_forwarded_calls();
+        uint64_t now = system_get_ticks();
+        int finished_steps = get_finished_steps();
+        int show_frame = can_show_progress && now - start_time >= PROGRESS_DELAY_MILLIS &&
+            (finished_steps != shown_steps || now - last_frame_time >= FRAME_MILLIS);
+        if (show_frame) {
+            draw_progress(finished_steps);
+            shown_steps = finished_steps;
+            last_frame_time = now;
+        }
+        system_handle_events_while_loading(show_frame);
+    }
+    thread_pool_finish_job(job);
+    graphics_renderer_stop_forwarding();
+}
@@ -0,0 +1,30 @@
+#ifndef GAME_LOADING_H
+#define GAME_LOADING_H
+
+/**
+ * @file
+ * Loads images on a background thread while the main thread keeps the window responsive.
+ *
+ * While the steps run, the renderer calls that create or free images are forwarded to the main thread,
+ * which runs them, handles the window events and draws a progress bar when loading takes a while.
+ * The progress bar is only shown when loading starts outside of drawing a frame, such as at startup.
+ * Without worker threads, the steps simply run on the calling thread.
+ */
+
+/**
+ * A loading step
+ * @return The result of the step
+ */
+typedef int (*game_loading_step)(void);
+
+/**
+ * Runs the steps one after the other in the background and waits for all of them to finish.
+ * Must be called from the main thread, and the steps must not use anything the main thread changes
+ * while handling window events
+ * @param steps The steps to run
+ * @param results Receives the result of every step
+ * @param total_steps The number of steps
+ */
+void game_loading_run(const game_loading_step *steps, int *results, int total_steps);
+
+#endif // GAME_LOADING_H
@@ -0,0 +1,429 @@
+#include "save_benchmark.h"
+
+#include "core/dir.h"
+#include "core/file.h"
+#include "core/log.h"
+#include "game/file.h"
+#include "game/file_io.h"
+#include "game/system.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCHMARK_ITERATIONS 5
+#define RESULTS_FILE_NAME "save_benchmark.csv"
+#define PIECE_RESULTS_FILE_NAME "save_benchmark_pieces.csv"
+#define TEMP_FILE_NAME_FIRST "save_benchmark_1.tmp"
+#define TEMP_FILE_NAME_SECOND "save_benchmark_2.tmp"
+// A load or save is only reported as slower when it takes 10% and at least a millisecond longer than the baseline
+#define SLOWER_PERCENTAGE 110
+#define SLOWER_MIN_DIFFERENCE 1000
+
+typedef enum {
+    STATUS_OK = 0,
+    STATUS_LOAD_FAILED = 1,
+    STATUS_SAVE_FAILED = 2,
+    STATUS_ROUND_TRIP_MISMATCH = 3,
+    STATUS_ORIGINAL_STATE_MISMATCH = 4,
+    STATUS_SLOWER = 5
+} benchmark_status;
+
+static const char *STATUS_NAMES[] = {
+    "ok", "load failed", "save failed", "round trip mismatch", "original state mismatch", "slower"
+};
+
+typedef enum {
+    ORIGINAL_STATE_NOT_COMPARED = 0,
+    ORIGINAL_STATE_SAME = 1,
+    ORIGINAL_STATE_DIFFERENT = 2
+} original_state_check;
+
+static const char *ORIGINAL_STATE_NAMES[] = { "", "same", "different" };
+
+typedef struct {
+    char name[FILE_NAME_MAX];
+    int is_scenario;
+    long file_size;
+    long saved_size;
+    game_file_io_timings load;
+    game_file_io_piece_timings *load_pieces;
+    uint64_t load_time;
+    game_file_io_timings save;
+    game_file_io_piece_timings *save_pieces;
+    uint64_t save_time;
+    int round_trip_ok;
+    original_state_check original_state;
+    int has_baseline;
+    uint64_t baseline_load_time;
+    uint64_t baseline_save_time;
+    benchmark_status status;
+} benchmark_result;
+
+typedef struct {
+    char name[FILE_NAME_MAX];
+    uint64_t load_time;
+    uint64_t save_time;
+} baseline_entry;
+
+static struct {
+    char directory[FILE_NAME_MAX];
+    char output_directory[FILE_NAME_MAX];
+    benchmark_result *results;
+    int num_results;
+    baseline_entry *baseline;
+    int num_baseline;
+} data;
+
+static const char *full_path(const char *directory, const char *name)
+{
+    static char path[FILE_NAME_MAX];
+    size_t length = strlen(directory);
+    int has_separator = length && (directory[length - 1] == '/' || directory[length - 1] == '\\');
+    snprintf(path, FILE_NAME_MAX, "%s%s%s", directory, has_separator ? "" : "/", name);
+    return path;
+}
+
+static const char *output_path(const char *name)
+{
+    return full_path(data.output_directory, name);
+}
+
+static long get_file_size(const char *filename)
+{
+    FILE *fp = file_open(filename, "rb");
+    if (!fp) {
+        return 0;
+    }
+    long size = 0;
+    if (fseek(fp, 0, SEEK_END) == 0) {
+        size = ftell(fp);
+    }
+    file_close(fp);
+    return size;
+}
+
+static int files_are_equal(const char *first, const char *second)
+{
+    file_mapping first_file;
+    file_mapping second_file;
+    FILE *fp = file_open(first, "rb");
+    if (!fp) {
+        return 0;
+    }
+    int mapped = file_map(fp, &first_file);
+    file_close(fp);
+    if (!mapped) {
+        return 0;
+    }
+    fp = file_open(second, "rb");
+    if (!fp) {
+        file_unmap(&first_file);
+        return 0;
+    }
+    mapped = file_map(fp, &second_file);
+    file_close(fp);
+    if (!mapped) {
+        file_unmap(&first_file);
+        return 0;
+    }
+    int equal = first_file.size == second_file.size && memcmp(first_file.data, second_file.data, first_file.size) == 0;
+    file_unmap(&first_file);
+    file_unmap(&second_file);
+    return equal;
+}
+
+/**
+ * Keeps the timings of the last load or save, with their own copy of the piece timings
+ */
+static void keep_timings(game_file_io_timings *timings, game_file_io_piece_timings **pieces)
+{
+    const game_file_io_timings *current = game_file_io_get_timings();
+    free(*pieces);
+    *pieces = 0;
+    *timings = *current;
+    timings->pieces = 0;
+    if (!current->num_pieces) {
+        return;
+    }
+    *pieces = malloc(current->num_pieces * sizeof(game_file_io_piece_timings));
+    if (!*pieces) {
+        timings->num_pieces = 0;
+        return;
+    }
+    memcpy(*pieces, current->pieces, current->num_pieces * sizeof(game_file_io_piece_timings));
+    timings->pieces = *pieces;
+}
+
+static int load_file(const benchmark_result *result, const char *filename)
+{
+    if (result->is_scenario) {
+        return game_file_io_read_scenario(filename);
+    }
+    return game_file_io_read_saved_game(filename, 0) == FILE_LOAD_SUCCESS;
+}
+
+static int save_file(const benchmark_result *result, const char *filename)
+{
+    if (result->is_scenario) {
+        return game_file_io_write_scenario(filename);
+    }
+    return game_file_io_write_saved_game(filename);
+}
+
+static void load_baseline(void)
+{
+    FILE *fp = file_open(output_path(RESULTS_FILE_NAME), "r");
+    if (!fp) {
+        return;
+    }
+    char line[FILE_NAME_MAX * 2];
+    // Skip the header
+    if (!fgets(line, sizeof(line), fp)) {
+        file_close(fp);
+        return;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] != '"') {
+            continue;
+        }
+        char *name_end = strchr(line + 1, '"');
+        if (!name_end || name_end - line - 1 >= FILE_NAME_MAX) {
+            continue;
+        }
+        unsigned long long load_time;
+        unsigned long long save_time;
+        if (sscanf(name_end + 1, ",%*[^,],%*d,%*u,%*u,%*u,%llu,%*f,%*u,%*u,%*u,%llu", &load_time, &save_time) != 2) {
+            continue;
+        }
+        baseline_entry *baseline = realloc(data.baseline, (data.num_baseline + 1) * sizeof(baseline_entry));
+        if (!baseline) {
+            break;
+        }
+        data.baseline = baseline;
+        baseline_entry *entry = &data.baseline[data.num_baseline++];
+        *name_end = 0;
+        strcpy(entry->name, line + 1);
+        entry->load_time = load_time;
+        entry->save_time = save_time;
+    }
+    file_close(fp);
+}
+
+static void compare_with_baseline(benchmark_result *result)
+{
+    for (int i = 0; i < data.num_baseline; i++) {
+        const baseline_entry *entry = &data.baseline[i];
+        if (strcmp(entry->name, result->name) != 0) {
+            continue;
+        }
+        result->has_baseline = 1;
+        result->baseline_load_time = entry->load_time;
+        result->baseline_save_time = entry->save_time;
+        if (result->status != STATUS_OK) {
+            return;
+        }
+        if ((result->load_time * 100 > entry->load_time * SLOWER_PERCENTAGE &&
+            result->load_time > entry->load_time + SLOWER_MIN_DIFFERENCE) ||
+            (result->save_time * 100 > entry->save_time * SLOWER_PERCENTAGE &&
+            result->save_time > entry->save_time + SLOWER_MIN_DIFFERENCE)) {
+            result->status = STATUS_SLOWER;
+        }
+        return;
+    }
+}
+
+static void run_file(benchmark_result *result)
+{
+    char filename[FILE_NAME_MAX];
+    char first_copy[FILE_NAME_MAX];
+    char second_copy[FILE_NAME_MAX];
+    snprintf(filename, FILE_NAME_MAX, "%s", full_path(data.directory, result->name));
+    snprintf(first_copy, FILE_NAME_MAX, "%s", output_path(TEMP_FILE_NAME_FIRST));
+    snprintf(second_copy, FILE_NAME_MAX, "%s", output_path(TEMP_FILE_NAME_SECOND));
+
+    result->file_size = get_file_size(filename);
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        uint64_t start_time = system_get_precise_ticks();
+        if (!load_file(result, filename)) {
+            result->status = STATUS_LOAD_FAILED;
+            return;
+        }
+        uint64_t load_time = system_get_precise_ticks() - start_time;
+        if (!i || load_time < result->load_time) {
+            result->load_time = load_time;
+            keep_timings(&result->load, &result->load_pieces);
+        }
+        start_time = system_get_precise_ticks();
+        if (!save_file(result, first_copy)) {
+            result->status = STATUS_SAVE_FAILED;
+            return;
+        }
+        uint64_t save_time = system_get_precise_ticks() - start_time;
+        if (!i || save_time < result->save_time) {
+            result->save_time = save_time;
+            keep_timings(&result->save, &result->save_pieces);
+        }
+    }
+    result->saved_size = get_file_size(first_copy);
+
+    // The copy holds the state decoded from the original. When the original was saved by this version, its pieces
+    // are laid out the same way, so they must hold the same state as the copy, or something was lost when decoding
+    uint64_t original_id;
+    uint64_t copy_id;
+    if (!result->is_scenario && game_file_io_read_saved_game_state_id(filename, &original_id)) {
+        result->original_state = game_file_io_read_saved_game_state_id(first_copy, &copy_id) &&
+            copy_id == original_id ? ORIGINAL_STATE_SAME : ORIGINAL_STATE_DIFFERENT;
+    }
+
+    // Compressing is deterministic, so both copies only match when the state survived the reload
+    result->round_trip_ok = load_file(result, first_copy) && save_file(result, second_copy) &&
+        files_are_equal(first_copy, second_copy);
+    if (!result->round_trip_ok) {
+        result->status = STATUS_ROUND_TRIP_MISMATCH;
+    } else if (result->original_state == ORIGINAL_STATE_DIFFERENT) {
+        result->status = STATUS_ORIGINAL_STATE_MISMATCH;
+    }
+    file_remove(first_copy);
+    file_remove(second_copy);
+}
+
+static void add_files(const dir_listing *files, int is_scenario)
+{
+    benchmark_result *results = realloc(data.results,
+        (data.num_results + files->num_files) * sizeof(benchmark_result));
+    if (!results) {
+        log_error("Unable to allocate memory for the benchmark", 0, 0);
+        return;
+    }
+    data.results = results;
+    for (int i = 0; i < files->num_files; i++) {
+        benchmark_result *result = &data.results[data.num_results++];
+        memset(result, 0, sizeof(benchmark_result));
+        snprintf(result->name, FILE_NAME_MAX, "%s", files->files[i].name);
+        result->is_scenario = is_scenario;
+    }
+}
+
+static double megabytes_per_second(long size, uint64_t time)
+{
+    // Bytes per microsecond are megabytes per second
+    return time ? (double) size / time : 0.0;
+}
+
+static int change_percentage(uint64_t time, uint64_t baseline_time)
+{
+    return baseline_time ? (int) (((double) time - baseline_time) * 100 / baseline_time) : 0;
+}
+
+static int write_results(void)
+{
+    FILE *fp = file_open(output_path(RESULTS_FILE_NAME), "w");
+    if (!fp) {
+        log_error("Unable to write the benchmark results", output_path(RESULTS_FILE_NAME), 0);
+        return 0;
+    }
+    fprintf(fp, "file,type,file_bytes,read_us,inflate_us,decode_us,load_us,load_mb_per_s,"
+        "encode_us,deflate_us,write_us,save_us,save_mb_per_s,round_trip,original_state,load_change_percent,"
+        "save_change_percent,"
+        "status\n");
+    for (int i = 0; i < data.num_results; i++) {
+        const benchmark_result *result = &data.results[i];
+        fprintf(fp, "\"%s\",%s,%ld,%llu,%llu,%llu,%llu,%.1f,%llu,%llu,%llu,%llu,%.1f,%s,%s,",
+            result->name, result->is_scenario ? "scenario" : "save", result->file_size,
+            (unsigned long long) result->load.read, (unsigned long long) result->load.inflate,
+            (unsigned long long) result->load.decode, (unsigned long long) result->load_time,
+            megabytes_per_second(result->file_size, result->load_time),
+            (unsigned long long) result->save.encode, (unsigned long long) result->save.deflate,
+            (unsigned long long) result->save.write, (unsigned long long) result->save_time,
+            megabytes_per_second(result->saved_size, result->save_time),
+            result->round_trip_ok ? "same" : "different", ORIGINAL_STATE_NAMES[result->original_state]);
+        if (result->has_baseline) {
+            fprintf(fp, "%d,%d,", change_percentage(result->load_time, result->baseline_load_time),
+                change_percentage(result->save_time, result->baseline_save_time));
+        } else {
+            fprintf(fp, ",,");
+        }
+        fprintf(fp, "%s\n", STATUS_NAMES[result->status]);
+    }
+    file_close(fp);
+    return 1;
+}
+
+static void write_piece_results(FILE *fp, const benchmark_result *result, const char *operation,
+    const game_file_io_timings *timings)
+{
+    for (int i = 0; i < timings->num_pieces; i++) {
+        const game_file_io_piece_timings *piece = &timings->pieces[i];
+        fprintf(fp, "\"%s\",%s,%d,%d,%d,%llu,%llu,%llu\n", result->name, operation, i, piece->size,
+            piece->stored_size, (unsigned long long) piece->inflate, (unsigned long long) piece->deflate,
+            (unsigned long long) piece->write);
+    }
+}
+
+static int write_piece_results_file(void)
+{
+    FILE *fp = file_open(output_path(PIECE_RESULTS_FILE_NAME), "w");
+    if (!fp) {
+        log_error("Unable to write the benchmark results", output_path(PIECE_RESULTS_FILE_NAME), 0);
+        return 0;
+    }
+    fprintf(fp, "file,operation,piece,bytes,stored_bytes,inflate_us,deflate_us,write_us\n");
+    for (int i = 0; i < data.num_results; i++) {
+        const benchmark_result *result = &data.results[i];
+        write_piece_results(fp, result, "load", &result->load);
+        write_piece_results(fp, result, "save", &result->save);
+    }
+    file_close(fp);
+    return 1;
+}
+
+static void clear_data(void)
+{
+    for (int i = 0; i < data.num_results; i++) {
+        free(data.results[i].load_pieces);
+        free(data.results[i].save_pieces);
+    }
+    free(data.results);
+    free(data.baseline);
+    data.results = 0;
+    data.baseline = 0;
+    data.num_results = 0;
+    data.num_baseline = 0;
+}
+
+int save_benchmark_run(const char *directory, const char *output_directory)
+{
+    snprintf(data.directory, FILE_NAME_MAX, "%s", directory);
+    snprintf(data.output_directory, FILE_NAME_MAX, "%s", output_directory ? output_directory : ".");
+    log_info("Running the save benchmark in", directory, 0);
+    log_info("Writing the save benchmark results to", data.output_directory, 0);
+
+    add_files(dir_find_files_with_extension(directory, "svx"), 0);
+    add_files(dir_find_files_with_extension(directory, "sav"), 0);
+    add_files(dir_find_files_with_extension(directory, "map"), 1);
+    add_files(dir_find_files_with_extension(directory, "mapx"), 1);
+    load_baseline();
+
+    int total_failed = 0;
+    int total_slower = 0;
+    for (int i = 0; i < data.num_results; i++) {
+        benchmark_result *result = &data.results[i];
+        run_file(result);
+        compare_with_baseline(result);
+        if (result->status == STATUS_SLOWER) {
+            log_info("Save benchmark slower than the baseline with file:", result->name, 0);
+            total_slower++;
+        } else if (result->status != STATUS_OK) {
+            log_error("Save benchmark problem with file:", result->name, result->status);
+            total_failed++;
+        }
+    }
+    int result = write_results();
+    result = write_piece_results_file() && result;
+    log_info("Files benchmarked:", 0, data.num_results);
+    log_info("Files slower than the baseline:", 0, total_slower);
+    log_info("Files with problems:", 0, total_failed);
+    clear_data();
+    return result && !total_failed;
+}
@@ -0,0 +1,26 @@
+#ifndef GAME_SAVE_BENCHMARK_H
+#define GAME_SAVE_BENCHMARK_H
+
+/**
+ * @file
+ * Benchmark and round-trip check of loading and saving every saved game and scenario in a directory.
+ *
+ * Every file is loaded and saved a few times, keeping the fastest time of every stage. When a saved game was
+ * written by this version, the state in its pieces is compared with the state in the saved copy. The copy is then
+ * loaded and saved again, and both copies are compared byte by byte, as any difference means some state
+ * was lost or changed on the way. The results are written as CSV to save_benchmark.csv in the output directory,
+ * and the size and timings of every piece of the fastest load and save to save_benchmark_pieces.csv.
+ * When save_benchmark.csv already exists there, it is used as the baseline and slower loads or saves are reported.
+ * The copies are also written to the output directory, so the directory with the files is left untouched.
+ */
+
+/**
+ * Runs the benchmark on all files in the directory
+ * @param directory Directory with the saved games and scenarios
+ * @param output_directory Directory to write the results and the copies to, or 0 for the current directory
+ * @return Boolean true when all files were loaded and saved without differences, false otherwise.
+ *         Files that are only slower than the baseline are reported but don't count as failures.
+ */
+int save_benchmark_run(const char *directory, const char *output_directory);
+
+#endif // GAME_SAVE_BENCHMARK_H
@@ -0,0 +1,287 @@
+#include "saved_game_index.h"
+
+#include "core/buffer.h"
+#include "core/file.h"
+#include "core/log.h"
+#include "game/save_version.h"
+#include "game/system.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define INDEX_FILE_NAME "saved_games.idx"
+#define INDEX_MAGIC "AUGSGIDX"
+#define INDEX_MAGIC_LENGTH 8
+#define INDEX_FORMAT_VERSION 1
+#define SIZE_UNKNOWN -1
+// Saves are read on the main thread, a few per frame, so that the dialog stays responsive
+#define UPDATE_TIME_BUDGET_MICROS 4000
+
+typedef struct {
+    char name[FILE_NAME_MAX];
+    unsigned int modified_time;
+    int size;
+    savegame_load_status status;
+    saved_game_info info;
+    int valid;
+    int checked;
+    int in_listing;
+} index_entry;
+
+static struct {
+    int loaded;
+    int running;
+    int changed;
+    index_entry *entries;
+    int num_entries;
+    int max_entries;
+} data;
+
+static index_entry *find_entry(const char *name)
+{
+    for (int i = 0; i < data.num_entries; i++) {
+        if (strcmp(data.entries[i].name, name) == 0) {
+            return &data.entries[i];
+        }
+    }
+    return 0;
+}
+
+static index_entry *add_entry(const char *name)
+{
+    if (strlen(name) >= FILE_NAME_MAX) {
+        return 0;
+    }
+    if (data.num_entries == data.max_entries) {
+        int max_entries = data.max_entries ? data.max_entries * 2 : 64;
+        index_entry *entries = realloc(data.entries, max_entries * sizeof(index_entry));
+        if (!entries) {
+            log_error("Unable to allocate memory for the saved game index", 0, 0);
+            return 0;
+        }
+        data.entries = entries;
+        data.max_entries = max_entries;
+    }
+    index_entry *entry = &data.entries[data.num_entries++];
+    memset(entry, 0, sizeof(index_entry));
+    strcpy(entry->name, name);
+    entry->size = SIZE_UNKNOWN;
+    return entry;
+}
+
+static void load_index(void)
+{
+    const char *filename = dir_get_file_at_location(INDEX_FILE_NAME, PATH_LOCATION_SAVEGAME);
+    if (!filename) {
+        return;
+    }
+    FILE *fp = file_open(filename, "rb");
+    if (!fp) {
+        return;
+    }
+    file_mapping file;
+    int mapped = file_map(fp, &file);
+    file_close(fp);
+    if (!mapped) {
+        return;
+    }
+    buffer buf;
+    buffer_init(&buf, file.data, file.size);
+    char magic[INDEX_MAGIC_LENGTH];
+    buffer_read_raw(&buf, magic, INDEX_MAGIC_LENGTH);
+    // The info is stored as is, so the index is thrown away when the info struct or the save version change
+    if (memcmp(magic, INDEX_MAGIC, INDEX_MAGIC_LENGTH) != 0 ||
+        buffer_read_i32(&buf) != INDEX_FORMAT_VERSION ||
+        buffer_read_i32(&buf) != SAVE_GAME_CURRENT_VERSION ||
+        buffer_read_i32(&buf) != sizeof(saved_game_info)) {
+        file_unmap(&file);
+        return;
+    }
+    int num_entries = buffer_read_i32(&buf);
+    for (int i = 0; i < num_entries && !buf.overflow; i++) {
+        char name[FILE_NAME_MAX];
+        size_t name_length = buffer_read_u16(&buf);
+        if (name_length >= FILE_NAME_MAX) {
+            break;
+        }
+        buffer_read_raw(&buf, name, name_length);
+        name[name_length] = 0;
+        unsigned int modified_time = buffer_read_u32(&buf);
+        int size = buffer_read_i32(&buf);
+        savegame_load_status status = buffer_read_i32(&buf);
+        saved_game_info info;
+        if (buffer_read_raw(&buf, &info, sizeof(saved_game_info)) != sizeof(saved_game_info)) {
+            break;
+        }
+        index_entry *entry = add_entry(name);
+        if (!entry) {
+            break;
+        }
+        entry->modified_time = modified_time;
+        entry->size = size;
+        entry->status = status;
+        entry->info = info;
+        entry->valid = 1;
+    }
+    file_unmap(&file);
+}
+
+static void save_index(void)
+{
+    size_t size = INDEX_MAGIC_LENGTH + 4 * sizeof(int32_t);
+    for (int i = 0; i < data.num_entries; i++) {
+        if (data.entries[i].valid && data.entries[i].in_listing) {
+            size += sizeof(uint16_t) + strlen(data.entries[i].name) + 3 * sizeof(int32_t) + sizeof(saved_game_info);
+        }
+    }
+    uint8_t *index_data = malloc(size);
+    if (!index_data) {
+        log_error("Unable to allocate memory for the saved game index", 0, 0);
+        return;
+    }
+    buffer buf;
+    buffer_init(&buf, index_data, size);
+    buffer_write_raw(&buf, INDEX_MAGIC, INDEX_MAGIC_LENGTH);
+    buffer_write_i32(&buf, INDEX_FORMAT_VERSION);
+    buffer_write_i32(&buf, SAVE_GAME_CURRENT_VERSION);
+    buffer_write_i32(&buf, sizeof(saved_game_info));
+    size_t num_entries_index = buf.index;
+    buffer_write_i32(&buf, 0);
+    int num_entries = 0;
+    for (int i = 0; i < data.num_entries; i++) {
+        const index_entry *entry = &data.entries[i];
+        // Entries for saves that no longer exist are dropped
+        if (!entry->valid || !entry->in_listing) {
+            continue;
+        }
+        size_t name_length = strlen(entry->name);
+        buffer_write_u16(&buf, (uint16_t) name_length);
+        buffer_write_raw(&buf, entry->name, name_length);
+        buffer_write_u32(&buf, entry->modified_time);
+        buffer_write_i32(&buf, entry->size);
+        buffer_write_i32(&buf, entry->status);
+        buffer_write_raw(&buf, &entry->info, sizeof(saved_game_info));
+        num_entries++;
+    }
+    buffer_set(&buf, num_entries_index);
+    buffer_write_i32(&buf, num_entries);
+
+    FILE *fp = file_open(dir_append_location(INDEX_FILE_NAME, PATH_LOCATION_SAVEGAME), "wb");
+    if (fp) {
+        fwrite(index_data, 1, size, fp);
+        file_close(fp);
+    } else {
+        log_error("Unable to write the saved game index", 0, 0);
+    }
+    free(index_data);
+}
+
+static int get_file_size(const char *filename)
+{
+    FILE *fp = file_open(filename, "rb");
+    if (!fp) {
+        return SIZE_UNKNOWN;
+    }
+    int size = SIZE_UNKNOWN;
+    if (fseek(fp, 0, SEEK_END) == 0) {
+        size = (int) ftell(fp);
+    }
+    file_close(fp);
+    return size;
+}
+
+static void index_entry_file(index_entry *entry)
+{
+    entry->checked = 1;
+    const char *filename = dir_get_file_at_location(entry->name, PATH_LOCATION_SAVEGAME);
+    if (!filename) {
+        return;
+    }
+    int size = get_file_size(filename);
+    if (entry->valid && size != SIZE_UNKNOWN && size == entry->size) {
+        return;
+    }
+    entry->status = game_file_io_read_saved_game_basic_info(filename, &entry->info);
+    entry->size = size;
+    entry->valid = 1;
+    data.changed = 1;
+}
+
+static index_entry *get_next_unchecked_entry(void)
+{
+    for (int i = 0; i < data.num_entries; i++) {
+        if (data.entries[i].in_listing && !data.entries[i].checked) {
+            return &data.entries[i];
+        }
+    }
+    return 0;
+}
+
+void saved_game_index_start(const dir_listing *files)
+{
+    if (!data.loaded) {
+        load_index();
+        data.loaded = 1;
+    }
+    for (int i = 0; i < data.num_entries; i++) {
+        data.entries[i].in_listing = 0;
+    }
+    for (int i = 0; i < files->num_files; i++) {
+        const dir_entry *file = &files->files[i];
+        index_entry *entry = find_entry(file->name);
+        if (!entry) {
+            entry = add_entry(file->name);
+            if (!entry) {
+                continue;
+            }
+        }
+        if (entry->modified_time != file->modified_time) {
+            entry->modified_time = file->modified_time;
+            entry->valid = 0;
+            entry->checked = 0;
+        }
+        entry->in_listing = 1;
+    }
+    data.running = 1;
+}
+
+int saved_game_index_update(void)
+{
+    if (!data.running) {
+        return 0;
+    }
+    uint64_t start_time = system_get_precise_ticks();
+    int indexed = 0;
+    index_entry *entry;
+    while ((entry = get_next_unchecked_entry()) != 0) {
+        index_entry_file(entry);
+        indexed = 1;
+        if (system_get_precise_ticks() - start_time >= UPDATE_TIME_BUDGET_MICROS) {
+            return indexed;
+        }
+    }
+    if (data.changed) {
+        // Everything is indexed
+        save_index();
+        data.changed = 0;
+    }
+    return indexed;
+}
+
+const saved_game_info *saved_game_index_get(const char *filename, unsigned int modified_time)
+{
+    const index_entry *entry = find_entry(filename);
+    if (!entry || !entry->valid || entry->modified_time != modified_time || entry->status != SAVEGAME_STATUS_OK) {
+        return 0;
+    }
+    return &entry->info;
+}
+
+void saved_game_index_stop(void)
+{
+    data.running = 0;
+    if (data.changed) {
+        save_index();
+        data.changed = 0;
+    }
+}
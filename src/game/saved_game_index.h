@@ -0,0 +1,41 @@
+#ifndef GAME_SAVED_GAME_INDEX_H
+#define GAME_SAVED_GAME_INDEX_H
+
+#include "core/dir.h"
+#include "game/file_io.h"
+
+/**
+ * @file
+ * Index of the saved game info of every save in the saves directory.
+ *
+ * The index is kept in a file next to the saves, and every entry is keyed by the name, modified time and size
+ * of its save. While the index is running, entries are read or refreshed a few files per update.
+ * As reading a save uses the shared state in game/file_io.c, the files are read on the main thread.
+ */
+
+/**
+ * Starts indexing the given files in the saves directory, loading the index file the first time
+ * @param files The saved games in the saves directory
+ */
+void saved_game_index_start(const dir_listing *files);
+
+/**
+ * Indexes the next files, for a few milliseconds at most. Should be called every frame while the index is running.
+ * @return Boolean true if entries were indexed, false otherwise
+ */
+int saved_game_index_update(void);
+
+/**
+ * Gets the info of a saved game from the index
+ * @param filename The name of the saved game
+ * @param modified_time The modified time of the saved game
+ * @return The info, or 0 if the save wasn't indexed yet or is not a valid saved game
+ */
+const saved_game_info *saved_game_index_get(const char *filename, unsigned int modified_time);
+
+/**
+ * Stops indexing and writes the index file if it changed
+ */
+void saved_game_index_stop(void);
+
+#endif // GAME_SAVED_GAME_INDEX_H
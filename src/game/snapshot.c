@@ -0,0 +1,186 @@
+#include "snapshot.h"
+
+#include "core/config.h"
+#include "core/log.h"
+#include "game/file_io.h"
+#include "game/time.h"
+
+#include <stdlib.h>
+
+#define MAX_SNAPSHOTS 64
+#define SNAPSHOT_INTERVAL_DAYS 4
+#define BYTES_PER_MB (1024 * 1024)
+
+typedef struct {
+    saved_game_piece piece;
+    int references;
+} shared_piece;
+
+typedef struct {
+    shared_piece **pieces;
+    int num_pieces;
+} snapshot;
+
+static struct {
+    snapshot snapshots[MAX_SNAPSHOTS];
+    int first;
+    int count;
+    size_t memory_used;
+} data;
+
+static void release_piece(shared_piece *piece)
+{
+    if (--piece->references > 0) {
+        return;
+    }
+    data.memory_used -= piece->piece.size;
+    free(piece->piece.data);
+    free(piece);
+}
+
+static void free_snapshot(snapshot *s)
+{
+    for (int i = 0; i < s->num_pieces; i++) {
+        release_piece(s->pieces[i]);
+    }
+    free(s->pieces);
+    s->pieces = 0;
+    s->num_pieces = 0;
+}
+
+static snapshot *latest_snapshot(void)
+{
+    if (!data.count) {
+        return 0;
+    }
+    return &data.snapshots[(data.first + data.count - 1) % MAX_SNAPSHOTS];
+}
+
+static void drop_oldest(void)
+{
+    free_snapshot(&data.snapshots[data.first]);
+    data.first = (data.first + 1) % MAX_SNAPSHOTS;
+    data.count--;
+}
+
+static int add_snapshot(saved_game_piece *pieces, int num_pieces, const snapshot *previous)
+{
+    shared_piece **shared = malloc(num_pieces * sizeof(shared_piece *));
+    if (!shared) {
+        return 0;
+    }
+    int total_added = 0;
+    for (int i = 0; i < num_pieces; i++) {
+        if (!pieces[i].data) {
+            // Unchanged since the previous snapshot
+            shared[i] = previous->pieces[i];
+            shared[i]->references++;
+            total_added++;
+            continue;
+        }
+        shared[i] = malloc(sizeof(shared_piece));
+        if (!shared[i]) {
+            break;
+        }
+        shared[i]->piece = pieces[i];
+        shared[i]->references = 1;
+        data.memory_used += pieces[i].size;
+        total_added++;
+    }
+    if (total_added < num_pieces) {
+        for (int i = 0; i < total_added; i++) {
+            release_piece(shared[i]);
+        }
+        for (int i = total_added; i < num_pieces; i++) {
+            free(pieces[i].data);
+        }
+        free(shared);
+        return 0;
+    }
+    if (data.count == MAX_SNAPSHOTS) {
+        drop_oldest();
+    }
+    snapshot *s = &data.snapshots[(data.first + data.count) % MAX_SNAPSHOTS];
+    s->pieces = shared;
+    s->num_pieces = num_pieces;
+    data.count++;
+    return 1;
+}
+
+void game_snapshot_update(void)
+{
+    if (config_get(CONFIG_GENERAL_SNAPSHOT_MEMORY) > 0 && game_time_day() % SNAPSHOT_INTERVAL_DAYS == 0) {
+        game_snapshot_take();
+    }
+}
+
+int game_snapshot_take(void)
+{
+    size_t memory_limit = (size_t) config_get(CONFIG_GENERAL_SNAPSHOT_MEMORY) * BYTES_PER_MB;
+    if (!memory_limit) {
+        game_snapshot_clear();
+        return 0;
+    }
+    const snapshot *latest = latest_snapshot();
+    saved_game_piece *previous = 0;
+    int num_previous = 0;
+    if (latest) {
+        previous = malloc(latest->num_pieces * sizeof(saved_game_piece));
+        if (previous) {
+            for (int i = 0; i < latest->num_pieces; i++) {
+                previous[i] = latest->pieces[i]->piece;
+            }
+            num_previous = latest->num_pieces;
+        }
+    }
+    saved_game_piece *pieces;
+    int num_pieces = game_file_io_write_saved_game_to_memory(&pieces, previous, num_previous);
+    free(previous);
+    if (!num_pieces) {
+        return 0;
+    }
+    int result = add_snapshot(pieces, num_pieces, latest);
+    free(pieces);
+    if (!result) {
+        log_error("Unable to allocate memory for the game snapshot", 0, 0);
+        return 0;
+    }
+    while (data.count && data.memory_used > memory_limit) {
+        drop_oldest();
+    }
+    log_info("Game snapshots in memory, in kB:", 0, (int) (data.memory_used / 1024));
+    return data.count > 0;
+}
+
+int game_snapshot_pop_latest(buffer *buf)
+{
+    snapshot *s = latest_snapshot();
+    if (!s) {
+        return 0;
+    }
+    size_t size = 0;
+    for (int i = 0; i < s->num_pieces; i++) {
+        size += s->pieces[i]->piece.size;
+    }
+    uint8_t *snapshot_data = malloc(size);
+    if (!snapshot_data) {
+        log_error("Unable to allocate memory for the game snapshot", 0, 0);
+        return 0;
+    }
+    buffer_init(buf, snapshot_data, size);
+    for (int i = 0; i < s->num_pieces; i++) {
+        buffer_write_raw(buf, s->pieces[i]->piece.data, s->pieces[i]->piece.size);
+    }
+    buffer_reset(buf);
+    free_snapshot(s);
+    data.count--;
+    return 1;
+}
+
+void game_snapshot_clear(void)
+{
+    while (data.count) {
+        drop_oldest();
+    }
+    data.first = 0;
+}
@@ -0,0 +1,39 @@
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+
+#include "core/buffer.h"
+
+/**
+ * @file
+ * Ring of in-memory snapshots of the game, to quickly rewind to an earlier point of the current game.
+ *
+ * Every snapshot is kept as the compressed pieces of a saved game. Pieces that did not change since
+ * the previous snapshot are shared between both snapshots. The oldest snapshots are dropped when
+ * the memory used goes over the limit set in the config. Snapshots are disabled when the limit is 0.
+ */
+
+/**
+ * Takes a snapshot when one is due. Should be called on every day tick.
+ */
+void game_snapshot_update(void);
+
+/**
+ * Takes a snapshot of the current game
+ * @return Boolean true on success, false on failure or when snapshots are disabled
+ */
+int game_snapshot_take(void);
+
+/**
+ * Removes the latest snapshot from the ring and puts it in a newly allocated buffer,
+ * which can be loaded as a saved game from memory
+ * @param buf Buffer to initialize with the snapshot. Its data must be freed by the caller
+ * @return Boolean true on success, false if there is no snapshot
+ */
+int game_snapshot_pop_latest(buffer *buf);
+
+/**
+ * Drops all snapshots, for example when another game is loaded
+ */
+void game_snapshot_clear(void);
+
+#endif // GAME_SNAPSHOT_H
@@ -33,6 +33,12 @@ const char *system_OS(void);
  */
 uint64_t system_get_ticks(void);
 
+/**
+ * Gets the current number of ticks in microseconds, as precise as the platform allows, for profiling
+ * @return Number of ticks
+ */
+uint64_t system_get_precise_ticks(void);
+
 /**
  * Resize window
  * @param width New width
@@ -223,4 +229,11 @@ const char *system_show_select_folder_dialog(const char *title, const char *defa
  */
 void system_exit(void);
 
+/**
+ * Keeps the window responsive while the game is loading in the background: handles the window events
+ * and waits briefly. Other events stay queued until loading is done
+ * @param show_frame Whether to show what was drawn since the last call
+ */
+void system_handle_events_while_loading(int show_frame);
+
 #endif // GAME_SYSTEM_H
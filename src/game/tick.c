@@ -32,7 +32,6 @@
 #include "city/trade.h"
 #include "city/victory.h"
 #include "core/config.h"
-#include "core/dir.h"
 #include "core/random.h"
 #include "editor/editor.h"
 #include "empire/city.h"
@@ -40,6 +39,7 @@
 #include "figuretype/crime.h"
 #include "game/file.h"
 #include "game/settings.h"
+#include "game/snapshot.h"
 #include "game/time.h"
 #include "game/tutorial.h"
 #include "game/undo.h"
@@ -118,7 +118,7 @@ static void advance_month(void)
     city_gods_update_blessings();
     tutorial_on_month_tick();
     if (setting_monthly_autosave()) {
-        game_file_write_saved_game(dir_append_location("autosave.svx", PATH_LOCATION_SAVEGAME));
+        game_file_make_monthly_autosave();
     }
 
     city_weather_update(game_time_month());
@@ -141,6 +141,7 @@ static void advance_day(void)
         // 0-based index so 11 = December, 15 = last day of the month
         game_file_make_yearly_autosave();
     }
+    game_snapshot_update();
     scenario_events_progress_paused(1);
     scenario_events_process_all();
 }
@@ -89,3 +89,17 @@ void graphics_draw_from_image(int image_id, int x, int y)
 {
     graphics_renderer()->draw_image_to_screen(image_id, x, y);
 }
+
+void graphics_start_sprite_batch(void)
+{
+    if (graphics_renderer()->start_sprite_batch) {
+        graphics_renderer()->start_sprite_batch();
+    }
+}
+
+void graphics_finish_sprite_batch(void)
+{
+    if (graphics_renderer()->finish_sprite_batch) {
+        graphics_renderer()->finish_sprite_batch();
+    }
+}
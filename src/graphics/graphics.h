@@ -24,4 +24,7 @@ void graphics_tint_rect(int x, int y, int width, int height, color_t rgb, int al
 int graphics_save_to_image(int image_id, int x, int y, int width, int height);
 void graphics_draw_from_image(int image_id, int x, int y);
 
+void graphics_start_sprite_batch(void);
+void graphics_finish_sprite_batch(void);
+
 #endif // GRAPHICS_GRAPHICS_H
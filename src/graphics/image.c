@@ -5,6 +5,18 @@
 #include "graphics/renderer.h"
 #include "graphics/screen.h"
 
+static void draw_image(const image *img, int x, int y, color_t color, float scale)
+{
+    image_load_pixels(img);
+    graphics_renderer()->draw_image(img, x, y, color, scale);
+}
+
+static void draw_silhouette(const image *img, int x, int y, color_t color, float scale)
+{
+    image_load_pixels(img);
+    graphics_renderer()->draw_silhouette(img, x, y, color, scale);
+}
+
 void image_draw(int image_id, int x, int y, color_t color, float scale)
 {
     const image *img = image_get(image_id);
@@ -13,7 +25,7 @@ void image_draw(int image_id, int x, int y, color_t color, float scale)
     } else if ((img->atlas.id >> IMAGE_ATLAS_BIT_OFFSET) == ATLAS_UNPACKED_EXTRA_ASSET) {
         assets_load_unpacked_asset(image_id);
     }
-    graphics_renderer()->draw_image(img, x, y, color, scale);
+    draw_image(img, x, y, color, scale);
 }
 
 void image_draw_silhouette(int image_id, int x, int y, color_t color, float scale)
@@ -24,7 +36,7 @@ void image_draw_silhouette(int image_id, int x, int y, color_t color, float scal
     } else if ((img->atlas.id >> IMAGE_ATLAS_BIT_OFFSET) == ATLAS_UNPACKED_EXTRA_ASSET) {
         assets_load_unpacked_asset(image_id);
     }
-    graphics_renderer()->draw_silhouette(img, x, y, color, scale);
+    draw_silhouette(img, x, y, color, scale);
 
 }
 
@@ -44,7 +56,7 @@ void image_draw_enemy(int image_id, int x, int y, float scale)
     if (image_id <= 0 || image_id >= 801) {
         return;
     }
-    graphics_renderer()->draw_image(image_get_enemy(image_id), x, y, COLOR_MASK_NONE, scale);
+    draw_image(image_get_enemy(image_id), x, y, COLOR_MASK_NONE, scale);
 }
 
 void image_blend_footprint_color(int x, int y, color_t color, float scale)
@@ -69,31 +81,31 @@ static void draw_multibyte_letter(font_t font, const image *img, int x, int y, c
 {
     switch (font) {
         case FONT_NORMAL_WHITE:
-            graphics_renderer()->draw_image(img, x + 1, y + 1, 0xff311c10, scale);
-            graphics_renderer()->draw_image(img, x, y, COLOR_WHITE, scale);
+            draw_image(img, x + 1, y + 1, 0xff311c10, scale);
+            draw_image(img, x, y, COLOR_WHITE, scale);
             break;
         case FONT_NORMAL_RED:
-            graphics_renderer()->draw_image(img, x + 1, y + 1, 0xffe7cfad, scale);
-            graphics_renderer()->draw_image(img, x, y, 0xff731408, scale);
+            draw_image(img, x + 1, y + 1, 0xffe7cfad, scale);
+            draw_image(img, x, y, 0xff731408, scale);
             break;
         case FONT_NORMAL_GREEN:
-            graphics_renderer()->draw_image(img, x + 1, y + 1, 0xffe7cfad, scale);
-            graphics_renderer()->draw_image(img, x, y, 0xff180800, scale);
+            draw_image(img, x + 1, y + 1, 0xffe7cfad, scale);
+            draw_image(img, x, y, 0xff180800, scale);
             break;
         case FONT_NORMAL_BLACK:
         case FONT_LARGE_BLACK:
-            graphics_renderer()->draw_image(img, x + 1, y + 1, 0xffcead9c, scale);
-            graphics_renderer()->draw_image(img, x, y, COLOR_BLACK, scale);
+            draw_image(img, x + 1, y + 1, 0xffcead9c, scale);
+            draw_image(img, x, y, COLOR_BLACK, scale);
             break;
         case FONT_NORMAL_BROWN:
         case FONT_LARGE_BROWN:
-            graphics_renderer()->draw_image(img, x, y, COLOR_FONT_PLAIN, scale);
+            draw_image(img, x, y, COLOR_FONT_PLAIN, scale);
             break;
         default: // Plain + brown
             if (!color) {
                 color = base_color_for_font(font);
             }
-            graphics_renderer()->draw_image(img, x, y, ALPHA_OPAQUE | color, scale);
+            draw_image(img, x, y, ALPHA_OPAQUE | color, scale);
             break;
     }
 }
@@ -108,7 +120,7 @@ void image_draw_letter(font_t font, int letter_id, int x, int y, color_t color,
     if (!color) {
         color = base_color_for_font(font);
     }
-    graphics_renderer()->draw_image(img, x, y, color, scale);
+    draw_image(img, x, y, color, scale);
 }
 
 static inline void draw_fullscreen_background(int image_id, int x, int y, color_t alpha)
@@ -140,7 +152,7 @@ static inline void draw_fullscreen_background(int image_id, int x, int y, color_
         } else if ((img->atlas.id >> IMAGE_ATLAS_BIT_OFFSET) == ATLAS_UNPACKED_EXTRA_ASSET) {
             assets_load_unpacked_asset(image_id);
         }
-        graphics_renderer()->draw_image(img, x, y, color_mask, scale);
+        draw_image(img, x, y, color_mask, scale);
     }
 }
 
@@ -224,7 +236,7 @@ void image_draw_isometric_footprint(int image_id, int x, int y, color_t color_ma
     }
     int num_tiles = (img->width + 2) / (FOOTPRINT_WIDTH + 2);
     x -= 30 * (num_tiles - 1);
-    graphics_renderer()->draw_image(img, x, y, color_mask, scale);
+    draw_image(img, x, y, color_mask, scale);
 }
 
 void image_draw_isometric_footprint_from_draw_tile(int image_id, int x, int y, color_t color_mask, float scale)
@@ -235,7 +247,7 @@ void image_draw_isometric_footprint_from_draw_tile(int image_id, int x, int y, c
     }
     int num_tiles = (img->width + 2) / (FOOTPRINT_WIDTH + 2);
     y -= FOOTPRINT_HALF_HEIGHT * (num_tiles - 1);
-    graphics_renderer()->draw_image(img, x, y, color_mask, scale);
+    draw_image(img, x, y, color_mask, scale);
 }
 
 void image_draw_isometric_top(int image_id, int x, int y, color_t color_mask, float scale)
@@ -250,7 +262,7 @@ void image_draw_isometric_top(int image_id, int x, int y, color_t color_mask, fl
     int num_tiles = (img->width + 2) / (FOOTPRINT_WIDTH + 2);
     x -= 30 * (num_tiles - 1);
     y -= img->top->original.height - FOOTPRINT_HALF_HEIGHT * num_tiles;
-    graphics_renderer()->draw_image(img->top, x, y, color_mask, scale);
+    draw_image(img->top, x, y, color_mask, scale);
 }
 
 void image_draw_isometric_top_from_draw_tile(int image_id, int x, int y, color_t color_mask, float scale)
@@ -263,7 +275,7 @@ void image_draw_isometric_top_from_draw_tile(int image_id, int x, int y, color_t
         assets_load_unpacked_asset(image_id);
     }
     y -= img->top->original.height - FOOTPRINT_HALF_HEIGHT;
-    graphics_renderer()->draw_image(img->top, x, y, color_mask, scale);
+    draw_image(img->top, x, y, color_mask, scale);
 }
 
 void image_draw_set_isometric_top_from_draw_tile(int image_id, int x, int y, color_t color_mask, float scale)
@@ -276,5 +288,5 @@ void image_draw_set_isometric_top_from_draw_tile(int image_id, int x, int y, col
         assets_load_unpacked_asset(image_id);
     }
     y -= img->top->original.height - FOOTPRINT_HALF_HEIGHT;
-    graphics_renderer()->draw_silhouette(img->top, x, y, color_mask, scale);
+    draw_silhouette(img->top, x, y, color_mask, scale);
 }
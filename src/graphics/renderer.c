@@ -1,7 +1,43 @@
 #include "renderer.h"
 
+#include "core/thread.h"
+
+typedef enum {
+    CALL_NONE,
+    CALL_PREPARE_IMAGE_ATLAS,
+    CALL_CREATE_IMAGE_ATLAS,
+    CALL_CREATE_EMPTY_IMAGE_ATLAS,
+    CALL_UPDATE_IMAGE_ATLAS,
+    CALL_UPDATE_IMAGE_ATLAS_REGION,
+    CALL_HAS_IMAGE_ATLAS,
+    CALL_FREE_IMAGE_ATLAS,
+    CALL_LOAD_UNPACKED_IMAGE,
+    CALL_FREE_UNPACKED_IMAGE
+} forwarded_call_type;
+
+typedef struct {
+    forwarded_call_type type;
+    const image_atlas_data *atlas_data;
+    atlas_type atlas;
+    const image *img;
+    const color_t *pixels;
+    int values[5];
+    int result;
+    const image_atlas_data *result_atlas_data;
+    int done;
+} forwarded_call;
+
 static const graphics_renderer_interface *renderer;
 
+static struct {
+    int active;
+    const graphics_renderer_interface *renderer;
+    graphics_renderer_interface interface;
+    thread_mutex *mutex;
+    thread_condition *call_done;
+    forwarded_call *pending;
+} forwarding;
+
 const graphics_renderer_interface *graphics_renderer(void)
 {
     return renderer;
@@ -11,3 +47,207 @@ void graphics_renderer_set_interface(const graphics_renderer_interface *new_rend
 {
     renderer = new_renderer;
 }
+
+static void forward_call(forwarded_call *call)
+{
+    thread_mutex_lock(forwarding.mutex);
+    while (forwarding.pending) {
+        thread_condition_wait(forwarding.call_done, forwarding.mutex);
+    }
+    forwarding.pending = call;
+    while (!call->done) {
+        thread_condition_wait(forwarding.call_done, forwarding.mutex);
+    }
+    thread_mutex_unlock(forwarding.mutex);
+}
+
+static void run_call(forwarded_call *call)
+{
+    const graphics_renderer_interface *r = forwarding.renderer;
+    switch (call->type) {
+        case CALL_PREPARE_IMAGE_ATLAS:
+            call->result_atlas_data = r->prepare_image_atlas(call->atlas,
+                call->values[0], call->values[1], call->values[2]);
+            break;
+        case CALL_CREATE_IMAGE_ATLAS:
+            call->result = r->create_image_atlas(call->atlas_data, call->values[0]);
+            break;
+        case CALL_CREATE_EMPTY_IMAGE_ATLAS:
+            call->result = r->create_empty_image_atlas(call->atlas_data);
+            break;
+        case CALL_UPDATE_IMAGE_ATLAS:
+            call->result = r->update_image_atlas(call->atlas_data, call->values[0], call->values[1]);
+            break;
+        case CALL_UPDATE_IMAGE_ATLAS_REGION:
+            call->result = r->update_image_atlas_region(call->atlas_data, call->values[0],
+                call->values[1], call->values[2], call->values[3], call->values[4]);
+            break;
+        case CALL_HAS_IMAGE_ATLAS:
+            call->result = r->has_image_atlas(call->atlas);
+            break;
+        case CALL_FREE_IMAGE_ATLAS:
+            r->free_image_atlas(call->atlas);
+            break;
+        case CALL_LOAD_UNPACKED_IMAGE:
+            r->load_unpacked_image(call->img, call->pixels);
+            break;
+        case CALL_FREE_UNPACKED_IMAGE:
+            r->free_unpacked_image(call->img);
+            break;
+        default:
+            break;
+    }
+}
+
+static const image_atlas_data *forward_prepare_image_atlas(atlas_type type, int num_images,
+    int last_width, int last_height)
+{
+    forwarded_call call = { CALL_PREPARE_IMAGE_ATLAS };
+    call.atlas = type;
+    call.values[0] = num_images;
+    call.values[1] = last_width;
+    call.values[2] = last_height;
+    forward_call(&call);
+    return call.result_atlas_data;
+}
+
+static int forward_create_image_atlas(const image_atlas_data *atlas_data, int delete_buffers)
+{
+    forwarded_call call = { CALL_CREATE_IMAGE_ATLAS };
+    call.atlas_data = atlas_data;
+    call.values[0] = delete_buffers;
+    forward_call(&call);
+    return call.result;
+}
+
+static int forward_create_empty_image_atlas(const image_atlas_data *atlas_data)
+{
+    forwarded_call call = { CALL_CREATE_EMPTY_IMAGE_ATLAS };
+    call.atlas_data = atlas_data;
+    forward_call(&call);
+    return call.result;
+}
+
+static int forward_update_image_atlas(const image_atlas_data *atlas_data, int index, int delete_buffer)
+{
+    forwarded_call call = { CALL_UPDATE_IMAGE_ATLAS };
+    call.atlas_data = atlas_data;
+    call.values[0] = index;
+    call.values[1] = delete_buffer;
+    forward_call(&call);
+    return call.result;
+}
+
+static int forward_update_image_atlas_region(const image_atlas_data *atlas_data, int index,
+    int x, int y, int width, int height)
+{
+    forwarded_call call = { CALL_UPDATE_IMAGE_ATLAS_REGION };
+    call.atlas_data = atlas_data;
+    call.values[0] = index;
+    call.values[1] = x;
+    call.values[2] = y;
+    call.values[3] = width;
+    call.values[4] = height;
+    forward_call(&call);
+    return call.result;
+}
+
+static int forward_has_image_atlas(atlas_type type)
+{
+    forwarded_call call = { CALL_HAS_IMAGE_ATLAS };
+    call.atlas = type;
+    forward_call(&call);
+    return call.result;
+}
+
+static void forward_free_image_atlas(atlas_type type)
+{
+    forwarded_call call = { CALL_FREE_IMAGE_ATLAS };
+    call.atlas = type;
+    forward_call(&call);
+}
+
+static void forward_load_unpacked_image(const image *img, const color_t *pixels)
+{
+    forwarded_call call = { CALL_LOAD_UNPACKED_IMAGE };
+    call.img = img;
+    call.pixels = pixels;
+    forward_call(&call);
+}
+
+static void forward_free_unpacked_image(const image *img)
+{
+    forwarded_call call = { CALL_FREE_UNPACKED_IMAGE };
+    call.img = img;
+    forward_call(&call);
+}
+
+static int init_forwarding(void)
+{
+    if (forwarding.mutex) {
+        return 1;
+    }
+    forwarding.mutex = thread_mutex_create();
+    forwarding.call_done = thread_condition_create();
+    if (!forwarding.mutex || !forwarding.call_done) {
+        if (forwarding.mutex) {
+            thread_mutex_destroy(forwarding.mutex);
+            forwarding.mutex = 0;
+        }
+        if (forwarding.call_done) {
+            thread_condition_destroy(forwarding.call_done);
+            forwarding.call_done = 0;
+        }
+        return 0;
+    }
+    return 1;
+}
+
+int graphics_renderer_start_forwarding(void)
+{
+    if (forwarding.active || !renderer || !init_forwarding()) {
+        return 0;
+    }
+    forwarding.renderer = renderer;
+    forwarding.interface = *renderer;
+    graphics_renderer_interface *r = &forwarding.interface;
+    // Only the calls that change the images are forwarded, functions the renderer does not have stay missing
+    r->prepare_image_atlas = renderer->prepare_image_atlas ? forward_prepare_image_atlas : 0;
+    r->create_image_atlas = renderer->create_image_atlas ? forward_create_image_atlas : 0;
+    r->create_empty_image_atlas = renderer->create_empty_image_atlas ? forward_create_empty_image_atlas : 0;
+    r->update_image_atlas = renderer->update_image_atlas ? forward_update_image_atlas : 0;
+    r->update_image_atlas_region = renderer->update_image_atlas_region ? forward_update_image_atlas_region : 0;
+    r->has_image_atlas = renderer->has_image_atlas ? forward_has_image_atlas : 0;
+    r->free_image_atlas = renderer->free_image_atlas ? forward_free_image_atlas : 0;
+    r->load_unpacked_image = renderer->load_unpacked_image ? forward_load_unpacked_image : 0;
+    r->free_unpacked_image = renderer->free_unpacked_image ? forward_free_unpacked_image : 0;
+    forwarding.active = 1;
+    renderer = &forwarding.interface;
+    return 1;
+}
+
+void graphics_renderer_run_forwarded_calls(void)
+{
+    if (!forwarding.active) {
+        return;
+    }
+    thread_mutex_lock(forwarding.mutex);
+    forwarded_call *call = forwarding.pending;
+    if (call) {
+        run_call(call);
+        call->done = 1;
+        forwarding.pending = 0;
+        thread_condition_broadcast(forwarding.call_done);
+    }
+    thread_mutex_unlock(forwarding.mutex);
+}
+
+void graphics_renderer_stop_forwarding(void)
+{
+    if (!forwarding.active) {
+        return;
+    }
+    graphics_renderer_run_forwarded_calls();
+    renderer = forwarding.renderer;
+    forwarding.active = 0;
+}
@@ -58,6 +58,11 @@ typedef struct {
         float scale_x, float scale_y, double angle, int disable_coord_scaling);
     void (*draw_silhouette)(const image *img, int x, int y, color_t color, float scale);
 
+    // Optional: until the batch is finished, consecutive images that share a texture may be drawn together.
+    // Everything is still drawn in the order it was requested
+    void (*start_sprite_batch)(void);
+    void (*finish_sprite_batch)(void);
+
     void (*create_custom_image)(custom_image_type type, int width, int height, int is_yuv);
     int (*has_custom_image)(custom_image_type type);
     color_t *(*get_custom_image_buffer)(custom_image_type type, int *actual_texture_width);
@@ -80,10 +85,22 @@ typedef struct {
     void (*draw_image_to_screen)(int image_id, int x, int y);
     int (*save_screen_buffer)(color_t *pixels, int x, int y, int width, int height, int row_width);
 
+    // Optional: offscreen images that keep what was drawn into them, so that parts of the screen that rarely change
+    // can be drawn again in one go. The contents may be lost at any time, in which case drawing the layer fails
+    int (*start_cached_layer)(int layer_id, int width, int height);
+    void (*finish_cached_layer)(void);
+    // Whether a layer drawn at this scale looks exactly like drawing the images in it one by one would
+    int (*can_draw_cached_layer)(float scale);
+    int (*draw_cached_layer)(int layer_id, int x, int y, float scale);
+
     void (*get_max_image_size)(int *width, int *height);
 
     const image_atlas_data *(*prepare_image_atlas)(atlas_type type, int num_images, int last_width, int last_height);
     int (*create_image_atlas)(const image_atlas_data *data, int delete_buffers);
+    // Optional: create the atlas textures without pixels and upload each image, or part of it, later on
+    int (*create_empty_image_atlas)(const image_atlas_data *data);
+    int (*update_image_atlas)(const image_atlas_data *data, int index, int delete_buffer);
+    int (*update_image_atlas_region)(const image_atlas_data *data, int index, int x, int y, int width, int height);
     const image_atlas_data *(*get_image_atlas)(atlas_type type);
     int (*has_image_atlas)(atlas_type type);
     void (*free_image_atlas)(atlas_type type);
@@ -100,4 +117,23 @@ const graphics_renderer_interface *graphics_renderer(void);
 
 void graphics_renderer_set_interface(const graphics_renderer_interface *new_renderer);
 
+/**
+ * Starts forwarding the renderer calls that create, update or free images, so that images can be loaded
+ * from another thread. A forwarded call waits until the render thread runs it with
+ * graphics_renderer_run_forwarded_calls. Drawing calls are not forwarded, and the render thread
+ * must not call the forwarded functions itself until forwarding stops.
+ * @return Boolean true if the calls are forwarded, false if forwarding could not be started
+ */
+int graphics_renderer_start_forwarding(void);
+
+/**
+ * Runs the forwarded call that is waiting, if any. Must be called from the render thread
+ */
+void graphics_renderer_run_forwarded_calls(void);
+
+/**
+ * Stops forwarding the renderer calls. The thread that made the forwarded calls must be done with them
+ */
+void graphics_renderer_stop_forwarding(void);
+
 #endif // GRAPHICS_RENDERER_H
@@ -19,6 +19,7 @@ static struct {
     int refresh_immediate;
     int refresh_on_draw;
     int underlying_windows_redrawing;
+    int drawing;
 } data;
 
 static void noop(void)
@@ -130,6 +131,7 @@ static void update_input_after(void)
 
 void window_draw(int force)
 {
+    data.drawing = 1;
     update_input_before();
     window_type *w = data.current_window;
     if (force || data.refresh_on_draw) {
@@ -146,6 +148,12 @@ void window_draw(int force)
     tooltip_handle(m, w->get_tooltip);
     warning_draw();
     update_input_after();
+    data.drawing = 0;
+}
+
+int window_is_drawing(void)
+{
+    return data.drawing;
 }
 
 void window_draw_underlying_window(void)
@@ -131,6 +131,11 @@ int window_is_invalid(void);
 
 void window_draw(int force);
 
+/**
+ * Returns whether a frame is being drawn, which includes handling the input of the window
+ */
+int window_is_drawing(void);
+
 void window_draw_underlying_window(void);
 
 int window_is(window_id id);
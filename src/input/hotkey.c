@@ -513,6 +513,9 @@ static void set_definition_for_action(hotkey_action action, hotkey_definition *d
         case HOTKEY_EDITOR_EMPIRE_PICK_TOOL:
             def->action = &data.hotkey_state.pick_empire_tool;
             break;
+        case HOTKEY_REWIND_TO_SNAPSHOT:
+            def->action = &data.hotkey_state.rewind_to_snapshot;
+            break;
         default:
             def->action = 0;
     }
@@ -46,6 +46,7 @@ typedef struct {
     int build_menu_index_num;
     int empire_tool;
     int pick_empire_tool;
+    int rewind_to_snapshot;
 } hotkeys;
 
 void hotkey_install_mapping(hotkey_mapping *mappings, int num_mappings);
@@ -513,9 +513,7 @@ void map_grid_save_state_i8(const int8_t *grid, buffer *buf)
 
 void map_grid_save_state_u16(const uint16_t *grid, buffer *buf)
 {
-    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
-        buffer_write_u16(buf, grid[i]);
-    }
+    buffer_write_u16_array(buf, grid, GRID_SIZE * GRID_SIZE);
 }
 
 void map_grid_save_state_u32_to_u16(const uint32_t *grid, buffer *buf)
@@ -527,9 +525,7 @@ void map_grid_save_state_u32_to_u16(const uint32_t *grid, buffer *buf)
 
 void map_grid_save_state_u32(const uint32_t *grid, buffer *buf)
 {
-    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
-        buffer_write_u32(buf, grid[i]);
-    }
+    buffer_write_u32_array(buf, grid, GRID_SIZE * GRID_SIZE);
 }
 
 void map_grid_load_state_u8(uint8_t *grid, buffer *buf)
@@ -544,9 +540,7 @@ void map_grid_load_state_i8(int8_t *grid, buffer *buf)
 
 void map_grid_load_state_u16(uint16_t *grid, buffer *buf)
 {
-    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
-        grid[i] = buffer_read_u16(buf);
-    }
+    buffer_read_u16_array(buf, grid, GRID_SIZE * GRID_SIZE);
 }
 
 void map_grid_load_state_u16_to_u32(uint32_t *grid, buffer *buf)
@@ -558,7 +552,5 @@ void map_grid_load_state_u16_to_u32(uint32_t *grid, buffer *buf)
 
 void map_grid_load_state_u32(uint32_t *grid, buffer *buf)
 {
-    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
-        grid[i] = buffer_read_u32(buf);
-    }
+    buffer_read_u32_array(buf, grid, GRID_SIZE * GRID_SIZE);
 }
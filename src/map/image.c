@@ -10,21 +10,57 @@
 #include "map/orientation.h"
 #include "map/tiles.h"
 
+#define MAX_CHANGED_TILES 4096
+
 static grid_u32 images;
 static grid_u32 images_backup;
 
+static struct {
+    int grid_offsets[MAX_CHANGED_TILES];
+    int total;
+    int whole_map;
+} changed_tiles;
+
+static void mark_changed(int grid_offset)
+{
+    if (changed_tiles.whole_map) {
+        return;
+    }
+    if (changed_tiles.total == MAX_CHANGED_TILES) {
+        changed_tiles.whole_map = 1;
+        return;
+    }
+    changed_tiles.grid_offsets[changed_tiles.total++] = grid_offset;
+}
+
+static void mark_whole_map_changed(void)
+{
+    changed_tiles.whole_map = 1;
+}
+
 unsigned int map_image_at(int grid_offset)
 {
     return images.items[grid_offset];
 }
 
 void map_image_set(int grid_offset, int image_id)
+{
+    if (images.items[grid_offset] != (unsigned int) image_id) {
+        mark_changed(grid_offset);
+    }
+    images.items[grid_offset] = image_id;
+}
+
+void map_image_set_animation_frame(int grid_offset, int image_id)
 {
     images.items[grid_offset] = image_id;
 }
 
 void map_image_set_with_backup(int grid_offset, int image_id)
 {
+    if (images.items[grid_offset] != (unsigned int) image_id) {
+        mark_changed(grid_offset);
+    }
     images.items[grid_offset] = image_id;
     images_backup.items[grid_offset] = image_id;
 }
@@ -36,17 +72,26 @@ void map_image_backup(void)
 
 void map_image_restore(void)
 {
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+        if (images.items[i] != images_backup.items[i]) {
+            mark_changed(i);
+        }
+    }
     map_grid_copy_u32(images_backup.items, images.items);
 }
 
 void map_image_restore_at(int grid_offset)
 {
+    if (images.items[grid_offset] != images_backup.items[grid_offset]) {
+        mark_changed(grid_offset);
+    }
     images.items[grid_offset] = images_backup.items[grid_offset];
 }
 
 void map_image_clear(void)
 {
     map_grid_clear_u32(images.items);
+    mark_whole_map_changed();
 }
 
 void map_image_init_edges(void)
@@ -62,6 +107,7 @@ void map_image_init_edges(void)
     images.items[map_grid_offset(0, height)] = 3;
     images.items[map_grid_offset(width, 0)] = 4;
     images.items[map_grid_offset(width, height)] = 5;
+    mark_whole_map_changed();
 }
 
 void map_image_update_all(void)
@@ -90,6 +136,19 @@ void map_image_update_all(void)
     }
 }
 
+int map_image_take_changed_tiles(void (*callback)(int grid_offset))
+{
+    int whole_map = changed_tiles.whole_map;
+    if (!whole_map) {
+        for (int i = 0; i < changed_tiles.total; i++) {
+            callback(changed_tiles.grid_offsets[i]);
+        }
+    }
+    changed_tiles.total = 0;
+    changed_tiles.whole_map = 0;
+    return !whole_map;
+}
+
 void map_image_save_state_legacy(buffer *buf)
 {
     map_grid_save_state_u32_to_u16(images.items, buf);
@@ -98,4 +157,5 @@ void map_image_save_state_legacy(buffer *buf)
 void map_image_load_state_legacy(buffer *buf)
 {
     map_grid_load_state_u16_to_u32(images.items, buf);
+    mark_whole_map_changed();
 }
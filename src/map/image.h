@@ -7,6 +7,9 @@ unsigned int map_image_at(int grid_offset);
 
 void map_image_set(int grid_offset, int image_id);
 
+// Set the image without reporting the tile as changed, for animation frames that are drawn every frame anyway
+void map_image_set_animation_frame(int grid_offset, int image_id);
+
 // Set both the live image and the undo backup image for a single tile. Used by
 // auto-clear of vegetation so that, after we lay a road/aqueduct/building on the
 // cleared tile, the undo backup still shows grass (not the original tree image
@@ -23,6 +26,14 @@ void map_image_clear(void);
 void map_image_init_edges(void);
 void map_image_update_all(void);
 
+/**
+ * Reports the tiles whose image changed since the last call and forgets about them
+ * @param callback Called with the grid offset of every changed tile, possibly more than once for the same tile
+ * @return Boolean true if the changed tiles were reported, false if too many tiles changed to keep track of them,
+ * in which case the whole map should be considered changed
+ */
+int map_image_take_changed_tiles(void (*callback)(int grid_offset));
+
 void map_image_save_state_legacy(buffer *buf);
 
 void map_image_load_state_legacy(buffer *buf);
@@ -6,7 +6,9 @@
 #include "core/lang.h"
 #include "core/log.h"
 #include "core/time.h"
+#include "core/trace.h"
 #include "game/game.h"
+#include "game/save_benchmark.h"
 #include "game/settings.h"
 #include "game/system.h"
 #include "graphics/screen.h"
@@ -141,6 +143,13 @@ uint64_t system_get_ticks(void)
 #endif
 }
 
+uint64_t system_get_precise_ticks(void)
+{
+    uint64_t counter = SDL_GetPerformanceCounter();
+    uint64_t frequency = SDL_GetPerformanceFrequency();
+    return counter / frequency * 1000000 + counter % frequency * 1000000 / frequency;
+}
+
 #ifdef _WIN32
 #define PLATFORM_ENABLE_PER_FRAME_CALLBACK
 static void platform_per_frame_callback(void)
@@ -389,6 +398,20 @@ static void handle_event(SDL_Event *event)
     }
 }
 
+void system_handle_events_while_loading(int show_frame)
+{
+    SDL_Event event;
+    SDL_PumpEvents();
+    // Only window events are handled, the rest is left for the main loop once loading is done
+    while (SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_WINDOWEVENT, SDL_WINDOWEVENT) > 0) {
+        handle_window_event(&event.window, &data.active);
+    }
+    if (show_frame) {
+        platform_renderer_render();
+    }
+    SDL_Delay(1);
+}
+
 static void teardown(void)
 {
     SDL_Log("Exiting game");
@@ -609,10 +632,12 @@ static void setup(const augustus_args *args)
     SDL_Log("Augustus version %s, %s build", system_version(), system_architecture());
     SDL_Log("Running on: %s", system_OS());
 
+    trace_begin("init_sdl");
     if (!init_sdl(args->enable_joysticks)) {
         SDL_Log("Exiting: SDL init failed");
         exit_with_status(-1);
     }
+    trace_end("init_sdl");
 
 #ifdef __vita__
     const char *base_dir = VITA_PATH_PREFIX;
@@ -652,10 +677,12 @@ static void setup(const augustus_args *args)
 
     char title[100];
     encoding_to_utf8(lang_get_string(9, 0), title, 100, 0);
+    trace_begin("platform_screen_create");
     if (!platform_screen_create(title, config_get(CONFIG_SCREEN_DISPLAY_SCALE), args->display_id)) {
         SDL_Log("Exiting: SDL create window failed");
         exit_with_status(-2);
     }
+    trace_end("platform_screen_create");
 
 #ifdef PLATFORM_ENABLE_INIT_CALLBACK
     platform_init_callback();
@@ -683,7 +710,9 @@ static void setup(const augustus_args *args)
 
     time_set_millis(system_get_ticks());
 
+    trace_begin("game_init");
     int result = args->launch_asset_previewer ? window_asset_previewer_show() : game_init();
+    trace_end("game_init");
 
     if (!result) {
         SDL_Log("Exiting: game init failed");
@@ -704,13 +733,23 @@ int main(int argc, char **argv)
 #endif
     }
 
+    if (args.trace_startup_file) {
+        trace_start(args.trace_startup_file);
+    }
+
     setup(&args);
 
+    if (args.benchmark_saves_directory) {
+        exit_with_status(save_benchmark_run(args.benchmark_saves_directory, args.benchmark_output_directory) ? 0 : 1);
+    }
+
 
 
     mouse_set_inside_window(1);
     mouse_set_window_focus(1);
+    trace_begin("first_frame");
     run_and_draw();
+    trace_finish();
 
 #ifdef __EMSCRIPTEN__
     emscripten_set_main_loop(main_loop, 0, 1);
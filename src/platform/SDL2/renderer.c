@@ -25,6 +25,11 @@
 #define HAS_YUV_TEXTURES 0
 #endif
 
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+#define USE_CUSTOM_BLEND_MODE
+#define HAS_CUSTOM_BLEND_MODE (platform_sdl_version_at_least(2, 0, 6))
+#endif
+
 #if SDL_VERSION_ATLEAST(2, 0, 10)
 #define USE_RENDERCOPYF
 #define HAS_RENDERCOPYF (platform_sdl_version_at_least(2, 0, 10))
@@ -37,10 +42,19 @@
 #define HAS_TEXTURE_SCALE_MODE 0
 #endif
 
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+#define USE_RENDER_GEOMETRY
+#define HAS_RENDER_GEOMETRY (platform_sdl_version_at_least(2, 0, 18))
+#endif
+
 #define MAX_UNPACKED_IMAGES 20
 
 #define MAX_PACKED_IMAGE_SIZE 64000
 
+#define SPRITE_BATCH_MAX_SPRITES 1024
+
+#define MAX_CACHED_LAYERS 64
+
 #if (defined(__ANDROID__) || defined(__EMSCRIPTEN__)) && !SDL_VERSION_ATLEAST(2, 24, 0)
 // On the arm versions of android, on SDL < 2.24.0, atlas textures that are too large will make the renderer fetch
 // some images from the atlas with an off-by-one pixel, making things look terrible. Defining a smaller atlas texture
@@ -110,6 +124,16 @@ static struct {
         int current_id;
     } texture_buffers;
     silhouette_texture *silhouettes;
+    struct {
+        SDL_Texture *texture;
+        int width;
+        int height;
+    } cached_layers[MAX_CACHED_LAYERS];
+    struct {
+        SDL_Texture *target;
+        SDL_Rect viewport;
+        SDL_Rect clip;
+    } cached_layer_former_state;
     struct {
         int id;
         time_millis last_used;
@@ -120,10 +144,25 @@ static struct {
     float city_scale;
     int should_correct_texture_offset;
     int disable_linear_filter;
+#ifdef USE_RENDER_GEOMETRY
+    struct {
+        int active;
+        SDL_Texture *texture;
+        int texture_width;
+        int texture_height;
+        float scale;
+        int total_sprites;
+        SDL_Vertex vertices[SPRITE_BATCH_MAX_SPRITES * 4];
+        int indices[SPRITE_BATCH_MAX_SPRITES * 6];
+    } sprite_batch;
+#endif
 } data;
 
+static void flush_sprite_batch(void);
+
 static int save_screen_buffer(color_t *pixels, int x, int y, int width, int height, int row_width)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return 0;
     }
@@ -134,6 +173,7 @@ static int save_screen_buffer(color_t *pixels, int x, int y, int width, int heig
 
 static void draw_line(int x_start, int x_end, int y_start, int y_end, color_t color)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -147,6 +187,7 @@ static void draw_line(int x_start, int x_end, int y_start, int y_end, color_t co
 
 static void draw_rect(int x_start, int x_end, int y_start, int y_end, color_t color)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -161,6 +202,7 @@ static void draw_rect(int x_start, int x_end, int y_start, int y_end, color_t co
 
 static void fill_rect(int x_start, int x_end, int y_start, int y_end, color_t color)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -175,6 +217,7 @@ static void fill_rect(int x_start, int x_end, int y_start, int y_end, color_t co
 
 static void set_clip_rectangle(int x, int y, int width, int height)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -184,6 +227,7 @@ static void set_clip_rectangle(int x, int y, int width, int height)
 
 static void reset_clip_rectangle(void)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -192,6 +236,7 @@ static void reset_clip_rectangle(void)
 
 static void set_viewport(int x, int y, int width, int height)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -201,6 +246,7 @@ static void set_viewport(int x, int y, int width, int height)
 
 static void reset_viewport(void)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -210,6 +256,7 @@ static void reset_viewport(void)
 
 static void clear_screen(void)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -235,6 +282,16 @@ static void free_silhouettes(void)
     data.silhouettes = 0;
 }
 
+static void free_cached_layers(void)
+{
+    for (int i = 0; i < MAX_CACHED_LAYERS; i++) {
+        if (data.cached_layers[i].texture) {
+            SDL_DestroyTexture(data.cached_layers[i].texture);
+        }
+    }
+    memset(data.cached_layers, 0, sizeof(data.cached_layers));
+}
+
 static void free_unpacked_assets(void)
 {
     for (int i = 0; i < MAX_UNPACKED_IMAGES; i++) {
@@ -247,6 +304,7 @@ static void free_unpacked_assets(void)
 
 static void free_texture_atlas(atlas_type type)
 {
+    flush_sprite_batch();
     if (!data.texture_lists[type]) {
         return;
     }
@@ -354,6 +412,7 @@ static const image_atlas_data *prepare_texture_atlas(atlas_type type, int num_im
 
 static int create_texture_atlas(const image_atlas_data *atlas_data, int delete_buffers)
 {
+    flush_sprite_batch();
     if (!atlas_data || atlas_data != &data.atlas_data[atlas_data->type] || !atlas_data->num_images) {
         return 0;
     }
@@ -403,6 +462,78 @@ static int create_texture_atlas(const image_atlas_data *atlas_data, int delete_b
     return 1;
 }
 
+#ifndef __VITA__
+static int create_empty_texture_atlas(const image_atlas_data *atlas_data)
+{
+    if (!atlas_data || atlas_data != &data.atlas_data[atlas_data->type] || !atlas_data->num_images) {
+        return 0;
+    }
+    data.texture_lists[atlas_data->type] = malloc(sizeof(SDL_Texture *) * atlas_data->num_images);
+    SDL_Texture **list = data.texture_lists[atlas_data->type];
+    if (!list) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unable to create texture lists for atlas %u - out of memory",
+            atlas_data->type);
+        return 0;
+    }
+    memset(list, 0, sizeof(SDL_Texture *) * atlas_data->num_images);
+    for (int i = 0; i < atlas_data->num_images; i++) {
+        SDL_Log("Creating empty atlas texture with size %dx%d",
+            atlas_data->image_widths[i], atlas_data->image_heights[i]);
+        list[i] = SDL_CreateTexture(data.renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+            atlas_data->image_widths[i], atlas_data->image_heights[i]);
+        if (!list[i]) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unable to create texture. Reason: %s", SDL_GetError());
+            free_texture_atlas(atlas_data->type);
+            return 0;
+        }
+        SDL_SetTextureBlendMode(list[i], SDL_BLENDMODE_BLEND);
+    }
+    return 1;
+}
+
+static int can_update_texture_atlas(const image_atlas_data *atlas_data, int index)
+{
+    return !data.paused && atlas_data && atlas_data == &data.atlas_data[atlas_data->type] &&
+        index >= 0 && index < atlas_data->num_images && data.texture_lists[atlas_data->type] &&
+        atlas_data->buffers[index];
+}
+
+static int update_texture_atlas(const image_atlas_data *atlas_data, int index, int delete_buffer)
+{
+    flush_sprite_batch();
+    if (!can_update_texture_atlas(atlas_data, index)) {
+        return 0;
+    }
+    if (SDL_UpdateTexture(data.texture_lists[atlas_data->type][index], NULL, atlas_data->buffers[index],
+        atlas_data->image_widths[index] * sizeof(color_t)) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unable to update texture. Reason: %s", SDL_GetError());
+        return 0;
+    }
+    if (delete_buffer) {
+        free(atlas_data->buffers[index]);
+        atlas_data->buffers[index] = 0;
+    }
+    return 1;
+}
+
+static int update_texture_atlas_region(const image_atlas_data *atlas_data, int index,
+    int x, int y, int width, int height)
+{
+    flush_sprite_batch();
+    if (!can_update_texture_atlas(atlas_data, index)) {
+        return 0;
+    }
+    SDL_Rect rect = { x, y, width, height };
+    int row_width = atlas_data->image_widths[index];
+    if (SDL_UpdateTexture(data.texture_lists[atlas_data->type][index], &rect,
+        &atlas_data->buffers[index][y * row_width + x], row_width * sizeof(color_t)) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unable to update texture. Reason: %s", SDL_GetError());
+        return 0;
+    }
+    return 1;
+}
+#endif
+
 static int has_texture_atlas(atlas_type type)
 {
     return data.texture_lists[type] != 0;
@@ -418,6 +549,7 @@ static const image_atlas_data *get_texture_atlas(atlas_type type)
 
 static void free_all_textures(void)
 {
+    flush_sprite_batch();
     for (atlas_type i = ATLAS_FIRST; i < ATLAS_MAX - 1; i++) {
         free_texture_atlas_and_data(i);
     }
@@ -434,6 +566,7 @@ static void free_all_textures(void)
     }
 
     free_silhouettes();
+    free_cached_layers();
 
     if (data.tooltip.texture) {
         SDL_DestroyTexture(data.tooltip.texture);
@@ -505,6 +638,101 @@ static void set_texture_color_and_scale_mode(SDL_Texture *texture, color_t color
 #endif
 }
 
+static void flush_sprite_batch(void)
+{
+#ifdef USE_RENDER_GEOMETRY
+    if (!data.sprite_batch.total_sprites) {
+        return;
+    }
+    if (!data.paused) {
+        // The color of each sprite is in its vertices, so the texture itself must not be tinted
+        set_texture_color_and_scale_mode(data.sprite_batch.texture, COLOR_MASK_NONE, data.sprite_batch.scale);
+        SDL_RenderGeometry(data.renderer, data.sprite_batch.texture,
+            data.sprite_batch.vertices, data.sprite_batch.total_sprites * 4,
+            data.sprite_batch.indices, data.sprite_batch.total_sprites * 6);
+    }
+    data.sprite_batch.total_sprites = 0;
+    data.sprite_batch.texture = 0;
+#endif
+}
+
+#ifdef USE_RENDER_GEOMETRY
+static void start_sprite_batch(void)
+{
+    flush_sprite_batch();
+    // The software renderer rasterizes geometry differently from the copies it replaces
+    if (!HAS_RENDER_GEOMETRY || data.is_software_renderer) {
+        return;
+    }
+    if (!data.sprite_batch.indices[SPRITE_BATCH_MAX_SPRITES * 6 - 1]) {
+        for (int i = 0; i < SPRITE_BATCH_MAX_SPRITES; i++) {
+            int *indices = &data.sprite_batch.indices[i * 6];
+            int first_vertex = i * 4;
+            // The same triangles, in the same vertex order, as the strip the renderers draw a copied texture with.
+            // Texture coordinates that land exactly between two texels are then rounded the same way
+            indices[0] = first_vertex;
+            indices[1] = first_vertex + 1;
+            indices[2] = first_vertex + 3;
+            indices[3] = first_vertex + 1;
+            indices[4] = first_vertex + 3;
+            indices[5] = first_vertex + 2;
+        }
+    }
+    data.sprite_batch.active = 1;
+}
+
+static void finish_sprite_batch(void)
+{
+    flush_sprite_batch();
+    data.sprite_batch.active = 0;
+}
+
+static void set_sprite_vertex(SDL_Vertex *vertex, float x, float y, float texture_x, float texture_y, SDL_Color color)
+{
+    vertex->position.x = x;
+    vertex->position.y = y;
+    vertex->color = color;
+    vertex->tex_coord.x = texture_x / data.sprite_batch.texture_width;
+    vertex->tex_coord.y = texture_y / data.sprite_batch.texture_height;
+}
+
+static int add_sprite_to_batch(SDL_Texture *texture, const SDL_Rect *src, const SDL_FRect *dst,
+    color_t color, float scale)
+{
+    // Sprites are only joined while they use the same texture state, so they are still drawn in order
+    if (texture != data.sprite_batch.texture || scale != data.sprite_batch.scale ||
+        data.sprite_batch.total_sprites == SPRITE_BATCH_MAX_SPRITES) {
+        flush_sprite_batch();
+        if (SDL_QueryTexture(texture, NULL, NULL,
+            &data.sprite_batch.texture_width, &data.sprite_batch.texture_height) < 0) {
+            return 0;
+        }
+        data.sprite_batch.texture = texture;
+        data.sprite_batch.scale = scale;
+    }
+    if (!color) {
+        color = COLOR_MASK_NONE;
+    }
+    SDL_Color vertex_color = {
+        (color & COLOR_CHANNEL_RED) >> COLOR_BITSHIFT_RED,
+        (color & COLOR_CHANNEL_GREEN) >> COLOR_BITSHIFT_GREEN,
+        (color & COLOR_CHANNEL_BLUE) >> COLOR_BITSHIFT_BLUE,
+        (color & COLOR_CHANNEL_ALPHA) >> COLOR_BITSHIFT_ALPHA
+    };
+    SDL_Vertex *vertices = &data.sprite_batch.vertices[data.sprite_batch.total_sprites * 4];
+    float x_end = dst->x + dst->w;
+    float y_end = dst->y + dst->h;
+    int src_x_end = src->x + src->w;
+    int src_y_end = src->y + src->h;
+    set_sprite_vertex(&vertices[0], dst->x, dst->y, src->x, src->y, vertex_color);
+    set_sprite_vertex(&vertices[1], x_end, dst->y, src_x_end, src->y, vertex_color);
+    set_sprite_vertex(&vertices[2], x_end, y_end, src_x_end, src_y_end, vertex_color);
+    set_sprite_vertex(&vertices[3], dst->x, y_end, src->x, src_y_end, vertex_color);
+    data.sprite_batch.total_sprites++;
+    return 1;
+}
+#endif
+
 static void draw_texture_advanced(const image *img, float x, float y, color_t color,
     float scale_x, float scale_y, double angle, int disable_coord_scaling)
 {
@@ -520,8 +748,6 @@ static void draw_texture_advanced(const image *img, float x, float y, color_t co
 
     float scale = scale_x == scale_y ? scale_x : 0.0f;
 
-    set_texture_color_and_scale_mode(texture, color, scale);
-
     x += img->x_offset;
     y += img->y_offset;
 
@@ -546,6 +772,14 @@ static void draw_texture_advanced(const image *img, float x, float y, color_t co
             (img->width - grid_correction) / scale_x,
             (img->height - grid_correction) / scale_y
         };
+#ifdef USE_RENDER_GEOMETRY
+        if (data.sprite_batch.active && angle == 0.0 &&
+            add_sprite_to_batch(texture, &src_coords, &dst_coords, color, scale)) {
+            return;
+        }
+#endif
+        flush_sprite_batch();
+        set_texture_color_and_scale_mode(texture, color, scale);
         SDL_RenderCopyExF(data.renderer, texture, &src_coords, &dst_coords, angle, NULL, SDL_FLIP_NONE);
         return;
     }
@@ -557,6 +791,8 @@ static void draw_texture_advanced(const image *img, float x, float y, color_t co
         (int) round((img->width - grid_correction) / scale_x),
         (int) round((img->height - grid_correction) / scale_y)
     };
+    flush_sprite_batch();
+    set_texture_color_and_scale_mode(texture, color, scale);
     SDL_RenderCopyEx(data.renderer, texture, &src_coords, &dst_coords, angle, NULL, SDL_FLIP_NONE);
 }
 
@@ -567,6 +803,7 @@ static void draw_texture(const image *img, int x, int y, color_t color, float sc
 
 static void create_custom_texture(custom_image_type type, int width, int height, int is_yuv)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -593,6 +830,7 @@ static void create_custom_texture(custom_image_type type, int width, int height,
 
 static color_t *get_custom_texture_buffer(custom_image_type type, int *actual_texture_width)
 {
+    flush_sprite_batch();
     if (data.paused || !data.custom_textures[type].texture) {
         return 0;
     }
@@ -631,6 +869,7 @@ static void release_custom_texture_buffer(custom_image_type type)
 
 static void update_custom_texture(custom_image_type type)
 {
+    flush_sprite_batch();
 #ifndef __vita__
     if (data.paused || !data.custom_textures[type].texture || !data.custom_textures[type].buffer) {
         return;
@@ -645,6 +884,7 @@ static void update_custom_texture(custom_image_type type)
 static void update_custom_texture_from(custom_image_type type, const color_t *buffer,
     int x_offset, int y_offset, int width, int height)
 {
+    flush_sprite_batch();
     if (data.paused || !data.custom_textures[type].texture) {
         return;
     }
@@ -672,6 +912,7 @@ static void update_custom_texture_from(custom_image_type type, const color_t *bu
 static void update_custom_texture_yuv(custom_image_type type, const uint8_t *y_data, int y_width,
     const uint8_t *cb_data, int cb_width, const uint8_t *cr_data, int cr_width)
 {
+    flush_sprite_batch();
 #ifdef USE_YUV_TEXTURES
     if (data.paused || !data.supports_yuv_textures || !data.custom_textures[type].texture) {
         return;
@@ -690,6 +931,7 @@ static void update_custom_texture_yuv(custom_image_type type, const uint8_t *y_d
 
 static int start_tooltip_creation(int width, int height)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return 0;
     }
@@ -727,6 +969,7 @@ static int start_tooltip_creation(int width, int height)
 
 static void finish_tooltip_creation(void)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -765,6 +1008,7 @@ static buffer_texture *get_saved_texture_info(int texture_id)
 
 static int save_to_texture(int texture_id, int x, int y, int width, int height)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return 0;
     }
@@ -840,6 +1084,7 @@ static int save_to_texture(int texture_id, int x, int y, int width, int height)
 
 static void draw_saved_texture(int texture_id, int x, int y)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -852,6 +1097,112 @@ static void draw_saved_texture(int texture_id, int x, int y)
     SDL_RenderCopy(data.renderer, texture_info->texture, &src_coords, &dst_coords);
 }
 
+static void set_cached_layer_blend_mode(SDL_Texture *texture)
+{
+#ifdef USE_CUSTOM_BLEND_MODE
+    // Drawing into an empty layer already multiplies the colors by their alpha, so they must not be multiplied again
+    if (HAS_CUSTOM_BLEND_MODE) {
+        SDL_BlendMode premultiplied_blend_mode = SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+        if (SDL_SetTextureBlendMode(texture, premultiplied_blend_mode) == 0) {
+            return;
+        }
+    }
+#endif
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+}
+
+static int start_cached_layer(int layer_id, int width, int height)
+{
+    flush_sprite_batch();
+    if (data.paused || layer_id < 0 || layer_id >= MAX_CACHED_LAYERS) {
+        return 0;
+    }
+    SDL_Texture *former_target = SDL_GetRenderTarget(data.renderer);
+    if (!former_target) {
+        return 0;
+    }
+    if (data.cached_layers[layer_id].texture &&
+        (data.cached_layers[layer_id].width != width || data.cached_layers[layer_id].height != height)) {
+        SDL_DestroyTexture(data.cached_layers[layer_id].texture);
+        data.cached_layers[layer_id].texture = 0;
+    }
+    if (!data.cached_layers[layer_id].texture) {
+        SDL_Texture *texture = SDL_CreateTexture(data.renderer, SDL_PIXELFORMAT_ABGR8888,
+            SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!texture) {
+            return 0;
+        }
+        set_cached_layer_blend_mode(texture);
+        data.cached_layers[layer_id].texture = texture;
+        data.cached_layers[layer_id].width = width;
+        data.cached_layers[layer_id].height = height;
+    }
+    data.cached_layer_former_state.target = former_target;
+    SDL_RenderGetViewport(data.renderer, &data.cached_layer_former_state.viewport);
+    SDL_RenderGetClipRect(data.renderer, &data.cached_layer_former_state.clip);
+    if (SDL_SetRenderTarget(data.renderer, data.cached_layers[layer_id].texture) != 0) {
+        return 0;
+    }
+    SDL_SetRenderDrawColor(data.renderer, 0, 0, 0, 0);
+    SDL_RenderClear(data.renderer);
+    return 1;
+}
+
+static void finish_cached_layer(void)
+{
+    flush_sprite_batch();
+    if (data.paused || !data.cached_layer_former_state.target) {
+        return;
+    }
+    SDL_SetRenderTarget(data.renderer, data.cached_layer_former_state.target);
+    SDL_RenderSetViewport(data.renderer, &data.cached_layer_former_state.viewport);
+    if (SDL_RectEmpty(&data.cached_layer_former_state.clip)) {
+        SDL_RenderSetClipRect(data.renderer, NULL);
+    } else {
+        SDL_RenderSetClipRect(data.renderer, &data.cached_layer_former_state.clip);
+    }
+    data.cached_layer_former_state.target = 0;
+}
+
+static int can_draw_cached_layer(float scale)
+{
+    // At these scales the textures are offset or shrunk one by one, which drawing a whole layer cannot reproduce
+    if (config_get(CONFIG_UI_SHOW_GRID) && data.city_scale > 2.0f) {
+        return 0;
+    }
+    return scale != data.city_scale || !data.should_correct_texture_offset;
+}
+
+static int draw_cached_layer(int layer_id, int x, int y, float scale)
+{
+    flush_sprite_batch();
+    if (data.paused || layer_id < 0 || layer_id >= MAX_CACHED_LAYERS || !data.cached_layers[layer_id].texture) {
+        return 0;
+    }
+    SDL_Texture *texture = data.cached_layers[layer_id].texture;
+    int width = data.cached_layers[layer_id].width;
+    int height = data.cached_layers[layer_id].height;
+    set_texture_color_and_scale_mode(texture, COLOR_MASK_NONE, scale);
+#ifdef USE_RENDERCOPYF
+    if (HAS_RENDERCOPYF) {
+        SDL_FRect dst_coords = { x / scale, y / scale, width / scale, height / scale };
+        return SDL_RenderCopyF(data.renderer, texture, NULL, &dst_coords) == 0;
+    }
+#endif
+    // Round both edges, so that neighbouring layers neither overlap nor leave a gap
+    int x_start = (int) round(x / scale);
+    int y_start = (int) round(y / scale);
+    SDL_Rect dst_coords = {
+        x_start,
+        y_start,
+        (int) round((x + width) / scale) - x_start,
+        (int) round((y + height) / scale) - y_start
+    };
+    return SDL_RenderCopy(data.renderer, texture, NULL, &dst_coords) == 0;
+}
+
 static void create_blend_texture(custom_image_type type)
 {
     SDL_Texture *texture = SDL_CreateTexture(data.renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET, 58, 30);
@@ -859,6 +1210,7 @@ static void create_blend_texture(custom_image_type type)
         return;
     }
     const image *img = image_get(image_group(GROUP_TERRAIN_FLAT_TILE));
+    image_load_pixels(img);
     SDL_Texture *flat_tile = get_texture(img->atlas.id);
     SDL_Texture *former_target = SDL_GetRenderTarget(data.renderer);
     SDL_Rect former_viewport;
@@ -992,6 +1344,7 @@ static SDL_Texture *get_silhouette_texture(const image *img)
 
 static void draw_silhouetted_texture(const image *img, int x, int y, color_t color, float scale)
 {
+    flush_sprite_batch();
     SDL_Texture *texture = get_silhouette_texture(img);
     if (!texture) {
         return;
@@ -1026,6 +1379,7 @@ static void draw_silhouetted_texture(const image *img, int x, int y, color_t col
 
 static void draw_custom_texture(custom_image_type type, int x, int y, float scale, int disable_filtering)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -1046,6 +1400,7 @@ static int has_custom_texture(custom_image_type type)
 
 static void load_unpacked_image(const image *img, const color_t *pixels)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -1109,6 +1464,7 @@ static void load_unpacked_image(const image *img, const color_t *pixels)
 
 static void free_unpacked_image(const image *img)
 {
+    flush_sprite_batch();
     int unpacked_image_id = img->atlas.id & IMAGE_ATLAS_BIT_MASK;
     int found_id = -1;
     for (int i = 0; i < MAX_UNPACKED_IMAGES; i++) {
@@ -1133,6 +1489,7 @@ static int should_pack_image(int width, int height)
 
 static void update_scale(int city_scale)
 {
+    flush_sprite_batch();
     // The renderer draws the textures off-by-one when "scale * 100" is a multiple of 8, or when zooming out enough,
     // this fixes that rendering bug by properly offseting the textures
     data.should_correct_texture_offset = (city_scale > 250 && (city_scale % 100) != 0) || (city_scale % 8) == 0;
@@ -1157,6 +1514,10 @@ static void create_renderer_interface(void)
     data.renderer_interface.draw_image = draw_texture;
     data.renderer_interface.draw_image_advanced = draw_texture_advanced;
     data.renderer_interface.draw_silhouette = draw_silhouetted_texture;
+#ifdef USE_RENDER_GEOMETRY
+    data.renderer_interface.start_sprite_batch = start_sprite_batch;
+    data.renderer_interface.finish_sprite_batch = finish_sprite_batch;
+#endif
     data.renderer_interface.create_custom_image = create_custom_texture;
     data.renderer_interface.has_custom_image = has_custom_texture;
     data.renderer_interface.get_custom_image_buffer = get_custom_texture_buffer;
@@ -1174,9 +1535,18 @@ static void create_renderer_interface(void)
     data.renderer_interface.save_image_from_screen = save_to_texture;
     data.renderer_interface.draw_image_to_screen = draw_saved_texture;
     data.renderer_interface.save_screen_buffer = save_screen_buffer;
+    data.renderer_interface.start_cached_layer = start_cached_layer;
+    data.renderer_interface.finish_cached_layer = finish_cached_layer;
+    data.renderer_interface.can_draw_cached_layer = can_draw_cached_layer;
+    data.renderer_interface.draw_cached_layer = draw_cached_layer;
     data.renderer_interface.get_max_image_size = get_max_image_size;
     data.renderer_interface.prepare_image_atlas = prepare_texture_atlas;
     data.renderer_interface.create_image_atlas = create_texture_atlas;
+#ifndef __VITA__
+    data.renderer_interface.create_empty_image_atlas = create_empty_texture_atlas;
+    data.renderer_interface.update_image_atlas = update_texture_atlas;
+    data.renderer_interface.update_image_atlas_region = update_texture_atlas_region;
+#endif
     data.renderer_interface.get_image_atlas = get_texture_atlas;
     data.renderer_interface.has_image_atlas = has_texture_atlas;
     data.renderer_interface.free_image_atlas = free_texture_atlas_and_data;
@@ -1253,6 +1623,7 @@ int platform_renderer_init(void *window)
 
 static void destroy_render_texture(void)
 {
+    flush_sprite_batch();
     if (data.render_texture) {
         SDL_DestroyTexture(data.render_texture);
         data.render_texture = 0;
@@ -1325,6 +1696,7 @@ int platform_renderer_lost_render_texture(void)
 
 void platform_renderer_invalidate_target_textures(void)
 {
+    flush_sprite_batch();
     if (data.custom_textures[CUSTOM_IMAGE_RED_FOOTPRINT].texture) {
         SDL_DestroyTexture(data.custom_textures[CUSTOM_IMAGE_RED_FOOTPRINT].texture);
         data.custom_textures[CUSTOM_IMAGE_RED_FOOTPRINT].texture = 0;
@@ -1339,6 +1711,7 @@ void platform_renderer_invalidate_target_textures(void)
         SDL_DestroyTexture(data.tooltip.texture);
         data.tooltip.texture = 0;
     }
+    free_cached_layers();
 }
 
 void platform_renderer_clear(void)
@@ -1391,6 +1764,7 @@ static void draw_software_mouse_cursor(void)
 
 void platform_renderer_render(void)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -1430,6 +1804,7 @@ void platform_renderer_generate_mouse_cursor_texture(int cursor_id, int size, co
 
 void platform_renderer_pause(void)
 {
+    flush_sprite_batch();
     SDL_SetRenderTarget(data.renderer, NULL);
     data.paused = 1;
 }
@@ -22,6 +22,10 @@
 
 #define MAX_PACKED_IMAGE_SIZE 64000
 
+#define SPRITE_BATCH_MAX_SPRITES 1024
+
+#define MAX_CACHED_LAYERS 64
+
 #ifdef __vita__
 // On Vita, due to the small amount of VRAM, having textures that are too large will cause the game to eventually crash
 // when changing climates, due to lack of contiguous memory space. Creating smaller atlases mitigates the issue
@@ -83,6 +87,17 @@ static struct {
         int current_id;
     } texture_buffers;
     silhouette_texture *silhouettes;
+    struct {
+        SDL_Texture *texture;
+        int width;
+        int height;
+    } cached_layers[MAX_CACHED_LAYERS];
+    struct {
+        SDL_Texture *target;
+        SDL_Rect viewport;
+        SDL_Rect clip;
+        int has_clip;
+    } cached_layer_former_state;
     struct {
         int id;
         time_millis last_used;
@@ -93,10 +108,23 @@ static struct {
     float city_scale;
     int should_correct_texture_offset;
     int disable_linear_filter;
+    struct {
+        int active;
+        SDL_Texture *texture;
+        float texture_width;
+        float texture_height;
+        float scale;
+        int total_sprites;
+        SDL_Vertex vertices[SPRITE_BATCH_MAX_SPRITES * 4];
+        int indices[SPRITE_BATCH_MAX_SPRITES * 6];
+    } sprite_batch;
 } data;
 
+static void flush_sprite_batch(void);
+
 static int save_screen_buffer(color_t *pixels, int x, int y, int width, int height, int row_width)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return 0;
     }
@@ -135,6 +163,7 @@ static int save_screen_buffer(color_t *pixels, int x, int y, int width, int heig
 
 static void draw_line(int x_start, int x_end, int y_start, int y_end, color_t color)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -148,6 +177,7 @@ static void draw_line(int x_start, int x_end, int y_start, int y_end, color_t co
 
 static void draw_rect(int x_start, int x_end, int y_start, int y_end, color_t color)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -162,6 +192,7 @@ static void draw_rect(int x_start, int x_end, int y_start, int y_end, color_t co
 
 static void fill_rect(int x_start, int x_end, int y_start, int y_end, color_t color)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -176,6 +207,7 @@ static void fill_rect(int x_start, int x_end, int y_start, int y_end, color_t co
 
 static void set_clip_rectangle(int x, int y, int width, int height)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -185,6 +217,7 @@ static void set_clip_rectangle(int x, int y, int width, int height)
 
 static void reset_clip_rectangle(void)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -193,6 +226,7 @@ static void reset_clip_rectangle(void)
 
 static void set_viewport(int x, int y, int width, int height)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -202,6 +236,7 @@ static void set_viewport(int x, int y, int width, int height)
 
 static void reset_viewport(void)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -211,6 +246,7 @@ static void reset_viewport(void)
 
 static void clear_screen(void)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -236,6 +272,16 @@ static void free_silhouettes(void)
     data.silhouettes = 0;
 }
 
+static void free_cached_layers(void)
+{
+    for (int i = 0; i < MAX_CACHED_LAYERS; i++) {
+        if (data.cached_layers[i].texture) {
+            SDL_DestroyTexture(data.cached_layers[i].texture);
+        }
+    }
+    memset(data.cached_layers, 0, sizeof(data.cached_layers));
+}
+
 static void free_unpacked_assets(void)
 {
     for (int i = 0; i < MAX_UNPACKED_IMAGES; i++) {
@@ -248,6 +294,7 @@ static void free_unpacked_assets(void)
 
 static void free_texture_atlas(atlas_type type)
 {
+    flush_sprite_batch();
     if (!data.texture_lists[type]) {
         return;
     }
@@ -355,6 +402,7 @@ static const image_atlas_data *prepare_texture_atlas(atlas_type type, int num_im
 
 static int create_texture_atlas(const image_atlas_data *atlas_data, int delete_buffers)
 {
+    flush_sprite_batch();
     if (!atlas_data || atlas_data != &data.atlas_data[atlas_data->type] || !atlas_data->num_images) {
         return 0;
     }
@@ -401,6 +449,77 @@ static int create_texture_atlas(const image_atlas_data *atlas_data, int delete_b
     return 1;
 }
 
+#ifndef __VITA__
+static int create_empty_texture_atlas(const image_atlas_data *atlas_data)
+{
+    if (!atlas_data || atlas_data != &data.atlas_data[atlas_data->type] || !atlas_data->num_images) {
+        return 0;
+    }
+    data.texture_lists[atlas_data->type] = malloc(sizeof(SDL_Texture *) * atlas_data->num_images);
+    SDL_Texture **list = data.texture_lists[atlas_data->type];
+    if (!list) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unable to create texture lists for atlas %u - out of memory",
+            atlas_data->type);
+        return 0;
+    }
+    memset(list, 0, sizeof(SDL_Texture *) * atlas_data->num_images);
+    for (int i = 0; i < atlas_data->num_images; i++) {
+        SDL_Log("Creating empty atlas texture with size %dx%d",
+            atlas_data->image_widths[i], atlas_data->image_heights[i]);
+        list[i] = SDL_CreateTexture(data.renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+            atlas_data->image_widths[i], atlas_data->image_heights[i]);
+        if (!list[i]) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unable to create texture. Reason: %s", SDL_GetError());
+            free_texture_atlas(atlas_data->type);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int can_update_texture_atlas(const image_atlas_data *atlas_data, int index)
+{
+    return !data.paused && atlas_data && atlas_data == &data.atlas_data[atlas_data->type] &&
+        index >= 0 && index < atlas_data->num_images && data.texture_lists[atlas_data->type] &&
+        atlas_data->buffers[index];
+}
+
+static int update_texture_atlas(const image_atlas_data *atlas_data, int index, int delete_buffer)
+{
+    flush_sprite_batch();
+    if (!can_update_texture_atlas(atlas_data, index)) {
+        return 0;
+    }
+    if (!SDL_UpdateTexture(data.texture_lists[atlas_data->type][index], NULL, atlas_data->buffers[index],
+        atlas_data->image_widths[index] * sizeof(color_t))) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unable to update texture. Reason: %s", SDL_GetError());
+        return 0;
+    }
+    if (delete_buffer) {
+        free(atlas_data->buffers[index]);
+        atlas_data->buffers[index] = 0;
+    }
+    return 1;
+}
+
+static int update_texture_atlas_region(const image_atlas_data *atlas_data, int index,
+    int x, int y, int width, int height)
+{
+    flush_sprite_batch();
+    if (!can_update_texture_atlas(atlas_data, index)) {
+        return 0;
+    }
+    SDL_Rect rect = { x, y, width, height };
+    int row_width = atlas_data->image_widths[index];
+    if (!SDL_UpdateTexture(data.texture_lists[atlas_data->type][index], &rect,
+        &atlas_data->buffers[index][y * row_width + x], row_width * sizeof(color_t))) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unable to update texture. Reason: %s", SDL_GetError());
+        return 0;
+    }
+    return 1;
+}
+#endif
+
 static int has_texture_atlas(atlas_type type)
 {
     return data.texture_lists[type] != 0;
@@ -416,6 +535,7 @@ static const image_atlas_data *get_texture_atlas(atlas_type type)
 
 static void free_all_textures(void)
 {
+    flush_sprite_batch();
     for (atlas_type i = ATLAS_FIRST; i < ATLAS_MAX - 1; i++) {
         free_texture_atlas_and_data(i);
     }
@@ -432,6 +552,7 @@ static void free_all_textures(void)
     }
 
     free_silhouettes();
+    free_cached_layers();
 
     if (data.tooltip.texture) {
         SDL_DestroyTexture(data.tooltip.texture);
@@ -498,6 +619,96 @@ static void set_texture_color_and_scale_mode(SDL_Texture *texture, color_t color
     }
 }
 
+static void flush_sprite_batch(void)
+{
+    if (!data.sprite_batch.total_sprites) {
+        return;
+    }
+    if (!data.paused) {
+        // The color of each sprite is in its vertices, so the texture itself must not be tinted
+        set_texture_color_and_scale_mode(data.sprite_batch.texture, COLOR_MASK_NONE, data.sprite_batch.scale);
+        SDL_RenderGeometry(data.renderer, data.sprite_batch.texture,
+            data.sprite_batch.vertices, data.sprite_batch.total_sprites * 4,
+            data.sprite_batch.indices, data.sprite_batch.total_sprites * 6);
+    }
+    data.sprite_batch.total_sprites = 0;
+    data.sprite_batch.texture = 0;
+}
+
+static void start_sprite_batch(void)
+{
+    flush_sprite_batch();
+    // The software renderer rasterizes geometry differently from the copies it replaces
+    if (data.is_software_renderer) {
+        return;
+    }
+    if (!data.sprite_batch.indices[SPRITE_BATCH_MAX_SPRITES * 6 - 1]) {
+        for (int i = 0; i < SPRITE_BATCH_MAX_SPRITES; i++) {
+            int *indices = &data.sprite_batch.indices[i * 6];
+            int first_vertex = i * 4;
+            // The same triangles, in the same vertex order, as the strip the renderers draw a copied texture with.
+            // Texture coordinates that land exactly between two texels are then rounded the same way
+            indices[0] = first_vertex;
+            indices[1] = first_vertex + 1;
+            indices[2] = first_vertex + 3;
+            indices[3] = first_vertex + 1;
+            indices[4] = first_vertex + 3;
+            indices[5] = first_vertex + 2;
+        }
+    }
+    data.sprite_batch.active = 1;
+}
+
+static void finish_sprite_batch(void)
+{
+    flush_sprite_batch();
+    data.sprite_batch.active = 0;
+}
+
+static void set_sprite_vertex(SDL_Vertex *vertex, float x, float y, float texture_x, float texture_y, SDL_FColor color)
+{
+    vertex->position.x = x;
+    vertex->position.y = y;
+    vertex->color = color;
+    vertex->tex_coord.x = texture_x / data.sprite_batch.texture_width;
+    vertex->tex_coord.y = texture_y / data.sprite_batch.texture_height;
+}
+
+static int add_sprite_to_batch(SDL_Texture *texture, const SDL_FRect *src, const SDL_FRect *dst,
+    color_t color, float scale)
+{
+    // Sprites are only joined while they use the same texture state, so they are still drawn in order
+    if (texture != data.sprite_batch.texture || scale != data.sprite_batch.scale ||
+        data.sprite_batch.total_sprites == SPRITE_BATCH_MAX_SPRITES) {
+        flush_sprite_batch();
+        if (!SDL_GetTextureSize(texture, &data.sprite_batch.texture_width, &data.sprite_batch.texture_height)) {
+            return 0;
+        }
+        data.sprite_batch.texture = texture;
+        data.sprite_batch.scale = scale;
+    }
+    if (!color) {
+        color = COLOR_MASK_NONE;
+    }
+    SDL_FColor vertex_color = {
+        ((color & COLOR_CHANNEL_RED) >> COLOR_BITSHIFT_RED) / 255.0f,
+        ((color & COLOR_CHANNEL_GREEN) >> COLOR_BITSHIFT_GREEN) / 255.0f,
+        ((color & COLOR_CHANNEL_BLUE) >> COLOR_BITSHIFT_BLUE) / 255.0f,
+        ((color & COLOR_CHANNEL_ALPHA) >> COLOR_BITSHIFT_ALPHA) / 255.0f
+    };
+    SDL_Vertex *vertices = &data.sprite_batch.vertices[data.sprite_batch.total_sprites * 4];
+    float x_end = dst->x + dst->w;
+    float y_end = dst->y + dst->h;
+    float src_x_end = src->x + src->w;
+    float src_y_end = src->y + src->h;
+    set_sprite_vertex(&vertices[0], dst->x, dst->y, src->x, src->y, vertex_color);
+    set_sprite_vertex(&vertices[1], x_end, dst->y, src_x_end, src->y, vertex_color);
+    set_sprite_vertex(&vertices[2], x_end, y_end, src_x_end, src_y_end, vertex_color);
+    set_sprite_vertex(&vertices[3], dst->x, y_end, src->x, src_y_end, vertex_color);
+    data.sprite_batch.total_sprites++;
+    return 1;
+}
+
 static void draw_texture_advanced(const image *img, float x, float y, color_t color,
     float scale_x, float scale_y, double angle, int disable_coord_scaling)
 {
@@ -513,8 +724,6 @@ static void draw_texture_advanced(const image *img, float x, float y, color_t co
 
     float scale = scale_x == scale_y ? scale_x : 0.0f;
 
-    set_texture_color_and_scale_mode(texture, color, scale);
-
     x += img->x_offset;
     y += img->y_offset;
 
@@ -537,6 +746,12 @@ static void draw_texture_advanced(const image *img, float x, float y, color_t co
         (img->width - grid_correction) / scale_x,
         (img->height - grid_correction) / scale_y
     };
+    if (data.sprite_batch.active && angle == 0.0 &&
+        add_sprite_to_batch(texture, &src_coords, &dst_coords, color, scale)) {
+        return;
+    }
+    flush_sprite_batch();
+    set_texture_color_and_scale_mode(texture, color, scale);
     SDL_RenderTextureRotated(data.renderer, texture, &src_coords, &dst_coords, angle, NULL, SDL_FLIP_NONE);
 }
 
@@ -547,6 +762,7 @@ static void draw_texture(const image *img, int x, int y, color_t color, float sc
 
 static void create_custom_texture(custom_image_type type, int width, int height, int is_yuv)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -574,6 +790,7 @@ static void create_custom_texture(custom_image_type type, int width, int height,
 
 static color_t *get_custom_texture_buffer(custom_image_type type, int *actual_texture_width)
 {
+    flush_sprite_batch();
     if (data.paused || !data.custom_textures[type].texture) {
         return 0;
     }
@@ -625,6 +842,7 @@ static void release_custom_texture_buffer(custom_image_type type)
 
 static void update_custom_texture(custom_image_type type)
 {
+    flush_sprite_batch();
 #ifndef __vita__
     if (data.paused || !data.custom_textures[type].texture || !data.custom_textures[type].buffer) {
         return;
@@ -639,6 +857,7 @@ static void update_custom_texture(custom_image_type type)
 static void update_custom_texture_from(custom_image_type type, const color_t *buffer,
     int x_offset, int y_offset, int width, int height)
 {
+    flush_sprite_batch();
     if (data.paused || !data.custom_textures[type].texture) {
         return;
     }
@@ -666,6 +885,7 @@ static void update_custom_texture_from(custom_image_type type, const color_t *bu
 static void update_custom_texture_yuv(custom_image_type type, const uint8_t *y_data, int y_width,
     const uint8_t *cb_data, int cb_width, const uint8_t *cr_data, int cr_width)
 {
+    flush_sprite_batch();
     if (data.paused || !data.supports_yuv_textures || !data.custom_textures[type].texture) {
         return;
     }
@@ -684,6 +904,7 @@ static void update_custom_texture_yuv(custom_image_type type, const uint8_t *y_d
 
 static int start_tooltip_creation(int width, int height)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return 0;
     }
@@ -719,6 +940,7 @@ static int start_tooltip_creation(int width, int height)
 
 static void finish_tooltip_creation(void)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -756,6 +978,7 @@ static buffer_texture *get_saved_texture_info(int texture_id)
 
 static int save_to_texture(int texture_id, int x, int y, int width, int height)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return 0;
     }
@@ -827,6 +1050,7 @@ static int save_to_texture(int texture_id, int x, int y, int width, int height)
 
 static void draw_saved_texture(int texture_id, int x, int y)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -839,6 +1063,86 @@ static void draw_saved_texture(int texture_id, int x, int y)
     SDL_RenderTexture(data.renderer, texture_info->texture, &src_coords, &dst_coords);
 }
 
+static int start_cached_layer(int layer_id, int width, int height)
+{
+    flush_sprite_batch();
+    if (data.paused || layer_id < 0 || layer_id >= MAX_CACHED_LAYERS) {
+        return 0;
+    }
+    SDL_Texture *former_target = SDL_GetRenderTarget(data.renderer);
+    if (!former_target) {
+        return 0;
+    }
+    if (data.cached_layers[layer_id].texture &&
+        (data.cached_layers[layer_id].width != width || data.cached_layers[layer_id].height != height)) {
+        SDL_DestroyTexture(data.cached_layers[layer_id].texture);
+        data.cached_layers[layer_id].texture = 0;
+    }
+    if (!data.cached_layers[layer_id].texture) {
+        SDL_Texture *texture = SDL_CreateTexture(data.renderer, SDL_PIXELFORMAT_ABGR8888,
+            SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!texture) {
+            return 0;
+        }
+        // Drawing into an empty layer already multiplies the colors by their alpha, so they must not be multiplied again
+        if (!SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND_PREMULTIPLIED)) {
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        }
+        data.cached_layers[layer_id].texture = texture;
+        data.cached_layers[layer_id].width = width;
+        data.cached_layers[layer_id].height = height;
+    }
+    data.cached_layer_former_state.target = former_target;
+    SDL_GetRenderViewport(data.renderer, &data.cached_layer_former_state.viewport);
+    data.cached_layer_former_state.has_clip = SDL_RenderClipEnabled(data.renderer);
+    SDL_GetRenderClipRect(data.renderer, &data.cached_layer_former_state.clip);
+    if (!SDL_SetRenderTarget(data.renderer, data.cached_layers[layer_id].texture)) {
+        return 0;
+    }
+    SDL_SetRenderDrawColor(data.renderer, 0, 0, 0, 0);
+    SDL_RenderClear(data.renderer);
+    return 1;
+}
+
+static void finish_cached_layer(void)
+{
+    flush_sprite_batch();
+    if (data.paused || !data.cached_layer_former_state.target) {
+        return;
+    }
+    SDL_SetRenderTarget(data.renderer, data.cached_layer_former_state.target);
+    SDL_SetRenderViewport(data.renderer, &data.cached_layer_former_state.viewport);
+    SDL_SetRenderClipRect(data.renderer,
+        data.cached_layer_former_state.has_clip ? &data.cached_layer_former_state.clip : NULL);
+    data.cached_layer_former_state.target = 0;
+}
+
+static int can_draw_cached_layer(float scale)
+{
+    // At these scales the textures are offset or shrunk one by one, which drawing a whole layer cannot reproduce
+    if (config_get(CONFIG_UI_SHOW_GRID) && data.city_scale > 2.0f) {
+        return 0;
+    }
+    return scale != data.city_scale || !data.should_correct_texture_offset;
+}
+
+static int draw_cached_layer(int layer_id, int x, int y, float scale)
+{
+    flush_sprite_batch();
+    if (data.paused || layer_id < 0 || layer_id >= MAX_CACHED_LAYERS || !data.cached_layers[layer_id].texture) {
+        return 0;
+    }
+    SDL_Texture *texture = data.cached_layers[layer_id].texture;
+    set_texture_color_and_scale_mode(texture, COLOR_MASK_NONE, scale);
+    SDL_FRect dst_coords = {
+        x / scale,
+        y / scale,
+        data.cached_layers[layer_id].width / scale,
+        data.cached_layers[layer_id].height / scale
+    };
+    return SDL_RenderTexture(data.renderer, texture, NULL, &dst_coords);
+}
+
 static void create_blend_texture(custom_image_type type)
 {
     SDL_Texture *texture = SDL_CreateTexture(data.renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET, 58, 30);
@@ -846,6 +1150,7 @@ static void create_blend_texture(custom_image_type type)
         return;
     }
     const image *img = image_get(image_group(GROUP_TERRAIN_FLAT_TILE));
+    image_load_pixels(img);
     SDL_Texture *flat_tile = get_texture(img->atlas.id);
     SDL_Texture *former_target = SDL_GetRenderTarget(data.renderer);
     SDL_Rect former_viewport;
@@ -976,6 +1281,7 @@ static SDL_Texture *get_silhouette_texture(const image *img)
 
 static void draw_silhouetted_texture(const image *img, int x, int y, color_t color, float scale)
 {
+    flush_sprite_batch();
     SDL_Texture *texture = get_silhouette_texture(img);
     if (!texture) {
         return;
@@ -1001,6 +1307,7 @@ static void draw_silhouetted_texture(const image *img, int x, int y, color_t col
 
 static void draw_custom_texture(custom_image_type type, int x, int y, float scale, int disable_filtering)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -1021,6 +1328,7 @@ static int has_custom_texture(custom_image_type type)
 
 static void load_unpacked_image(const image *img, const color_t *pixels)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -1083,6 +1391,7 @@ static void load_unpacked_image(const image *img, const color_t *pixels)
 
 static void free_unpacked_image(const image *img)
 {
+    flush_sprite_batch();
     int unpacked_image_id = img->atlas.id & IMAGE_ATLAS_BIT_MASK;
     int found_id = -1;
     for (int i = 0; i < MAX_UNPACKED_IMAGES; i++) {
@@ -1107,6 +1416,7 @@ static int should_pack_image(int width, int height)
 
 static void update_scale(int city_scale)
 {
+    flush_sprite_batch();
     // The renderer draws the textures off-by-one when "scale * 100" is a multiple of 8, or when zooming out enough,
     // this fixes that rendering bug by properly offseting the textures
     data.should_correct_texture_offset = (city_scale > 250 && (city_scale % 100) != 0) || (city_scale % 8) == 0;
@@ -1131,6 +1441,8 @@ static void create_renderer_interface(void)
     data.renderer_interface.draw_image = draw_texture;
     data.renderer_interface.draw_image_advanced = draw_texture_advanced;
     data.renderer_interface.draw_silhouette = draw_silhouetted_texture;
+    data.renderer_interface.start_sprite_batch = start_sprite_batch;
+    data.renderer_interface.finish_sprite_batch = finish_sprite_batch;
     data.renderer_interface.create_custom_image = create_custom_texture;
     data.renderer_interface.has_custom_image = has_custom_texture;
     data.renderer_interface.get_custom_image_buffer = get_custom_texture_buffer;
@@ -1148,9 +1460,18 @@ static void create_renderer_interface(void)
     data.renderer_interface.save_image_from_screen = save_to_texture;
     data.renderer_interface.draw_image_to_screen = draw_saved_texture;
     data.renderer_interface.save_screen_buffer = save_screen_buffer;
+    data.renderer_interface.start_cached_layer = start_cached_layer;
+    data.renderer_interface.finish_cached_layer = finish_cached_layer;
+    data.renderer_interface.can_draw_cached_layer = can_draw_cached_layer;
+    data.renderer_interface.draw_cached_layer = draw_cached_layer;
     data.renderer_interface.get_max_image_size = get_max_image_size;
     data.renderer_interface.prepare_image_atlas = prepare_texture_atlas;
     data.renderer_interface.create_image_atlas = create_texture_atlas;
+#ifndef __VITA__
+    data.renderer_interface.create_empty_image_atlas = create_empty_texture_atlas;
+    data.renderer_interface.update_image_atlas = update_texture_atlas;
+    data.renderer_interface.update_image_atlas_region = update_texture_atlas_region;
+#endif
     data.renderer_interface.get_image_atlas = get_texture_atlas;
     data.renderer_interface.has_image_atlas = has_texture_atlas;
     data.renderer_interface.free_image_atlas = free_texture_atlas_and_data;
@@ -1176,6 +1497,7 @@ int platform_renderer_init(void *window)
         }
         SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Unable to create hardware-accelerated renderer, created software renderer instead");
     }
+    data.is_software_renderer = strcmp(SDL_GetRendererName(data.renderer), SDL_SOFTWARE_RENDERER) == 0;
 
     SDL_PropertiesID renderer_properties = SDL_GetRendererProperties(data.renderer);
     if (!renderer_properties) {
@@ -1225,6 +1547,7 @@ int platform_renderer_init(void *window)
 
 static void destroy_render_texture(void)
 {
+    flush_sprite_batch();
     if (data.render_texture) {
         SDL_DestroyTexture(data.render_texture);
         data.render_texture = 0;
@@ -1271,6 +1594,7 @@ int platform_renderer_lost_render_texture(void)
 
 void platform_renderer_invalidate_target_textures(void)
 {
+    flush_sprite_batch();
     if (data.custom_textures[CUSTOM_IMAGE_RED_FOOTPRINT].texture) {
         SDL_DestroyTexture(data.custom_textures[CUSTOM_IMAGE_RED_FOOTPRINT].texture);
         data.custom_textures[CUSTOM_IMAGE_RED_FOOTPRINT].texture = 0;
@@ -1285,6 +1609,7 @@ void platform_renderer_invalidate_target_textures(void)
         SDL_DestroyTexture(data.tooltip.texture);
         data.tooltip.texture = 0;
     }
+    free_cached_layers();
 }
 
 void platform_renderer_clear(void)
@@ -1337,6 +1662,7 @@ static void draw_software_mouse_cursor(void)
 
 void platform_renderer_render(void)
 {
+    flush_sprite_batch();
     if (data.paused) {
         return;
     }
@@ -1375,6 +1701,7 @@ void platform_renderer_generate_mouse_cursor_texture(int cursor_id, int size, co
 
 void platform_renderer_pause(void)
 {
+    flush_sprite_batch();
     SDL_SetRenderTarget(data.renderer, NULL);
     data.paused = 1;
 }
@@ -0,0 +1,71 @@
+#include "core/thread.h"
+
+#include <SDL3/SDL.h>
+
+thread_handle *thread_create(int (*function)(void *), const char *name, void *data)
+{
+    return (thread_handle *) SDL_CreateThread(function, name, data);
+}
+
+int thread_wait(thread_handle *thread)
+{
+    int status = 0;
+    SDL_WaitThread((SDL_Thread *) thread, &status);
+    return status;
+}
+
+int thread_cpu_count(void)
+{
+    int count = SDL_GetNumLogicalCPUCores();
+    return count > 0 ? count : 1;
+}
+
+uint64_t thread_current_id(void)
+{
+    return SDL_GetCurrentThreadID();
+}
+
+thread_mutex *thread_mutex_create(void)
+{
+    return (thread_mutex *) SDL_CreateMutex();
+}
+
+void thread_mutex_lock(thread_mutex *mutex)
+{
+    SDL_LockMutex((SDL_Mutex *) mutex);
+}
+
+void thread_mutex_unlock(thread_mutex *mutex)
+{
+    SDL_UnlockMutex((SDL_Mutex *) mutex);
+}
+
+void thread_mutex_destroy(thread_mutex *mutex)
+{
+    SDL_DestroyMutex((SDL_Mutex *) mutex);
+}
+
+thread_condition *thread_condition_create(void)
+{
+    return (thread_condition *) SDL_CreateCondition();
+}
+
+void thread_condition_wait(thread_condition *condition, thread_mutex *mutex)
+{
+    SDL_WaitCondition((SDL_Condition *) condition, (SDL_Mutex *) mutex);
+}
+
+void thread_condition_signal(thread_condition *condition)
+{
+    SDL_SignalCondition((SDL_Condition *) condition);
+}
+
+void thread_condition_broadcast(thread_condition *condition)
+{
+    SDL_BroadcastCondition((SDL_Condition *) condition);
+}
+
+void thread_condition_destroy(thread_condition *condition)
+{
+    SDL_DestroyCondition((SDL_Condition *) condition);
+}
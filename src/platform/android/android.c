@@ -101,7 +101,7 @@ int android_set_base_path(const char *path)
     return result;
 }
 
-int android_get_directory_contents(const char *dir, int type, const char *extension, int (*callback)(const char *, long))
+int android_get_directory_contents(const char *dir, int type, const char *extension, int (*callback)(const char *, long, long))
 {
     if (strncmp(dir, ASSETS_DIRECTORY, strlen(ASSETS_DIRECTORY)) == 0) {
         return asset_handler_get_directory_contents(dir + strlen(ASSETS_DIRECTORY), type, extension, callback);
@@ -109,6 +109,7 @@ int android_get_directory_contents(const char *dir, int type, const char *extens
     jni_function_handler handler;
     jni_function_handler get_name;
     jni_function_handler get_last_modified_time;
+    jni_function_handler get_size;
 
     if (!jni_get_static_method_handler(CLASS_FILE_MANAGER, "getDirectoryFileList",
         "(L" CLASS_AUGUSTUS_ACTIVITY ";Ljava/lang/String;ILjava/lang/String;)[L" CLASS_FILE_MANAGER "$FileInfo;",
@@ -127,6 +128,13 @@ int android_get_directory_contents(const char *dir, int type, const char *extens
         jni_destroy_function_handler(&handler);
         return LIST_ERROR;
     }
+    if (!jni_get_method_handler(CLASS_FILE_MANAGER "$FileInfo", "getSize", "()J", &get_size)) {
+        jni_destroy_function_handler(&get_size);
+        jni_destroy_function_handler(&get_last_modified_time);
+        jni_destroy_function_handler(&get_name);
+        jni_destroy_function_handler(&handler);
+        return LIST_ERROR;
+    }
 
     jstring jdir = (*handler.env)->NewStringUTF(handler.env, dir);
     jstring jextension = (*handler.env)->NewStringUTF(handler.env, extension);
@@ -142,7 +150,8 @@ int android_get_directory_contents(const char *dir, int type, const char *extens
         const char *filename = (*handler.env)->GetStringUTFChars(handler.env, jfilename, NULL);
         long last_modified = (long) (*handler.env)->CallLongMethod(handler.env, jfile_info,
             get_last_modified_time.method);
-        match = callback(filename, last_modified);
+        long size = (long) (*handler.env)->CallLongMethod(handler.env, jfile_info, get_size.method);
+        match = callback(filename, last_modified, size);
         (*handler.env)->ReleaseStringUTFChars(handler.env, (jstring) jfilename, filename);
         (*handler.env)->DeleteLocalRef(handler.env, jfilename);
         (*handler.env)->DeleteLocalRef(handler.env, jfile_info);
@@ -151,6 +160,7 @@ int android_get_directory_contents(const char *dir, int type, const char *extens
         }
     }
     (*handler.env)->DeleteLocalRef(handler.env, result);
+    jni_destroy_function_handler(&get_size);
     jni_destroy_function_handler(&get_last_modified_time);
     jni_destroy_function_handler(&get_name);
     jni_destroy_function_handler(&handler);
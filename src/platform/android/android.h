@@ -12,7 +12,7 @@ const char *android_get_c3_path(void);
 float android_get_screen_density(void);
 int android_get_file_descriptor(const char *filename, const char *mode);
 int android_set_base_path(const char *path);
-int android_get_directory_contents(const char *dir, int type, const char *extension, int (*callback)(const char *, long));
+int android_get_directory_contents(const char *dir, int type, const char *extension, int (*callback)(const char *, long, long));
 int android_create_directory(const char *name);
 int android_remove_file(const char *filename);
 
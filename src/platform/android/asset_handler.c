@@ -21,7 +21,7 @@ static enum {
 static jobject java_asset_manager;
 static AAssetManager *asset_manager;
 
-static int assets_directory_found(const char *dummy, long unused)
+static int assets_directory_found(const char *dummy, long unused, long unused_size)
 {
     return LIST_MATCH;
 }
@@ -99,7 +99,7 @@ void *asset_handler_open_asset(const char *asset_name, const char *mode)
 }
 
 int asset_handler_get_directory_contents(const char *dir_name, int type,
-    const char *extension, int (*callback)(const char *, long))
+    const char *extension, int (*callback)(const char *, long, long))
 {
     if (*dir_name == '\\' || *dir_name == '/') {
         dir_name++;
@@ -122,7 +122,7 @@ int asset_handler_get_directory_contents(const char *dir_name, int type,
     while ((asset_name = AAssetDir_getNextFileName(dir))) {
         char *asset_extension = strrchr(asset_name, '.');
         if (asset_extension && strcmp(asset_extension + 1, extension) == 0) {
-            match = callback(asset_name, 0);
+            match = callback(asset_name, 0, 0);
         }
         if (match == LIST_MATCH) {
             break;
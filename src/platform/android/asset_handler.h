@@ -5,7 +5,7 @@
 
 void *asset_handler_open_asset(const char *asset, const char *mode);
 int asset_handler_get_directory_contents(const char *dir_name, int type, const char *extension,
-    int (*callback)(const char *, long));
+    int (*callback)(const char *, long, long));
 
 #endif // __ANDROID__
 #endif // PLATFORM_ANDROID_ASSET_HANDLER_H
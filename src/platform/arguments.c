@@ -8,6 +8,9 @@
 #define DISPLAY_SCALE_ERROR_MESSAGE "Option --display-scale must be followed by a scale value between 0.5 and 5"
 #define WINDOWED_AND_FULLSCREEN_ERROR_MESSAGE "Option --windowed and --fullscreen cannot both be specified"
 #define DISPLAY_ID_ERROR_MESSAGE "Option --display must be followed by a number indicating the display, starting from 0"
+#define BENCHMARK_SAVES_ERROR_MESSAGE "Option --benchmark-saves must be followed by a directory with saved games"
+#define BENCHMARK_OUTPUT_ERROR_MESSAGE "Option --benchmark-output must be followed by a directory for the results"
+#define TRACE_STARTUP_ERROR_MESSAGE "Option --trace-startup must be followed by the name of the trace file"
 #define UNKNOWN_OPTION_ERROR_MESSAGE "Option %s not recognized"
 
 static void print_log(const char *message)
@@ -74,6 +77,9 @@ int platform_parse_arguments(int argc, char **argv, augustus_args *output_args)
     output_args->use_software_cursor = 0;
     output_args->force_fullscreen = 0;
     output_args->display_id = 0;
+    output_args->benchmark_saves_directory = 0;
+    output_args->benchmark_output_directory = 0;
+    output_args->trace_startup_file = 0;
 
     for (int i = 1; i < argc; i++) {
         // we ignore "-psn" arguments, this is needed to launch the app
@@ -118,6 +124,30 @@ int platform_parse_arguments(int argc, char **argv, augustus_args *output_args)
                 print_log(DISPLAY_ID_ERROR_MESSAGE);
                 ok = 0;
             }
+        } else if (strcmp(argv[i], "--benchmark-saves") == 0) {
+            if (i + 1 < argc) {
+                output_args->benchmark_saves_directory = argv[i + 1];
+                i++;
+            } else {
+                print_log(BENCHMARK_SAVES_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (strcmp(argv[i], "--benchmark-output") == 0) {
+            if (i + 1 < argc) {
+                output_args->benchmark_output_directory = argv[i + 1];
+                i++;
+            } else {
+                print_log(BENCHMARK_OUTPUT_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (strcmp(argv[i], "--trace-startup") == 0) {
+            if (i + 1 < argc) {
+                output_args->trace_startup_file = argv[i + 1];
+                i++;
+            } else {
+                print_log(TRACE_STARTUP_ERROR_MESSAGE);
+                ok = 0;
+            }
         } else if (strcmp(argv[i], "--windowed") == 0) {
             output_args->force_windowed = 1;
         } else if (strcmp(argv[i], "--asset-previewer") == 0) {
@@ -165,6 +195,12 @@ int platform_parse_arguments(int argc, char **argv, augustus_args *output_args)
         print_log("          Enables joystick support");
         print_log("--software-cursor");
         print_log("          Uses a software cursor instead of the default hardware cursor");
+        print_log("--benchmark-saves DIR");
+        print_log("          Benchmarks loading and saving all saved games and scenarios in DIR and exits");
+        print_log("--benchmark-output DIR");
+        print_log("          Writes the results of --benchmark-saves to DIR instead of the current directory");
+        print_log("--trace-startup FILE");
+        print_log("          Writes how long each phase of the startup takes to FILE, in Chrome trace format");
         print_log("The last argument, if present, is interpreted as data directory for the Caesar 3 installation");
     }
     return ok;
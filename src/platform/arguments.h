@@ -11,6 +11,9 @@ typedef struct {
     int use_software_cursor;
     int force_fullscreen;
     int display_id;
+    const char *benchmark_saves_directory;
+    const char *benchmark_output_directory;
+    const char *trace_startup_file;
 } augustus_args;
 
 int platform_parse_arguments(int argc, char **argv, augustus_args *output_args);
@@ -26,6 +26,7 @@
 #endif
 
 #ifdef _WIN32
+#include <io.h>
 #include <windows.h>
 #include <sys/utime.h>
 
@@ -339,7 +340,7 @@ static void set_assets_directory(void)
 }
 
 int platform_file_manager_list_directory_contents(
-    const char *dir, int type, const char *extension, int (*callback)(const char *, long))
+    const char *dir, int type, const char *extension, int (*callback)(const char *, long, long))
 {
     if (type == TYPE_NONE) {
         return LIST_ERROR;
@@ -347,23 +348,26 @@ int platform_file_manager_list_directory_contents(
 
     const file_name *current_dir;
     size_t assets_directory_length = strlen(ASSETS_DIRECTORY);
+    char full_asset_path[FILE_NAME_MAX];
+    const char *entries_dir = dir;
 
     if (!dir || !*dir || strcmp(dir, ".") == 0) {
         current_dir = CURRENT_DIR;
     } else if (strncmp(dir, ASSETS_DIRECTORY, assets_directory_length) == 0) {
         set_assets_directory();
         if (strlen(dir) == assets_directory_length) {
-            current_dir = set_file_name(assets_directory);
+            snprintf(full_asset_path, FILE_NAME_MAX, "%s", assets_directory);
         } else {
-            char full_asset_path[FILE_NAME_MAX];
             // Prevent double slashes as they may not work
             if (*assets_directory && assets_directory[strlen(assets_directory) - 1] == '/' &&
                 dir[assets_directory_length] == '/') {
                 assets_directory_length++;
             }
             snprintf(full_asset_path, FILE_NAME_MAX, "%s%s", assets_directory, dir + assets_directory_length);
-            current_dir = set_file_name(full_asset_path);
         }
+        // The entries are checked with the real path, as the asset directory placeholder is not a valid path
+        entries_dir = full_asset_path;
+        current_dir = set_file_name(full_asset_path);
     } else {
         current_dir = set_file_name(dir);
     }
@@ -382,7 +386,7 @@ int platform_file_manager_list_directory_contents(
         if (!platform_file_manager_cache_file_has_extension(f, extension)) {
             continue;
         }
-        match = callback(f->name, f->modified_time);
+        match = callback(f->name, f->modified_time, f->size);
         if (match == LIST_MATCH) {
             break;
         }
@@ -401,9 +405,12 @@ int platform_file_manager_list_directory_contents(
     while ((entry = fs_dir_read(d)) != 0) {
         const char *name = dir_entry_name(entry->d_name);
         const file_name *full_path = 0;
-        if (dir && *dir && strcmp(dir, ".") != 0) {
+        if (entries_dir && *entries_dir && strcmp(entries_dir, ".") != 0) {
             char full_name[FILE_NAME_MAX];
-            snprintf(full_name, FILE_NAME_MAX, "%s/%s", dir, name);
+            if (snprintf(full_name, FILE_NAME_MAX, "%s/%s", entries_dir, name) >= FILE_NAME_MAX) {
+                // The entry can't be opened with a truncated path, so it is left out
+                continue;
+            }
             full_path = set_file_name(full_name);
         }
         if (fs_stat(full_path ? full_path : entry->d_name, &file_info) != -1) {
@@ -420,9 +427,9 @@ int platform_file_manager_list_directory_contents(
                 // Skip current (.), parent (..) and hidden directories (.*)
                 continue;
             }
-            match = callback(name, (long) file_info.st_mtime);
+            match = callback(name, (long) file_info.st_mtime, (long) file_info.st_size);
         } else if (file_has_extension(name, extension)) {
-            match = callback(name, (long) file_info.st_mtime);
+            match = callback(name, 0, 0);
         }
         free_file_name(full_path);
         if (match == LIST_MATCH) {
@@ -632,6 +639,16 @@ int platform_file_manager_remove_file(const char *filename)
     return android_remove_file(filename);
 }
 
+int platform_file_manager_rename_file(const char *old_filename, const char *new_filename)
+{
+    // Files are only reachable through their descriptors, so the contents are copied instead
+    if (!platform_file_manager_copy_file(old_filename, new_filename)) {
+        return 0;
+    }
+    android_remove_file(old_filename);
+    return 1;
+}
+
 #else
 
 FILE *platform_file_manager_open_file(const char *filename, const char *mode)
@@ -675,6 +692,32 @@ int platform_file_manager_remove_file(const char *filename)
     return result == 0;
 }
 
+int platform_file_manager_rename_file(const char *old_filename, const char *new_filename)
+{
+#ifdef USE_FILE_CACHE
+    platform_file_manager_cache_delete_file_info(old_filename);
+    platform_file_manager_cache_update_file_info(new_filename);
+#endif
+    const file_name *wold = set_file_name(old_filename);
+    const file_name *wnew = set_file_name(new_filename);
+#ifdef _WIN32
+    // Unlike rename, this replaces a file that already exists
+    int result = MoveFileExW(wold, wnew, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    int result = rename(wold, wnew) == 0;
+#endif
+    free_file_name(wold);
+    free_file_name(wnew);
+#if defined(__EMSCRIPTEN__)
+    if (result) {
+        EM_ASM(
+            Module.syncFS();
+        );
+    }
+#endif
+    return result;
+}
+
 FILE *platform_file_manager_open_asset(const char *asset, const char *mode)
 {
     const char *cased_asset_path = dir_get_file_at_location(asset, PATH_LOCATION_ASSET);
@@ -696,6 +739,91 @@ int platform_file_manager_close_file(FILE *stream)
     return result == 0;
 }
 
+#if defined(_WIN32)
+#define HAS_FILE_MAPPING
+#elif !defined(__vita__) && !defined(__SWITCH__) && !defined(__EMSCRIPTEN__)
+#include <sys/mman.h>
+#define HAS_FILE_MAPPING
+#endif
+
+#ifdef HAS_FILE_MAPPING
+typedef struct {
+    void *base;
+    size_t length;
+#ifdef _WIN32
+    HANDLE mapping;
+#endif
+} file_mapping_handle;
+#endif
+
+void *platform_file_manager_map_file(FILE *stream, size_t *size, void **handle)
+{
+#ifdef HAS_FILE_MAPPING
+    long position = ftell(stream);
+    if (position < 0) {
+        return 0;
+    }
+    file_mapping_handle *mapped = malloc(sizeof(file_mapping_handle));
+    if (!mapped) {
+        return 0;
+    }
+#ifdef _WIN32
+    HANDLE file = (HANDLE) _get_osfhandle(_fileno(stream));
+    LARGE_INTEGER file_size;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &file_size) || file_size.QuadPart <= position) {
+        free(mapped);
+        return 0;
+    }
+    mapped->length = (size_t) file_size.QuadPart;
+    mapped->mapping = CreateFileMapping(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (!mapped->mapping) {
+        free(mapped);
+        return 0;
+    }
+    mapped->base = MapViewOfFile(mapped->mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (!mapped->base) {
+        CloseHandle(mapped->mapping);
+        free(mapped);
+        return 0;
+    }
+#else
+    stat_info file_info;
+    if (fstat(fileno(stream), &file_info) == -1 || !S_ISREG(file_info.st_mode) || file_info.st_size <= position) {
+        free(mapped);
+        return 0;
+    }
+    mapped->length = (size_t) file_info.st_size;
+    mapped->base = mmap(0, mapped->length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(stream), 0);
+    if (mapped->base == MAP_FAILED) {
+        free(mapped);
+        return 0;
+    }
+#endif
+    *size = mapped->length - position;
+    *handle = mapped;
+    return (char *) mapped->base + position;
+#else
+    return 0;
+#endif
+}
+
+void platform_file_manager_unmap_file(void *handle)
+{
+#ifdef HAS_FILE_MAPPING
+    file_mapping_handle *mapped = handle;
+    if (!mapped) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(mapped->base);
+    CloseHandle(mapped->mapping);
+#else
+    munmap(mapped->base, mapped->length);
+#endif
+    free(mapped);
+#endif
+}
+
 int platform_file_manager_create_directory(const char *name, const char *location, int overwrite)
 {
     char tokenized_name[FILE_NAME_MAX];
@@ -828,7 +956,7 @@ static void move_up_path(void)
 }
 
 
-static int copy_file(const char *name, long unused)
+static int copy_file(const char *name, long unused, long unused_size)
 {
     append_name_to_path(name);
     if (!directory_copy_data.overwrite_files) {
@@ -846,7 +974,7 @@ static int copy_file(const char *name, long unused)
     return result;
 }
 
-static int copy_directory(const char *name, long unused)
+static int copy_directory(const char *name, long unused, long unused_size)
 {
     if (name) {
         append_name_to_path(name);
@@ -894,7 +1022,7 @@ static void copy_directory_name(const char *name, char *dst)
     }
 }
 
-static int do_nothing(const char *name, long unused)
+static int do_nothing(const char *name, long unused, long unused_size)
 {
     return LIST_MATCH;
 }
@@ -907,10 +1035,10 @@ int platform_file_manager_copy_directory(const char *src, const char *dst, int o
     copy_directory_name(src, directory_copy_data.current_src_path);
     copy_directory_name(dst, directory_copy_data.current_dst_path);
     directory_copy_data.overwrite_files = overwrite_files;
-    return copy_directory(0, 0);
+    return copy_directory(0, 0, 0);
 }
 
-static int remove_file(const char *name, long unused)
+static int remove_file(const char *name, long unused, long unused_size)
 {
     append_name_to_path(name);
     int result = platform_file_manager_remove_file(directory_copy_data.current_src_path);
@@ -918,7 +1046,7 @@ static int remove_file(const char *name, long unused)
     return result;
 }
 
-static int remove_directory(const char *name, long unused)
+static int remove_directory(const char *name, long unused, long unused_size)
 {
     if (name) {
         append_name_to_path(name);
@@ -950,5 +1078,5 @@ static int remove_directory(const char *name, long unused)
 int platform_file_manager_remove_directory(const char *path)
 {
     copy_directory_name(path, directory_copy_data.current_src_path);
-    return remove_directory(0, 0);
+    return remove_directory(0, 0, 0);
 }
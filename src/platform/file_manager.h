@@ -45,12 +45,12 @@ int platform_file_manager_is_directory_writeable(const char *directory);
  * Gets the contents of a directory by the specified extension
  * @param dir The directory to search on, or null if base directory
  * @param type The file type to filter (dir, file or both)
- * @param extension The extension to filter
+ * @param callback The function to call when a matched file is found, with its name, modified time and size
  * @param callback The function to call when a matched file is found
  * @return LIST_ERROR if error, LIST_MATCH if there was a match in the callback, LIST_NO_MATCH if no match was set
  */
 int platform_file_manager_list_directory_contents(
-    const char *dir, int type, const char *extension, int (*callback)(const char *, long));
+    const char *dir, int type, const char *extension, int (*callback)(const char *, long, long));
 
 /**
  * Indicates whether the file name casing should be checked
@@ -99,6 +99,23 @@ FILE *platform_file_manager_open_file(const char *filename, const char *mode);
  */
 FILE *platform_file_manager_open_asset(const char *asset, const char *mode);
 
+/**
+ * Maps the contents of an open file into memory, from the current position of the stream until the end of the file.
+ * The mapped memory can be changed, but the changes are never written back to the file.
+ * @param stream The file to map. It can be closed while the mapping is in use
+ * @param size Set to the number of mapped bytes from the current position of the stream
+ * @param handle Set to the handle that must be passed to platform_file_manager_unmap_file
+ * @return A pointer to the contents at the current position of the stream,
+ *         or NULL if the file can't be mapped on this platform
+ */
+void *platform_file_manager_map_file(FILE *stream, size_t *size, void **handle);
+
+/**
+ * Releases a file mapping
+ * @param handle The handle set by platform_file_manager_map_file
+ */
+void platform_file_manager_unmap_file(void *handle);
+
 
 /**
  * Closes a file
@@ -115,6 +132,14 @@ int platform_file_manager_close_file(FILE *stream);
  */
 int platform_file_manager_remove_file(const char *filename);
 
+/**
+ * Renames a file, replacing the file that has the new name if there is one
+ * @param old_filename The file to rename
+ * @param new_filename The new name of the file
+ * @return 1 if renaming was successful, 0 otherwise
+ */
+int platform_file_manager_rename_file(const char *old_filename, const char *new_filename);
+
 /**
  * Creates a directory
  * @param name The full path to the new directory
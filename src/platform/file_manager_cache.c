@@ -100,6 +100,7 @@ const dir_info *platform_file_manager_cache_get_dir_info(const char *dir)
                 type = TYPE_DIR;
             }
             file_item->modified_time = current_file_info.st_mtime;
+            file_item->size = (long) current_file_info.st_size;
         } else {
             // When stat does not work, we check if a file is a directory by trying to open it as a dir
             // For performance reasons, we only check for a directory if the name has no extension
@@ -112,6 +113,7 @@ const dir_info *platform_file_manager_cache_get_dir_info(const char *dir)
                 }
             }
             file_item->modified_time = 0;
+            file_item->size = 0;
         }
         file_item->type = type;
     }
@@ -135,6 +137,7 @@ void platform_file_manager_cache_update_file_info(const char *filename)
         current_file = malloc(sizeof(file_info));
         snprintf(current_file->name, FILE_NAME_MAX, "%s", filename);
         current_file->type = TYPE_FILE;
+        current_file->size = 0;
         char c;
         const char *name = current_file->name;
         do {
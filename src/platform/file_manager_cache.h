@@ -11,6 +11,7 @@ typedef struct file_info {
     const char *extension;
     int type;
     unsigned int modified_time;
+    long size;
     struct file_info *next;
 } file_info;
 
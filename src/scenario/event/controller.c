@@ -418,7 +418,8 @@ static void formulas_save_state(buffer *buf)
         + sizeof(int32_t)             // evaluation
         + sizeof(uint8_t) * 2         // is_static + is_error
         + sizeof(int32_t) * 2;        // min_evaluation + max_evaluation
-    buffer_init_dynamic_array(buf, scenario_formulas.size, struct_size);
+    // Index 0 is not saved
+    buffer_init_dynamic_array(buf, scenario_formulas.size ? scenario_formulas.size - 1 : 0, struct_size);
 
     scenario_formula_t *formula;
 
@@ -449,13 +450,15 @@ static void formulas_load_state(buffer *buf)
 
     for (size_t i = 0; i < array_size; ++i) {
 
-        scenario_formula_t *formula = array_advance(scenario_formulas);
-
         unsigned int id = buffer_read_u32(buf);
-        if (id != formula->id) {
+        if (!id && i == array_size - 1) {
+            break; // Older saves count the unused index 0 and store an empty entry for it at the end
+        }
+        if (id != scenario_formulas.size) {
             log_error("Formula ID mismatch during loading. Something has gone wrong.", 0, 0);
             return;
         }
+        scenario_formula_t *formula = array_advance(scenario_formulas);
 
         buffer_read_raw(buf, formula->formatted_calculation, MAX_FORMULA_LENGTH);
         formula->formatted_calculation[MAX_FORMULA_LENGTH - 1] = '\0'; // ensure safety
@@ -472,7 +475,8 @@ static void texts_save_state(buffer *buf)
     int struct_size =
         sizeof(uint32_t)                              // id
         + sizeof(uint8_t) * MAX_SCENARIO_TEXT_LENGTH; // text
-    buffer_init_dynamic_array(buf, scenario_texts.size, struct_size);
+    // Index 0 is not saved
+    buffer_init_dynamic_array(buf, scenario_texts.size ? scenario_texts.size - 1 : 0, struct_size);
 
     scenario_text_t *text;
 
@@ -498,13 +502,15 @@ static void texts_load_state(buffer *buf)
 
     for (size_t i = 0; i < array_size; ++i) {
 
-        scenario_text_t *text = array_advance(scenario_texts);
-
         unsigned int id = buffer_read_u32(buf);
-        if (id != text->id) {
+        if (!id && i == array_size - 1) {
+            break; // Older saves count the unused index 0 and store an empty entry for it at the end
+        }
+        if (id != scenario_texts.size) {
             log_error("Text ID mismatch during loading. Something has gone wrong.", 0, 0);
             return;
         }
+        scenario_text_t *text = array_advance(scenario_texts);
 
         buffer_read_raw(buf, text->text, MAX_SCENARIO_TEXT_LENGTH);
         text->text[MAX_SCENARIO_TEXT_LENGTH - 1] = '\0'; // ensure safety
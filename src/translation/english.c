@@ -2333,6 +2333,7 @@ static translation_string all_strings[] = {
     {TR_PARAMETER_PLAY_FANFARE, "Play fanfare"},
     {TR_CONFIG_UI_SCROLL_LEGACY_SCROLLBAR, "Enable classic scrollbars"},
     {TR_BUILDING_WILLOW_TREE, "Willow tree"},
+    {TR_HOTKEY_REWIND_TO_SNAPSHOT, "Rewind to last snapshot"},
 };
 
 void translation_english(const translation_string **strings, int *num_strings)
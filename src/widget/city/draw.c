@@ -48,6 +48,7 @@
 #include "widget/city/bridge.h"
 #include "widget/city/building_ghost.h"
 #include "widget/city/figure.h"
+#include "widget/city/footprint_cache.h"
 #include "widget/city/highway.h"
 #include "widget/city/overlay/overlay.h"
 
@@ -87,6 +88,7 @@ static struct {
     const city_overlay *overlay;
 
     float scale;
+    int has_cached_footprints;
 } draw_context;
 
 static void init_draw_context(int selected_figure_id, pixel_coordinate *figure_coord, int highlighted_formation)
@@ -339,6 +341,42 @@ static color_t full_grid_color(void)
     }
 }
 
+static int is_animated_water(int image_id)
+{
+    return image_id >= draw_context.image_id_water_first && image_id <= draw_context.image_id_water_last;
+}
+
+// Animated water is left out. All water tiles move to their next frame every 60 ms, so every block with water
+// would be drawn again that often, which takes longer than drawing the water tiles one by one
+static int has_cached_footprint(int grid_offset)
+{
+    return map_property_is_draw_tile(grid_offset) && !map_building_at(grid_offset) &&
+        !map_terrain_is(grid_offset, TERRAIN_HIGHWAY) && !is_animated_water(map_image_at(grid_offset));
+}
+
+static unsigned int get_cached_footprint_style(void)
+{
+    if (!config_get(CONFIG_UI_SHOW_GRID)) {
+        return 0;
+    }
+    // The renderer draws the grid itself by shrinking the footprints
+    if (draw_context.scale > 2.0f) {
+        return 1;
+    }
+    return full_grid_color();
+}
+
+static void draw_cached_footprint(int x, int y, int grid_offset)
+{
+    if (!has_cached_footprint(grid_offset)) {
+        return;
+    }
+    image_draw_isometric_footprint_from_draw_tile(map_image_at(grid_offset), x, y, COLOR_MASK_NONE, 1.0f);
+    if (config_get(CONFIG_UI_SHOW_GRID) && draw_context.scale <= 2.0f) {
+        image_draw(assets_lookup_image_id(ASSET_UI_GRID), x, y, full_grid_color(), 1.0f);
+    }
+}
+
 static void draw_footprint(int x, int y, int grid_offset)
 {
     sound_city_progress_ambient();
@@ -386,14 +424,19 @@ static void draw_footprint(int x, int y, int grid_offset)
         //  !building_is_connectable(building_construction_type())) {
         image_id = image_group(GROUP_TERRAIN_OVERLAY);
     }
-    if (draw_context.advance_water_animation &&
-        image_id >= draw_context.image_id_water_first &&
-        image_id <= draw_context.image_id_water_last) {
+    if (draw_context.advance_water_animation && is_animated_water(image_id)) {
         image_id++;
         if (image_id > draw_context.image_id_water_last) {
             image_id = draw_context.image_id_water_first;
         }
-        map_image_set(grid_offset, image_id);
+        map_image_set_animation_frame(grid_offset, image_id);
+    }
+
+    // Cached footprints are already drawn, unless the tile is highlighted or under construction
+    if (draw_context.has_cached_footprints && color_mask == COLOR_MASK_NONE &&
+        !map_property_is_constructing(grid_offset) && has_cached_footprint(grid_offset)) {
+        draw_roamer_frequency(x, y, grid_offset);
+        return;
     }
 
     if (map_terrain_is(grid_offset, TERRAIN_HIGHWAY) && !map_terrain_is(grid_offset, TERRAIN_GATEHOUSE)) {
@@ -1317,7 +1360,11 @@ void city_draw(int selected_figure_id, pixel_coordinate *figure_coord, const map
     int x, y, width, height;
     city_view_get_viewport(&x, &y, &width, &height);
     graphics_fill_rect(x, y, width, height, COLOR_BLACK);
+    graphics_start_sprite_batch();
     int should_mark_deleting = city_building_ghost_mark_deleting(tile);
+    // Drawing the cached blocks was measured slower than drawing the tiles one by one, so it is opt-in for now
+    draw_context.has_cached_footprints = config_get(CONFIG_SCREEN_CACHE_TERRAIN) &&
+        city_draw_footprint_cache(draw_context.scale, get_cached_footprint_style(), draw_cached_footprint);
     city_view_foreach_valid_map_tile(draw_footprint);
     if (!should_mark_deleting) {
         city_view_foreach_valid_map_tile_row(
@@ -1347,6 +1394,7 @@ void city_draw(int selected_figure_id, pixel_coordinate *figure_coord, const map
             city_view_foreach_valid_map_tile(draw_overlay);
         }
     }
+    graphics_finish_sprite_batch();
     update_clouds();
     update_weather();
 }
@@ -0,0 +1,181 @@
+#include "footprint_cache.h"
+
+#include "core/calc.h"
+#include "graphics/renderer.h"
+#include "map/image.h"
+
+// Blocks of 16 by 16 tiles
+#define BLOCK_WIDTH 960
+#define BLOCK_HEIGHT 480
+
+// The view rows are 60 pixels wide and 15 pixels apart. The first block starts one block before the view,
+// since the tiles on the edge stick out of it
+#define BLOCKS_X (VIEW_X_MAX * 60 / BLOCK_WIDTH + 2)
+#define BLOCKS_Y (VIEW_Y_MAX * 15 / BLOCK_HEIGHT + 2)
+
+#define MAX_CACHED_BLOCKS 32
+
+// Terrain footprints span up to five tiles, so a changed tile may show in the blocks up to five tiles away
+#define CHANGED_TILE_MARGIN_X 300
+#define CHANGED_TILE_MARGIN_Y 150
+
+#define NO_LAYER -1
+
+typedef struct {
+    int layer_id;
+    int needs_redraw;
+} cached_block;
+
+static struct {
+    int initialized;
+    int orientation;
+    unsigned int style;
+    unsigned int frame;
+    cached_block blocks[BLOCKS_Y][BLOCKS_X];
+    struct {
+        cached_block *block;
+        unsigned int last_used_frame;
+    } layers[MAX_CACHED_BLOCKS];
+} data;
+
+static void init(void)
+{
+    for (int y = 0; y < BLOCKS_Y; y++) {
+        for (int x = 0; x < BLOCKS_X; x++) {
+            data.blocks[y][x].layer_id = NO_LAYER;
+            data.blocks[y][x].needs_redraw = 1;
+        }
+    }
+    data.initialized = 1;
+}
+
+static void invalidate_all_blocks(void)
+{
+    for (int y = 0; y < BLOCKS_Y; y++) {
+        for (int x = 0; x < BLOCKS_X; x++) {
+            data.blocks[y][x].needs_redraw = 1;
+        }
+    }
+}
+
+static int block_index(int pixels, int block_size, int total_blocks)
+{
+    return calc_bound((pixels + block_size) / block_size, 0, total_blocks - 1);
+}
+
+static void mark_tile_changed(int grid_offset)
+{
+    int x, y;
+    if (!city_view_grid_offset_to_pixels(grid_offset, &x, &y)) {
+        return;
+    }
+    int x_first = block_index(x - CHANGED_TILE_MARGIN_X, BLOCK_WIDTH, BLOCKS_X);
+    int x_last = block_index(x + CHANGED_TILE_MARGIN_X, BLOCK_WIDTH, BLOCKS_X);
+    int y_first = block_index(y - CHANGED_TILE_MARGIN_Y, BLOCK_HEIGHT, BLOCKS_Y);
+    int y_last = block_index(y + CHANGED_TILE_MARGIN_Y, BLOCK_HEIGHT, BLOCKS_Y);
+    for (int block_y = y_first; block_y <= y_last; block_y++) {
+        for (int block_x = x_first; block_x <= x_last; block_x++) {
+            data.blocks[block_y][block_x].needs_redraw = 1;
+        }
+    }
+}
+
+static int assign_layer(cached_block *block)
+{
+    // Reuse the layer that was drawn the longest time ago, as long as it is not needed for this frame
+    int layer_id = NO_LAYER;
+    unsigned int oldest_frame = data.frame;
+    for (int i = 0; i < MAX_CACHED_BLOCKS; i++) {
+        if (!data.layers[i].block) {
+            layer_id = i;
+            break;
+        }
+        if (data.layers[i].last_used_frame < oldest_frame) {
+            oldest_frame = data.layers[i].last_used_frame;
+            layer_id = i;
+        }
+    }
+    if (layer_id == NO_LAYER) {
+        return 0;
+    }
+    if (data.layers[layer_id].block) {
+        data.layers[layer_id].block->layer_id = NO_LAYER;
+    }
+    data.layers[layer_id].block = block;
+    block->layer_id = layer_id;
+    block->needs_redraw = 1;
+    return 1;
+}
+
+static int prepare_block(int block_x, int block_y, map_callback *draw_footprint)
+{
+    cached_block *block = &data.blocks[block_y][block_x];
+    if (block->layer_id == NO_LAYER && !assign_layer(block)) {
+        return 0;
+    }
+    data.layers[block->layer_id].last_used_frame = data.frame;
+    if (!block->needs_redraw) {
+        return 1;
+    }
+    const graphics_renderer_interface *renderer = graphics_renderer();
+    if (!renderer->start_cached_layer(block->layer_id, BLOCK_WIDTH, BLOCK_HEIGHT)) {
+        return 0;
+    }
+    city_view_foreach_map_tile_in_area((block_x - 1) * BLOCK_WIDTH, (block_y - 1) * BLOCK_HEIGHT,
+        BLOCK_WIDTH, BLOCK_HEIGHT, draw_footprint);
+    renderer->finish_cached_layer();
+    block->needs_redraw = 0;
+    return 1;
+}
+
+int city_draw_footprint_cache(float scale, unsigned int style, map_callback *draw_footprint)
+{
+    const graphics_renderer_interface *renderer = graphics_renderer();
+    if (!renderer->start_cached_layer || !renderer->finish_cached_layer || !renderer->can_draw_cached_layer ||
+        !renderer->draw_cached_layer || !renderer->can_draw_cached_layer(scale)) {
+        return 0;
+    }
+    if (!data.initialized) {
+        init();
+    }
+    int orientation = city_view_orientation();
+    if (!map_image_take_changed_tiles(mark_tile_changed) || orientation != data.orientation || style != data.style) {
+        invalidate_all_blocks();
+        data.orientation = orientation;
+        data.style = style;
+    }
+
+    int x, y, width, height;
+    city_view_get_viewport(&x, &y, &width, &height);
+    int camera_x, camera_y;
+    city_view_get_camera_in_pixels(&camera_x, &camera_y);
+
+    // The tiles are drawn at their position divided by the scale, so this is the part of the city that shows
+    int x_first = block_index((int) (x * scale) - x + camera_x, BLOCK_WIDTH, BLOCKS_X);
+    int x_last = block_index((int) ((x + width) * scale) - x + camera_x, BLOCK_WIDTH, BLOCKS_X);
+    int y_first = block_index((int) (y * scale) - y + camera_y, BLOCK_HEIGHT, BLOCKS_Y);
+    int y_last = block_index((int) ((y + height) * scale) - y + camera_y, BLOCK_HEIGHT, BLOCKS_Y);
+    if ((x_last - x_first + 1) * (y_last - y_first + 1) > MAX_CACHED_BLOCKS) {
+        return 0;
+    }
+
+    data.frame++;
+    for (int block_y = y_first; block_y <= y_last; block_y++) {
+        for (int block_x = x_first; block_x <= x_last; block_x++) {
+            if (!prepare_block(block_x, block_y, draw_footprint)) {
+                return 0;
+            }
+        }
+    }
+    for (int block_y = y_first; block_y <= y_last; block_y++) {
+        for (int block_x = x_first; block_x <= x_last; block_x++) {
+            int layer_id = data.blocks[block_y][block_x].layer_id;
+            if (!renderer->draw_cached_layer(layer_id, x + (block_x - 1) * BLOCK_WIDTH - camera_x,
+                    y + (block_y - 1) * BLOCK_HEIGHT - camera_y, scale)) {
+                invalidate_all_blocks();
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
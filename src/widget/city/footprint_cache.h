@@ -0,0 +1,16 @@
+#ifndef CITY_DRAW_FOOTPRINT_CACHE_H
+#define CITY_DRAW_FOOTPRINT_CACHE_H
+
+#include "city/view.h"
+
+/**
+ * Draws the footprints that only change along with their tile image from cached blocks of the city,
+ * drawing again the blocks whose tiles changed since the last time.
+ * @param scale The city scale
+ * @param style Anything else the cached footprints depend on, all blocks are drawn again when it changes
+ * @param draw_footprint Draws the cached footprint of a tile, if it has one, at scale 1
+ * @return Boolean true if the cached footprints were drawn, false if they have to be drawn tile by tile
+ */
+int city_draw_footprint_cache(float scale, unsigned int style, map_callback *draw_footprint);
+
+#endif // CITY_DRAW_FOOTPRINT_CACHE_H
@@ -18,6 +18,7 @@
 #include "figure/formation.h"
 #include "figure/formation_legion.h"
 #include "figure/roamer_preview.h"
+#include "game/file.h"
 #include "game/orientation.h"
 #include "game/settings.h"
 #include "game/state.h"
@@ -805,6 +806,11 @@ static void handle_hotkeys(const hotkeys *h)
         game_undo_perform();
         window_invalidate();
     }
+    if (h->rewind_to_snapshot) {
+        if (game_file_rewind_to_snapshot()) {
+            window_invalidate();
+        }
+    }
     if (h->mothball_toggle) {
         int building_id = map_building_at(widget_city_current_grid_offset());
         building *b = building_main(building_get(building_id));
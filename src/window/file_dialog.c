@@ -10,6 +10,7 @@
 #include "core/image_group.h"
 #include "core/image_group_editor.h"
 #include "core/lang.h"
+#include "core/locale.h"
 #include "core/log.h"
 #include "core/string.h"
 #include "editor/editor.h"
@@ -22,6 +23,7 @@
 #include "game/file_editor.h"
 #include "game/file_io.h"
 #include "game/save_version.h"
+#include "game/saved_game_index.h"
 #include "graphics/button.h"
 #include "graphics/generic_button.h"
 #include "graphics/graphics.h"
@@ -64,6 +66,7 @@ static void button_toggle_sort_type(const generic_button *button);
 static void button_ok_cancel(int is_ok, int param2);
 static void input_box_changed(int is_addition_at_end);
 static void draw_file(const list_box_item *item);
+static uint8_t *append_saved_game_year(uint8_t *cursor, int year, int length);
 static void select_file(unsigned int index, int is_double_click);
 static void file_tooltip(const list_box_item *item, tooltip_context *c);
 
@@ -279,6 +282,9 @@ static void init(file_type type, file_dialog_type dialog_type)
     }
     init_filtered_file_list();
     list_box_init(&list_box, data.filtered_file_list.num_files);
+    if (type == FILE_TYPE_SAVED_GAME) {
+        saved_game_index_start(data.file_list);
+    }
 
     if (data.dialog_type == FILE_DIALOG_SAVE) {
         main_input.placeholder = 0;
@@ -361,8 +367,22 @@ static void draw_file(const list_box_item *item)
 {
     uint8_t file[FILE_NAME_MAX];
     font_t font = item->is_selected ? FONT_NORMAL_WHITE : FONT_NORMAL_GREEN;
-    encoding_from_utf8(data.filtered_file_list.files[item->index].name, file, FILE_NAME_MAX);
-    text_ellipsize(file, font, item->width);
+    const dir_entry *entry = &data.filtered_file_list.files[item->index];
+    int name_width = item->width;
+    const saved_game_info *info = 0;
+    if (data.type == FILE_TYPE_SAVED_GAME) {
+        info = saved_game_index_get(entry->name, entry->modified_time);
+    }
+    if (info) {
+        // The year of the save comes from the index, so the files aren't read while drawing the list
+        uint8_t year[32];
+        append_saved_game_year(year, info->year, sizeof(year));
+        int year_width = text_get_width(year, font);
+        text_draw(year, item->x + item->width - year_width, item->y + 2, font, 0);
+        name_width -= year_width + 8;
+    }
+    encoding_from_utf8(entry->name, file, FILE_NAME_MAX);
+    text_ellipsize(file, font, name_width);
     text_draw(file, item->x, item->y + 2, font, 0);
     if (item->is_focused) {
         button_border_draw(item->x - 4, item->y - 4, item->width + 6, item->height + 4, 1);
@@ -371,6 +391,9 @@ static void draw_file(const list_box_item *item)
 
 static void draw_foreground(void)
 {
+    if (saved_game_index_update()) {
+        list_box_request_refresh(&list_box);
+    }
     graphics_in_dialog();
 
     if (data.redraw_full_window) {
@@ -517,6 +540,7 @@ static void handle_input(const mouse *m, const hotkeys *h)
         return;
     }
     if (input_go_back_requested(m, h)) {
+        saved_game_index_stop();
         input_box_stop(&main_input);
         window_go_back();
         return;
@@ -659,6 +683,7 @@ static void confirm_small_image(int accepted, int checked)
 
 static void button_ok_cancel(int is_ok, int param2)
 {
+    saved_game_index_stop();
     if (!is_ok) {
         input_box_stop(&main_input);
         window_go_back();
@@ -775,6 +800,7 @@ static void button_ok_cancel(int is_ok, int param2)
 
             init_filtered_file_list();
             list_box_update_total_items(&list_box, data.filtered_file_list.num_files);
+            saved_game_index_start(data.file_list);
             select_correct_index();
             snprintf(data.file_data->last_loaded_file, FILE_NAME_MAX, "%s", data.selected_file);
             window_request_refresh();
@@ -845,15 +871,62 @@ static void select_file(unsigned int index, int is_double_click)
     update_preview_image();
 }
 
+static uint8_t *append_saved_game_year(uint8_t *cursor, int year, int length)
+{
+    const uint8_t *era = lang_get_string(20, year >= 0 ? 1 : 0);
+    uint8_t *end = cursor + length;
+    if (year >= 0 && !locale_year_before_ad()) {
+        cursor = string_copy(era, cursor, end - cursor);
+        cursor = string_copy(string_from_ascii(" "), cursor, end - cursor);
+        era = 0;
+    }
+    cursor += string_from_int(cursor, year >= 0 ? year : -year, 0);
+    if (era) {
+        cursor = string_copy(string_from_ascii(" "), cursor, end - cursor);
+        cursor = string_copy(era, cursor, end - cursor);
+    }
+    return cursor;
+}
+
+static uint8_t *append_saved_game_date(uint8_t *cursor, int month, int year, int length)
+{
+    uint8_t *end = cursor + length;
+    cursor = string_copy(lang_get_string(25, month), cursor, end - cursor);
+    cursor = string_copy(string_from_ascii(" "), cursor, end - cursor);
+    return append_saved_game_year(cursor, year, (int) (end - cursor));
+}
+
 static void file_tooltip(const list_box_item *item, tooltip_context *c)
 {
-    static uint8_t file[FILE_NAME_MAX];
+    // Leave room for the info after the name
+    static uint8_t file[FILE_NAME_MAX * 2];
     font_t font = item->is_selected ? FONT_NORMAL_WHITE : FONT_NORMAL_GREEN;
-    encoding_from_utf8(data.filtered_file_list.files[item->index].name, file, FILE_NAME_MAX);
-    if (text_get_width(file, font) > item->width) {
-        c->precomposed_text = file;
-        c->type = TOOLTIP_BUTTON;
+    const dir_entry *entry = &data.filtered_file_list.files[item->index];
+    encoding_from_utf8(entry->name, file, FILE_NAME_MAX);
+    int name_fits = text_get_width(file, font) <= item->width;
+    const saved_game_info *info = 0;
+    if (data.type == FILE_TYPE_SAVED_GAME) {
+        info = saved_game_index_get(entry->name, entry->modified_time);
+    }
+    if (!info) {
+        if (!name_fits) {
+            c->precomposed_text = file;
+            c->type = TOOLTIP_BUTTON;
+        }
+        return;
     }
+    // Show the date and population of the save, from the index so the file isn't read while hovering
+    uint8_t *cursor = name_fits ? file : file + string_length(file);
+    if (!name_fits) {
+        cursor = string_copy(string_from_ascii(" - "), cursor, sizeof(file) - (cursor - file));
+    }
+    cursor = append_saved_game_date(cursor, info->month, info->year, (int) (sizeof(file) - (cursor - file)));
+    cursor = string_copy(string_from_ascii(" - "), cursor, sizeof(file) - (cursor - file));
+    cursor = string_copy(translation_for(TR_SAVE_DIALOG_POPULATION), cursor, sizeof(file) - (cursor - file));
+    cursor = string_copy(string_from_ascii(" "), cursor, sizeof(file) - (cursor - file));
+    string_from_int(cursor, info->population, 0);
+    c->precomposed_text = file;
+    c->type = TOOLTIP_BUTTON;
 }
 
 static void handle_tooltip(tooltip_context *c)
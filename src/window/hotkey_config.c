@@ -75,6 +75,7 @@ static hotkey_widget hotkey_widgets[] = {
     {HOTKEY_ROTATE_BUILDING_BACK, TR_HOTKEY_ROTATE_BUILDING_BACK},
     {HOTKEY_SHOW_EMPIRE_MAP, TR_HOTKEY_SHOW_EMPIRE_MAP},
     {HOTKEY_SHOW_MESSAGES, TR_HOTKEY_SHOW_MESSAGES},
+    {HOTKEY_REWIND_TO_SNAPSHOT, TR_HOTKEY_REWIND_TO_SNAPSHOT},
     {HOTKEY_HEADER, TR_HOTKEY_HEADER_BUILD},
     {HOTKEY_BUILD_CLONE, TR_HOTKEY_BUILD_CLONE},
     {HOTKEY_COPY_BUILDING_SETTINGS, TR_HOTKEY_COPY_SETTINGS},